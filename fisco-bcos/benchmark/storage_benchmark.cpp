@@ -32,6 +32,7 @@
 #include <libstorage/MemoryTableFactoryFactory2.h>
 #include <libstorage/RocksDBStorage.h>
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -40,6 +41,7 @@
 #include <boost/log/support/date_time.hpp>
 #include <boost/log/utility/setup/common_attributes.hpp>
 #include <boost/log/utility/setup/from_stream.hpp>
+#include <malloc.h>
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -183,31 +185,120 @@ void testMemoryTable2(size_t round, size_t count, bool verify)
               << std::setprecision(4) << elapsed.count() << std::endl;
 }
 
-int main(int argc, char* argv[])
+void testEntryLayout(size_t count)
 {
-    (void)argc;
-    (void)argv;
-
-    boost::multi_index_container<std::pair<std::string, std::string>,
-        boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
-            boost::multi_index::hashed_unique<
-                boost::multi_index::identity<std::pair<std::string, std::string> > > > >
-        m_mru;
-    m_mru.push_back(std::make_pair("a", "b"));
-    m_mru.push_back(std::make_pair("b", "c"));
-    m_mru.push_back(std::make_pair("a", "b"));
-
-    for (auto it = m_mru.begin(); it != m_mru.end();)
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "test_entry";
+    tableInfo->key = "key";
+    tableInfo->fields = std::vector<std::string>{"value", STATUS, "key", NUM_FIELD, ID_FIELD};
+
+    auto memoryTable = std::make_shared<MemoryTable2>();
+    memoryTable->setTableInfo(tableInfo);
+    memoryTable->setRecorder(
+        [](Table::Ptr, Change::Kind, std::string const&, std::vector<Change::Record>&) {});
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back((boost::format("%064x") % i).str());
+    }
+
+    auto before = mallinfo();
+    std::vector<Entry::Ptr> entries;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto entry = memoryTable->newEntry();
+        entry->setField("key", keys[i]);
+        entry->setField("value", "0x1234567890");
+        entry->setID(i + 1);
+        entry->setNum(1);
+        entries.push_back(entry);
+    }
+    auto after = mallinfo();
+    std::cout << "Entry bytes: " << (double)(after.uordblks - before.uordblks) / count
+              << " per entry, fields: " << entries[0]->size() << std::endl;
+    entries.clear();
+
+    auto start = std::chrono::system_clock::now();
+    for (size_t i = 0; i < count; ++i)
     {
-        std::cout << "item: " << it->first << ", " << it->second;
+        auto entry = memoryTable->newEntry();
+        entry->setField("value", "0x1234567890");
+        memoryTable->insert(keys[i], entry, std::make_shared<AccessOptions>(Address(), false));
+    }
+    std::chrono::duration<double> insertElapsed = std::chrono::system_clock::now() - start;
 
-        it = m_mru.erase(it);
+    start = std::chrono::system_clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        memoryTable->select(keys[i], memoryTable->newCondition());
     }
+    std::chrono::duration<double> selectElapsed = std::chrono::system_clock::now() - start;
+
+    std::cout << "MemoryTable2 insert: " << count / insertElapsed.count()
+              << " ops/s, select: " << count / selectElapsed.count() << " ops/s" << std::endl;
+}
 
-#if 0
+void testCacheScalability(size_t count, size_t maxThreads)
+{
+    CachedStorage::Ptr cachedStorage = std::make_shared<CachedStorage>();
+    // no backend, every key is committed into the cache first
+    cachedStorage->setMaxCapacity(0);
+    cachedStorage->setMaxForwardBlock(0);
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "test_cache";
+    tableInfo->key = "key";
+    tableInfo->fields = std::vector<std::string>{"value"};
+
+    auto tableData = std::make_shared<TableData>();
+    tableData->info = tableInfo;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto entry = std::make_shared<Entry>();
+        entry->setField("key", (boost::format("[%08d]") % i).str());
+        entry->setField("value", "0");
+        entry->setForce(true);
+        tableData->newEntries->addEntry(entry);
+    }
+    cachedStorage->commit(dev::h256(0), 1, std::vector<TableData::Ptr>{tableData});
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back((boost::format("[%08d]") % i).str());
+    }
+
+    std::cout << "Cache shards: " << cachedStorage->shardNum() << std::endl;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        tbb::task_arena arena(threads);
+
+        auto start = std::chrono::system_clock::now();
+        arena.execute([&]() {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, count * 10),
+                [&](const tbb::blocked_range<size_t>& range) {
+                    for (size_t j = range.begin(); j < range.end(); ++j)
+                    {
+                        cachedStorage->select(
+                            dev::h256(0), 2, tableInfo, keys[j % count], nullptr);
+                    }
+                });
+        });
+        std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - start;
+
+        std::cout << "Threads: " << threads << ", select: " << count * 10
+                  << ", elapsed: " << std::setiosflags(std::ios::fixed) << std::setprecision(4)
+                  << elapsed.count() << "s, throughput: " << (count * 10) / elapsed.count()
+                  << " ops/s" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
     if (argc < 3)
     {
-        std::cout << "Usage: " << argv[0] << " [round] [count] [verify]" << std::endl;
+        std::cout << "Usage: " << argv[0] << " [round] [count] [verify] [maxThreads]" << std::endl;
         return 1;
     }
 
@@ -228,9 +319,15 @@ int main(int argc, char* argv[])
     {
         verify = boost::lexical_cast<bool>(argv[3]);
     }
+    size_t maxThreads = std::thread::hardware_concurrency();
+    if (argc > 4)
+    {
+        maxThreads = boost::lexical_cast<size_t>(argv[4]);
+    }
 
     testMemoryTable2(round, count, verify);
-#endif
+    testEntryLayout(count);
+    testCacheScalability(count, maxThreads);
 
     return 0;
 }
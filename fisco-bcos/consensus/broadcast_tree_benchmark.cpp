@@ -0,0 +1,125 @@
+/**
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ *
+ * @brief: simulates the leader egress and the commit latency of broadcasting the prepare to all
+ * the sealers directly and along the broadcast tree, every node sends over one uplink of the
+ * given bandwidth, every hop adds the given latency and every sealer executes the block before
+ * signing it
+ *
+ * @file: broadcast_tree_benchmark.cpp
+ */
+
+#include <libconsensus/pbft/Common.h>
+#include <libdevcore/easylog.h>
+#include <algorithm>
+#include <iomanip>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std;
+using namespace dev;
+using namespace dev::consensus;
+
+struct SimulateResult
+{
+    /// bytes sent by the leader for one prepare
+    size_t leaderEgress = 0;
+    /// ms until 2f+1 sealers hold the prepare
+    double quorumTime = 0;
+    /// ms until all the sealers hold the prepare
+    double allTime = 0;
+};
+
+/// every node sends the prepare to its children one after another over its uplink, a relaying
+/// node starts sending _relayDelay ms after it received the prepare
+static SimulateResult simulate(IDXTYPE _nodeNum, unsigned _width, size_t _prepareSize,
+    double _bandwidth, double _latency, double _relayDelay = 0)
+{
+    SimulateResult result;
+    double sendTime = (double)_prepareSize / (_bandwidth * 1024 * 1024) * 1000;
+    std::vector<double> receiveTime(_nodeNum, 0);
+    BroadcastTree tree(_nodeNum, _width == 0 ? _nodeNum : _width, 0);
+    std::vector<IDXTYPE> level = {0};
+    while (!level.empty())
+    {
+        std::vector<IDXTYPE> next;
+        for (auto idx : level)
+        {
+            auto children = tree.children(idx);
+            for (size_t i = 0; i < children.size(); i++)
+            {
+                receiveTime[children[i]] = receiveTime[idx] + (idx == 0 ? 0 : _relayDelay) +
+                                           (i + 1) * sendTime + _latency;
+                next.push_back(children[i]);
+            }
+            if (idx == 0)
+            {
+                result.leaderEgress = children.size() * _prepareSize;
+            }
+        }
+        level = next;
+    }
+    std::sort(receiveTime.begin(), receiveTime.end());
+    IDXTYPE quorum = _nodeNum - (_nodeNum - 1) / 3;
+    result.quorumTime = receiveTime[quorum - 1];
+    result.allTime = receiveTime.back();
+    return result;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage:   broadcast-tree-benchmark <tree width> [prepare size(KB)] "
+                     "[uplink bandwidth(MB/s)] [hop latency(ms)] [block execution(ms)]"
+                  << std::endl;
+        std::cout << "Example: broadcast-tree-benchmark 3 1024 10 20 100" << std::endl;
+        return 0;
+    }
+    unsigned width = atoi(argv[1]);
+    size_t prepareSize = (argc > 2 ? atoi(argv[2]) : 1024) * 1024;
+    double bandwidth = argc > 3 ? atof(argv[3]) : 10;
+    double latency = argc > 4 ? atof(argv[4]) : 20;
+    double execution = argc > 5 ? atof(argv[5]) : 100;
+
+    /// the last column relays the prepare only after executing its block, as nodes did before
+    std::cout << std::setw(6) << "nodes" << std::setw(18) << "egress(KB)" << std::setw(24)
+              << "quorum prepare(ms)" << std::setw(30) << "commit latency(ms)" << std::endl;
+    std::cout << std::setw(6) << "" << std::setw(18) << "direct/tree" << std::setw(24)
+              << "direct/tree" << std::setw(30) << "direct/tree/relay after exec" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (IDXTYPE nodeNum : {4, 7, 10, 16, 25, 40, 64, 100})
+    {
+        auto direct = simulate(nodeNum, 0, prepareSize, bandwidth, latency);
+        auto relay = simulate(nodeNum, width, prepareSize, bandwidth, latency);
+        auto relayAfterExec = simulate(nodeNum, width, prepareSize, bandwidth, latency, execution);
+        /// a sealer signs once it executed the block, the sign and the commit rounds are small
+        /// all-to-all messages
+        auto commit = [latency, execution](SimulateResult const& _result) {
+            return _result.quorumTime + execution + 2 * latency;
+        };
+        std::cout << std::setw(6) << nodeNum << std::setw(18)
+                  << (to_string(direct.leaderEgress / 1024) + "/" +
+                         to_string(relay.leaderEgress / 1024))
+                  << std::setw(24)
+                  << (to_string((int)direct.quorumTime) + "/" + to_string((int)relay.quorumTime))
+                  << std::setw(30)
+                  << (to_string((int)commit(direct)) + "/" + to_string((int)commit(relay)) + "/" +
+                         to_string((int)commit(relayAfterExec)))
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ *
+ * @brief: request/response benchmark of the p2p network between two local nodes
+ *
+ * @file: p2p_benchmark.cpp
+ */
+
+#include <libdevcore/easylog.h>
+#include <libinitializer/BoostLogInitializer.h>
+#include <libinitializer/GlobalConfigureInitializer.h>
+#include <libinitializer/P2PInitializer.h>
+#include <libinitializer/SecureInitializer.h>
+#include <libp2p/P2PMessageFactory.h>
+#include <libp2p/P2PSession.h>
+#include <libp2p/Service.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std;
+using namespace dev;
+using namespace dev::p2p;
+using namespace dev::initializer;
+
+/// not used by any module of the node
+static const PROTOCOL_ID c_benchmarkProtocol = 0x7f00;
+
+static std::shared_ptr<P2PInitializer> initP2P(std::string const& _configPath)
+{
+    boost::property_tree::ptree pt;
+    boost::property_tree::read_ini(_configPath, pt);
+
+    auto logInitializer = std::make_shared<LogInitializer>();
+    logInitializer->initLog(pt);
+    initGlobalConfig(pt);
+
+    auto secureInitializer = std::make_shared<SecureInitializer>();
+    secureInitializer->initConfig(pt);
+
+    auto p2pInitializer = std::make_shared<P2PInitializer>();
+    p2pInitializer->setSSLContext(
+        secureInitializer->SSLContext(SecureInitializer::Usage::ForP2P));
+    p2pInitializer->setKeyPair(secureInitializer->keyPair());
+    p2pInitializer->initConfig(pt);
+    return p2pInitializer;
+}
+
+/// answer every benchmark request with its own payload
+static void startEcho(std::shared_ptr<Service> _service)
+{
+    std::cout << "Echo node: " << _service->id().hex() << std::endl;
+    _service->registerHandlerByProtoclID(c_benchmarkProtocol,
+        [_service](dev::network::NetworkException _e, std::shared_ptr<P2PSession> _session,
+            P2PMessage::Ptr _request) {
+            if (_e.errorCode() != 0 || !_session)
+            {
+                return;
+            }
+            auto response = std::dynamic_pointer_cast<P2PMessage>(
+                _service->p2pMessageFactory()->buildMessage());
+            response->setProtocolID(-c_benchmarkProtocol);
+            response->setSeq(_request->seq());
+            response->setBuffer(_request->buffer());
+            _session->session()->asyncSendMessage(response);
+        });
+
+    while (true)
+    {
+        this_thread::sleep_for(chrono::seconds(1));
+    }
+}
+
+static void startSend(std::shared_ptr<Service> _service, NodeID const& _peer, size_t _msgSize,
+    size_t _msgCount, size_t _inFlight)
+{
+    std::cout << "Waiting for " << _peer.abridged() << " ..." << std::endl;
+    while (!_service->isConnected(_peer))
+    {
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t sent = 0;
+    size_t received = 0;
+    size_t failed = 0;
+    std::shared_ptr<P2PSession> session;
+    std::vector<uint64_t> latencies;
+    latencies.reserve(_msgCount);
+
+    auto payload = std::make_shared<bytes>(_msgSize, 0x5a);
+    dev::network::Options options;
+    options.timeout = 10000;
+    auto start = chrono::steady_clock::now();
+    std::unique_lock<std::mutex> l(mutex);
+    while (received < _msgCount)
+    {
+        /// keep _inFlight requests outstanding
+        while (sent < _msgCount && sent - received < _inFlight)
+        {
+            auto request = std::dynamic_pointer_cast<P2PMessage>(
+                _service->p2pMessageFactory()->buildMessage());
+            request->setProtocolID(c_benchmarkProtocol);
+            request->setBuffer(payload);
+            auto sendTime = chrono::steady_clock::now();
+            ++sent;
+            l.unlock();
+            _service->asyncSendMessageByNodeID(_peer, request,
+                [&, sendTime](dev::network::NetworkException _e,
+                    std::shared_ptr<P2PSession> _session, P2PMessage::Ptr) {
+                    auto latency = chrono::duration_cast<chrono::microseconds>(
+                        chrono::steady_clock::now() - sendTime)
+                                       .count();
+                    std::lock_guard<std::mutex> guard(mutex);
+                    if (_e.errorCode() != 0)
+                    {
+                        ++failed;
+                    }
+                    else if (!session)
+                    {
+                        session = _session;
+                    }
+                    latencies.push_back(latency);
+                    ++received;
+                    cv.notify_one();
+                },
+                options);
+            l.lock();
+        }
+        cv.wait(l);
+    }
+    auto elapsed =
+        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double _p) { return latencies[(size_t)(_p * (latencies.size() - 1))]; };
+    std::cout << "messages: " << _msgCount << ", size: " << _msgSize << ", in flight: " << _inFlight
+              << ", failed: " << failed << std::endl;
+    std::cout << "throughput: " << (double)_msgCount * 1000000 / elapsed << " msg/s, "
+              << (double)_msgCount * _msgSize / elapsed << " MB/s" << std::endl;
+    std::cout << "latency(us): p50 " << percentile(0.5) << ", p99 " << percentile(0.99)
+              << ", max " << latencies.back() << std::endl;
+    if (session)
+    {
+        auto readStatus = session->session()->readStatus();
+        std::cout << "receive: " << readStatus.readMessages << " messages, "
+                  << (double)readStatus.readChunks * 1024 * 1024 /
+                         std::max<uint64_t>(readStatus.readBytes, 1)
+                  << " buffer allocations per MB" << std::endl;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 3 || (string(argv[2]) == "send" && argc < 4))
+    {
+        std::cout << "Usage:   p2p-benchmark <config.ini> echo" << std::endl;
+        std::cout << "         p2p-benchmark <config.ini> send <peer node id> [message size] "
+                     "[message count] [in flight]"
+                  << std::endl;
+        std::cout << "Example: p2p-benchmark node1/config.ini send "
+                     "<node id of node0> 256 100000 1000"
+                  << std::endl;
+        return 0;
+    }
+
+    auto p2pInitializer = initP2P(argv[1]);
+    auto service = p2pInitializer->p2pService();
+    if (string(argv[2]) == "echo")
+    {
+        startEcho(service);
+    }
+    else
+    {
+        size_t msgSize = argc > 4 ? atoi(argv[4]) : 256;
+        size_t msgCount = argc > 5 ? atoi(argv[5]) : 100000;
+        size_t inFlight = argc > 6 ? atoi(argv[6]) : 1000;
+        startSend(service, NodeID(string(argv[3])), msgSize, msgCount, inFlight);
+    }
+    p2pInitializer->stop();
+    return 0;
+}
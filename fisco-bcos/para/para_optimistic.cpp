@@ -0,0 +1,194 @@
+/**
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ *
+ * @brief: benchmark of the optimistic executor on blocks mixing parallel and non-parallel txs
+ *
+ * @file: para_optimistic.cpp
+ */
+#include <libblockchain/BlockChainImp.h>
+#include <libblockverifier/BlockVerifier.h>
+#include <libdevcore/easylog.h>
+#include <libethcore/ABI.h>
+#include <libethcore/Protocol.h>
+#include <libinitializer/Initializer.h>
+#include <libinitializer/LedgerInitializer.h>
+#include <libledger/DBInitializer.h>
+#include <libledger/LedgerManager.h>
+#include <unistd.h>
+#include <chrono>
+#include <ctime>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::ledger;
+using namespace dev::initializer;
+using namespace dev::txpool;
+using namespace dev::blockverifier;
+using namespace dev::blockchain;
+INITIALIZE_EASYLOGGINGPP
+
+static shared_ptr<Secret> sec;
+
+Transaction genTx(Address const& _dest, bytes const& _data)
+{
+    u256 value = 0;
+    u256 gasPrice = 0;
+    u256 gas = 10000000;
+    u256 nonce = u256(utcTime() + rand());
+    Transaction tx(value, gasPrice, gas, _dest, _data, nonce);
+    tx.setBlockLimit(250);
+    Signature sig = sign(*sec, tx.sha3(WithoutSignature));
+    tx.updateSignature(SignatureStruct(sig));
+    return tx;
+}
+
+void genTxUserAddBlock(Block& _block, size_t _userNum)
+{
+    Transactions txs;
+    dev::eth::ContractABI abi;
+    for (size_t i = 0; i < _userNum; i++)
+    {
+        txs.push_back(genTx(Address(0x5002),
+            abi.abiIn("userSave(string,uint256)", to_string(i), u256(1000000000))));
+    }
+
+    _block.setTransactions(txs);
+    for (auto& tx : _block.transactions())
+        tx.sender();
+}
+
+// Every _interval-th tx registers a CNS name, CNSPrecompiled is not a parallel precompile so
+// the DAG turns each of them into a barrier
+void genMixedBlock(Block& _block, size_t _userNum, size_t _txNum, size_t _interval)
+{
+    Transactions txs;
+    dev::eth::ContractABI abi;
+    srand(utcTime());
+    for (size_t i = 0; i < _txNum; i++)
+    {
+        if (_interval > 0 && i % _interval == _interval - 1)
+        {
+            txs.push_back(genTx(Address(0x1004),
+                abi.abiIn("insert(string,string,string,string)", "bench" + to_string(i), "1.0",
+                    Address(0x5002).hex(), string(""))));
+            continue;
+        }
+
+        string userFrom = to_string(rand() % _userNum);
+        string userTo = to_string(rand() % _userNum);
+        txs.push_back(genTx(Address(0x5002),
+            abi.abiIn("userTransfer(string,string,uint256)", userFrom, userTo, u256(1))));
+    }
+
+    _block.setTransactions(txs);
+    for (auto& tx : _block.transactions())
+        tx.sender();
+}
+
+static void startExecute(int _totalUser, int _totalTxs, int _interval, int _round)
+{
+    boost::property_tree::ptree pt;
+    LogInitializer log;
+    log.initLog(pt);
+
+    std::shared_ptr<LedgerParamInterface> params = std::make_shared<LedgerParam>();
+    params->mutableStorageParam().type = "LevelDB";
+    params->mutableStorageParam().path = "/tmp/data/block";
+    params->mutableStateParam().type = "storage";
+
+    auto dbInitializer = std::make_shared<dev::ledger::DBInitializer>(params);
+    dbInitializer->initStorageDB();
+    std::shared_ptr<BlockChainImp> blockChain = std::make_shared<BlockChainImp>();
+    blockChain->setStateStorage(dbInitializer->storage());
+    blockChain->setTableFactoryFactory(dbInitializer->tableFactoryFactory());
+
+    GenesisBlockParam initParam = {"", dev::h512s(), dev::h512s(), "consensusType", "storageType",
+        "stateType", 5000, 300000000, 0};
+    bool ret = blockChain->checkAndBuildGenesisBlock(initParam);
+    assert(ret == true);
+
+    dev::h256 genesisHash = blockChain->getBlockByNumber(0)->headerHash();
+    dbInitializer->initState(genesisHash);
+
+    std::shared_ptr<BlockVerifier> blockVerifier = std::make_shared<BlockVerifier>(true);
+    blockVerifier->setExecutiveContextFactory(dbInitializer->executiveContextFactory());
+    blockVerifier->setNumberHash(boost::bind(&BlockChainImp::numberHash, blockChain, _1));
+
+    auto height = blockChain->number();
+    auto parentBlock = blockChain->getBlockByNumber(height);
+    BlockInfo parentBlockInfo = {parentBlock->header().hash(), parentBlock->header().number(),
+        parentBlock->header().stateRoot()};
+
+    std::cout << "Creating user..." << std::endl;
+    Block userAddBlock;
+    userAddBlock.header().setNumber(parentBlockInfo.number + 1);
+    userAddBlock.header().setParentHash(parentBlockInfo.hash);
+    genTxUserAddBlock(userAddBlock, _totalUser);
+    auto exeCtx = blockVerifier->executeBlock(userAddBlock, parentBlockInfo);
+    blockChain->commitBlock(userAddBlock, exeCtx);
+
+    parentBlock = blockChain->getBlockByNumber(height + 1);
+    parentBlockInfo = {parentBlock->header().hash(), parentBlock->header().number(),
+        parentBlock->header().stateRoot()};
+
+    Block block;
+    block.header().setNumber(parentBlockInfo.number + 1);
+    block.header().setParentHash(parentBlockInfo.hash);
+    genMixedBlock(block, _totalUser, _totalTxs, _interval);
+
+    // roots are cleared once per mode, the later rounds throw if they do not reproduce them
+    auto run = [&](const string& _name, std::function<void()> _execute) {
+        block.header().setStateRoot(h256());
+        block.header().setReceiptsRoot(h256());
+        block.header().setDBhash(h256());
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < _round; i++)
+        {
+            _execute();
+        }
+        auto elapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+        std::cout << _name << ": " << (double)_totalTxs * _round * 1000000 / elapsed.count()
+                  << " tx/s, stateRoot " << block.header().stateRoot().abridged()
+                  << ", receiptRoot " << block.header().receiptsRoot().abridged() << std::endl;
+    };
+
+    run("serial    ", [&]() { blockVerifier->serialExecuteBlock(block, parentBlockInfo); });
+    run("dag       ", [&]() { blockVerifier->parallelExecuteBlock(block, parentBlockInfo); });
+    blockVerifier->setEnableOptimistic(true);
+    run("optimistic", [&]() { blockVerifier->parallelExecuteBlock(block, parentBlockInfo); });
+    exit(0);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage:   para_optimistic <total user> <total txs> <non-para tx interval> "
+                     "[round]"
+                  << std::endl;
+        std::cout << "Example: para_optimistic 1000 10000 10 10" << std::endl;
+        return 0;
+    }
+    sec = make_shared<Secret>(KeyPair::create().secret());
+    int totalUser = atoi(argv[1]);
+    int totalTxs = atoi(argv[2]);
+    int interval = atoi(argv[3]);
+    int round = argc > 4 ? atoi(argv[4]) : 10;
+    startExecute(totalUser, totalTxs, interval, round);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief: export the RocksDB of a stopped node at its head block into a snapshot file, or load
+ * the snapshot into the empty RocksDB of a new node which then syncs from the next block. The
+ * head block of the snapshot is checked against the hash given by --hash, which is to be taken
+ * from a node of the group instead of from the one providing the snapshot
+ * @file: rocksdb_snapshot.cpp
+ */
+#include <libdevcore/CommonData.h>
+#include <libstorage/BasicRocksDB.h>
+#include <libstorage/RocksDBSnapshot.h>
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std;
+using namespace dev;
+using namespace dev::storage;
+namespace po = boost::program_options;
+
+namespace
+{
+void printManifest(RocksDBSnapshot::Manifest const& _manifest)
+{
+    cout << "block number: " << _manifest.number << endl
+         << "block hash: " << _manifest.blockHash.hex() << endl
+         << "stateRoot: " << _manifest.stateRoot.hex() << endl
+         << "dbHash: " << _manifest.dbHash.hex() << endl
+         << "keys: " << _manifest.keys << ", chunks: " << _manifest.chunks << endl;
+}
+}  // namespace
+
+int main(int argc, const char* argv[])
+{
+    po::options_description options("Export or import the snapshot of RocksDB at the head block");
+    options.add_options()("help,h", "help of rocksdb-snapshot")("path,p", po::value<string>(),
+        "[RocksDB path], e.g. data/group1/block/RocksDB")(
+        "export,e", po::value<string>(), "[snapshot file] export the RocksDB of a stopped node")(
+        "import,i", po::value<string>(), "[snapshot file] import into an empty RocksDB")(
+        "verify,v", po::value<string>(), "[snapshot file] verify the snapshot without importing")(
+        "hash", po::value<string>(), "[hash of the head block] trusted, needed by import")(
+        "number", po::value<int64_t>(), "[number of the head block] trusted")(
+        "chunk,c", po::value<size_t>()->default_value(4), "[MB of the keys in one chunk]")(
+        "sst,s", po::value<size_t>()->default_value(256), "[MB of one SST file when importing]");
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, options), vm);
+        po::notify(vm);
+    }
+    catch (...)
+    {
+        cout << "invalid input" << endl;
+        return -1;
+    }
+    if (vm.count("help") || vm.count("export") + vm.count("import") + vm.count("verify") != 1 ||
+        (!vm.count("verify") && !vm.count("path")) || (vm.count("import") && !vm.count("hash")))
+    {
+        cout << options << endl;
+        return vm.count("help") ? 0 : -1;
+    }
+    auto chunkSize = max<size_t>(1, vm["chunk"].as<size_t>()) * 1024 * 1024;
+    auto sstSize = max<size_t>(1, vm["sst"].as<size_t>()) * 1024 * 1024;
+    h256 trustedHash;
+    int64_t trustedNumber = vm.count("number") ? vm["number"].as<int64_t>() : -1;
+    if (vm.count("hash"))
+    {
+        auto hash = vm["hash"].as<string>();
+        if (!isHash<h256>(hash))
+        {
+            cerr << "invalid block hash: " << hash << endl;
+            return -1;
+        }
+        trustedHash = h256(hash);
+    }
+
+    try
+    {
+        if (vm.count("verify"))
+        {
+            ifstream in(vm["verify"].as<string>(), ios::binary);
+            if (!in)
+            {
+                cerr << "Open snapshot failed: " << vm["verify"].as<string>() << endl;
+                return -1;
+            }
+            printManifest(RocksDBSnapshot::verifySnapshot(in, trustedHash, trustedNumber));
+            cout << "snapshot verified" << endl;
+            return 0;
+        }
+
+        auto path = vm["path"].as<string>();
+        bool exportSnapshot = vm.count("export");
+        if (exportSnapshot && !boost::filesystem::exists(path))
+        {
+            cerr << "RocksDB path not found: " << path << endl;
+            return -1;
+        }
+        rocksdb::Options dbOptions;
+        dbOptions.create_if_missing = !exportSnapshot;
+        dbOptions.max_open_files = 200;
+        dbOptions.compression = rocksdb::kSnappyCompression;
+        auto basicDB = make_shared<dev::db::BasicRocksDB>();
+        shared_ptr<rocksdb::DB> db;
+        try
+        {
+            /// fails if the node holds the lock of the directory
+            db = basicDB->Open(dbOptions, path);
+        }
+        catch (exception const& e)
+        {
+            cerr << "Open RocksDB failed, please stop the node first: "
+                 << boost::diagnostic_information(e) << endl;
+            return -1;
+        }
+
+        if (exportSnapshot)
+        {
+            auto file = vm["export"].as<string>();
+            ofstream out(file, ios::binary | ios::trunc);
+            if (!out)
+            {
+                cerr << "Open snapshot failed: " << file << endl;
+                return -1;
+            }
+            printManifest(RocksDBSnapshot::exportSnapshot(basicDB, db, out, chunkSize));
+            cout << "snapshot exported to " << file << endl;
+            return 0;
+        }
+
+        auto file = vm["import"].as<string>();
+        ifstream in(file, ios::binary);
+        if (!in)
+        {
+            cerr << "Open snapshot failed: " << file << endl;
+            return -1;
+        }
+        /// in the same file system with RocksDB, the SST files are moved instead of copied
+        auto sstDir = boost::filesystem::path(path).parent_path() / "snapshot_sst";
+        printManifest(RocksDBSnapshot::importSnapshot(
+            in, db, sstDir.string(), sstSize, trustedHash, trustedNumber));
+        cout << "snapshot imported, the node syncs from the next block" << endl;
+    }
+    catch (exception const& e)
+    {
+        cerr << "Snapshot failed: " << boost::diagnostic_information(e) << endl;
+        return -1;
+    }
+    return 0;
+}
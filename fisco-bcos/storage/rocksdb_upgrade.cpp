@@ -0,0 +1,160 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief: rewrite the rows of a RocksDB data directory written by boost::serialization in the
+ * RowCodec format, the node must be stopped. The converted values are skipped, so the tool can be
+ * run again after an interruption. With --downgrade the RowCodec values are rewritten in the
+ * legacy format instead, for going back to a node that reads the legacy rows only.
+ * @file: rocksdb_upgrade.cpp
+ */
+#include <libstorage/BasicRocksDB.h>
+#include <libstorage/RowCodec.h>
+#include <rocksdb/db.h>
+#include <rocksdb/write_batch.h>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <memory>
+
+INITIALIZE_EASYLOGGINGPP
+
+using namespace std;
+using namespace dev;
+using namespace dev::storage;
+namespace po = boost::program_options;
+
+int main(int argc, const char* argv[])
+{
+    po::options_description options("Upgrade the rows of RocksDB to the RowCodec format");
+    options.add_options()("help,h", "help of rocksdb-upgrade")("path,p", po::value<string>(),
+        "[RocksDB path], e.g. data/group1/block/RocksDB")(
+        "batch,b", po::value<size_t>()->default_value(10000), "[keys written in one batch]")(
+        "check,c", "count the rows to be converted without writing")(
+        "downgrade,d", "rewrite the RowCodec rows in the legacy format");
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, options), vm);
+        po::notify(vm);
+    }
+    catch (...)
+    {
+        cout << "invalid input" << endl;
+        return -1;
+    }
+    if (vm.count("help") || !vm.count("path"))
+    {
+        cout << options << endl;
+        return vm.count("help") ? 0 : -1;
+    }
+    auto path = vm["path"].as<string>();
+    auto batchSize = max<size_t>(1, vm["batch"].as<size_t>());
+    bool checkOnly = vm.count("check");
+    bool downgrade = vm.count("downgrade");
+    if (!boost::filesystem::exists(path))
+    {
+        cerr << "RocksDB path not found: " << path << endl;
+        return -1;
+    }
+
+    rocksdb::Options dbOptions;
+    dbOptions.create_if_missing = false;
+    dbOptions.max_open_files = 200;
+    dbOptions.compression = rocksdb::kSnappyCompression;
+    auto basicDB = make_shared<dev::db::BasicRocksDB>();
+    shared_ptr<rocksdb::DB> db;
+    try
+    {
+        /// fails if the node holds the lock of the directory
+        db = basicDB->Open(dbOptions, path);
+    }
+    catch (exception const& e)
+    {
+        cerr << "Open RocksDB failed, please stop the node first: "
+             << boost::diagnostic_information(e) << endl;
+        return -1;
+    }
+
+    size_t total = 0;
+    size_t upgraded = 0;
+    size_t written = 0;
+    rocksdb::WriteBatch batch;
+    auto writeBatch = [&]() -> bool {
+        if (batch.Count() == 0)
+        {
+            return true;
+        }
+        rocksdb::WriteOptions writeOptions;
+        writeOptions.sync = true;
+        auto status = db->Write(writeOptions, &batch);
+        if (!status.ok())
+        {
+            cerr << "Write RocksDB failed: " << status.ToString() << endl;
+            return false;
+        }
+        written += batch.Count();
+        batch.Clear();
+        cout << (downgrade ? "downgraded " : "upgraded ") << written << " keys" << endl;
+        return true;
+    };
+
+    unique_ptr<rocksdb::Iterator> it(db->NewIterator(rocksdb::ReadOptions()));
+    for (it->SeekToFirst(); it->Valid(); it->Next())
+    {
+        ++total;
+        auto value = it->value().ToString();
+        if (RowCodec::isLegacy(value) == downgrade)
+        {
+            continue;
+        }
+        string upgradedValue;
+        try
+        {
+            upgradedValue = downgrade ? RowCodec::downgrade(value) : RowCodec::upgrade(value);
+        }
+        catch (exception const& e)
+        {
+            /// the values of the disk encrypted nodes can not be decoded without the data key
+            cerr << "Decode the value of key " << it->key().ToString()
+                 << " failed, the data may be encrypted: " << e.what() << endl;
+            return -1;
+        }
+        ++upgraded;
+        if (checkOnly)
+        {
+            continue;
+        }
+        batch.Put(it->key(), upgradedValue);
+        if (batch.Count() >= batchSize && !writeBatch())
+        {
+            return -1;
+        }
+    }
+    if (!it->status().ok())
+    {
+        cerr << "Iterate RocksDB failed: " << it->status().ToString() << endl;
+        return -1;
+    }
+    if (!checkOnly && !writeBatch())
+    {
+        return -1;
+    }
+    cout << "keys: " << total << (downgrade ? ", version 1: " : ", legacy: ") << upgraded
+         << (checkOnly ? ", nothing written" : (downgrade ? ", all downgraded" : ", all upgraded"))
+         << endl;
+    return 0;
+}
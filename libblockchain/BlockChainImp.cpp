@@ -29,6 +29,7 @@
 #include <libethcore/CommonJS.h>
 #include <libethcore/Transaction.h>
 #include <libprecompiled/ConsensusPrecompiled.h>
+#include <libstorage/BasicRocksDB.h>
 #include <libstorage/StorageException.h>
 #include <libstorage/Table.h>
 #include <tbb/parallel_for.h>
@@ -51,50 +52,282 @@ using namespace dev::precompiled;
 
 using boost::lexical_cast;
 
-std::shared_ptr<Block> BlockCache::add(Block const& _block)
+BlockCache::BlockCache(uint64_t _capacity)
 {
+    m_capacity = _capacity;
+    m_size = 0;
+    m_tick = 0;
+    m_queryTimes = 0;
+    m_hitTimes = 0;
+    m_rlpQueryTimes = 0;
+    m_rlpHitTimes = 0;
+    m_evictTimes = 0;
+}
+
+std::shared_ptr<Block> BlockCache::add(Block const& _block, std::shared_ptr<bytes> _blockRLP)
+{
+    return add(std::make_shared<Block>(_block), _blockRLP);
+}
+
+std::shared_ptr<Block> BlockCache::add(
+    std::shared_ptr<Block> _block, std::shared_ptr<bytes> _blockRLP)
+{
+    insert(_block->blockHeader().hash(), _block->blockHeader().number(), _block, _blockRLP);
+    return _block;
+}
+
+void BlockCache::addRLP(h256 const& _hash, int64_t _number, std::shared_ptr<bytes> _blockRLP)
+{
+    insert(_hash, _number, nullptr, _blockRLP);
+}
+
+void BlockCache::insert(h256 const& _hash, int64_t _number, std::shared_ptr<Block> _block,
+    std::shared_ptr<bytes> _blockRLP)
+{
+    uint64_t blockSize = _block ? decodedSize(*_block) : 0;
+    uint64_t keepFrom = 0;
     {
-        WriteGuard guard(m_sharedMutex);
-        if (m_blockCache.size() > c_blockCacheSize)
+        auto& cacheShard = shard(_hash);
+        std::lock_guard<std::mutex> l(cacheShard.mutex);
+        auto it = cacheShard.index.find(_hash);
+        if (it == cacheShard.index.end())
         {
-            BLOCKCHAIN_LOG(TRACE) << LOG_DESC("[add]Block cache full, start to remove old item...");
-            auto firstHash = m_blockCacheFIFO.front();
-            m_blockCacheFIFO.pop_front();
-            m_blockCache.erase(firstHash);
-            // in case something unexcept error
-            if (m_blockCache.size() > c_blockCacheSize)
+            cacheShard.lru.push_front(Item{_hash, _number, nullptr, nullptr, 0, 0});
+            it = cacheShard.index.emplace(_hash, cacheShard.lru.begin()).first;
+            WriteGuard ll(m_numberMutex);
+            m_numberIndex[_number] = _hash;
+        }
+        touch(cacheShard, it->second);
+        auto& item = *it->second;
+        uint64_t size = 0;
+        if (_block)
+        {
+            item.block = _block;
+            size += blockSize;
+        }
+        else if (item.block)
+        {
+            size += item.size - (item.blockRLP ? item.blockRLP->size() : 0);
+        }
+        if (_blockRLP)
+        {
+            item.blockRLP = _blockRLP;
+        }
+        if (item.blockRLP)
+        {
+            size += item.blockRLP->size();
+        }
+        m_size += size;
+        m_size -= item.size;
+        item.size = size;
+        keepFrom = item.lastUsed;
+    }
+    evict(keepFrom);
+}
+
+void BlockCache::touch(Shard& _shard, std::list<Item>::iterator _it)
+{
+    _shard.lru.splice(_shard.lru.begin(), _shard.lru, _it);
+    _it->lastUsed = ++m_tick;
+}
+
+void BlockCache::evict(uint64_t _keepFrom)
+{
+    std::lock_guard<std::mutex> l(m_evictMutex);
+    while (m_size > m_capacity)
+    {
+        /// the tail of every shard is its least recently used item
+        Shard* victim = nullptr;
+        uint64_t oldest = _keepFrom;
+        for (auto& cacheShard : m_shards)
+        {
+            std::lock_guard<std::mutex> ll(cacheShard.mutex);
+            if (!cacheShard.lru.empty() && cacheShard.lru.back().lastUsed < oldest)
             {
-                // meet error, cache and cacheFIFO not sync, clear the cache
-                m_blockCache.clear();
-                m_blockCacheFIFO.clear();
+                oldest = cacheShard.lru.back().lastUsed;
+                victim = &cacheShard;
             }
         }
+        if (!victim)
+        {
+            break;
+        }
+        std::lock_guard<std::mutex> ll(victim->mutex);
+        /// used again since the scan
+        if (victim->lru.empty() || victim->lru.back().lastUsed != oldest)
+        {
+            continue;
+        }
+        auto& item = victim->lru.back();
+        {
+            WriteGuard lll(m_numberMutex);
+            auto it = m_numberIndex.find(item.number);
+            if (it != m_numberIndex.end() && it->second == item.hash)
+            {
+                m_numberIndex.erase(it);
+            }
+        }
+        m_size -= item.size;
+        victim->index.erase(item.hash);
+        victim->lru.pop_back();
+        m_evictTimes++;
+    }
+}
 
-        auto blockHash = _block.blockHeader().hash();
-        auto block = std::make_shared<Block>(std::move(_block));
-        m_blockCache.insert(std::make_pair(blockHash, block));
-        // add hashindex to the blockCache queue, use to remove first element when the cache is full
-        m_blockCacheFIFO.push_back(blockHash);
+uint64_t BlockCache::decodedSize(Block const& _block)
+{
+    uint64_t size = sizeof(Block) + _block.blockHeader().sealerList().size() * sizeof(h512) +
+                    _block.sigList().size() * sizeof(std::pair<u256, Signature>);
+    for (auto const& tx : _block.transactions())
+    {
+        /// the data and the cached encoding of the transaction, which is mostly the data
+        size += sizeof(Transaction) + 2 * tx.data().size();
+    }
+    for (auto const& receipt : _block.transactionReceipts())
+    {
+        size += sizeof(TransactionReceipt) + receipt.outputBytes().size();
+        for (auto const& log : receipt.log())
+        {
+            size += sizeof(LogEntry) + log.topics.size() * sizeof(h256) + log.data.size();
+        }
+    }
+    return size;
+}
 
-        return block;
+h256 BlockCache::hashOf(int64_t _number)
+{
+    ReadGuard l(m_numberMutex);
+    auto it = m_numberIndex.find(_number);
+    if (it == m_numberIndex.end())
+    {
+        return h256();
     }
+    return it->second;
 }
 
 std::pair<std::shared_ptr<Block>, h256> BlockCache::get(h256 const& _hash)
 {
+    m_queryTimes++;
+    auto& cacheShard = shard(_hash);
+    std::lock_guard<std::mutex> l(cacheShard.mutex);
+    auto it = cacheShard.index.find(_hash);
+    if (it == cacheShard.index.end() || !it->second->block)
+    {
+        return std::make_pair(nullptr, h256(0));
+    }
+    touch(cacheShard, it->second);
+    m_hitTimes++;
+    return std::make_pair(it->second->block, _hash);
+}
+
+std::shared_ptr<Block> BlockCache::get(int64_t _number)
+{
+    h256 hash = hashOf(_number);
+    if (hash == h256())
     {
-        ReadGuard guard(m_sharedMutex);
+        m_queryTimes++;
+        return nullptr;
+    }
+    return get(hash).first;
+}
 
-        auto it = m_blockCache.find(_hash);
-        if (it == m_blockCache.end())
+std::shared_ptr<bytes> BlockCache::getRLP(h256 const& _hash)
+{
+    m_rlpQueryTimes++;
+    std::shared_ptr<Block> block;
+    {
+        auto& cacheShard = shard(_hash);
+        std::lock_guard<std::mutex> l(cacheShard.mutex);
+        auto it = cacheShard.index.find(_hash);
+        if (it == cacheShard.index.end())
+        {
+            return nullptr;
+        }
+        touch(cacheShard, it->second);
+        m_rlpHitTimes++;
+        if (it->second->blockRLP)
         {
-            return std::make_pair(nullptr, h256(0));
+            return it->second->blockRLP;
         }
+        block = it->second->block;
+    }
+    /// encode the block cached without its encoding outside the lock
+    auto blockRLP = block->rlpP();
+    insert(_hash, block->blockHeader().number(), nullptr, blockRLP);
+    return blockRLP;
+}
+
+std::shared_ptr<bytes> BlockCache::getRLP(int64_t _number)
+{
+    h256 hash = hashOf(_number);
+    if (hash == h256())
+    {
+        m_rlpQueryTimes++;
+        return nullptr;
+    }
+    return getRLP(hash);
+}
+
+void BlockCache::setCapacity(uint64_t _capacity)
+{
+    m_capacity = _capacity;
+    /// the most recently used block is kept
+    evict(m_tick);
+}
 
-        return std::make_pair(it->second, _hash);
+BlockCacheStatus BlockCache::status()
+{
+    BlockCacheStatus cacheStatus;
+    cacheStatus.queryTimes = m_queryTimes;
+    cacheStatus.hitTimes = m_hitTimes;
+    cacheStatus.rlpQueryTimes = m_rlpQueryTimes;
+    cacheStatus.rlpHitTimes = m_rlpHitTimes;
+    cacheStatus.evictTimes = m_evictTimes;
+    cacheStatus.capacity = m_capacity;
+    cacheStatus.size = m_size;
+    for (auto& cacheShard : m_shards)
+    {
+        std::lock_guard<std::mutex> l(cacheShard.mutex);
+        cacheStatus.blocks += cacheShard.lru.size();
     }
+    return cacheStatus;
+}
 
-    return std::make_pair(nullptr, h256(0));  // just make compiler happy
+void CommittedTxCache::add(std::shared_ptr<Block> _block)
+{
+    WriteGuard guard(m_sharedMutex);
+    auto const& txs = _block->transactions();
+    for (unsigned i = 0; i < txs.size(); i++)
+    {
+        m_txIndex[txs[i].sha3()] = std::make_pair(_block, i);
+    }
+    m_blocks.push_back(_block);
+    m_txNum += txs.size();
+    while (m_txNum > c_maxTxNum && m_blocks.size() > 1)
+    {
+        auto first = m_blocks.front();
+        m_blocks.pop_front();
+        for (auto const& tx : first->transactions())
+        {
+            auto it = m_txIndex.find(tx.sha3());
+            if (it != m_txIndex.end() && it->second.first == first)
+            {
+                m_txIndex.erase(it);
+            }
+        }
+        m_txNum -= first->transactions().size();
+    }
+}
+
+std::pair<std::shared_ptr<Block>, unsigned> CommittedTxCache::get(h256 const& _txHash)
+{
+    ReadGuard guard(m_sharedMutex);
+    auto it = m_txIndex.find(_txHash);
+    if (it == m_txIndex.end())
+    {
+        return std::make_pair(nullptr, 0);
+    }
+    return it->second;
 }
 
 void BlockChainImp::setStateStorage(Storage::Ptr stateStorage)
@@ -126,6 +359,11 @@ std::shared_ptr<Block> BlockChainImp::getBlock(int64_t _i)
     {
         return nullptr;
     }
+    auto cachedBlock = m_blockCache.get(_i);
+    if (cachedBlock)
+    {
+        return cachedBlock;
+    }
     string blockHash = "";
     Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_NUMBER_2_HASH);
     if (tb)
@@ -179,12 +417,13 @@ std::shared_ptr<Block> BlockChainImp::getBlock(dev::h256 const& _blockHash)
                 auto getField_time_cost = utcTime() - record_time;
                 record_time = utcTime();
 
-                auto block = Block(fromHex(strBlock.c_str()), CheckTransaction::None);
+                auto blockRLP = std::make_shared<bytes>(fromHex(strBlock.c_str()));
+                auto block = std::make_shared<Block>(*blockRLP, CheckTransaction::None);
                 auto constructBlock_time_cost = utcTime() - record_time;
                 record_time = utcTime();
 
                 BLOCKCHAIN_LOG(TRACE) << LOG_DESC("[#getBlock]Write to cache");
-                auto blockPtr = m_blockCache.add(block);
+                auto blockPtr = m_blockCache.add(block, blockRLP);
                 auto addCache_time_cost = utcTime() - record_time;
                 BLOCKCHAIN_LOG(DEBUG) << LOG_DESC("Get block from leveldb")
                                       << LOG_KV("getCacheTimeCost", getCache_time_cost)
@@ -211,6 +450,11 @@ std::shared_ptr<bytes> BlockChainImp::getBlockRLP(int64_t _i)
     {
         return nullptr;
     }
+    auto cachedRLP = m_blockCache.getRLP(_i);
+    if (cachedRLP)
+    {
+        return cachedRLP;
+    }
     string blockHash = "";
     Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_NUMBER_2_HASH);
     if (tb)
@@ -232,14 +476,14 @@ std::shared_ptr<bytes> BlockChainImp::getBlockRLP(dev::h256 const& _blockHash)
 {
     auto start_time = utcTime();
     auto record_time = utcTime();
-    auto cachedBlock = m_blockCache.get(_blockHash);
+    auto cachedRLP = m_blockCache.getRLP(_blockHash);
     auto getCache_time_cost = utcTime() - record_time;
     record_time = utcTime();
 
-    if (bool(cachedBlock.first))
+    if (bool(cachedRLP))
     {
         BLOCKCHAIN_LOG(TRACE) << LOG_DESC("[#getBlockRLP]Cache hit, read from cache");
-        std::shared_ptr<bytes> blockRLP = cachedBlock.first->rlpP();
+        std::shared_ptr<bytes> blockRLP = cachedRLP;
         BLOCKCHAIN_LOG(DEBUG) << LOG_DESC("Get block RLP from cache")
                               << LOG_KV("getCacheTimeCost", getCache_time_cost)
                               << LOG_KV("totalTimeCost", utcTime() - start_time);
@@ -267,6 +511,11 @@ std::shared_ptr<bytes> BlockChainImp::getBlockRLP(dev::h256 const& _blockHash)
                 auto blockRLP = std::make_shared<bytes>(fromHex(strBlock.c_str()));
                 auto blockRLP_time_cost = utcTime() - record_time;
 
+                /// only the header is decoded to index the cached encoding by number
+                BlockHeader header;
+                header.populate(BlockHeader::extractBlock(ref(*blockRLP))[0]);
+                m_blockCache.addRLP(_blockHash, header.number(), blockRLP);
+
                 BLOCKCHAIN_LOG(DEBUG) << LOG_DESC("Get block RLP from leveldb")
                                       << LOG_KV("getCacheTimeCost", getCache_time_cost)
                                       << LOG_KV("openTableTimeCost", openTable_time_cost)
@@ -764,60 +1013,109 @@ std::shared_ptr<bytes> BlockChainImp::getBlockRLPByNumber(int64_t _i)
     }
 }
 
-Transaction BlockChainImp::getTxByHash(dev::h256 const& _txHash)
+std::shared_ptr<bytes> BlockChainImp::getStateDiffByNumber(int64_t _i)
 {
-    Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_TX_HASH_2_BLOCK, false, true);
-    if (tb)
+    auto currentNumber = number();
+    if (!m_stateDiffDB || _i > currentNumber || _i <= currentNumber - m_stateDiffKeepBlocks)
+    {
+        return nullptr;
+    }
+    std::string value;
+    try
     {
-        string strblock = "";
-        string txIndex = "";
+        auto status = m_stateDiffDB->Get(
+            rocksdb::ReadOptions(), boost::lexical_cast<std::string>(_i), value);
+        if (!status.ok() || value.empty())
+        {
+            return nullptr;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        BLOCKCHAIN_LOG(WARNING) << LOG_DESC("[#getStateDiffByNumber]Read StateDiff failed")
+                                << LOG_KV("number", _i) << LOG_KV("what", e.what());
+        return nullptr;
+    }
+    return std::make_shared<bytes>(value.begin(), value.end());
+}
+
+bool BlockChainImp::getCommittedTx(
+    dev::h256 const& _txHash, CommittedTx& _committedTx, bool _withReceipt)
+{
+    auto cached = m_committedTxCache.get(_txHash);
+    std::shared_ptr<Block> pblock = cached.first;
+    unsigned txIndex = cached.second;
+    if (!pblock)
+    {
+        Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_TX_HASH_2_BLOCK, false, true);
+        if (!tb)
+        {
+            return false;
+        }
         auto entries = tb->select(_txHash.hex(), tb->newCondition());
-        if (entries->size() > 0)
+        if (entries->size() == 0)
         {
-            auto entry = entries->get(0);
-            strblock = entry->getField(SYS_VALUE);
-            txIndex = entry->getField("index");
-            std::shared_ptr<Block> pblock = getBlockByNumber(lexical_cast<int64_t>(strblock));
-            if (!pblock)
+            return false;
+        }
+        auto entry = entries->get(0);
+        auto blockNumber = lexical_cast<int64_t>(entry->getField(SYS_VALUE));
+        txIndex = lexical_cast<unsigned>(entry->getField("index"));
+        pblock = m_blockCache.get(blockNumber);
+        if (!pblock)
+        {
+            h256 blockHash = numberHash(blockNumber);
+            /// decode only the header, the transaction and the receipt of the stored block
+            auto blockRLP = getBlockRLP(blockHash);
+            if (!blockRLP)
             {
-                return Transaction();
+                return false;
             }
-            const std::vector<Transaction>& txs = pblock->transactions();
-            if (txs.size() > lexical_cast<uint>(txIndex))
+            BlockHeader header;
+            if (!Block::decodeAt(ref(*blockRLP), txIndex, header, &_committedTx.tx,
+                    _withReceipt ? &_committedTx.receipt : nullptr))
             {
-                return txs[lexical_cast<uint>(txIndex)];
+                return false;
             }
+            _committedTx.blockHash = header.hash();
+            _committedTx.blockNumber = header.number();
+            _committedTx.index = txIndex;
+            return true;
         }
     }
+    if (pblock->transactions().size() <= txIndex ||
+        (_withReceipt && pblock->transactionReceipts().size() <= txIndex))
+    {
+        return false;
+    }
+    _committedTx.tx = pblock->transactions()[txIndex];
+    if (_withReceipt)
+    {
+        _committedTx.receipt = pblock->transactionReceipts()[txIndex];
+    }
+    _committedTx.blockHash = pblock->headerHash();
+    _committedTx.blockNumber = pblock->blockHeader().number();
+    _committedTx.index = txIndex;
+    return true;
+}
+
+Transaction BlockChainImp::getTxByHash(dev::h256 const& _txHash)
+{
+    CommittedTx committedTx;
+    if (getCommittedTx(_txHash, committedTx, false))
+    {
+        return committedTx.tx;
+    }
     BLOCKCHAIN_LOG(TRACE) << LOG_DESC("[#getTxByHash]Can't find tx, return empty tx");
     return Transaction();
 }
 
 LocalisedTransaction BlockChainImp::getLocalisedTxByHash(dev::h256 const& _txHash)
 {
-    Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_TX_HASH_2_BLOCK, false, true);
-    if (tb)
+    CommittedTx committedTx;
+    if (getCommittedTx(_txHash, committedTx, false))
     {
-        string strblockhash = "";
-        string txIndex = "";
-        auto entries = tb->select(_txHash.hex(), tb->newCondition());
-        if (entries->size() > 0)
-        {
-            auto entry = entries->get(0);
-            strblockhash = entry->getField(SYS_VALUE);
-            txIndex = entry->getField("index");
-            std::shared_ptr<Block> pblock = getBlockByNumber(lexical_cast<int64_t>(strblockhash));
-            if (!pblock)
-            {
-                return LocalisedTransaction(Transaction(), h256(0), -1, -1);
-            }
-            const std::vector<Transaction>& txs = pblock->transactions();
-            if (txs.size() > lexical_cast<uint>(txIndex))
-            {
-                return LocalisedTransaction(txs[lexical_cast<uint>(txIndex)], pblock->headerHash(),
-                    lexical_cast<unsigned>(txIndex), pblock->blockHeader().number());
-            }
-        }
+        return LocalisedTransaction(committedTx.tx, committedTx.blockHash, committedTx.index,
+            committedTx.blockNumber);
     }
     BLOCKCHAIN_LOG(TRACE) << LOG_DESC(
         "[#getLocalisedTxByHash]Can't find tx, return empty localised tx");
@@ -826,28 +1124,10 @@ LocalisedTransaction BlockChainImp::getLocalisedTxByHash(dev::h256 const& _txHas
 
 TransactionReceipt BlockChainImp::getTransactionReceiptByHash(dev::h256 const& _txHash)
 {
-    Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_TX_HASH_2_BLOCK, false, true);
-    if (tb)
+    CommittedTx committedTx;
+    if (getCommittedTx(_txHash, committedTx, true))
     {
-        string strblock = "";
-        string txIndex = "";
-        auto entries = tb->select(_txHash.hex(), tb->newCondition());
-        if (entries->size() > 0)
-        {
-            auto entry = entries->get(0);
-            strblock = entry->getField(SYS_VALUE);
-            txIndex = entry->getField("index");
-            std::shared_ptr<Block> pblock = getBlockByNumber(lexical_cast<int64_t>(strblock));
-            if (!pblock)
-            {
-                return TransactionReceipt();
-            }
-            const TransactionReceipts& receipts = pblock->transactionReceipts();
-            if (receipts.size() > lexical_cast<uint>(txIndex))
-            {
-                return receipts[lexical_cast<uint>(txIndex)];
-            }
-        }
+        return committedTx.receipt;
     }
     BLOCKCHAIN_LOG(TRACE) << LOG_DESC(
         "[#getTransactionReceiptByHash]Can't find tx, return empty localised tx receipt");
@@ -856,34 +1136,14 @@ TransactionReceipt BlockChainImp::getTransactionReceiptByHash(dev::h256 const& _
 
 LocalisedTransactionReceipt BlockChainImp::getLocalisedTxReceiptByHash(dev::h256 const& _txHash)
 {
-    Table::Ptr tb = getMemoryTableFactory()->openTable(SYS_TX_HASH_2_BLOCK, false, true);
-    if (tb)
+    CommittedTx committedTx;
+    if (getCommittedTx(_txHash, committedTx, true))
     {
-        auto entries = tb->select(_txHash.hex(), tb->newCondition());
-        if (entries->size() > 0)
-        {
-            auto entry = entries->get(0);
-            auto blockNum = lexical_cast<int64_t>(entry->getField(SYS_VALUE));
-            auto txIndex = lexical_cast<uint>(entry->getField("index"));
-
-            std::shared_ptr<Block> pblock = getBlockByNumber(lexical_cast<int64_t>(blockNum));
-            if (!pblock)
-            {
-                return LocalisedTransactionReceipt(
-                    TransactionReceipt(), h256(0), h256(0), -1, Address(), Address(), -1, 0);
-            }
-            const Transactions& txs = pblock->transactions();
-            const TransactionReceipts& receipts = pblock->transactionReceipts();
-            if (receipts.size() > txIndex && txs.size() > txIndex)
-            {
-                auto& tx = txs[txIndex];
-                auto& receipt = receipts[txIndex];
-
-                return LocalisedTransactionReceipt(receipt, _txHash, pblock->headerHash(),
-                    pblock->header().number(), tx.from(), tx.to(), txIndex, receipt.gasUsed(),
-                    receipt.contractAddress());
-            }
-        }
+        auto const& tx = committedTx.tx;
+        auto const& receipt = committedTx.receipt;
+        return LocalisedTransactionReceipt(receipt, _txHash, committedTx.blockHash,
+            committedTx.blockNumber, tx.from(), tx.to(), committedTx.index, receipt.gasUsed(),
+            receipt.contractAddress());
     }
     BLOCKCHAIN_LOG(TRACE) << LOG_DESC(
         "[#getLocalisedTxReceiptByHash]Can't find tx, return empty localised tx receipt");
@@ -1045,17 +1305,19 @@ void BlockChainImp::writeNumber2Hash(const Block& block, std::shared_ptr<Executi
     }
 }
 
-void BlockChainImp::writeHash2Block(Block& block, std::shared_ptr<ExecutiveContext> context)
+std::shared_ptr<bytes> BlockChainImp::writeHash2Block(
+    Block& block, std::shared_ptr<ExecutiveContext> context)
 {
     Table::Ptr tb = context->getMemoryTableFactory()->openTable(SYS_HASH_2_BLOCK, false);
     if (tb)
     {
         Entry::Ptr entry = std::make_shared<Entry>();
-        bytes out;
-        block.encode(out);
-        entry->setField(SYS_VALUE, toHexPrefixed(out));
+        auto out = std::make_shared<bytes>();
+        block.encode(*out);
+        entry->setField(SYS_VALUE, toHexPrefixed(*out));
         entry->setForce(true);
         tb->insert(block.blockHeader().hash().hex(), entry);
+        return out;
     }
     else
     {
@@ -1063,6 +1325,34 @@ void BlockChainImp::writeHash2Block(Block& block, std::shared_ptr<ExecutiveConte
     }
 }
 
+void BlockChainImp::writeStateDiff(int64_t _blockNumber, bytes const& _stateDiff)
+{
+    // the block is committed already, the peers execute it if its StateDiff is missing
+    try
+    {
+        rocksdb::WriteBatch batch;
+        std::string value(_stateDiff.begin(), _stateDiff.end());
+        m_stateDiffDB->Put(batch, boost::lexical_cast<std::string>(_blockNumber), value);
+        // one block falls out of the window per block committed
+        if (_blockNumber >= m_stateDiffKeepBlocks)
+        {
+            batch.Delete(boost::lexical_cast<std::string>(_blockNumber - m_stateDiffKeepBlocks));
+        }
+        auto status = m_stateDiffDB->Write(rocksdb::WriteOptions(), batch);
+        if (!status.ok())
+        {
+            BLOCKCHAIN_LOG(WARNING) << LOG_DESC("[#writeStateDiff]Write StateDiff failed")
+                                    << LOG_KV("number", _blockNumber)
+                                    << LOG_KV("status", status.ToString());
+        }
+    }
+    catch (std::exception const& e)
+    {
+        BLOCKCHAIN_LOG(WARNING) << LOG_DESC("[#writeStateDiff]Write StateDiff failed")
+                                << LOG_KV("number", _blockNumber) << LOG_KV("what", e.what());
+    }
+}
+
 void BlockChainImp::writeBlockInfo(Block& block, std::shared_ptr<ExecutiveContext> context)
 {
     writeHash2Block(block, context);
@@ -1105,6 +1395,7 @@ CommitResult BlockChainImp::commitBlock(Block& block, std::shared_ptr<ExecutiveC
     {
         auto before_write_time_cost = utcTime() - record_time;
         record_time = utcTime();
+        std::shared_ptr<bytes> blockRLP;
         {
             std::lock_guard<std::mutex> l(commitMutex);
             if (!isBlockShouldCommit(block.blockHeader().number()))
@@ -1113,7 +1404,7 @@ CommitResult BlockChainImp::commitBlock(Block& block, std::shared_ptr<ExecutiveC
             }
             auto write_record_time = utcTime();
             // writeBlockInfo(block, context);
-            writeHash2Block(block, context);
+            blockRLP = writeHash2Block(block, context);
             auto writeHash2Block_time_cost = utcTime() - write_record_time;
             write_record_time = utcTime();
 
@@ -1163,11 +1454,28 @@ CommitResult BlockChainImp::commitBlock(Block& block, std::shared_ptr<ExecutiveC
                                   << LOG_KV(
                                          "updateBlockNumberTimeCost", updateBlockNumber_time_cost);
         }
+        if (m_stateDiffDB && context->stateDiff())
+        {
+            writeStateDiff(block.blockHeader().number(), *context->stateDiff());
+        }
         auto writeBlock_time_cost = utcTime() - record_time;
         record_time = utcTime();
 
-        m_blockCache.add(block);
+        m_committedTxCache.add(m_blockCache.add(block, blockRLP));
         auto addBlockCache_time_cost = utcTime() - record_time;
+        if (block.blockHeader().number() % c_cacheStatusInterval == 0)
+        {
+            auto cacheStatus = m_blockCache.status();
+            BLOCKCHAIN_LOG(INFO) << LOG_DESC("Block cache status")
+                                 << LOG_KV("blocks", cacheStatus.blocks)
+                                 << LOG_KV("size", cacheStatus.size)
+                                 << LOG_KV("capacity", cacheStatus.capacity)
+                                 << LOG_KV("query", cacheStatus.queryTimes)
+                                 << LOG_KV("hit", cacheStatus.hitTimes)
+                                 << LOG_KV("rlpQuery", cacheStatus.rlpQueryTimes)
+                                 << LOG_KV("rlpHit", cacheStatus.rlpHitTimes)
+                                 << LOG_KV("evicted", cacheStatus.evictTimes);
+        }
         record_time = utcTime();
         m_onReady(m_blockNumber);
         auto noteReady_time_cost = utcTime() - record_time;
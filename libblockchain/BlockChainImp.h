@@ -36,11 +36,15 @@
 #include <libstorage/Storage.h>
 #include <libstorage/Table.h>
 #include <libstoragestate/StorageStateFactory.h>
+#include <tbb/atomic.h>
 #include <boost/thread/shared_mutex.hpp>
+#include <array>
 #include <deque>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #define BLOCKCHAIN_LOG(LEVEL) LOG(LEVEL) << LOG_BADGE("BLOCKCHAIN")
 
@@ -54,23 +58,136 @@ namespace storage
 {
 class MemoryTableFactory;
 }
+namespace db
+{
+class BasicRocksDB;
+}
 
 namespace blockchain
 {
 class BlockChainImp;
 
+struct BlockCacheStatus
+{
+    uint64_t queryTimes = 0;
+    uint64_t hitTimes = 0;
+    uint64_t rlpQueryTimes = 0;
+    uint64_t rlpHitTimes = 0;
+    uint64_t evictTimes = 0;
+    size_t blocks = 0;
+    uint64_t size = 0;
+    uint64_t capacity = 0;
+
+    double hitRatio() const { return queryTimes == 0 ? 0 : (double)hitTimes / queryTimes; }
+    double rlpHitRatio() const
+    {
+        return rlpQueryTimes == 0 ? 0 : (double)rlpHitTimes / rlpQueryTimes;
+    }
+};
+
+/**
+ * @brief: LRU cache of the blocks bounded by bytes, indexed by shards of the block hash. The
+ * decoded block and its encoding are cached separately. The least recently used block of all the
+ * shards is evicted first once the cached blocks are beyond the capacity.
+ */
 class BlockCache
 {
 public:
-    BlockCache(){};
-    std::shared_ptr<dev::eth::Block> add(dev::eth::Block const& _block);
+    BlockCache(uint64_t _capacity = c_defaultCapacity);
+    /// cache the decoded block, and its encoding if given, return the cached block
+    std::shared_ptr<dev::eth::Block> add(
+        dev::eth::Block const& _block, std::shared_ptr<dev::bytes> _blockRLP = nullptr);
+    std::shared_ptr<dev::eth::Block> add(
+        std::shared_ptr<dev::eth::Block> _block, std::shared_ptr<dev::bytes> _blockRLP);
+    /// cache only the encoding of the block
+    void addRLP(h256 const& _hash, int64_t _number, std::shared_ptr<dev::bytes> _blockRLP);
+
     std::pair<std::shared_ptr<dev::eth::Block>, dev::h256> get(h256 const& _hash);
+    std::shared_ptr<dev::eth::Block> get(int64_t _number);
+    std::shared_ptr<dev::bytes> getRLP(h256 const& _hash);
+    std::shared_ptr<dev::bytes> getRLP(int64_t _number);
+
+    void setCapacity(uint64_t _capacity);
+    BlockCacheStatus status();
+    /// the approximate memory of the decoded block
+    static uint64_t decodedSize(dev::eth::Block const& _block);
+
+    static const uint64_t c_defaultCapacity = 64 * 1024 * 1024;
+
+private:
+    struct Item
+    {
+        dev::h256 hash;
+        int64_t number;
+        std::shared_ptr<dev::eth::Block> block;
+        std::shared_ptr<dev::bytes> blockRLP;
+        uint64_t size;
+        /// m_tick when the item is used last time
+        uint64_t lastUsed;
+    };
+    struct Shard
+    {
+        std::mutex mutex;
+        /// the most recently used at the front
+        std::list<Item> lru;
+        std::unordered_map<dev::h256, std::list<Item>::iterator> index;
+    };
+
+    Shard& shard(h256 const& _hash) { return m_shards[_hash[0] % c_shardNum]; }
+    h256 hashOf(int64_t _number);
+    /// update the item of _hash, the null fields are kept
+    void insert(h256 const& _hash, int64_t _number, std::shared_ptr<dev::eth::Block> _block,
+        std::shared_ptr<dev::bytes> _blockRLP);
+    /// move the item to the front of the LRU list of the shard, the mutex of the shard must be held
+    void touch(Shard& _shard, std::list<Item>::iterator _it);
+    /// evict the least recently used items used before _keepFrom until the cache is within the
+    /// capacity, no mutex of the shards must be held
+    void evict(uint64_t _keepFrom);
+
+    static const size_t c_shardNum = 16;
+    std::array<Shard, c_shardNum> m_shards;
+    tbb::atomic<uint64_t> m_capacity;
+    tbb::atomic<uint64_t> m_size;
+    tbb::atomic<uint64_t> m_tick;
+    /// one thread scans the shards for the least recently used item at a time
+    std::mutex m_evictMutex;
+
+    mutable boost::shared_mutex m_numberMutex;
+    std::unordered_map<int64_t, dev::h256> m_numberIndex;
+
+    tbb::atomic<uint64_t> m_queryTimes;
+    tbb::atomic<uint64_t> m_hitTimes;
+    tbb::atomic<uint64_t> m_rlpQueryTimes;
+    tbb::atomic<uint64_t> m_rlpHitTimes;
+    tbb::atomic<uint64_t> m_evictTimes;
+};
+
+/// index the transactions of the latest committed blocks by hash, so the receipts polled right
+/// after the commit are served without reading the storage
+class CommittedTxCache
+{
+public:
+    CommittedTxCache(){};
+    void add(std::shared_ptr<dev::eth::Block> _block);
+    /// the cached block containing the transaction and its index, nullptr if not cached
+    std::pair<std::shared_ptr<dev::eth::Block>, unsigned> get(h256 const& _txHash);
 
 private:
     mutable boost::shared_mutex m_sharedMutex;
-    mutable std::map<dev::h256, std::shared_ptr<dev::eth::Block>> m_blockCache;
-    mutable std::deque<dev::h256> m_blockCacheFIFO;  // insert queue log for m_blockCache
-    const unsigned c_blockCacheSize = 10;            // m_blockCache size, default set 10
+    std::unordered_map<dev::h256, std::pair<std::shared_ptr<dev::eth::Block>, unsigned>> m_txIndex;
+    std::deque<std::shared_ptr<dev::eth::Block>> m_blocks;  // insert queue of the indexed blocks
+    size_t m_txNum = 0;
+    const size_t c_maxTxNum = 50000;  // the latest block is kept even if it is larger
+};
+
+/// the committed transaction, the receipt is set if required
+struct CommittedTx
+{
+    dev::eth::Transaction tx;
+    dev::eth::TransactionReceipt receipt;
+    dev::h256 blockHash;
+    int64_t blockNumber = -1;
+    unsigned index = 0;
 };
 DEV_SIMPLE_EXCEPTION(OpenSysTableFailed);
 
@@ -90,6 +207,7 @@ public:
     std::shared_ptr<dev::eth::Block> getBlockByNumber(int64_t _i) override;
     std::shared_ptr<dev::bytes> getBlockRLPByHash(dev::h256 const& _blockHash) override;
     std::shared_ptr<dev::bytes> getBlockRLPByNumber(int64_t _i) override;
+    std::shared_ptr<dev::bytes> getStateDiffByNumber(int64_t _i) override;
     CommitResult commitBlock(dev::eth::Block& block,
         std::shared_ptr<dev::blockverifier::ExecutiveContext> context) override;
 
@@ -112,11 +230,25 @@ public:
         m_tableFactoryFactory = tableFactoryFactory;
     }
 
+    /// the budget of the block cache in bytes
+    void setBlockCacheCapacity(uint64_t _capacity) { m_blockCache.setCapacity(_capacity); }
+    BlockCacheStatus blockCacheStatus() { return m_blockCache.status(); }
+
+    /// keep the StateDiffs of the latest _keepBlocks committed blocks in _db, which is out of the
+    /// state storage since the rows of the state get their ids in commit order
+    void setStateDiffDB(std::shared_ptr<dev::db::BasicRocksDB> _db, int64_t _keepBlocks)
+    {
+        m_stateDiffDB = _db;
+        m_stateDiffKeepBlocks = _keepBlocks;
+    }
+
 private:
     std::shared_ptr<dev::eth::Block> getBlock(int64_t _i);
     std::shared_ptr<dev::eth::Block> getBlock(dev::h256 const& _blockHash);
     std::shared_ptr<dev::bytes> getBlockRLP(int64_t _i);
     std::shared_ptr<dev::bytes> getBlockRLP(dev::h256 const& _blockHash);
+    /// only the transaction and the receipt are decoded if its block is not cached
+    bool getCommittedTx(dev::h256 const& _txHash, CommittedTx& _committedTx, bool _withReceipt);
     int64_t obtainNumber();
     void writeNumber(const dev::eth::Block& block,
         std::shared_ptr<dev::blockverifier::ExecutiveContext> context);
@@ -128,8 +260,10 @@ private:
         dev::eth::Block& block, std::shared_ptr<dev::blockverifier::ExecutiveContext> context);
     void writeNumber2Hash(const dev::eth::Block& block,
         std::shared_ptr<dev::blockverifier::ExecutiveContext> context);
-    void writeHash2Block(
+    /// return the encoded block
+    std::shared_ptr<dev::bytes> writeHash2Block(
         dev::eth::Block& block, std::shared_ptr<dev::blockverifier::ExecutiveContext> context);
+    void writeStateDiff(int64_t _blockNumber, dev::bytes const& _stateDiff);
 
     bool isBlockShouldCommit(int64_t const& _blockNumber);
 
@@ -156,12 +290,17 @@ private:
     std::map<std::string, SystemConfigRecord> m_systemConfigRecord;
     mutable SharedMutex m_systemConfigMutex;
     BlockCache m_blockCache;
+    /// log the status of m_blockCache every c_cacheStatusInterval blocks
+    const int64_t c_cacheStatusInterval = 100;
+    CommittedTxCache m_committedTxCache;
 
     /// cache the block number
     mutable SharedMutex m_blockNumberMutex;
     int64_t m_blockNumber = -1;
 
     dev::storage::TableFactoryFactory::Ptr m_tableFactoryFactory;
+    std::shared_ptr<dev::db::BasicRocksDB> m_stateDiffDB;
+    int64_t m_stateDiffKeepBlocks = 10000;
 };
 }  // namespace blockchain
 }  // namespace dev
@@ -74,6 +74,8 @@ public:
     virtual std::shared_ptr<dev::eth::Block> getBlockByNumber(int64_t _i) = 0;
     virtual std::shared_ptr<dev::bytes> getBlockRLPByHash(dev::h256 const& _blockHash) = 0;
     virtual std::shared_ptr<dev::bytes> getBlockRLPByNumber(int64_t _i) = 0;
+    /// the StateDiff recorded when the block was committed, nullptr if not recorded
+    virtual std::shared_ptr<dev::bytes> getStateDiffByNumber(int64_t) { return nullptr; }
     virtual CommitResult commitBlock(
         dev::eth::Block& block, std::shared_ptr<dev::blockverifier::ExecutiveContext>) = 0;
     virtual std::pair<int64_t, int64_t> totalTransactionCount() = 0;
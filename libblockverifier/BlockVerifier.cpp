@@ -26,8 +26,11 @@
 #include <libethcore/TransactionReceipt.h>
 #include <libexecutive/ExecutionResult.h>
 #include <libexecutive/Executive.h>
+#include <libstorage/MemoryTableFactory2.h>
+#include <libstorage/StorageException.h>
 #include <libstorage/Table.h>
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include <exception>
 #include <thread>
 
@@ -58,10 +61,98 @@ ExecutiveContext::Ptr BlockVerifier::executeBlock(Block& block, BlockInfo const&
     {
         context = serialExecuteBlock(block, parentBlockInfo);
     }
+    if (m_recordStateDiff && context)
+    {
+        // encoded at once since the ids of the new entries are assigned by the commit
+        auto tableFactory =
+            std::dynamic_pointer_cast<MemoryTableFactory2>(context->getMemoryTableFactory());
+        if (tableFactory)
+        {
+            auto stateDiff = std::make_shared<bytes>();
+            tableFactory->exportStateDiff()->encode(*stateDiff);
+            context->setStateDiff(stateDiff);
+        }
+    }
     m_executingNumber = block.blockHeader().number();
     return context;
 }
 
+ExecutiveContext::Ptr BlockVerifier::applyStateDiff(
+    Block& block, BlockInfo const& parentBlockInfo, bytesConstRef _stateDiff)
+{
+    if (block.blockHeader().number() < m_executingNumber)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> l(m_executingMutex);
+    if (block.blockHeader().number() < m_executingNumber)
+    {
+        return nullptr;
+    }
+    uint64_t startTime = utcTime();
+    auto executiveContext = initExecutiveContext(parentBlockInfo);
+    auto tableFactory = std::dynamic_pointer_cast<MemoryTableFactory2>(
+        executiveContext->getMemoryTableFactory());
+    if (!tableFactory)
+    {
+        BLOCKVERIFIER_LOG(WARNING) << LOG_BADGE("applyStateDiff")
+                                   << LOG_DESC("StateDiff is not supported by the state")
+                                   << LOG_KV("num", block.blockHeader().number());
+        return nullptr;
+    }
+    if (block.transactionReceipts().size() != block.transactions().size())
+    {
+        BOOST_THROW_EXCEPTION(InvalidBlockWithBadStateOrReceipt()
+                              << errinfo_comment("StateDiff without the transaction receipts"));
+    }
+    try
+    {
+        tableFactory->importStateDiff(*StateDiff::decode(_stateDiff));
+    }
+    catch (StorageException const& e)
+    {
+        BLOCKVERIFIER_LOG(ERROR) << LOG_BADGE("applyStateDiff") << LOG_DESC("Invalid StateDiff")
+                                 << LOG_KV("num", block.blockHeader().number())
+                                 << LOG_KV("EINFO", boost::diagnostic_information(e));
+        BOOST_THROW_EXCEPTION(
+            InvalidBlockWithBadStateOrReceipt() << errinfo_comment("Invalid StateDiff"));
+    }
+
+    /// the signed header covers the receipts and the hash of the tables, the diff is accepted
+    /// only if they match
+    BlockHeader tmpHeader = block.blockHeader();
+    block.calReceiptRoot();
+    block.header().setStateRoot(executiveContext->getState()->rootHash());
+    block.header().setDBhash(tableFactory->hash());
+    if (tmpHeader != block.blockHeader())
+    {
+        BLOCKVERIFIER_LOG(ERROR) << "StateDiff with bad stateRoot or receiptRoot or dbHash"
+                                 << LOG_KV("blkNum", block.blockHeader().number())
+                                 << LOG_KV("orgReceipt", tmpHeader.receiptsRoot().abridged())
+                                 << LOG_KV("curRecepit", block.header().receiptsRoot().abridged())
+                                 << LOG_KV("orgState", tmpHeader.stateRoot().abridged())
+                                 << LOG_KV("curState", block.header().stateRoot().abridged())
+                                 << LOG_KV("orgDBHash", tmpHeader.dbHash().abridged())
+                                 << LOG_KV("curDBHash", block.header().dbHash().abridged());
+        // the block can still be executed
+        block.header() = tmpHeader;
+        BOOST_THROW_EXCEPTION(InvalidBlockWithBadStateOrReceipt() << errinfo_comment(
+                                  "StateDiff with bad stateRoot or ReceiptRoot, orgBlockHash " +
+                                  tmpHeader.hash().abridged()));
+    }
+    if (m_recordStateDiff)
+    {
+        executiveContext->setStateDiff(std::make_shared<bytes>(_stateDiff.toBytes()));
+    }
+    m_executingNumber = block.blockHeader().number();
+    BLOCKVERIFIER_LOG(DEBUG) << LOG_BADGE("applyStateDiff") << LOG_DESC("Apply StateDiff takes")
+                             << LOG_KV("time(ms)", utcTime() - startTime)
+                             << LOG_KV("txNum", block.transactions().size())
+                             << LOG_KV("num", block.blockHeader().number())
+                             << LOG_KV("stateDiffSize", _stateDiff.size());
+    return executiveContext;
+}
+
 ExecutiveContext::Ptr BlockVerifier::serialExecuteBlock(
     Block& block, BlockInfo const& parentBlockInfo)
 {
@@ -106,29 +197,7 @@ ExecutiveContext::Ptr BlockVerifier::serialExecuteBlock(
                              << LOG_KV("num", block.blockHeader().number());
     uint64_t pastTime = utcTime();
 
-    try
-    {
-        for (size_t i = 0; i < block.transactions().size(); i++)
-        {
-            auto& tx = block.transactions()[i];
-            EnvInfo envInfo(block.blockHeader(), m_pNumberHash, 0);
-            envInfo.setPrecompiledEngine(executiveContext);
-            std::pair<ExecutionResult, TransactionReceipt> resultReceipt =
-                execute(envInfo, tx, OnOpFunc(), executiveContext);
-            block.setTransactionReceipt(i, resultReceipt.second);
-            executiveContext->getState()->commit();
-        }
-    }
-    catch (exception& e)
-    {
-        BLOCKVERIFIER_LOG(ERROR) << LOG_BADGE("executeBlock")
-                                 << LOG_DESC("Error during serial block execution")
-                                 << LOG_KV("blkNum", block.blockHeader().number())
-                                 << LOG_KV("EINFO", boost::diagnostic_information(e));
-
-        BOOST_THROW_EXCEPTION(
-            BlockExecutionFailed() << errinfo_comment("Error during serial block execution"));
-    }
+    executeTransactions(block, executiveContext);
 
 
     BLOCKVERIFIER_LOG(DEBUG) << LOG_BADGE("executeBlock") << LOG_DESC("Run serial tx takes")
@@ -178,6 +247,33 @@ ExecutiveContext::Ptr BlockVerifier::serialExecuteBlock(
     return executiveContext;
 }
 
+void BlockVerifier::executeTransactions(Block& block, ExecutiveContext::Ptr executiveContext)
+{
+    try
+    {
+        for (size_t i = 0; i < block.transactions().size(); i++)
+        {
+            auto& tx = block.transactions()[i];
+            EnvInfo envInfo(block.blockHeader(), m_pNumberHash, 0);
+            envInfo.setPrecompiledEngine(executiveContext);
+            std::pair<ExecutionResult, TransactionReceipt> resultReceipt =
+                execute(envInfo, tx, OnOpFunc(), executiveContext);
+            block.setTransactionReceipt(i, resultReceipt.second);
+            executiveContext->getState()->commit();
+        }
+    }
+    catch (exception& e)
+    {
+        BLOCKVERIFIER_LOG(ERROR) << LOG_BADGE("executeBlock")
+                                 << LOG_DESC("Error during serial block execution")
+                                 << LOG_KV("blkNum", block.blockHeader().number())
+                                 << LOG_KV("EINFO", boost::diagnostic_information(e));
+
+        BOOST_THROW_EXCEPTION(
+            BlockExecutionFailed() << errinfo_comment("Error during serial block execution"));
+    }
+}
+
 ExecutiveContext::Ptr BlockVerifier::parallelExecuteBlock(
     Block& block, BlockInfo const& parentBlockInfo)
 
@@ -220,43 +316,54 @@ ExecutiveContext::Ptr BlockVerifier::parallelExecuteBlock(
     shared_ptr<TxDAG> txDag = make_shared<TxDAG>();
     txDag->init(executiveContext, block.transactions(), block.blockHeader().number());
 
+    // Every non-parallel transaction is a barrier of the DAG, in optimistic mode the block is
+    // executed speculatively first and the DAG is built from the rows each transaction accessed
+    std::vector<TableAccessSet::Ptr> predictedAccessSets;
+    if (m_enableOptimistic &&
+        worthSpeculating(block.transactions().size(), txDag->nonParaTxsNumber()))
+    {
+        try
+        {
+            predictedAccessSets = speculativeExecute(block, parentBlockInfo);
+            txDag = make_shared<TxDAG>();
+            txDag->init(block.transactions(), predictedAccessSets, block.blockHeader().number());
+        }
+        catch (exception& e)
+        {
+            BLOCKVERIFIER_LOG(WARNING) << LOG_BADGE("executeBlock")
+                                       << LOG_DESC("Speculative execution failed, use the DAG")
+                                       << LOG_KV("EINFO", boost::diagnostic_information(e));
+            predictedAccessSets.clear();
+            txDag = make_shared<TxDAG>();
+            txDag->init(executiveContext, block.transactions(), block.blockHeader().number());
+        }
+    }
+    std::atomic<bool> mispredicted = {false};
+
     txDag->setTxExecuteFunc([&](Transaction const& _tr, ID _txId) {
+        TableAccessSet accessSet;
+        TableAccessSet::Scope scope(predictedAccessSets.empty() ? nullptr : &accessSet);
+
         EnvInfo envInfo(block.blockHeader(), m_pNumberHash, 0);
         envInfo.setPrecompiledEngine(executiveContext);
         std::pair<ExecutionResult, TransactionReceipt> resultReceipt =
             execute(envInfo, _tr, OnOpFunc(), executiveContext);
         block.setTransactionReceipt(_txId, resultReceipt.second);
         executiveContext->getState()->commit();
+
+        // a row out of the prediction may have been accessed concurrently with its writer
+        if (!predictedAccessSets.empty() && !accessSet.coveredBy(*predictedAccessSets[_txId]))
+        {
+            mispredicted = true;
+        }
         return true;
     });
     auto initDag_time_cost = utcTime() - record_time;
     record_time = utcTime();
 
-    auto parallelTimeOut = utcTime() + 30000;  // 30 timeout
-
     try
     {
-        tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_threadNum),
-            [&](const tbb::blocked_range<unsigned int>& _r) {
-                (void)_r;
-                while (!txDag->hasFinished())
-                {
-                    if (utcTime() >= parallelTimeOut)
-                    {
-                        BLOCKVERIFIER_LOG(WARNING)
-                            << LOG_BADGE("executeBlock") << LOG_DESC("Para execute block timeout")
-                            << LOG_KV("txNum", block.transactions().size())
-                            << LOG_KV("blockNumber", block.blockHeader().number());
-
-#if 0
-                        BOOST_THROW_EXCEPTION(BlockExecutionFailed()
-                                              << errinfo_comment("Para execute block timeout"));
-#endif
-                    }
-
-                    txDag->executeUnit();
-                }
-            });
+        txDag->run(m_threadNum);
     }
     catch (exception& e)
     {
@@ -268,6 +375,20 @@ ExecutiveContext::Ptr BlockVerifier::parallelExecuteBlock(
             BlockExecutionFailed() << errinfo_comment("Error during parallel block execution"));
     }
 
+    if (mispredicted)
+    {
+        // the DAG is not trustworthy, execute the block again in block order
+        BLOCKVERIFIER_LOG(INFO) << LOG_BADGE("executeBlock")
+                                << LOG_DESC("Speculation mispredicted, re-execute serially")
+                                << LOG_KV("txNum", block.transactions().size())
+                                << LOG_KV("blockNumber", block.blockHeader().number());
+
+        executiveContext = initExecutiveContext(parentBlockInfo);
+        block.clearAllReceipts();
+        block.resizeTransactionReceipt(block.transactions().size());
+        executeTransactions(block, executiveContext);
+    }
+
     auto exe_time_cost = utcTime() - record_time;
     record_time = utcTime();
 
@@ -321,6 +442,8 @@ ExecutiveContext::Ptr BlockVerifier::parallelExecuteBlock(
                              << LOG_KV("perpareBlockTimeCost", perpareBlock_time_cost)
                              << LOG_KV("initDagTimeCost", initDag_time_cost)
                              << LOG_KV("exeTimeCost", exe_time_cost)
+                             << LOG_KV("criticalPath", txDag->criticalPathLength())
+                             << LOG_KV("parallelism", txDag->achievedParallelism())
                              << LOG_KV("getRootHashTimeCost", getRootHash_time_cost)
                              << LOG_KV("setAllReceiptTimeCost", setAllReceipt_time_cost)
                              << LOG_KV("getReceiptRootTimeCost", getReceiptRoot_time_cost)
@@ -328,6 +451,67 @@ ExecutiveContext::Ptr BlockVerifier::parallelExecuteBlock(
     return executiveContext;
 }
 
+bool BlockVerifier::worthSpeculating(size_t _txNum, size_t _nonParaTxNum)
+{
+    if (_nonParaTxNum == 0)
+    {
+        return false;
+    }
+    // the barriers cut the block into runs of parallel transactions, the speculation executes
+    // every transaction once more and pays only if the runs are too short to keep the threads busy
+    size_t threadNum = std::max(std::min(m_threadNum, std::thread::hardware_concurrency()), 1u);
+    return _txNum < (_nonParaTxNum + 1) * threadNum * c_speculativeRunFactor;
+}
+
+std::vector<TableAccessSet::Ptr> BlockVerifier::speculativeExecute(
+    Block& block, BlockInfo const& parentBlockInfo)
+{
+    auto& txs = block.transactions();
+    std::vector<TableAccessSet::Ptr> accessSets(txs.size());
+
+    // every transaction runs on a context of its own on top of the parent block, which is dropped
+    // afterwards, so the concurrent transactions never see each other's writes or precompiled
+    // addresses and only the access sets are kept
+    tbb::task_arena arena(m_threadNum);
+    arena.execute([&]() {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, txs.size()), [&](const tbb::blocked_range<size_t>& _r) {
+                for (size_t i = _r.begin(); i != _r.end(); ++i)
+                {
+                    auto speculativeContext = initExecutiveContext(parentBlockInfo);
+                    auto accessSet = std::make_shared<TableAccessSet>();
+                    TableAccessSet::Scope scope(accessSet.get());
+
+                    EnvInfo envInfo(block.blockHeader(), m_pNumberHash, 0);
+                    envInfo.setPrecompiledEngine(speculativeContext);
+                    execute(envInfo, txs[i], OnOpFunc(), speculativeContext);
+
+                    accessSets[i] = accessSet;
+                }
+            });
+    });
+    return accessSets;
+}
+
+ExecutiveContext::Ptr BlockVerifier::initExecutiveContext(BlockInfo const& parentBlockInfo)
+{
+    ExecutiveContext::Ptr executiveContext = std::make_shared<ExecutiveContext>();
+    try
+    {
+        m_executiveContextFactory->initExecutiveContext(
+            parentBlockInfo, parentBlockInfo.stateRoot, executiveContext);
+    }
+    catch (exception& e)
+    {
+        BLOCKVERIFIER_LOG(ERROR) << LOG_DESC("[executeBlock] Error during initExecutiveContext")
+                                 << LOG_KV("EINFO", boost::diagnostic_information(e));
+
+        BOOST_THROW_EXCEPTION(InvalidBlockWithBadStateOrReceipt()
+                              << errinfo_comment("Error during initExecutiveContext"));
+    }
+    return executiveContext;
+}
+
 std::pair<ExecutionResult, TransactionReceipt> BlockVerifier::executeTransaction(
     const BlockHeader& blockHeader, dev::eth::Transaction const& _t)
 {
@@ -34,6 +34,7 @@
 #include <libevm/ExtVMFace.h>
 #include <libexecutive/ExecutionResult.h>
 #include <libmptstate/State.h>
+#include <libstorage/Table.h>
 #include <boost/function.hpp>
 #include <algorithm>
 #include <memory>
@@ -75,6 +76,8 @@ public:
         dev::eth::Block& block, BlockInfo const& parentBlockInfo);
     ExecutiveContext::Ptr parallelExecuteBlock(
         dev::eth::Block& block, BlockInfo const& parentBlockInfo);
+    ExecutiveContext::Ptr applyStateDiff(dev::eth::Block& block, BlockInfo const& parentBlockInfo,
+        dev::bytesConstRef _stateDiff) override;
 
     std::pair<dev::executive::ExecutionResult, dev::eth::TransactionReceipt> executeTransaction(
         const dev::eth::BlockHeader& blockHeader, dev::eth::Transaction const& _t);
@@ -94,11 +97,29 @@ public:
         m_pNumberHash = _pNumberHash;
     }
 
+    // schedule blocks with non-parallel transactions by speculatively captured read/write sets
+    void setEnableOptimistic(bool _enableOptimistic) { m_enableOptimistic = _enableOptimistic; }
+
+    // keep the StateDiff of the executed blocks in the context for the syncing peers
+    void setRecordStateDiff(bool _recordStateDiff) { m_recordStateDiff = _recordStateDiff; }
+
 private:
+    /// execute the transactions of the block in order on executiveContext
+    void executeTransactions(dev::eth::Block& block, ExecutiveContext::Ptr executiveContext);
+    bool worthSpeculating(size_t _txNum, size_t _nonParaTxNum);
+    std::vector<dev::storage::TableAccessSet::Ptr> speculativeExecute(
+        dev::eth::Block& block, BlockInfo const& parentBlockInfo);
+    ExecutiveContext::Ptr initExecutiveContext(BlockInfo const& parentBlockInfo);
+
     ExecutiveContextFactory::Ptr m_executiveContextFactory;
     NumberHashCallBackFunction m_pNumberHash;
     bool m_enableParallel;
+    bool m_enableOptimistic = false;
+    bool m_recordStateDiff = false;
     unsigned int m_threadNum = -1;
+    /// speculate only if the runs of parallel transactions between the barriers of the DAG are
+    /// shorter than this many transactions per thread on average
+    static const size_t c_speculativeRunFactor = 2;
 
     std::mutex m_executingMutex;
     std::atomic<int64_t> m_executingNumber = {0};
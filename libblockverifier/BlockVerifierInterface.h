@@ -54,6 +54,13 @@ public:
     virtual std::pair<dev::executive::ExecutionResult, dev::eth::TransactionReceipt>
     executeTransaction(
         const dev::eth::BlockHeader& blockHeader, dev::eth::Transaction const& _t) = 0;
+    /// apply the StateDiff recorded by the node executing the block instead of executing it,
+    /// return nullptr if the state can not be rebuilt from a diff
+    virtual ExecutiveContext::Ptr applyStateDiff(
+        dev::eth::Block&, BlockInfo const&, dev::bytesConstRef)
+    {
+        return nullptr;
+    }
 };
 }  // namespace blockverifier
 }  // namespace dev
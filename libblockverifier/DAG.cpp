@@ -21,6 +21,7 @@
  */
 
 #include "DAG.h"
+#include <algorithm>
 
 using namespace std;
 using namespace dev;
@@ -52,10 +53,26 @@ void DAG::addEdge(ID _f, ID _t)
 
 void DAG::generate()
 {
+    m_roots.clear();
     for (ID id = 0; id < m_vtxs.size(); ++id)
     {
         if (m_vtxs[id]->inDegree == 0)
+        {
             m_topLevel.push(id);
+            m_roots.push_back(id);
+        }
+    }
+
+    // edges always point to a greater ID, so ID order is a topological order
+    IDs depth(m_vtxs.size(), 1);
+    m_criticalPathLength = m_vtxs.empty() ? 0 : 1;
+    for (ID id = 0; id < m_vtxs.size(); ++id)
+    {
+        for (ID to : m_vtxs[id]->outEdge)
+        {
+            depth[to] = std::max(depth[to], depth[id] + 1);
+            m_criticalPathLength = std::max(m_criticalPathLength, depth[to]);
+        }
     }
 
     // PARA_LOG(TRACE) << LOG_BADGE("DAG") << LOG_DESC("generate")
@@ -153,6 +170,27 @@ ID DAG::consume(ID _id)
     return nextId;
 }
 
+ID DAG::consume(ID _id, std::function<void(ID)> const& _onReady)
+{
+    ID nextId = INVALID_ID;
+    for (ID id : m_vtxs[_id]->outEdge)
+    {
+        if (m_vtxs[id]->inDegree.fetch_sub(1) == 1)
+        {
+            if (nextId == INVALID_ID)
+            {
+                nextId = id;
+            }
+            else
+            {
+                _onReady(id);
+            }
+        }
+    }
+    m_totalConsume.fetch_add(1);
+    return nextId;
+}
+
 void DAG::clear()
 {
     m_vtxs = std::vector<std::shared_ptr<Vertex>>();
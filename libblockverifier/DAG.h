@@ -27,6 +27,7 @@
 #include <tbb/concurrent_queue.h>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <queue>
 #include <thread>
 #include <vector>
@@ -68,6 +69,16 @@ public:
     // Consume the top and add new top in top queue (thread safe)
     ID consume(ID _id);
 
+    // Consume the vertex without touching the top queue, return one of the vertices it makes
+    // ready and pass the others to _onReady (thread safe, lock free)
+    ID consume(ID _id, std::function<void(ID)> const& _onReady);
+
+    // Vertices without in edge, available after generate
+    IDs const& roots() const { return m_roots; }
+
+    // Vertex number of the longest path, available after generate
+    ID criticalPathLength() const { return m_criticalPathLength; }
+
     // Clear all data of this class (thread safe)
     void clear();
 
@@ -75,6 +86,9 @@ private:
     std::vector<std::shared_ptr<Vertex>> m_vtxs;
     tbb::concurrent_queue<ID> m_topLevel;
 
+    IDs m_roots;
+    ID m_criticalPathLength = 0;
+
     ID m_totalVtxs = 0;
     std::atomic<ID> m_totalConsume;
 
@@ -111,6 +111,10 @@ public:
     // Get transaction criticals, return nullptr if critical to all
     std::shared_ptr<std::vector<std::string>> getTxCriticals(const dev::eth::Transaction& _tx);
 
+    // the encoded StateDiff of the block, kept with the block when committed
+    std::shared_ptr<bytes> stateDiff() const { return m_stateDiff; }
+    void setStateDiff(std::shared_ptr<bytes> _stateDiff) { m_stateDiff = _stateDiff; }
+
 private:
     tbb::concurrent_unordered_map<Address, Precompiled::Ptr, std::hash<Address>>
         m_address2Precompiled;
@@ -120,6 +124,7 @@ private:
     std::unordered_map<Address, dev::eth::PrecompiledContract> m_precompiledContract;
     std::shared_ptr<dev::storage::TableFactory> m_memoryTableFactory;
     uint64_t m_txGasLimit = 300000000;
+    std::shared_ptr<bytes> m_stateDiff;
 };
 
 }  // namespace blockverifier
@@ -22,7 +22,11 @@
 
 #include "TxDAG.h"
 #include "Common.h"
+#include <tbb/parallel_do.h>
+#include <tbb/task_arena.h>
+#include <chrono>
 #include <map>
+#include <set>
 
 using namespace std;
 using namespace dev;
@@ -82,6 +86,7 @@ void TxDAG::init(ExecutiveContext::Ptr _ctx, Transactions const& _txs, int64_t _
 
             // set all critical to my id
             latestCriticals.setCriticalAll(id);
+            ++m_totalNonParaTxs;
         }
     }
 
@@ -93,6 +98,77 @@ void TxDAG::init(ExecutiveContext::Ptr _ctx, Transactions const& _txs, int64_t _
     DAG_LOG(TRACE) << LOG_DESC("End init transaction DAG") << LOG_KV("blockHeight", _blockHeight);
 }
 
+void TxDAG::init(Transactions const& _txs,
+    std::vector<storage::TableAccessSet::Ptr> const& _accessSets, int64_t _blockHeight)
+{
+    DAG_LOG(TRACE) << LOG_DESC("Begin init transaction DAG by access sets")
+                   << LOG_KV("blockHeight", _blockHeight) << LOG_KV("transactionNum", _txs.size());
+
+    m_txs = make_shared<Transactions const>(_txs);
+    m_dag.init(_txs.size());
+
+    map<storage::TableAccessSet::Key, ID> lastWriters;
+    // readers since the last write of the row
+    map<storage::TableAccessSet::Key, IDs> lastReaders;
+
+    for (ID id = 0; id < _txs.size(); ++id)
+    {
+        auto& accessSet = _accessSets[id];
+        set<ID> dependencies;
+
+        for (auto& key : accessSet->reads())
+        {
+            auto it = lastWriters.find(key);
+            if (it != lastWriters.end())
+            {
+                dependencies.insert(it->second);
+            }
+        }
+
+        for (auto& key : accessSet->writes())
+        {
+            auto it = lastWriters.find(key);
+            if (it != lastWriters.end())
+            {
+                dependencies.insert(it->second);
+            }
+
+            auto readersIt = lastReaders.find(key);
+            if (readersIt != lastReaders.end())
+            {
+                dependencies.insert(readersIt->second.begin(), readersIt->second.end());
+                lastReaders.erase(readersIt);
+            }
+        }
+
+        for (ID pId : dependencies)
+        {
+            DAG_LOG(TRACE) << LOG_DESC("Add edge") << LOG_KV("from", pId) << LOG_KV("to", id);
+            m_dag.addEdge(pId, id);
+        }
+
+        for (auto& key : accessSet->reads())
+        {
+            if (accessSet->writes().count(key) == 0)
+            {
+                lastReaders[key].push_back(id);
+            }
+        }
+
+        for (auto& key : accessSet->writes())
+        {
+            lastWriters[key] = id;
+        }
+    }
+
+    m_dag.generate();
+
+    m_totalParaTxs = _txs.size();
+
+    DAG_LOG(TRACE) << LOG_DESC("End init transaction DAG by access sets")
+                   << LOG_KV("blockHeight", _blockHeight);
+}
+
 // Set transaction execution function
 void TxDAG::setTxExecuteFunc(ExecuteTxFunc const& _f)
 {
@@ -114,11 +190,7 @@ int TxDAG::executeUnit()
     while (id != INVALID_ID)
     {
         exeCnt += 1;
-        {
-            Guard l(x_exeCnt);
-            m_exeCnt += 1;
-        }
-        f_executeTx((*m_txs)[id], id);
+        executeTx(id);
 
         id = m_dag.consume(id);
 
@@ -127,3 +199,37 @@ int TxDAG::executeUnit()
     }
     return exeCnt;
 }
+
+void TxDAG::run(unsigned int _threadNum)
+{
+    auto start = chrono::steady_clock::now();
+    m_busyTime = 0;
+
+    auto& roots = m_dag.roots();
+    // the default arena of tbb takes all the cores whatever the configured thread number is
+    tbb::task_arena arena(_threadNum);
+    arena.execute([&]() {
+        tbb::parallel_do(
+            roots.begin(), roots.end(), [&](ID _id, tbb::parallel_do_feeder<ID>& _feeder) {
+                ID id = _id;
+                while (id != INVALID_ID)
+                {
+                    executeTx(id);
+                    id = m_dag.consume(id, [&](ID _readyId) { _feeder.add(_readyId); });
+                }
+            });
+    });
+
+    auto wallTime =
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    m_achievedParallelism = wallTime > 0 ? (double)m_busyTime / wallTime : 0;
+}
+
+void TxDAG::executeTx(ID _id)
+{
+    auto start = chrono::steady_clock::now();
+    m_exeCnt.fetch_add(1);
+    f_executeTx((*m_txs)[_id], _id);
+    m_busyTime.fetch_add(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+}
@@ -25,6 +25,8 @@
 #include "ExecutiveContext.h"
 #include <libethcore/Block.h>
 #include <libethcore/Transaction.h>
+#include <libstorage/Table.h>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <queue>
@@ -59,6 +61,11 @@ public:
     // Generate DAG according with given transactions
     void init(ExecutiveContext::Ptr _ctx, dev::eth::Transactions const& _txs, int64_t _blockHeight);
 
+    // Generate DAG according with the rows each transaction reads and writes, a transaction
+    // depends on the last writer of every row it accesses and on the readers of every row it writes
+    void init(dev::eth::Transactions const& _txs,
+        std::vector<dev::storage::TableAccessSet::Ptr> const& _accessSets, int64_t _blockHeight);
+
     // Set transaction execution function
     void setTxExecuteFunc(ExecuteTxFunc const& _f);
 
@@ -71,20 +78,39 @@ public:
     // This function can be parallel
     int executeUnit() override;
 
+    // Execute the whole DAG with the tbb work stealing scheduler, the successors made ready by a
+    // transaction are spawned on the local deque of its worker, the first of them runs in place.
+    // At most _threadNum threads execute the DAG
+    void run(unsigned int _threadNum);
+
     ID paraTxsNumber() { return m_totalParaTxs; }
 
+    // Transactions on the longest dependency chain, the block takes at least that many rounds
+    ID criticalPathLength() { return m_dag.criticalPathLength(); }
+
+    // Transaction execution time over wall time of the last run
+    double achievedParallelism() { return m_achievedParallelism; }
+
     ID haveExecuteNumber() { return m_exeCnt; }
 
+    // Transactions without critical fields, each of them is a barrier of the DAG
+    ID nonParaTxsNumber() { return m_totalNonParaTxs; }
+
 private:
     ExecuteTxFunc f_executeTx;
     std::shared_ptr<dev::eth::Transactions const> m_txs;
 
     DAG m_dag;
 
-    ID m_exeCnt = 0;
+    void executeTx(ID _id);
+
+    std::atomic<ID> m_exeCnt = {0};
     ID m_totalParaTxs = 0;
+    ID m_totalNonParaTxs = 0;
 
-    mutable std::mutex x_exeCnt;
+    // nanoseconds spent in f_executeTx by all threads
+    std::atomic<uint64_t> m_busyTime = {0};
+    double m_achievedParallelism = 0;
 };
 
 template <typename T>
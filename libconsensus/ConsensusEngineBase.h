@@ -189,7 +189,7 @@ protected:
         bool valid = isValidReq(message, session, peer_index);
         if (valid)
         {
-            valid = decodeToRequests(req, ref(*(message->buffer())));
+            valid = decodeToRequests(req, message->payload());
             if (valid)
                 req.setOtherField(
                     peer_index, session->nodeID(), session->session()->nodeIPEndpoint().name());
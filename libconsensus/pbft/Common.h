@@ -42,9 +42,63 @@ enum PBFTPacketType : byte
     SignReqPacket = 0x01,
     CommitReqPacket = 0x02,
     ViewChangeReqPacket = 0x03,
+    /// prepare request carrying the block header and the transaction hashes only
+    CompactPrepareReqPacket = 0x04,
+    /// ask the sender of a compact prepare for the transactions missing from the local txpool
+    GetMissedTxsPacket = 0x05,
+    MissedTxsPacket = 0x06,
     PBFTPacketCount
 };
 
+/// k-ary tree of the sealers rooted at the leader of a view, the prepare packets are relayed from
+/// the parents to their children instead of being sent by the leader to every sealer
+class BroadcastTree
+{
+public:
+    BroadcastTree(IDXTYPE _nodeNum, unsigned _width, IDXTYPE _rootIdx)
+      : m_nodeNum(_nodeNum), m_width(std::max(_width, 1u)), m_rootIdx(_rootIdx)
+    {}
+
+    /// the indexes of the sealers the node of _idx relays to
+    std::vector<IDXTYPE> children(IDXTYPE _idx) const
+    {
+        std::vector<IDXTYPE> ret;
+        if (_idx >= m_nodeNum || m_rootIdx >= m_nodeNum)
+        {
+            return ret;
+        }
+        size_t position = (_idx + m_nodeNum - m_rootIdx) % m_nodeNum;
+        for (size_t i = 1; i <= m_width; i++)
+        {
+            size_t childPosition = position * m_width + i;
+            if (childPosition >= m_nodeNum)
+            {
+                break;
+            }
+            ret.push_back((childPosition + m_rootIdx) % m_nodeNum);
+        }
+        return ret;
+    }
+
+    /// the number of hops from the root to the deepest sealer
+    unsigned depth() const
+    {
+        unsigned depth = 0;
+        size_t levelSize = 1;
+        for (size_t covered = 1; covered < m_nodeNum; covered += levelSize)
+        {
+            levelSize *= m_width;
+            depth++;
+        }
+        return depth;
+    }
+
+private:
+    IDXTYPE m_nodeNum;
+    unsigned m_width;
+    IDXTYPE m_rootIdx;
+};
+
 /// PBFT message
 struct PBFTMsgPacket
 {
@@ -352,6 +406,47 @@ struct PrepareReq : public PBFTMsg
         _s << block;
     }
 
+    /**
+     * @brief: encode the PrepareReq of CompactPrepareReqPacket, the block field holds the block
+     *         header and the transaction hashes of pBlock instead of the encoded block
+     * @param encodedBytes: the encoded bytes of the compact PrepareReq
+     */
+    void encodeCompact(bytes& encodedBytes) const
+    {
+        bytes headerData;
+        pBlock->blockHeader().encode(headerData);
+        h256s txHashes;
+        txHashes.reserve(pBlock->transactions().size());
+        for (auto const& tx : pBlock->transactions())
+        {
+            txHashes.push_back(tx.sha3());
+        }
+        RLPStream compactBlock;
+        compactBlock.appendList(2);
+        compactBlock.appendRaw(headerData);
+        compactBlock.appendVector(txHashes);
+
+        RLPStream tmp;
+        PBFTMsg::streamRLPFields(tmp);
+        tmp << compactBlock.out();
+        RLPStream list_rlp;
+        list_rlp.appendList(1).append(tmp.out());
+        list_rlp.swapOut(encodedBytes);
+    }
+
+    /**
+     * @brief: decode the block field of a compact PrepareReq
+     * @param header: the block header
+     * @param txHashes: hashes of the transactions of the block in order
+     * @Exception Case: if decode failed, throw exception directly
+     */
+    void decodeCompactBlock(dev::eth::BlockHeader& header, h256s& txHashes) const
+    {
+        RLP compactBlock(block);
+        header.populate(compactBlock[0]);
+        txHashes = compactBlock[1].toVector<h256>();
+    }
+
     /// populate PrepareReq from given RLP object
     virtual void populate(RLP const& _rlp)
     {
@@ -0,0 +1,407 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : append-only log used to backup the pbft messages
+ * @file: PBFTBackupLog.cpp
+ */
+#include "PBFTBackupLog.h"
+#include <fcntl.h>
+#include <libdevcore/CommonData.h>
+#include <libdevcore/CommonIO.h>
+#include <libdevcore/RLP.h>
+#include <unistd.h>
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+
+namespace dev
+{
+namespace consensus
+{
+static void putUint32(bytes& _out, uint32_t _value)
+{
+    for (int i = 3; i >= 0; i--)
+    {
+        _out.push_back((byte)(_value >> (i * 8)));
+    }
+}
+
+static uint32_t getUint32(byte const* _data)
+{
+    return ((uint32_t)_data[0] << 24) | ((uint32_t)_data[1] << 16) | ((uint32_t)_data[2] << 8) |
+           (uint32_t)_data[3];
+}
+
+static uint32_t checksum(bytesConstRef _data)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(_data.data(), _data.size());
+    return crc.checksum();
+}
+
+BackupDurability PBFTBackupLog::durabilityFromString(std::string const& _durability)
+{
+    if (_durability == "sync")
+    {
+        return BackupDurability::Sync;
+    }
+    if (_durability == "none")
+    {
+        return BackupDurability::NoSync;
+    }
+    return BackupDurability::Async;
+}
+
+bytes PBFTBackupLog::encodeRecord(std::string const& _key, bytes const& _data)
+{
+    RLPStream s(2);
+    s << _key << _data;
+    bytes payload;
+    s.swapOut(payload);
+
+    bytes record;
+    record.reserve(c_headerSize + payload.size());
+    putUint32(record, payload.size());
+    putUint32(record, checksum(ref(payload)));
+    record += payload;
+    return record;
+}
+
+void PBFTBackupLog::open()
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    if (m_running)
+    {
+        return;
+    }
+    auto parent = boost::filesystem::path(m_path).parent_path();
+    if (!parent.empty() && !boost::filesystem::exists(parent))
+    {
+        boost::filesystem::create_directories(parent);
+    }
+    load();
+    openFile();
+    m_running = true;
+    m_flushThread = std::make_shared<std::thread>([this]() {
+        dev::pthread_setThreadName("PBFTBackup");
+        flushLoop();
+    });
+}
+
+/// load the valid records and truncate the log at the first torn or corrupted one
+void PBFTBackupLog::load()
+{
+    m_latest.clear();
+    m_fileSize = 0;
+    if (!boost::filesystem::exists(m_path))
+    {
+        return;
+    }
+    bytes content = dev::contents(m_path);
+    size_t offset = 0;
+    size_t records = 0;
+    while (offset + c_headerSize <= content.size())
+    {
+        uint32_t length = getUint32(&content[offset]);
+        uint32_t crc = getUint32(&content[offset + 4]);
+        if (content.size() - offset - c_headerSize < length)
+        {
+            break;
+        }
+        bytesConstRef payload(&content[offset + c_headerSize], length);
+        if (checksum(payload) != crc)
+        {
+            break;
+        }
+        try
+        {
+            RLP rlp(payload);
+            m_latest[rlp[0].toString()] = rlp[1].toBytes();
+        }
+        catch (std::exception const& e)
+        {
+            BACKUPLOG_LOG(WARNING) << LOG_DESC("load: invalid record") << LOG_KV("offset", offset)
+                                   << LOG_KV("EINFO", boost::diagnostic_information(e));
+            break;
+        }
+        offset += c_headerSize + length;
+        records++;
+    }
+    if (offset < content.size())
+    {
+        BACKUPLOG_LOG(WARNING) << LOG_DESC("load: drop the torn tail") << LOG_KV("path", m_path)
+                               << LOG_KV("validSize", offset)
+                               << LOG_KV("fileSize", content.size());
+        boost::filesystem::resize_file(m_path, offset);
+    }
+    m_fileSize = offset;
+    BACKUPLOG_LOG(INFO) << LOG_DESC("load") << LOG_KV("path", m_path) << LOG_KV("records", records)
+                        << LOG_KV("keys", m_latest.size()) << LOG_KV("fileSize", m_fileSize);
+}
+
+void PBFTBackupLog::stop()
+{
+    {
+        std::lock_guard<std::mutex> l(m_mutex);
+        if (!m_running)
+        {
+            return;
+        }
+        m_running = false;
+        m_signalled.notify_all();
+    }
+    if (m_flushThread && m_flushThread->joinable())
+    {
+        m_flushThread->join();
+    }
+    std::unique_lock<std::mutex> l(m_mutex);
+    try
+    {
+        syncWritten(l);
+        syncFile(m_fd);
+    }
+    catch (std::exception const& e)
+    {
+        BACKUPLOG_LOG(ERROR) << LOG_DESC("stop: sync the written records failed")
+                             << LOG_KV("EINFO", boost::diagnostic_information(e));
+        m_failed = true;
+    }
+    closeFile();
+    m_flushed.notify_all();
+}
+
+void PBFTBackupLog::append(std::string const& _key, bytes const& _data)
+{
+    bytes record = encodeRecord(_key, _data);
+    std::unique_lock<std::mutex> l(m_mutex);
+    if (!m_running || m_failed)
+    {
+        BOOST_THROW_EXCEPTION(
+            BackupLogError() << errinfo_comment("backup log is not writable: " + m_path));
+    }
+    /// written at once so that the record survives a crash of the process, only the fsync is
+    /// left to the flush thread
+    try
+    {
+        writeFile(m_fd, record);
+    }
+    catch (...)
+    {
+        /// the records after a torn one are dropped on open
+        m_failed = true;
+        m_flushed.notify_all();
+        throw;
+    }
+    m_fileSize += record.size();
+    m_latest[_key] = _data;
+    uint64_t seq = ++m_appendedSeq;
+    m_signalled.notify_all();
+    if (m_durability == BackupDurability::Sync)
+    {
+        m_flushed.wait(l, [&]() { return m_syncedSeq >= seq || m_failed; });
+        if (m_syncedSeq < seq)
+        {
+            BOOST_THROW_EXCEPTION(
+                BackupLogError() << errinfo_comment("sync backup record failed: " + m_path));
+        }
+    }
+}
+
+bytes PBFTBackupLog::lookup(std::string const& _key) const
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    auto it = m_latest.find(_key);
+    if (it == m_latest.end())
+    {
+        return bytes();
+    }
+    return it->second;
+}
+
+void PBFTBackupLog::flush()
+{
+    std::unique_lock<std::mutex> l(m_mutex);
+    uint64_t seq = m_appendedSeq;
+    m_signalled.notify_all();
+    m_flushed.wait(l, [&]() { return m_syncedSeq >= seq || m_failed; });
+}
+
+void PBFTBackupLog::flushLoop()
+{
+    std::unique_lock<std::mutex> l(m_mutex);
+    while (m_running)
+    {
+        m_signalled.wait(l, [&]() { return !m_running || m_syncedSeq < m_appendedSeq; });
+        if (!m_running)
+        {
+            break;
+        }
+        /// gather the records appended in the interval into one fsync
+        if (m_durability != BackupDurability::Sync)
+        {
+            m_signalled.wait_for(
+                l, std::chrono::milliseconds(c_flushInterval), [&]() { return !m_running; });
+        }
+        try
+        {
+            syncWritten(l);
+        }
+        catch (std::exception const& e)
+        {
+            BACKUPLOG_LOG(ERROR) << LOG_DESC("flushLoop: sync backup log failed")
+                                 << LOG_KV("path", m_path)
+                                 << LOG_KV("EINFO", boost::diagnostic_information(e));
+            m_failed = true;
+            m_flushed.notify_all();
+            raise(SIGTERM);
+            return;
+        }
+    }
+}
+
+void PBFTBackupLog::syncWritten(std::unique_lock<std::mutex>& _lock)
+{
+    if (m_syncedSeq >= m_appendedSeq)
+    {
+        return;
+    }
+    uint64_t seq = m_appendedSeq;
+    if (m_durability != BackupDurability::NoSync)
+    {
+        /// m_fd is replaced only by compact, which runs on this thread
+        int fd = m_fd;
+        _lock.unlock();
+        try
+        {
+            syncFile(fd);
+        }
+        catch (...)
+        {
+            _lock.lock();
+            throw;
+        }
+        _lock.lock();
+    }
+
+    /// keep only the latest records once the log is large enough, the appends wait for the
+    /// compacted log since they write to it
+    size_t liveSize = 0;
+    for (auto const& it : m_latest)
+    {
+        liveSize += c_headerSize + it.first.size() + it.second.size();
+    }
+    if (m_fileSize > std::max<uint64_t>(m_compactSize, 2 * liveSize))
+    {
+        compact(m_latest);
+        uint64_t compactedSize = boost::filesystem::file_size(m_path);
+        BACKUPLOG_LOG(INFO) << LOG_DESC("compact") << LOG_KV("path", m_path)
+                            << LOG_KV("fileSize", m_fileSize) << LOG_KV("compacted", compactedSize);
+        m_fileSize = compactedSize;
+    }
+    m_syncedSeq = seq;
+    m_flushed.notify_all();
+}
+
+/// write the latest records into a temporary file and replace the log with it
+void PBFTBackupLog::compact(std::unordered_map<std::string, bytes> const& _latest)
+{
+    bytes data;
+    for (auto const& it : _latest)
+    {
+        data += encodeRecord(it.first, it.second);
+    }
+    std::string tmpPath = m_path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        BOOST_THROW_EXCEPTION(BackupLogError() << errinfo_comment(
+                                  "open " + tmpPath + " failed: " + std::strerror(errno)));
+    }
+    try
+    {
+        writeFile(fd, data);
+        syncFile(fd);
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    boost::filesystem::rename(tmpPath, m_path);
+    /// persist the rename
+    auto parent = boost::filesystem::path(m_path).parent_path();
+    int dirFd = ::open(parent.empty() ? "." : parent.string().c_str(), O_RDONLY);
+    if (dirFd >= 0)
+    {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    closeFile();
+    openFile();
+}
+
+void PBFTBackupLog::openFile()
+{
+    m_fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (m_fd < 0)
+    {
+        BOOST_THROW_EXCEPTION(BackupLogError() << errinfo_comment(
+                                  "open " + m_path + " failed: " + std::strerror(errno)));
+    }
+}
+
+void PBFTBackupLog::closeFile()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void PBFTBackupLog::writeFile(int _fd, bytes const& _data)
+{
+    size_t written = 0;
+    while (written < _data.size())
+    {
+        auto ret = ::write(_fd, _data.data() + written, _data.size() - written);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            BOOST_THROW_EXCEPTION(BackupLogError() << errinfo_comment(
+                                      "write " + m_path + " failed: " + std::strerror(errno)));
+        }
+        written += ret;
+    }
+}
+
+void PBFTBackupLog::syncFile(int _fd)
+{
+    if (_fd >= 0 && ::fsync(_fd) != 0)
+    {
+        BOOST_THROW_EXCEPTION(BackupLogError() << errinfo_comment(
+                                  "fsync " + m_path + " failed: " + std::strerror(errno)));
+    }
+}
+}  // namespace consensus
+}  // namespace dev
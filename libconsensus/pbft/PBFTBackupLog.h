@@ -0,0 +1,123 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : append-only log used to backup the pbft messages
+ * @file: PBFTBackupLog.h
+ */
+#pragma once
+#include <libdevcore/Common.h>
+#include <libdevcore/Exceptions.h>
+#include <libdevcore/easylog.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#define BACKUPLOG_LOG(LEVEL) LOG(LEVEL) << LOG_BADGE("CONSENSUS") << LOG_BADGE("BackupLog")
+
+namespace dev
+{
+namespace consensus
+{
+DEV_SIMPLE_EXCEPTION(BackupLogError);
+
+enum class BackupDurability
+{
+    /// append() returns once the record is synced to disk, the waiting appends share one fsync
+    Sync,
+    /// append() returns once the record is written, the records are synced every
+    /// c_flushInterval ms, so a crash of the process loses none but a power loss may lose them
+    Async,
+    /// append() returns once the record is written, the records are never synced
+    NoSync
+};
+
+/**
+ * @brief: every record is [length(4 bytes), crc32(4 bytes), rlp(key, data)], the latest record of
+ * every key is kept in memory, and the log is rewritten with only the latest records once it grows
+ * beyond the compact size. The torn record at the tail left by a crash is dropped on open.
+ */
+class PBFTBackupLog
+{
+public:
+    typedef std::shared_ptr<PBFTBackupLog> Ptr;
+
+    PBFTBackupLog(
+        std::string const& _path, BackupDurability _durability = BackupDurability::Async)
+      : m_path(_path), m_durability(_durability)
+    {}
+    virtual ~PBFTBackupLog() { stop(); }
+
+    /// load the latest records and start the flush thread
+    void open();
+    /// sync all the appended records, then stop the flush thread
+    void stop();
+
+    void append(std::string const& _key, bytes const& _data);
+    /// the latest data of the key, empty if not found
+    bytes lookup(std::string const& _key) const;
+    /// block until all the appended records are synced, unless NoSync
+    void flush();
+
+    uint64_t fileSize() const
+    {
+        std::lock_guard<std::mutex> l(m_mutex);
+        return m_fileSize;
+    }
+    void setCompactSize(uint64_t _compactSize) { m_compactSize = _compactSize; }
+    BackupDurability durability() const { return m_durability; }
+
+    static BackupDurability durabilityFromString(std::string const& _durability);
+
+private:
+    static bytes encodeRecord(std::string const& _key, bytes const& _data);
+    void load();
+    void flushLoop();
+    /// sync the written records with m_mutex released and compact the log, called by the flush
+    /// thread only
+    void syncWritten(std::unique_lock<std::mutex>& _lock);
+    void compact(std::unordered_map<std::string, bytes> const& _latest);
+    void openFile();
+    void closeFile();
+    void writeFile(int _fd, bytes const& _data);
+    void syncFile(int _fd);
+
+    std::string m_path;
+    BackupDurability m_durability;
+    int m_fd = -1;
+    uint64_t m_fileSize = 0;
+    uint64_t m_compactSize = c_defaultCompactSize;
+
+    mutable std::mutex m_mutex;
+    /// notify the flush thread of new records
+    std::condition_variable m_signalled;
+    /// notify the flush waiters of the synced records
+    std::condition_variable m_flushed;
+    std::unordered_map<std::string, bytes> m_latest;
+    uint64_t m_appendedSeq = 0;
+    uint64_t m_syncedSeq = 0;
+    bool m_running = false;
+    /// set once writing the log failed, the node is being stopped then
+    bool m_failed = false;
+    std::shared_ptr<std::thread> m_flushThread;
+
+    static const uint64_t c_flushInterval = 10;
+    static const uint64_t c_defaultCompactSize = 16 * 1024 * 1024;
+    static const size_t c_headerSize = 8;
+};
+}  // namespace consensus
+}  // namespace dev
@@ -43,6 +43,7 @@ namespace consensus
 {
 const std::string PBFTEngine::c_backupKeyCommitted = "committed";
 const std::string PBFTEngine::c_backupMsgDirName = "pbftMsgBackup";
+const std::string PBFTEngine::c_backupLogName = "pbftMsgBackup.log";
 
 void PBFTEngine::start()
 {
@@ -158,6 +159,40 @@ void PBFTEngine::resetConfig()
 
 /// init pbftMsgBackup
 void PBFTEngine::initBackupDB()
+{
+    std::string path;
+    /// keep the encrypted LevelDB backup of the chains compatible with RC3
+    if (g_BCOSConfig.diskEncryption.enable && g_BCOSConfig.version() <= RC3_VERSION)
+    {
+        path = getBackupMsgPath();
+        m_backupDB = openLegacyBackupDB();
+    }
+    else
+    {
+        path = getBackupLogPath();
+        if (m_backupLog)
+        {
+            m_backupLog->stop();
+        }
+        m_backupLog = std::make_shared<PBFTBackupLog>(path, m_backupDurability);
+        m_backupLog->open();
+        migrateLegacyBackupDB();
+    }
+
+    if (!isDiskSpaceEnough(path))
+    {
+        PBFTENGINE_LOG(ERROR) << LOG_DESC(
+            "initBackupDB: Disk space is insufficient, less than 100MB. Release disk space and try "
+            "again");
+        raise(SIGTERM);
+        BOOST_THROW_EXCEPTION(NotEnoughAvailableSpace());
+    }
+    // reload msg from db to commited-prepare-cache
+    reloadMsg(c_backupKeyCommitted, m_reqCache->mutableCommittedPrepareCache());
+}
+
+/// open the LevelDB used to backup the pbft messages before the backup log
+std::shared_ptr<LevelDB> PBFTEngine::openLegacyBackupDB()
 {
     /// try-catch has already been considered by libdevcore/LevelDB.*
     std::string path = getBackupMsgPath();
@@ -183,18 +218,26 @@ void PBFTEngine::initBackupDB()
 
     LevelDB::checkStatus(status, path_handler);
 
-    m_backupDB = std::make_shared<LevelDB>(basicDB);
+    return std::make_shared<LevelDB>(basicDB);
+}
 
-    if (!isDiskSpaceEnough(path))
+/// move the committed prepare backed up in LevelDB by the former versions into the backup log
+void PBFTEngine::migrateLegacyBackupDB()
+{
+    boost::filesystem::path legacyPath(getBackupMsgPath());
+    if (!m_backupLog->lookup(c_backupKeyCommitted).empty() ||
+        !boost::filesystem::exists(legacyPath / "CURRENT"))
     {
-        PBFTENGINE_LOG(ERROR) << LOG_DESC(
-            "initBackupDB: Disk space is insufficient, less than 100MB. Release disk space and try "
-            "again");
-        raise(SIGTERM);
-        BOOST_THROW_EXCEPTION(NotEnoughAvailableSpace());
+        return;
     }
-    // reload msg from db to commited-prepare-cache
-    reloadMsg(c_backupKeyCommitted, m_reqCache->mutableCommittedPrepareCache());
+    bytes data = fromHex(openLegacyBackupDB()->lookup(c_backupKeyCommitted));
+    if (!data.empty())
+    {
+        m_backupLog->append(c_backupKeyCommitted, data);
+        m_backupLog->flush();
+    }
+    PBFTENGINE_LOG(INFO) << LOG_DESC("migrateLegacyBackupDB") << LOG_KV("size", data.size())
+                         << LOG_KV("path", legacyPath.string());
 }
 
 /**
@@ -204,13 +247,14 @@ void PBFTEngine::initBackupDB()
  */
 void PBFTEngine::reloadMsg(std::string const& key, PBFTMsg* msg)
 {
-    if (!m_backupDB || !msg)
+    if ((!m_backupLog && !m_backupDB) || !msg)
     {
         return;
     }
     try
     {
-        bytes data = fromHex(m_backupDB->lookup(key));
+        bytes data =
+            m_backupLog ? m_backupLog->lookup(key) : fromHex(m_backupDB->lookup(key));
         if (data.empty())
         {
             PBFTENGINE_LOG(DEBUG) << LOG_DESC("reloadMsg: Empty message stored")
@@ -241,7 +285,7 @@ void PBFTEngine::reloadMsg(std::string const& key, PBFTMsg* msg)
  */
 void PBFTEngine::backupMsg(std::string const& _key, PBFTMsg const& _msg)
 {
-    if (!m_backupDB)
+    if (!m_backupLog && !m_backupDB)
     {
         return;
     }
@@ -249,7 +293,14 @@ void PBFTEngine::backupMsg(std::string const& _key, PBFTMsg const& _msg)
     _msg.encode(message_data);
     try
     {
-        m_backupDB->insert(_key, toHex(message_data));
+        if (m_backupLog)
+        {
+            m_backupLog->append(_key, message_data);
+        }
+        else
+        {
+            m_backupDB->insert(_key, toHex(message_data));
+        }
     }
     catch (DatabaseError const& e)
     {
@@ -275,10 +326,39 @@ bool PBFTEngine::generatePrepare(Block const& block)
     m_notifyNextLeaderSeal = false;
     PrepareReq prepare_req(block, m_keyPair, m_view, nodeIdx());
     bytes prepare_data;
-    prepare_req.encode(prepare_data);
+    unsigned packetType = PrepareReqPacket;
+    if (m_enableCompactPrepare)
+    {
+        prepare_req.encodeCompact(prepare_data);
+        packetType = CompactPrepareReqPacket;
+    }
+    else
+    {
+        prepare_req.encode(prepare_data);
+    }
 
+    if (m_enableCompactPrepare)
+    {
+        updateMissedTxsSource(prepare_req);
+    }
     /// broadcast the generated preparePacket
-    bool succ = broadcastMsg(PrepareReqPacket, prepare_req.uniqueKey(), ref(prepare_data));
+    bool succ = true;
+    if (m_broadcastTreeWidth > 0)
+    {
+        BroadcastTree tree(m_nodeNum, m_broadcastTreeWidth, nodeIdx());
+        relayToChildren(nodeIdx(), nodeIdx(), packetType, prepare_req.uniqueKey(),
+            ref(prepare_data), tree.depth() + 1);
+        m_treeBroadcastPrepare = std::make_shared<TreeBroadcastPrepare>();
+        m_treeBroadcastPrepare->blockHash = prepare_req.block_hash;
+        m_treeBroadcastPrepare->packetType = packetType;
+        m_treeBroadcastPrepare->key = prepare_req.uniqueKey();
+        m_treeBroadcastPrepare->data = std::move(prepare_data);
+        m_treeBroadcastPrepare->sendTime = utcTime();
+    }
+    else
+    {
+        succ = broadcastMsg(packetType, prepare_req.uniqueKey(), ref(prepare_data));
+    }
     if (succ)
     {
         if (prepare_req.pBlock->getTransactionSize() == 0 && m_omitEmptyBlock)
@@ -299,6 +379,80 @@ bool PBFTEngine::generatePrepare(Block const& block)
     return succ;
 }
 
+void PBFTEngine::relayToChildren(IDXTYPE const& _rootIdx, IDXTYPE const& _idx,
+    unsigned const& packetType, std::string const& key, bytesConstRef data, unsigned const& ttl)
+{
+    BroadcastTree tree(m_nodeNum, m_broadcastTreeWidth, _rootIdx);
+    for (auto child : tree.children(_idx))
+    {
+        h512 nodeId = getSealerByIndex(child);
+        if (nodeId == h512() || !sendMsg(nodeId, packetType, key, data, ttl))
+        {
+            relayToChildren(_rootIdx, child, packetType, key, data, ttl);
+        }
+    }
+}
+
+void PBFTEngine::relayPrepare(PrepareReq const& req, PBFTMsgPacket const& pbftMsg)
+{
+    if (m_broadcastTreeWidth == 0 || pbftMsg.ttl == 1)
+    {
+        return;
+    }
+    bool height_flag = (req.height > m_highestBlock.number()) ||
+                       (m_highestBlock.number() - req.height < 10);
+    if (!height_flag || m_reqCache->isExistPrepare(req) || hasConsensused(req) || !checkSign(req))
+    {
+        return;
+    }
+    /// the leader of a future prepare is checked once this node reaches its height
+    if (!isFuturePrepare(req) && !isValidLeader(req))
+    {
+        return;
+    }
+    relayToChildren(req.idx, nodeIdx(), pbftMsg.packet_id, req.uniqueKey(), ref(pbftMsg.data),
+        pbftMsg.ttl - 1);
+}
+
+void PBFTEngine::checkTreeBroadcastTimeout()
+{
+    Guard l(m_mutex);
+    /// the sealers have a third of the view timeout to sign a prepare relayed along the tree, the
+    /// sealers it is sent to directly have the rest to sign and commit it
+    uint64_t fallbackTime = m_timeManager.m_viewTimeout / 3;
+    if (!m_treeBroadcastPrepare || utcTime() - m_treeBroadcastPrepare->sendTime < fallbackTime)
+    {
+        return;
+    }
+    auto prepare = m_treeBroadcastPrepare;
+    m_treeBroadcastPrepare.reset();
+    /// the prepare has been replaced or committed
+    if (m_reqCache->rawPrepareCache().block_hash != prepare->blockHash ||
+        m_reqCache->committedPrepareCache().block_hash == prepare->blockHash)
+    {
+        return;
+    }
+    auto signedNodes = m_reqCache->signedNodes(prepare->blockHash);
+    size_t resent = 0;
+    for (IDXTYPE i = 0; i < m_nodeNum; i++)
+    {
+        h512 nodeId = getSealerByIndex(i);
+        if (i == nodeIdx() || signedNodes.count(i) || nodeId == h512())
+        {
+            continue;
+        }
+        /// ttl 1 stops the receivers from relaying it again
+        if (sendMsg(nodeId, prepare->packetType, prepare->key, ref(prepare->data), 1))
+        {
+            resent++;
+        }
+    }
+    PBFTENGINE_LOG(INFO) << LOG_DESC("checkTreeBroadcastTimeout: send prepare directly")
+                         << LOG_KV("hash", prepare->blockHash.abridged())
+                         << LOG_KV("signed", signedNodes.size()) << LOG_KV("resent", resent)
+                         << LOG_KV("nodeIdx", nodeIdx());
+}
+
 /**
  * @brief : 1. generate and broadcast signReq according to given prepareReq,
  *          2. add the generated signReq into the cache
@@ -332,12 +486,30 @@ bool PBFTEngine::checkSign(PBFTMsg const& req) const
     if (getNodeIDByIndex(node_id, req.idx))
     {
         Public pub_id = jsToPublic(toJS(node_id.hex()));
-        return dev::verify(pub_id, req.sig, req.block_hash) &&
-               dev::verify(pub_id, req.sig2, req.fieldsWithoutBlock());
+        return m_sigVerifier->verify(pub_id, req);
     }
     return false;
 }
 
+void PBFTEngine::asyncCheckSign(PBFTMsgPacket const& pbftMsg)
+{
+    SignReq req;
+    try
+    {
+        req.decode(ref(pbftMsg.data));
+    }
+    catch (std::exception const&)
+    {
+        /// the packet is dropped by the handler of the pbft worker thread
+        return;
+    }
+    h512 node_id = getSealerByIndex(req.idx);
+    if (node_id != h512())
+    {
+        m_sigVerifier->asyncVerify(node_id, req);
+    }
+}
+
 /**
  * @brief: 1. generate commitReq according to prepare req
  *         2. broadcast the commitReq
@@ -605,6 +777,8 @@ bool PBFTEngine::checkBlock(Block const& block)
         return false;
     }
     /// check sign
+    std::vector<SigItem> sigItems;
+    sigItems.reserve(sig_list.size());
     for (auto sign : sig_list)
     {
         if (sign.first >= sealers.size())
@@ -614,16 +788,15 @@ bool PBFTEngine::checkBlock(Block const& block)
                                   << LOG_KV("Nsealer", sealers.size());
             return false;
         }
-        if (!dev::verify(
-                sealers[sign.first.convert_to<size_t>()], sign.second, block.blockHeader().hash()))
-        {
-            PBFTENGINE_LOG(ERROR) << LOG_DESC("checkBlock: invalid sign")
-                                  << LOG_KV("signer", sign.first)
-                                  << LOG_KV(
-                                         "pub", sealers[sign.first.convert_to<size_t>()].abridged())
-                                  << LOG_KV("hash", block.blockHeader().hash().abridged());
-            return false;
-        }
+        sigItems.push_back(SigItem{sealers[sign.first.convert_to<size_t>()], sign.second,
+            block.blockHeader().hash()});
+    }
+    if (!m_sigVerifier->verifyBatchCached(sigItems))
+    {
+        PBFTENGINE_LOG(ERROR) << LOG_DESC("checkBlock: invalid sign")
+                              << LOG_KV("signNum", sigItems.size())
+                              << LOG_KV("hash", block.blockHeader().hash().abridged());
+        return false;
     }  /// end of check sign
 
     /// Check whether the number of transactions in block exceeds the limit
@@ -634,6 +807,32 @@ bool PBFTEngine::checkBlock(Block const& block)
     return true;
 }
 
+/**
+ * @brief: verify the sigList of the downloaded block against the sealers of its header, called
+ * by the sync module before the parent block is committed. checkBlock compares the sealers with
+ * the current ones later, and reuses the result cached by m_sigVerifier
+ */
+bool PBFTEngine::preVerifyBlock(Block const& block)
+{
+    if (block.blockHeader().number() == 0)
+    {
+        return true;
+    }
+    auto const& sealers = block.blockHeader().sealerList();
+    std::vector<SigItem> sigItems;
+    sigItems.reserve(block.sigList().size());
+    for (auto const& sign : block.sigList())
+    {
+        if (sign.first >= sealers.size())
+        {
+            return false;
+        }
+        sigItems.push_back(SigItem{sealers[sign.first.convert_to<size_t>()], sign.second,
+            block.blockHeader().hash()});
+    }
+    return m_sigVerifier->verifyBatchCached(sigItems);
+}
+
 /**
  * @brief: notify the seal module to seal block if the current node is the next leader
  * @param block: block obtained from the prepare packet, used to filter transactions
@@ -754,6 +953,7 @@ bool PBFTEngine::needOmit(Sealing const& sealing)
  * sender and receiver)
  *        2. decode the data into PBFTMsgPacket
  *        3. push the message into message queue to handler later by workLoop
+ *        4. the requests for missed transactions are answered directly, without the queue
  * @param exception: exceptions related to the received-message
  * @param session: the session related to the network data(can get informations about the sender)
  * @param message: message constructed from data received from the network
@@ -774,8 +974,17 @@ void PBFTEngine::onRecvPBFTMessage(
     {
         return;
     }
-    if (pbft_msg.packet_id <= ViewChangeReqPacket)
+    if (pbft_msg.packet_id < PBFTPacketCount)
     {
+        if (pbft_msg.packet_id == SignReqPacket || pbft_msg.packet_id == CommitReqPacket)
+        {
+            asyncCheckSign(pbft_msg);
+        }
+        if (pbft_msg.packet_id == GetMissedTxsPacket)
+        {
+            handleGetMissedTxsMsg(pbft_msg);
+            return;
+        }
         m_msgQueue.push(pbft_msg);
         /// notify to handleMsg after push new PBFTMsgPacket into m_msgQueue
         m_signalled.notify_all();
@@ -796,9 +1005,269 @@ bool PBFTEngine::handlePrepareMsg(PrepareReq& prepare_req, PBFTMsgPacket const&
     {
         return false;
     }
+    relayPrepare(prepare_req, pbftMsg);
     return handlePrepareMsg(prepare_req, pbftMsg.endpoint);
 }
 
+bool PBFTEngine::handleCompactPrepareMsg(PrepareReq& prepareReq, PBFTMsgPacket const& pbftMsg)
+{
+    bool valid = decodeToRequests(prepareReq, ref(pbftMsg.data));
+    if (!valid)
+    {
+        return false;
+    }
+    /// no need to rebuild the block of a handled or forged prepare
+    if (m_reqCache->isExistPrepare(prepareReq) || hasConsensused(prepareReq) ||
+        !checkSign(prepareReq))
+    {
+        return false;
+    }
+    auto pending = std::make_shared<PendingCompactPrepare>();
+    pending->block = std::make_shared<Block>();
+    try
+    {
+        prepareReq.decodeCompactBlock(pending->block->header(), pending->txHashes);
+    }
+    catch (std::exception const& e)
+    {
+        PBFTENGINE_LOG(WARNING) << LOG_DESC("handleCompactPrepareMsg: invalid compact block")
+                                << LOG_KV("fromIp", pbftMsg.endpoint)
+                                << LOG_KV("EINFO", boost::diagnostic_information(e));
+        return false;
+    }
+    if (pending->block->header().hash() != prepareReq.block_hash)
+    {
+        PBFTENGINE_LOG(WARNING) << LOG_DESC("handleCompactPrepareMsg: inconsistent block hash")
+                                << LOG_KV("hash", prepareReq.block_hash.abridged())
+                                << LOG_KV("fromIp", pbftMsg.endpoint);
+        return false;
+    }
+
+    pending->txs = m_txPool->transactionViews(pending->txHashes);
+    std::vector<unsigned> missedIndexes;
+    for (size_t i = 0; i < pending->txs.size(); i++)
+    {
+        if (!pending->txs[i])
+        {
+            missedIndexes.push_back(i);
+        }
+    }
+    if (missedIndexes.empty())
+    {
+        return handleRebuiltPrepare(prepareReq, *pending, pbftMsg);
+    }
+
+    /// fetch the missed transactions from the node that sends the packet, the prepare is handled
+    /// and forwarded once they are received
+    pending->req = prepareReq;
+    pending->packet = pbftMsg;
+    pending->missedIndexes = std::move(missedIndexes);
+    m_pendingCompactPrepare = pending;
+    requestMissedTxs(*pending, pbftMsg.node_id);
+    PBFTENGINE_LOG(DEBUG) << LOG_DESC("handleCompactPrepareMsg: fetch missed transactions")
+                          << LOG_KV("reqNum", prepareReq.height)
+                          << LOG_KV("hash", prepareReq.block_hash.abridged())
+                          << LOG_KV("missed", pending->missedIndexes.size())
+                          << LOG_KV("total", pending->txHashes.size())
+                          << LOG_KV("fromIp", pbftMsg.endpoint) << LOG_KV("nodeIdx", nodeIdx());
+    return false;
+}
+
+void PBFTEngine::requestMissedTxs(PendingCompactPrepare& pending, h512 const& nodeId)
+{
+    RLPStream request;
+    request.appendList(2) << pending.req.block_hash;
+    request.appendVector(pending.missedIndexes);
+    bytes requestData;
+    request.swapOut(requestData);
+    pending.fetchFrom = nodeId;
+    pending.requestTime = utcTime();
+    m_service->asyncSendMessageByNodeID(
+        nodeId, transDataToMessage(ref(requestData), GetMissedTxsPacket, 1), nullptr);
+}
+
+void PBFTEngine::retryMissedTxs()
+{
+    auto pending = m_pendingCompactPrepare;
+    if (!pending)
+    {
+        return;
+    }
+    h512 leader = getSealerByIndex(pending->req.idx);
+    if (pending->retries >= c_maxMissedTxsRetries || hasConsensused(pending->req) ||
+        leader == h512())
+    {
+        PBFTENGINE_LOG(WARNING) << LOG_DESC("retryMissedTxs: drop the compact prepare")
+                                << LOG_KV("reqNum", pending->req.height)
+                                << LOG_KV("hash", pending->req.block_hash.abridged())
+                                << LOG_KV("retries", pending->retries)
+                                << LOG_KV("nodeIdx", nodeIdx());
+        m_pendingCompactPrepare.reset();
+        return;
+    }
+    pending->retries++;
+    requestMissedTxs(*pending, leader);
+    PBFTENGINE_LOG(INFO) << LOG_DESC("retryMissedTxs: fetch missed transactions from the leader")
+                         << LOG_KV("reqNum", pending->req.height)
+                         << LOG_KV("hash", pending->req.block_hash.abridged())
+                         << LOG_KV("retries", pending->retries) << LOG_KV("nodeIdx", nodeIdx());
+}
+
+void PBFTEngine::checkCompactPrepareTimeout()
+{
+    Guard l(m_mutex);
+    /// leave time for every retry before the view change
+    uint64_t retryTime = m_timeManager.m_viewTimeout / (c_maxMissedTxsRetries + 1);
+    if (m_pendingCompactPrepare && utcTime() - m_pendingCompactPrepare->requestTime >= retryTime)
+    {
+        retryMissedTxs();
+    }
+}
+
+void PBFTEngine::updateMissedTxsSource(PrepareReq const& req)
+{
+    WriteGuard l(x_missedTxsSource);
+    m_missedTxsSourceHash = req.block_hash;
+    m_missedTxsSource = req.pBlock;
+}
+
+bool PBFTEngine::handleRebuiltPrepare(
+    PrepareReq& prepareReq, PendingCompactPrepare const& pending, PBFTMsgPacket const& pbftMsg)
+{
+    pending.block->appendTransactions(pending.txs);
+    prepareReq.pBlock = pending.block;
+    /// encoded from pBlock only if the prepare is committed and backed up
+    prepareReq.block.clear();
+    /// the children ask this node for the transactions they miss, so relay after the rebuild
+    updateMissedTxsSource(prepareReq);
+    relayPrepare(prepareReq, pbftMsg);
+    return handlePrepareMsg(prepareReq, pbftMsg.endpoint);
+}
+
+void PBFTEngine::handleGetMissedTxsMsg(PBFTMsgPacket const& pbftMsg)
+{
+    h256 blockHash;
+    std::vector<unsigned> indexes;
+    try
+    {
+        RLP request(ref(pbftMsg.data));
+        blockHash = request[0].toHash<h256>(RLP::VeryStrict);
+        indexes = request[1].toVector<unsigned>();
+    }
+    catch (std::exception const& e)
+    {
+        PBFTENGINE_LOG(WARNING) << LOG_DESC("handleGetMissedTxsMsg: invalid request")
+                                << LOG_KV("fromIp", pbftMsg.endpoint)
+                                << LOG_KV("EINFO", boost::diagnostic_information(e));
+        return;
+    }
+    std::shared_ptr<dev::eth::Block> block;
+    {
+        ReadGuard l(x_missedTxsSource);
+        if (m_missedTxsSourceHash == blockHash)
+        {
+            block = m_missedTxsSource;
+        }
+    }
+    /// an empty list tells the requester to fetch the transactions from the leader
+    RLPStream txs;
+    bool found = (block != nullptr);
+    for (auto index : indexes)
+    {
+        if (!found || index >= block->transactions().size())
+        {
+            found = false;
+            break;
+        }
+    }
+    if (found)
+    {
+        txs.appendList(indexes.size());
+        for (auto index : indexes)
+        {
+            bytes txData;
+            block->transactions()[index].encode(txData);
+            txs.appendRaw(txData);
+        }
+    }
+    else
+    {
+        txs.appendList(0);
+        PBFTENGINE_LOG(DEBUG) << LOG_DESC("handleGetMissedTxsMsg: transactions not found")
+                              << LOG_KV("hash", blockHash.abridged())
+                              << LOG_KV("fromIp", pbftMsg.endpoint);
+    }
+    RLPStream response;
+    response.appendList(2) << blockHash;
+    response.appendRaw(txs.out());
+    bytes responseData;
+    response.swapOut(responseData);
+    m_service->asyncSendMessageByNodeID(
+        pbftMsg.node_id, transDataToMessage(ref(responseData), MissedTxsPacket, 1), nullptr);
+    PBFTENGINE_LOG(DEBUG) << LOG_DESC("handleGetMissedTxsMsg: send missed transactions")
+                          << LOG_KV("hash", blockHash.abridged())
+                          << LOG_KV("txs", found ? indexes.size() : 0)
+                          << LOG_KV("toIp", pbftMsg.endpoint) << LOG_KV("nodeIdx", nodeIdx());
+}
+
+void PBFTEngine::handleMissedTxsMsg(PBFTMsgPacket const& pbftMsg)
+{
+    auto pending = m_pendingCompactPrepare;
+    if (!pending || pending->fetchFrom != pbftMsg.node_id)
+    {
+        return;
+    }
+    dev::eth::ConstTransactions txs = pending->txs;
+    try
+    {
+        RLP response(ref(pbftMsg.data));
+        if (response[0].toHash<h256>(RLP::VeryStrict) != pending->req.block_hash)
+        {
+            return;
+        }
+        RLP txList = response[1];
+        if (txList.itemCount() != pending->missedIndexes.size())
+        {
+            PBFTENGINE_LOG(DEBUG) << LOG_DESC("handleMissedTxsMsg: transactions not found")
+                                  << LOG_KV("hash", pending->req.block_hash.abridged())
+                                  << LOG_KV("fromIp", pbftMsg.endpoint);
+            retryMissedTxs();
+            return;
+        }
+        for (size_t i = 0; i < pending->missedIndexes.size(); i++)
+        {
+            auto index = pending->missedIndexes[i];
+            /// the signature is verified by verifyAndSetSenderForBlock since it's not pooled
+            auto tx = std::make_shared<Transaction>();
+            tx->decode(txList[i], CheckTransaction::None);
+            if (tx->sha3() != pending->txHashes[index])
+            {
+                PBFTENGINE_LOG(WARNING) << LOG_DESC("handleMissedTxsMsg: inconsistent tx hash")
+                                        << LOG_KV("hash", pending->req.block_hash.abridged())
+                                        << LOG_KV("fromIp", pbftMsg.endpoint);
+                retryMissedTxs();
+                return;
+            }
+            txs[index] = tx;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        PBFTENGINE_LOG(WARNING) << LOG_DESC("handleMissedTxsMsg: invalid response")
+                                << LOG_KV("fromIp", pbftMsg.endpoint)
+                                << LOG_KV("EINFO", boost::diagnostic_information(e));
+        retryMissedTxs();
+        return;
+    }
+    m_pendingCompactPrepare.reset();
+    pending->txs = std::move(txs);
+    PrepareReq prepareReq = pending->req;
+    if (handleRebuiltPrepare(prepareReq, *pending, pending->packet))
+    {
+        forwardMsg(prepareReq.uniqueKey(), pending->packet, prepareReq);
+    }
+}
+
 /**
  * @brief: handle the prepare request:
  *       1. check whether the prepareReq is valid or not
@@ -1475,6 +1944,17 @@ void PBFTEngine::handleMsg(PBFTMsgPacket const& pbftMsg)
         pbft_msg = req;
         break;
     }
+    case CompactPrepareReqPacket:
+    {
+        PrepareReq prepare_req;
+        succ = handleCompactPrepareMsg(prepare_req, pbftMsg);
+        key = prepare_req.uniqueKey();
+        pbft_msg = prepare_req;
+        break;
+    }
+    case MissedTxsPacket:
+        handleMissedTxsMsg(pbftMsg);
+        return;
     default:
     {
         PBFTENGINE_LOG(DEBUG) << LOG_DESC("handleMsg:  Err pbft message")
@@ -1484,13 +1964,28 @@ void PBFTEngine::handleMsg(PBFTMsgPacket const& pbftMsg)
     }
     }
 
+    if (succ)
+    {
+        forwardMsg(key, pbftMsg, pbft_msg);
+    }
+}
+
+void PBFTEngine::forwardMsg(
+    std::string const& key, PBFTMsgPacket const& pbftMsg, PBFTMsg const& pbft_msg)
+{
     if (pbftMsg.ttl == 1)
     {
         return;
     }
+    /// relayed along the tree by relayPrepare before the block is executed
+    if (m_broadcastTreeWidth > 0 &&
+        (pbftMsg.packet_id == PrepareReqPacket || pbftMsg.packet_id == CompactPrepareReqPacket))
+    {
+        return;
+    }
     bool height_flag = (pbft_msg.height > m_highestBlock.number()) ||
                        (m_highestBlock.number() - pbft_msg.height < 10);
-    if (succ && key.size() > 0 && height_flag)
+    if (key.size() > 0 && height_flag)
     {
         std::unordered_set<h512> filter;
         filter.insert(pbftMsg.node_id);
@@ -1531,6 +2026,8 @@ void PBFTEngine::workLoop()
             if (nodeIdx() != MAXIDX)
             {
                 checkTimeout();
+                checkTreeBroadcastTimeout();
+                checkCompactPrepareTimeout();
                 handleFutureBlock();
                 collectGarbage();
             }
@@ -23,8 +23,10 @@
  */
 #pragma once
 #include "Common.h"
+#include "PBFTBackupLog.h"
 #include "PBFTMsgCache.h"
 #include "PBFTReqCache.h"
+#include "PBFTSigVerifier.h"
 #include "TimeManager.h"
 #include <libconsensus/ConsensusEngineBase.h>
 #include <libdevcore/FileSystem.h>
@@ -75,9 +77,14 @@ public:
         /// set thread name for PBFTEngine
         std::string threadName = "PBFT-" + std::to_string(m_groupId);
         setName(threadName);
+        m_sigVerifier = std::make_shared<PBFTSigVerifier>("PBFTVerify-" + std::to_string(m_groupId),
+            std::max(1u, std::thread::hardware_concurrency() / 2));
 
         /// register checkSealerList to blockSync for check SealerList
         m_blockSync->registerConsensusVerifyHandler(boost::bind(&PBFTEngine::checkBlock, this, _1));
+        /// verify the sigList of the downloaded blocks ahead of their execution
+        m_blockSync->registerBlockPreVerifyHandler(
+            boost::bind(&PBFTEngine::preVerifyBlock, this, _1));
     }
 
     void setBaseDir(std::string const& _path) { m_baseDir = _path; }
@@ -106,6 +113,26 @@ public:
         PBFTENGINE_LOG(INFO) << LOG_KV("minBlockGenerationTime", m_timeManager.m_minBlockGenTime);
     }
 
+    /// broadcast the prepare request as the block header and the transaction hashes, the other
+    /// sealers rebuild the block from their txpools
+    void setEnableCompactPrepare(bool _enableCompactPrepare)
+    {
+        m_enableCompactPrepare = _enableCompactPrepare;
+    }
+
+    /// whether the committed prepare is synced to disk before the commit request is broadcasted
+    void setBackupDurability(BackupDurability _backupDurability)
+    {
+        m_backupDurability = _backupDurability;
+    }
+
+    /// relay the prepare requests along a tree of the given width rooted at the leader, 0 sends
+    /// them from the leader to every sealer
+    void setBroadcastTreeWidth(unsigned _broadcastTreeWidth)
+    {
+        m_broadcastTreeWidth = _broadcastTreeWidth;
+    }
+
     void start() override;
 
     /// reach the minimum block generation time
@@ -205,6 +232,10 @@ protected:
     void handleFutureBlock();
     void collectGarbage();
     void checkTimeout();
+    /// send the prepare broadcast along the tree directly to the sealers that haven't signed it
+    void checkTreeBroadcastTimeout();
+    /// fetch the transactions of the pending compact prepare again once the request times out
+    void checkCompactPrepareTimeout();
     bool getNodeIDByIndex(dev::network::NodeID& nodeId, const IDXTYPE& idx) const;
     inline void checkBlockValid(dev::eth::Block const& block) override
     {
@@ -239,6 +270,14 @@ protected:
     bool handlePrepareMsg(PrepareReq const& prepare_req, std::string const& endpoint = "self");
     /// handler prepare messages
     bool handlePrepareMsg(PrepareReq& prepareReq, PBFTMsgPacket const& pbftMsg);
+    /// rebuild the block of the compact prepare from the txpool, and handle the prepare once no
+    /// transaction is missing
+    bool handleCompactPrepareMsg(PrepareReq& prepareReq, PBFTMsgPacket const& pbftMsg);
+    /// answer the transactions missed by the sender from the snapshot of the last prepare, called
+    /// on the network thread so that the answer doesn't wait for the execution of the block
+    void handleGetMissedTxsMsg(PBFTMsgPacket const& pbftMsg);
+    /// fill the pending compact prepare with the missed transactions and handle it
+    void handleMissedTxsMsg(PBFTMsgPacket const& pbftMsg);
     /// 1. decode the network-received PBFTMsgPacket to signReq
     /// 2. check the validation of the signReq
     /// add the signReq to the cache and
@@ -247,6 +286,9 @@ protected:
     bool handleCommitMsg(CommitReq& commitReq, PBFTMsgPacket const& pbftMsg);
     bool handleViewChangeMsg(ViewChangeReq& viewChangeReq, PBFTMsgPacket const& pbftMsg);
     void handleMsg(PBFTMsgPacket const& pbftMsg);
+    /// forward the handled message to the sealers that may not have received it
+    void forwardMsg(
+        std::string const& key, PBFTMsgPacket const& pbftMsg, PBFTMsg const& pbft_msg);
     void catchupView(ViewChangeReq const& req, std::ostringstream& oss);
     void checkAndCommit();
 
@@ -259,11 +301,17 @@ protected:
     /// recalculate m_nodeNum && m_f && m_cfgErr(must called after setSigList)
     void resetConfig() override;
     virtual void initBackupDB();
+    std::shared_ptr<dev::db::LevelDB> openLegacyBackupDB();
+    void migrateLegacyBackupDB();
     void reloadMsg(std::string const& _key, PBFTMsg* _msg);
     void backupMsg(std::string const& _key, PBFTMsg const& _msg);
     inline std::string getBackupMsgPath() { return m_baseDir + "/" + c_backupMsgDirName; }
+    inline std::string getBackupLogPath() { return m_baseDir + "/" + c_backupLogName; }
 
     bool checkSign(PBFTMsg const& req) const;
+    /// verify the signatures of the sign or commit packet on the crypto workers before it is
+    /// handled by the pbft worker thread
+    void asyncCheckSign(PBFTMsgPacket const& pbftMsg);
     inline bool broadcastFilter(
         dev::network::NodeID const& nodeId, unsigned const& packetType, std::string const& key)
     {
@@ -362,7 +410,7 @@ protected:
         std::shared_ptr<dev::p2p::P2PSession> session, ssize_t& peerIndex) override
     {
         /// check message size
-        if (message->buffer()->size() <= 0)
+        if (message->payload().size() <= 0)
             return false;
         /// check whether in the sealer list
         peerIndex = getIndexBySealer(session->nodeID());
@@ -539,6 +587,7 @@ protected:
     void checkSealerList(dev::eth::Block const& block);
     /// check block
     bool checkBlock(dev::eth::Block const& block);
+    bool preVerifyBlock(dev::eth::Block const& block);
     void execBlock(Sealing& sealing, PrepareReq const& req, std::ostringstream& oss);
     void changeViewForFastViewChange()
     {
@@ -547,6 +596,50 @@ protected:
         m_signalled.notify_all();
     }
     void notifySealing(dev::eth::Block const& block);
+
+    /// a compact prepare waiting for the transactions missing from the local txpool
+    struct PendingCompactPrepare
+    {
+        PrepareReq req;
+        /// forwarded once the block is rebuilt
+        PBFTMsgPacket packet;
+        std::shared_ptr<dev::eth::Block> block;
+        h256s txHashes;
+        /// nullptr for the missed transactions
+        dev::eth::ConstTransactions txs;
+        std::vector<unsigned> missedIndexes;
+        /// the node the missed transactions are requested from
+        h512 fetchFrom;
+        uint64_t requestTime = 0;
+        unsigned retries = 0;
+    };
+    void requestMissedTxs(PendingCompactPrepare& pending, h512 const& nodeId);
+    /// request the missed transactions from the leader of the prepare, drop the prepare after
+    /// c_maxMissedTxsRetries retries and leave it to the view change
+    void retryMissedTxs();
+    /// the block of the prepare the missed transactions are answered from
+    void updateMissedTxsSource(PrepareReq const& req);
+    bool handleRebuiltPrepare(PrepareReq& prepareReq, PendingCompactPrepare const& pending,
+        PBFTMsgPacket const& pbftMsg);
+
+    /// send the packet to the children of this node in the broadcast tree rooted at _rootIdx,
+    /// the packet goes to the children of an unreachable child instead
+    void relayToChildren(IDXTYPE const& _rootIdx, IDXTYPE const& _idx, unsigned const& packetType,
+        std::string const& key, bytesConstRef data, unsigned const& ttl);
+    /// relay a decoded prepare along the tree once its signature and leader are checked, before
+    /// its block is executed, so that a failed or a future prepare still reaches the subtree
+    void relayPrepare(PrepareReq const& req, PBFTMsgPacket const& pbftMsg);
+
+    /// the prepare the leader broadcast along the tree
+    struct TreeBroadcastPrepare
+    {
+        h256 blockHash;
+        unsigned packetType;
+        std::string key;
+        bytes data;
+        uint64_t sendTime;
+    };
+
     /// to ensure at least 100MB available disk space
     virtual bool isDiskSpaceEnough(std::string const& path)
     {
@@ -567,16 +660,20 @@ protected:
     std::atomic_bool m_leaderFailed = {false};
     std::atomic_bool m_notifyNextLeaderSeal = {false};
 
-    // backup msg
+    // backup msg, m_backupDB is only used by the chains compatible with the encrypted backup of RC3
+    PBFTBackupLog::Ptr m_backupLog = nullptr;
+    BackupDurability m_backupDurability = BackupDurability::Async;
     std::shared_ptr<dev::db::LevelDB> m_backupDB = nullptr;
 
     /// static vars
     static const std::string c_backupKeyCommitted;
     static const std::string c_backupMsgDirName;
+    static const std::string c_backupLogName;
     static const unsigned c_PopWaitSeconds = 5;
 
     std::shared_ptr<PBFTBroadcastCache> m_broadCastCache;
     std::shared_ptr<PBFTReqCache> m_reqCache;
+    PBFTSigVerifier::Ptr m_sigVerifier;
     TimeManager m_timeManager;
     PBFTMsgQueue m_msgQueue;
     mutable Mutex m_mutex;
@@ -603,6 +700,16 @@ protected:
     std::map<IDXTYPE, VIEWTYPE> m_viewMap;
 
     std::atomic<uint64_t> m_sealingNumber = {0};
+
+    bool m_enableCompactPrepare = false;
+    std::shared_ptr<PendingCompactPrepare> m_pendingCompactPrepare;
+    static const unsigned c_maxMissedTxsRetries = 3;
+    mutable SharedMutex x_missedTxsSource;
+    h256 m_missedTxsSourceHash;
+    std::shared_ptr<dev::eth::Block> m_missedTxsSource;
+
+    unsigned m_broadcastTreeWidth = 0;
+    std::shared_ptr<TreeBroadcastPrepare> m_treeBroadcastPrepare;
 };
 }  // namespace consensus
 }  // namespace dev
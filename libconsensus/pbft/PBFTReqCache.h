@@ -89,6 +89,21 @@ public:
         return 0;
     }
 
+    /// indexes of the nodes whose sign requests of the given block hash are cached
+    std::unordered_set<IDXTYPE> signedNodes(h256 const& blockHash) const
+    {
+        std::unordered_set<IDXTYPE> ret;
+        auto it = m_signCache.find(blockHash);
+        if (it != m_signCache.end())
+        {
+            for (auto const& sign : it->second)
+            {
+                ret.insert(sign.second.idx);
+            }
+        }
+        return ret;
+    }
+
     inline PrepareReq const& rawPrepareCache() { return m_rawPrepareCache; }
     inline PrepareReq const& prepareCache() { return m_prepareCache; }
     inline PrepareReq const& committedPrepareCache() { return m_committedPrepareCache; }
@@ -185,7 +200,16 @@ public:
     inline size_t futurePrepareCacheSize() { return m_futurePrepareCache.size(); }
 
     /// update m_committedPrepareCache to m_rawPrepareCache before broadcast the commit-request
-    inline void updateCommittedPrepare() { m_committedPrepareCache = m_rawPrepareCache; }
+    /// a prepare rebuilt from a compact block carries no block data, which is needed to reload
+    /// and rebroadcast the committed prepare
+    inline void updateCommittedPrepare()
+    {
+        m_committedPrepareCache = m_rawPrepareCache;
+        if (m_committedPrepareCache.block.empty() && m_committedPrepareCache.pBlock)
+        {
+            m_committedPrepareCache.pBlock->encode(m_committedPrepareCache.block);
+        }
+    }
     /// obtain the sig-list from m_commitCache, and append the sig-list to given block
     bool generateAndSetSigList(dev::eth::Block& block, const IDXTYPE& minSigSize);
     ///  determine can trigger viewchange or not
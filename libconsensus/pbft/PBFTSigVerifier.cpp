@@ -0,0 +1,162 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : verify the signatures of the pbft requests off the pbft worker thread
+ * @file: PBFTSigVerifier.cpp
+ */
+#include "PBFTSigVerifier.h"
+#include <libdevcrypto/Hash.h>
+#include <tbb/parallel_for.h>
+
+namespace dev
+{
+namespace consensus
+{
+h256 PBFTSigVerifier::cacheKey(Public const& _pub, PBFTMsg const& _req)
+{
+    bytes data;
+    data.reserve(Public::size + Signature::size * 2 + h256::size * 2);
+    data += _pub.asBytes();
+    data += _req.sig.asBytes();
+    data += _req.sig2.asBytes();
+    data += _req.block_hash.asBytes();
+    data += _req.fieldsWithoutBlock().asBytes();
+    return dev::sha3(data);
+}
+
+h256 PBFTSigVerifier::cacheKey(std::vector<SigItem> const& _items)
+{
+    bytes data;
+    data.reserve((Public::size + Signature::size + h256::size) * _items.size());
+    for (auto const& item : _items)
+    {
+        data += item.pub.asBytes();
+        data += item.sig.asBytes();
+        data += item.hash.asBytes();
+    }
+    return dev::sha3(data);
+}
+
+bool PBFTSigVerifier::insert(h256 const& _key, std::shared_future<bool> const& _result)
+{
+    Guard l(m_mutex);
+    if (!m_cache.emplace(_key, _result).second)
+    {
+        return false;
+    }
+    m_keys.push_back(_key);
+    while (m_keys.size() > m_capacity)
+    {
+        m_cache.erase(m_keys.front());
+        m_keys.pop_front();
+    }
+    return true;
+}
+
+void PBFTSigVerifier::asyncVerify(Public const& _pub, PBFTMsg const& _req)
+{
+    if (!m_verifyPool)
+    {
+        return;
+    }
+    auto key = cacheKey(_pub, _req);
+    auto promise = std::make_shared<std::promise<bool>>();
+    if (!insert(key, promise->get_future().share()))
+    {
+        return;
+    }
+    auto req = std::make_shared<PBFTMsg>(_req);
+    m_verifyPool->enqueue([_pub, req, promise]() {
+        try
+        {
+            promise->set_value(verifyReq(_pub, *req));
+        }
+        catch (...)
+        {
+            promise->set_value(false);
+        }
+    });
+}
+
+bool PBFTSigVerifier::verify(Public const& _pub, PBFTMsg const& _req)
+{
+    m_queryTimes++;
+    auto key = cacheKey(_pub, _req);
+    std::shared_future<bool> result;
+    {
+        Guard l(m_mutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end())
+        {
+            result = it->second;
+        }
+    }
+    if (result.valid())
+    {
+        m_hitTimes++;
+        return result.get();
+    }
+    bool ret = verifyReq(_pub, _req);
+    std::promise<bool> promise;
+    promise.set_value(ret);
+    insert(key, promise.get_future().share());
+    return ret;
+}
+
+bool PBFTSigVerifier::verifyBatchCached(std::vector<SigItem> const& _items)
+{
+    m_queryTimes++;
+    auto key = cacheKey(_items);
+    std::shared_future<bool> result;
+    {
+        Guard l(m_mutex);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end())
+        {
+            result = it->second;
+        }
+    }
+    if (result.valid())
+    {
+        m_hitTimes++;
+        return result.get();
+    }
+    bool ret = verifyBatch(_items);
+    std::promise<bool> promise;
+    promise.set_value(ret);
+    insert(key, promise.get_future().share());
+    return ret;
+}
+
+bool PBFTSigVerifier::verifyBatch(std::vector<SigItem> const& _items)
+{
+    tbb::atomic<bool> valid;
+    valid = true;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, _items.size()),
+        [&](tbb::blocked_range<size_t> const& _r) {
+            for (size_t i = _r.begin(); i != _r.end() && valid; ++i)
+            {
+                if (!dev::verify(_items[i].pub, _items[i].sig, _items[i].hash))
+                {
+                    valid = false;
+                }
+            }
+        });
+    return valid;
+}
+}  // namespace consensus
+}  // namespace dev
@@ -0,0 +1,114 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : verify the signatures of the pbft requests off the pbft worker thread
+ * @file: PBFTSigVerifier.h
+ */
+#pragma once
+#include <libconsensus/pbft/Common.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/ThreadPool.h>
+#include <libdevcrypto/Common.h>
+#include <tbb/atomic.h>
+#include <deque>
+#include <future>
+#include <unordered_map>
+
+namespace dev
+{
+namespace consensus
+{
+/// a signature and the public key and hash it should be verified against
+struct SigItem
+{
+    Public pub;
+    Signature sig;
+    h256 hash;
+};
+
+/**
+ * @brief: the requests are verified on a crypto worker pool once received, the results are cached
+ * by the digest of the signer, the hashes and the signatures of the requests, so the pbft worker
+ * thread only waits for the verifications that have not finished yet
+ */
+class PBFTSigVerifier
+{
+public:
+    typedef std::shared_ptr<PBFTSigVerifier> Ptr;
+
+    PBFTSigVerifier(std::string const& _threadName, size_t _threadNum,
+        size_t _capacity = c_defaultCapacity)
+      : m_capacity(_capacity)
+    {
+        if (_threadNum > 0)
+        {
+            m_verifyPool = std::make_shared<dev::ThreadPool>(_threadName, _threadNum);
+        }
+        m_hitTimes = 0;
+        m_queryTimes = 0;
+    }
+
+    /// start verifying the request on the worker pool, no-op if it has been verified
+    void asyncVerify(Public const& _pub, PBFTMsg const& _req);
+
+    /// the verify result of the request, it is verified on the calling thread if it has not been
+    /// handed to the worker pool
+    bool verify(Public const& _pub, PBFTMsg const& _req);
+
+    /// verify the items across the worker threads of tbb, return false if any of them is invalid
+    static bool verifyBatch(std::vector<SigItem> const& _items);
+
+    /// verify the items in a batch, the result is cached by the items so that the batch verified
+    /// ahead, such as the sigList of a downloaded block, is not verified again
+    bool verifyBatchCached(std::vector<SigItem> const& _items);
+
+    /// verify both signatures of the request
+    static bool verifyReq(Public const& _pub, PBFTMsg const& _req)
+    {
+        return dev::verify(_pub, _req.sig, _req.block_hash) &&
+               dev::verify(_pub, _req.sig2, _req.fieldsWithoutBlock());
+    }
+
+    size_t size() const
+    {
+        Guard l(m_mutex);
+        return m_cache.size();
+    }
+    uint64_t hitTimes() const { return m_hitTimes; }
+    uint64_t queryTimes() const { return m_queryTimes; }
+
+    static const size_t c_defaultCapacity = 4096;
+
+private:
+    static h256 cacheKey(Public const& _pub, PBFTMsg const& _req);
+    static h256 cacheKey(std::vector<SigItem> const& _items);
+    /// insert the result of the key and evict the oldest one once exceeding the capacity,
+    /// return false if the key exists
+    bool insert(h256 const& _key, std::shared_future<bool> const& _result);
+
+    std::shared_ptr<dev::ThreadPool> m_verifyPool;
+    mutable Mutex m_mutex;
+    std::unordered_map<h256, std::shared_future<bool>> m_cache;
+    /// the keys in inserting order, used for eviction
+    std::deque<h256> m_keys;
+    size_t m_capacity;
+
+    tbb::atomic<uint64_t> m_hitTimes;
+    tbb::atomic<uint64_t> m_queryTimes;
+};
+}  // namespace consensus
+}  // namespace dev
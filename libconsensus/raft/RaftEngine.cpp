@@ -185,7 +185,7 @@ void RaftEngine::reportBlock(dev::eth::Block const& _block)
 bool RaftEngine::isValidReq(P2PMessage::Ptr _message, P2PSession::Ptr _session, ssize_t& _peerIndex)
 {
     /// check whether message is empty
-    if (_message->buffer()->size() <= 0)
+    if (_message->payload().size() <= 0)
         return false;
     /// check whether in the sealer list
     _peerIndex = getIndexBySealer(_session->nodeID());
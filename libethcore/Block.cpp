@@ -342,5 +342,49 @@ void Block::decodeRC2(
     }
 }
 
+bool Block::decodeAt(bytesConstRef _block, size_t _index, BlockHeader& _header,
+    Transaction* _tx, TransactionReceipt* _receipt)
+{
+    RLP block_rlp = BlockHeader::extractBlock(_block);
+    _header.populate(block_rlp[0]);
+    RLP transactionReceipts_rlp;
+    if (g_BCOSConfig.version() >= RC2_VERSION)
+    {
+        if (_tx)
+        {
+            bytesConstRef txBytes =
+                TxsParallelParser::txBytesAt(block_rlp[1].toBytesConstRef(), _index);
+            if (txBytes.empty())
+            {
+                return false;
+            }
+            _tx->decode(txBytes, CheckTransaction::None);
+        }
+        transactionReceipts_rlp = block_rlp[4];
+    }
+    else
+    {
+        RLP transactions_rlp = block_rlp[1];
+        if (_tx)
+        {
+            if (_index >= transactions_rlp.itemCount())
+            {
+                return false;
+            }
+            _tx->decode(transactions_rlp[_index], CheckTransaction::None);
+        }
+        transactionReceipts_rlp = block_rlp[2];
+    }
+    if (_receipt)
+    {
+        if (_index >= transactionReceipts_rlp.itemCount())
+        {
+            return false;
+        }
+        _receipt->decode(transactionReceipts_rlp[_index]);
+    }
+    return true;
+}
+
 }  // namespace eth
 }  // namespace dev
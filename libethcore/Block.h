@@ -78,6 +78,11 @@ public:
         CheckTransaction const _option = CheckTransaction::Everything, bool _withReceipt = true,
         bool _withTxHash = false);
 
+    /// decode the header and only the transaction and the receipt at _index of the encoded block,
+    /// the null outputs are skipped, return false if _index is out of range
+    static bool decodeAt(bytesConstRef _block, size_t _index, BlockHeader& _header,
+        Transaction* _tx, TransactionReceipt* _receipt);
+
     /// @returns the RLP serialisation of this block.
     bytes rlp() const
     {
@@ -138,6 +143,14 @@ public:
             m_transactions.push_back(trans);
         noteChange();
     }
+    /// append transactions shared with the transaction pool
+    void appendTransactions(ConstTransactions const& _trans_array)
+    {
+        m_transactions.reserve(m_transactions.size() + _trans_array.size());
+        for (auto const& trans : _trans_array)
+            m_transactions.push_back(*trans);
+        noteChange();
+    }
     /// set block header
     void setBlockHeader(BlockHeader const& _blockHeader) { m_blockHeader = _blockHeader; }
     /// set sig list
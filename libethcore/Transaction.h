@@ -304,6 +304,9 @@ protected:
 
 /// Nice name for vector of Transaction.
 using Transactions = std::vector<Transaction>;
+/// Immutable transaction shared by the transaction pool and its readers.
+using ConstTransactionPtr = std::shared_ptr<Transaction const>;
+using ConstTransactions = std::vector<ConstTransactionPtr>;
 
 /// Simple human-readable stream-shift operator.
 inline std::ostream& operator<<(std::ostream& _out, Transaction const& _t)
@@ -181,5 +181,21 @@ void TxsParallelParser::decode(
     }
 }
 
+bytesConstRef TxsParallelParser::txBytesAt(bytesConstRef _bytes, size_t _index)
+{
+    if (_bytes.size() < sizeof(Offset_t))
+        return bytesConstRef();
+    Offset_t txNum = fromBytes(_bytes.cropped(0));
+    size_t objectStart = sizeof(Offset_t) * ((size_t)txNum + 2);
+    if (_index >= txNum || objectStart >= _bytes.size())
+        return bytesConstRef();
+
+    Offset_t offset = fromBytes(_bytes.cropped(sizeof(Offset_t) * (_index + 1)));
+    Offset_t end = fromBytes(_bytes.cropped(sizeof(Offset_t) * (_index + 2)));
+    if (end < offset || end > _bytes.size() - objectStart)
+        throwInvalidBlockFormat("offset > maxOffset");
+    return _bytes.cropped(objectStart + offset, end - offset);
+}
+
 }  // namespace eth
 }  // namespace dev
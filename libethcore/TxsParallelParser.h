@@ -47,6 +47,9 @@ public:
     static bytes encode(std::vector<bytes> const& _txs);
     static void decode(Transactions& _txs, bytesConstRef _bytes,
         CheckTransaction _checkSig = CheckTransaction::Everything, bool _withHash = false);
+    /// the encoded transaction at _index without decoding the others,
+    /// empty if _index is out of range
+    static bytesConstRef txBytesAt(bytesConstRef _bytes, size_t _index);
 
 private:
     static inline bytes toBytes(Offset_t _num)
@@ -0,0 +1,102 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : the code of the contracts analyzed for the interpreter, cached by code hash
+ * @file: AnalyzedCode.cpp
+ */
+#include "AnalyzedCode.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+AnalyzedCodeCache& AnalyzedCodeCache::instance()
+{
+    static AnalyzedCodeCache cache;
+    return cache;
+}
+
+AnalyzedCodeCache::AnalyzedCodeCache()
+{
+    m_capacity = c_defaultCapacity;
+    m_queryTimes = 0;
+    m_hitTimes = 0;
+}
+
+AnalyzedCode::Ptr AnalyzedCodeCache::get(h256 const& _codeHash)
+{
+    m_queryTimes++;
+    auto& cacheShard = shard(_codeHash);
+    lock_guard<mutex> l(cacheShard.mutex);
+    auto it = cacheShard.index.find(_codeHash);
+    if (it == cacheShard.index.end())
+    {
+        return nullptr;
+    }
+    cacheShard.lru.splice(cacheShard.lru.begin(), cacheShard.lru, it->second);
+    m_hitTimes++;
+    return it->second->code;
+}
+
+void AnalyzedCodeCache::add(h256 const& _codeHash, AnalyzedCode::Ptr _code)
+{
+    auto& cacheShard = shard(_codeHash);
+    lock_guard<mutex> l(cacheShard.mutex);
+    /// analyzed by another call at the same time
+    if (cacheShard.index.count(_codeHash))
+    {
+        return;
+    }
+    cacheShard.lru.push_front(Item{_codeHash, _code});
+    cacheShard.index.emplace(_codeHash, cacheShard.lru.begin());
+    cacheShard.size += _code->memorySize();
+    evict(cacheShard);
+}
+
+void AnalyzedCodeCache::evict(Shard& _shard)
+{
+    uint64_t budget = m_capacity / c_shardNum;
+    /// the most recently used code is kept even if it is beyond the budget
+    while (_shard.size > budget && _shard.lru.size() > 1)
+    {
+        auto& item = _shard.lru.back();
+        _shard.size -= item.code->memorySize();
+        _shard.index.erase(item.hash);
+        _shard.lru.pop_back();
+    }
+}
+
+void AnalyzedCodeCache::setCapacity(uint64_t _capacity)
+{
+    m_capacity = _capacity;
+    for (auto& cacheShard : m_shards)
+    {
+        lock_guard<mutex> l(cacheShard.mutex);
+        evict(cacheShard);
+    }
+}
+
+void AnalyzedCodeCache::clear()
+{
+    for (auto& cacheShard : m_shards)
+    {
+        lock_guard<mutex> l(cacheShard.mutex);
+        cacheShard.lru.clear();
+        cacheShard.index.clear();
+        cacheShard.size = 0;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : the code of the contracts analyzed for the interpreter, cached by code hash
+ * @file: AnalyzedCode.h
+ */
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+/// built by analyze and never changed after, so it is shared by all the calls of a contract
+struct AnalyzedCode
+{
+    typedef std::shared_ptr<AnalyzedCode const> Ptr;
+
+    /// the code extended by 33 zero bytes with the synthetic ops of the user code invalidated,
+    /// and the pushes and jumps rewritten when EVM_OPTIMIZE is on
+    bytes code;
+    /// size of the original code
+    size_t codeSize = 0;
+    /// the sorted JUMPDEST positions
+    std::vector<uint64_t> jumpDests;
+    /// the values of PUSHC
+    std::vector<u256> pool;
+
+    uint64_t memorySize() const
+    {
+        return code.size() + jumpDests.size() * sizeof(uint64_t) + pool.size() * sizeof(u256);
+    }
+
+    /// the pushes and the jumps are rewritten only if both _optimize and EVM_OPTIMIZE are set
+    static Ptr analyze(uint8_t const* _code, size_t _codeSize, bool _optimize = true);
+};
+
+/// the process-wide LRU cache of the analyzed code by code hash, bounded by the memory of the
+/// analyzed code and thread-safe
+class AnalyzedCodeCache
+{
+public:
+    static AnalyzedCodeCache& instance();
+
+    AnalyzedCode::Ptr get(h256 const& _codeHash);
+    void add(h256 const& _codeHash, AnalyzedCode::Ptr _code);
+
+    void setCapacity(uint64_t _capacity);
+    void clear();
+
+    uint64_t queryTimes() const { return m_queryTimes; }
+    uint64_t hitTimes() const { return m_hitTimes; }
+
+    static const uint64_t c_defaultCapacity = 32 * 1024 * 1024;
+
+private:
+    AnalyzedCodeCache();
+
+    struct Item
+    {
+        h256 hash;
+        AnalyzedCode::Ptr code;
+    };
+    struct Shard
+    {
+        std::mutex mutex;
+        /// the most recently used at the front
+        std::list<Item> lru;
+        std::unordered_map<h256, std::list<Item>::iterator> index;
+        uint64_t size = 0;
+    };
+
+    Shard& shard(h256 const& _hash) { return m_shards[_hash[0] % c_shardNum]; }
+    /// evict the least recently used code beyond the budget of the shard, the mutex of the shard
+    /// must be held
+    void evict(Shard& _shard);
+
+    static const size_t c_shardNum = 16;
+    std::array<Shard, c_shardNum> m_shards;
+    std::atomic<uint64_t> m_capacity;
+    std::atomic<uint64_t> m_queryTimes;
+    std::atomic<uint64_t> m_hitTimes;
+};
+}  // namespace eth
+}  // namespace dev
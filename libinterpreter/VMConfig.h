@@ -30,7 +30,7 @@ namespace eth
 //
 // interpreter configuration macros for development, optimizations and tracing
 //
-// EVM_OPTIMIZE           - all optimizations off when false (TO DO - MAKE DYNAMIC)
+// EVM_OPTIMIZE           - all optimizations off when false, on by default (TO DO - MAKE DYNAMIC)
 //
 // EVM_SWITCH_DISPATCH    - dispatch via loop and switch
 // EVM_JUMP_DISPATCH      - dispatch via a jump table - available only on GCC
@@ -57,7 +57,7 @@ namespace eth
 #endif
 
 #ifndef EVM_OPTIMIZE
-#define EVM_OPTIMIZE false
+#define EVM_OPTIMIZE true
 #endif
 #if EVM_OPTIMIZE
 #define EVM_REPLACE_CONST_JUMP true
@@ -45,65 +45,73 @@ void VM::initMetrics()
     (void)done;
 }
 
-void VM::copyCode(int _extraBytes)
+AnalyzedCode::Ptr AnalyzedCode::analyze(uint8_t const* _code, size_t _codeSize, bool _optimize)
 {
+    auto analyzed = std::make_shared<AnalyzedCode>();
     // Copy code so that it can be safely modified and extend code by
-    // _extraBytes zero bytes to allow reading virtual data at the end
+    // 33 zero bytes to allow reading virtual data at the end
     // of the code without bounds checks.
-    auto extendedSize = m_codeSize + _extraBytes;
-    m_code.reserve(extendedSize);
-    m_code.assign(m_pCode, m_pCode + m_codeSize);
-    m_code.resize(extendedSize);
-}
-
-void VM::optimize()
-{
-    copyCode(33);
+    bytes& code = analyzed->code;
+    code.reserve(_codeSize + 33);
+    code.assign(_code, _code + _codeSize);
+    code.resize(_codeSize + 33);
+    analyzed->codeSize = _codeSize;
 
-    size_t const nBytes = m_codeSize;
+    size_t const nBytes = _codeSize;
 
     // build a table of jump destinations for use in verifyJumpDest
 
     TRACE_STR(1, "Build JUMPDEST table")
     for (size_t pc = 0; pc < nBytes; ++pc)
     {
-        Instruction op = Instruction(m_code[pc]);
+        Instruction op = Instruction(code[pc]);
         TRACE_OP(2, pc, op);
 
         // make synthetic ops in user code trigger invalid instruction if run
         if (op == Instruction::PUSHC || op == Instruction::JUMPC || op == Instruction::JUMPCI)
         {
             TRACE_OP(1, pc, op);
-            m_code[pc] = (byte)Instruction::INVALID;
+            code[pc] = (byte)Instruction::INVALID;
         }
 
         if (op == Instruction::JUMPDEST)
         {
-            m_jumpDests.push_back(pc);
+            analyzed->jumpDests.push_back(pc);
         }
         else if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
         {
             pc += (byte)op - (byte)Instruction::PUSH1 + 1;
         }
     }
+    if (!_optimize)
+    {
+        return analyzed;
+    }
 
 #ifdef EVM_DO_FIRST_PASS_OPTIMIZATION
 
+    auto const& jumpDests = analyzed->jumpDests;
+    auto& pool = analyzed->pool;
+    auto isJumpDest = [&](u256 const& _dest) {
+        return _dest <= 0x7FFFFFFFFFFFFFFF &&
+               std::binary_search(jumpDests.begin(), jumpDests.end(), uint64_t(_dest));
+    };
+
     TRACE_STR(1, "Do first pass optimizations")
     for (size_t pc = 0; pc < nBytes; ++pc)
     {
         u256 val = 0;
-        Instruction op = Instruction(m_code[pc]);
+        Instruction op = Instruction(code[pc]);
 
         if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
         {
             byte nPush = (byte)op - (byte)Instruction::PUSH1 + 1;
 
             // decode pushed bytes to integral value
-            val = m_code[pc + 1];
+            val = code[pc + 1];
             for (uint64_t i = pc + 2, n = nPush; --n; ++i)
             {
-                val = (val << 8) | m_code[i];
+                val = (val << 8) | code[i];
             }
 
 #if EVM_USE_CONSTANT_POOL
@@ -111,18 +119,19 @@ void VM::optimize()
             // add value to constant pool and replace PUSHn with PUSHC
             // place offset in code as 2 bytes MSB-first
             // followed by one byte count of remaining pushed bytes
-            if (5 < nPush)
+            // the pool is addressed by 2 bytes, the pushes beyond it are kept
+            if (5 < nPush && pool.size() <= 0xffff)
             {
-                uint16_t pool_off = m_pool.size();
+                uint16_t pool_off = pool.size();
                 TRACE_VAL(1, "stash", val);
                 TRACE_VAL(1, "... in pool at offset", pool_off);
-                m_pool.push_back(val);
+                pool.push_back(val);
 
                 TRACE_PRE_OPT(1, pc, op);
-                m_code[pc] = byte(op = Instruction::PUSHC);
-                m_code[pc + 3] = nPush - 2;
-                m_code[pc + 2] = pool_off & 0xff;
-                m_code[pc + 1] = pool_off >> 8;
+                code[pc] = byte(op = Instruction::PUSHC);
+                code[pc + 3] = nPush - 2;
+                code[pc + 2] = pool_off & 0xff;
+                code[pc + 1] = pool_off >> 8;
                 TRACE_POST_OPT(1, pc, op);
             }
 
@@ -130,18 +139,18 @@ void VM::optimize()
 
 #if EVM_REPLACE_CONST_JUMP
             // replace JUMP or JUMPI to constant location with JUMPC or JUMPCI
-            // verifyJumpDest is M = log(number of jump destinations)
+            // isJumpDest is M = log(number of jump destinations)
             // outer loop is N = number of bytes in code array
             // so complexity is N log M, worst case is N log N
             size_t i = pc + nPush + 1;
-            op = Instruction(m_code[i]);
+            op = Instruction(code[i]);
             if (op == Instruction::JUMP)
             {
                 TRACE_VAL(1, "Replace const JUMP with JUMPC to", val)
                 TRACE_PRE_OPT(1, i, op);
 
-                if (0 <= verifyJumpDest(val, false))
-                    m_code[i] = byte(op = Instruction::JUMPC);
+                if (isJumpDest(val))
+                    code[i] = byte(op = Instruction::JUMPC);
 
                 TRACE_POST_OPT(1, i, op);
             }
@@ -150,8 +159,8 @@ void VM::optimize()
                 TRACE_VAL(1, "Replace const JUMPI with JUMPCI to", val)
                 TRACE_PRE_OPT(1, i, op);
 
-                if (0 <= verifyJumpDest(val, false))
-                    m_code[i] = byte(op = Instruction::JUMPCI);
+                if (isJumpDest(val))
+                    code[i] = byte(op = Instruction::JUMPCI);
 
                 TRACE_POST_OPT(1, i, op);
             }
@@ -162,6 +171,7 @@ void VM::optimize()
     }
     TRACE_STR(1, "Finished optimizations")
 #endif
+    return analyzed;
 }
 
 
@@ -172,7 +182,25 @@ void VM::initEntry()
 {
     m_bounce = &VM::interpretCases;
     initMetrics();
-    optimize();
+
+    // the init code runs only once, so it is not cached
+    h256 codeHash(m_message->code_hash.bytes, h256::ConstructFromPointer);
+    bool cached = m_message->kind != EVMC_CREATE && m_message->kind != EVMC_CREATE2 &&
+                  codeHash != h256();
+    if (cached)
+    {
+        m_analyzed = AnalyzedCodeCache::instance().get(codeHash);
+    }
+    if (!m_analyzed || m_analyzed->codeSize != m_codeSize)
+    {
+        m_analyzed = AnalyzedCode::analyze(m_pCode, m_codeSize);
+        if (cached)
+        {
+            AnalyzedCodeCache::instance().add(codeHash, m_analyzed);
+        }
+    }
+    m_code = m_analyzed->code.data();
+    m_pool = m_analyzed->pool.data();
 }
 
 
@@ -161,6 +161,7 @@ void DBInitializer::initTableFactory2(Storage::Ptr _backend)
     cachedStorage->setMaxCapacity(
         m_param->mutableStorageParam().maxCapacity * 1024 * 1024);  // Bytes
     cachedStorage->setMaxForwardBlock(m_param->mutableStorageParam().maxForwardBlock);
+    cachedStorage->setMaxPendingBlock(m_param->mutableStorageParam().maxPendingBlock);
 
     cachedStorage->init();
 
@@ -234,7 +235,17 @@ void DBInitializer::setHandlerForDB(std::shared_ptr<T> rocksDB)
 std::shared_ptr<dev::db::BasicRocksDB> DBInitializer::initBasicRocksDB()
 {
     m_param->mutableStorageParam().path = m_param->mutableStorageParam().path + "/RocksDB";
-    boost::filesystem::create_directories(m_param->mutableStorageParam().path);
+    return openRocksDB(m_param->mutableStorageParam().path);
+}
+
+std::shared_ptr<dev::db::BasicRocksDB> DBInitializer::initStateDiffDB()
+{
+    return openRocksDB(m_param->baseDir() + "/StateDiff");
+}
+
+std::shared_ptr<dev::db::BasicRocksDB> DBInitializer::openRocksDB(std::string const& _path)
+{
+    boost::filesystem::create_directories(_path);
     /// open and init the rocksDB
     rocksdb::Options options;
 
@@ -246,10 +257,12 @@ std::shared_ptr<dev::db::BasicRocksDB> DBInitializer::initBasicRocksDB()
     options.create_if_missing = true;
     options.max_open_files = 200;
     options.compression = rocksdb::kSnappyCompression;
+    // overlap the WAL write of a block with the memtable insert of the previous one
+    options.enable_pipelined_write = m_param->mutableStorageParam().pipelinedWrite;
     std::shared_ptr<BasicRocksDB> rocksDB = std::make_shared<BasicRocksDB>();
 
     // any exception will cause initBasicRocksDB failed, and the program will be stopped
-    rocksDB->Open(options, m_param->mutableStorageParam().path);
+    rocksDB->Open(options, _path);
 
     setHandlerForDB(rocksDB);
     return rocksDB;
@@ -264,6 +277,9 @@ void DBInitializer::initRocksDBStorage()
         // create and init rocksDBStorage
         std::shared_ptr<RocksDBStorage> rocksdbStorage = std::make_shared<RocksDBStorage>();
         rocksdbStorage->setDB(rocksDB);
+        rocksdbStorage->setWritePolicy(
+            m_param->mutableStorageParam().syncWrite, m_param->mutableStorageParam().disableWAL);
+        rocksdbStorage->setCompactRowFormat(m_param->mutableStorageParam().compactRowFormat);
         // init TableFactory2
         initTableFactory2(rocksdbStorage);
     }
@@ -82,6 +82,8 @@ public:
 
     // open and init rocksDB
     virtual std::shared_ptr<dev::db::BasicRocksDB> initBasicRocksDB();
+    // open the rocksDB keeping the StateDiffs of the committed blocks, out of the state storage
+    virtual std::shared_ptr<dev::db::BasicRocksDB> initStateDiffDB();
 
 protected:
     /// create stateStorage (mpt or storageState options)
@@ -101,6 +103,7 @@ private:
     void initSQLStorage();
     void initTableFactory2(dev::storage::Storage::Ptr _backend);
     void initRocksDBStorage();
+    std::shared_ptr<dev::db::BasicRocksDB> openRocksDB(std::string const& _path);
 
     void createStorageState();
     void createMptState(dev::h256 const& genesisHash);
@@ -171,13 +171,17 @@ void Ledger::initTxExecuteConfig(ptree const& pt)
     {
         m_param->mutableTxParam().enableParallel =
             pt.get<bool>("tx_execute.enable_parallel", false);
+        m_param->mutableTxParam().enableOptimistic =
+            pt.get<bool>("tx_execute.enable_optimistic", false);
     }
     else
     {
         m_param->mutableTxParam().enableParallel = false;
+        m_param->mutableTxParam().enableOptimistic = false;
     }
     Ledger_LOG(DEBUG) << LOG_BADGE("InitTxExecuteConfig")
-                      << LOG_KV("enableParallel", m_param->mutableTxParam().enableParallel);
+                      << LOG_KV("enableParallel", m_param->mutableTxParam().enableParallel)
+                      << LOG_KV("enableOptimistic", m_param->mutableTxParam().enableOptimistic);
 }
 
 void Ledger::initTxPoolConfig(ptree const& pt)
@@ -233,6 +237,13 @@ void Ledger::initConsensusIniConfig(ptree const& pt)
     {
         m_param->mutableConsensusParam().blockSizeIncreaseRatio = 0.5;
     }
+    /// all the sealers should be able to handle the compact prepare before enabling it
+    m_param->mutableConsensusParam().enableCompactPrepare =
+        pt.get<bool>("consensus.enable_compact_prepare", false);
+    m_param->mutableConsensusParam().broadcastTreeWidth =
+        pt.get<unsigned>("consensus.broadcast_tree_width", 0);
+    m_param->mutableConsensusParam().backupDurability =
+        pt.get<std::string>("consensus.backup_durability", "async");
     Ledger_LOG(DEBUG) << LOG_BADGE("initConsensusIniConfig")
                       << LOG_KV("maxTTL", std::to_string(m_param->mutableConsensusParam().maxTTL))
                       << LOG_KV("minBlockGenerationTime",
@@ -240,7 +251,13 @@ void Ledger::initConsensusIniConfig(ptree const& pt)
                       << LOG_KV("enablDynamicBlockSize",
                              m_param->mutableConsensusParam().enableDynamicBlockSize)
                       << LOG_KV("blockSizeIncreaseRatio",
-                             m_param->mutableConsensusParam().blockSizeIncreaseRatio);
+                             m_param->mutableConsensusParam().blockSizeIncreaseRatio)
+                      << LOG_KV("enableCompactPrepare",
+                             m_param->mutableConsensusParam().enableCompactPrepare)
+                      << LOG_KV("broadcastTreeWidth",
+                             m_param->mutableConsensusParam().broadcastTreeWidth)
+                      << LOG_KV("backupDurability",
+                             m_param->mutableConsensusParam().backupDurability);
 }
 
 
@@ -330,6 +347,40 @@ void Ledger::initSyncConfig(ptree const& pt)
         m_param->mutableSyncParam().idleWaitMs = SYNC_IDLE_WAIT_DEFAULT;
         Ledger_LOG(WARNING) << LOG_BADGE("initSyncConfig") << LOG_DESC("idleWaitMs invalid");
     }
+
+    /// the StateDiff is the tables of the storage state written by a block
+    try
+    {
+        m_param->mutableSyncParam().recordStateDiff =
+            pt.get<bool>("sync.record_state_diff", false);
+        m_param->mutableSyncParam().stateDiffSync = pt.get<bool>("sync.state_diff_sync", false);
+        m_param->mutableSyncParam().stateDiffKeepBlocks =
+            pt.get<int64_t>("sync.state_diff_keep_blocks", 10000);
+    }
+    catch (std::exception& e)
+    {
+        m_param->mutableSyncParam().recordStateDiff = false;
+        m_param->mutableSyncParam().stateDiffSync = false;
+        Ledger_LOG(WARNING) << LOG_BADGE("initSyncConfig") << LOG_DESC("StateDiff config invalid");
+    }
+    if (m_param->mutableSyncParam().stateDiffKeepBlocks <= 0)
+    {
+        BOOST_THROW_EXCEPTION(ForbidNegativeValue() << errinfo_comment(
+                                  "Please set sync.state_diff_keep_blocks to positive !"));
+    }
+    if (dev::stringCmpIgnoreCase(m_param->mutableStateParam().type, "storage") != 0 &&
+        (m_param->mutableSyncParam().recordStateDiff || m_param->mutableSyncParam().stateDiffSync))
+    {
+        m_param->mutableSyncParam().recordStateDiff = false;
+        m_param->mutableSyncParam().stateDiffSync = false;
+        Ledger_LOG(WARNING) << LOG_BADGE("initSyncConfig")
+                            << LOG_DESC("StateDiff is only supported by the storage state");
+    }
+    Ledger_LOG(DEBUG) << LOG_BADGE("initSyncConfig")
+                      << LOG_KV("recordStateDiff", m_param->mutableSyncParam().recordStateDiff)
+                      << LOG_KV("stateDiffSync", m_param->mutableSyncParam().stateDiffSync)
+                      << LOG_KV("stateDiffKeepBlocks",
+                             m_param->mutableSyncParam().stateDiffKeepBlocks);
 }
 
 /// init db related configurations:
@@ -366,6 +417,34 @@ void Ledger::initDBConfig(ptree const& pt)
                                   "Please set storage.max_forward_block to positive !"));
     }
 
+    // blocks whose data is read through while merged into the cache in the background
+    m_param->mutableStorageParam().maxPendingBlock = pt.get<int>("storage.max_pending_block", 1);
+    if (m_param->mutableStorageParam().maxPendingBlock < 0)
+    {
+        BOOST_THROW_EXCEPTION(ForbidNegativeValue() << errinfo_comment(
+                                  "Please set storage.max_pending_block to positive !"));
+    }
+
+    m_param->mutableStorageParam().blockCacheSize = pt.get<int>("storage.block_cache_size", 64);
+    if (m_param->mutableStorageParam().blockCacheSize < 0)
+    {
+        BOOST_THROW_EXCEPTION(ForbidNegativeValue() << errinfo_comment(
+                                  "Please set storage.block_cache_size to positive !"));
+    }
+
+    m_param->mutableStorageParam().syncWrite = pt.get<bool>("storage.sync_write", false);
+    m_param->mutableStorageParam().disableWAL = pt.get<bool>("storage.disable_wal", false);
+    m_param->mutableStorageParam().pipelinedWrite = pt.get<bool>("storage.pipelined_write", false);
+    m_param->mutableStorageParam().compactRowFormat =
+        pt.get<bool>("storage.compact_row_format", false);
+    if (m_param->mutableStorageParam().syncWrite && m_param->mutableStorageParam().disableWAL)
+    {
+        /// rocksdb rejects the sync writes without WAL
+        Ledger_LOG(WARNING) << LOG_BADGE("initDBConfig")
+                            << LOG_DESC("storage.disable_wal is ignored for storage.sync_write");
+        m_param->mutableStorageParam().disableWAL = false;
+    }
+
     if (m_param->mutableStorageParam().maxRetry <= 0)
     {
         m_param->mutableStorageParam().maxRetry = 100;
@@ -393,7 +472,13 @@ void Ledger::initDBConfig(ptree const& pt)
                       << LOG_KV("dbport", m_param->mutableStorageParam().dbPort)
                       << LOG_KV("dbcharset", m_param->mutableStorageParam().dbCharset)
                       << LOG_KV("initconnections", m_param->mutableStorageParam().initConnections)
-                      << LOG_KV("maxconnections", m_param->mutableStorageParam().maxConnections);
+                      << LOG_KV("maxconnections", m_param->mutableStorageParam().maxConnections)
+                      << LOG_KV("blockCacheSize", m_param->mutableStorageParam().blockCacheSize)
+                      << LOG_KV("syncWrite", m_param->mutableStorageParam().syncWrite)
+                      << LOG_KV("disableWAL", m_param->mutableStorageParam().disableWAL)
+                      << LOG_KV("pipelinedWrite", m_param->mutableStorageParam().pipelinedWrite)
+                      << LOG_KV("compactRowFormat",
+                             m_param->mutableStorageParam().compactRowFormat);
 }
 
 /// init tx related configurations
@@ -469,6 +554,8 @@ bool Ledger::initBlockVerifier()
         enableParallel = true;
     }
     std::shared_ptr<BlockVerifier> blockVerifier = std::make_shared<BlockVerifier>(enableParallel);
+    blockVerifier->setEnableOptimistic(m_param->mutableTxParam().enableOptimistic);
+    blockVerifier->setRecordStateDiff(m_param->mutableSyncParam().recordStateDiff);
     /// set params for blockverifier
     blockVerifier->setExecutiveContextFactory(m_dbInitializer->executiveContextFactory());
     std::shared_ptr<BlockChainImp> blockChain =
@@ -491,6 +578,13 @@ bool Ledger::initBlockChain(GenesisBlockParam& _genesisParam)
     std::shared_ptr<BlockChainImp> blockChain = std::make_shared<BlockChainImp>();
     blockChain->setStateStorage(m_dbInitializer->storage());
     blockChain->setTableFactoryFactory(m_dbInitializer->tableFactoryFactory());
+    blockChain->setBlockCacheCapacity(
+        (uint64_t)m_param->mutableStorageParam().blockCacheSize * 1024 * 1024);
+    if (m_param->mutableSyncParam().recordStateDiff)
+    {
+        blockChain->setStateDiffDB(m_dbInitializer->initStateDiffDB(),
+            m_param->mutableSyncParam().stateDiffKeepBlocks);
+    }
     m_blockChain = blockChain;
     bool ret = m_blockChain->checkAndBuildGenesisBlock(_genesisParam);
     if (!ret)
@@ -543,6 +637,10 @@ std::shared_ptr<Sealer> Ledger::createPBFTSealer()
 
     pbftEngine->setOmitEmptyBlock(g_BCOSConfig.c_omitEmptyBlock);
     pbftEngine->setMaxTTL(m_param->mutableConsensusParam().maxTTL);
+    pbftEngine->setEnableCompactPrepare(m_param->mutableConsensusParam().enableCompactPrepare);
+    pbftEngine->setBroadcastTreeWidth(m_param->mutableConsensusParam().broadcastTreeWidth);
+    pbftEngine->setBackupDurability(PBFTBackupLog::durabilityFromString(
+        m_param->mutableConsensusParam().backupDurability));
     return pbftSealer;
 }
 
@@ -615,8 +713,11 @@ bool Ledger::initSync()
     }
     dev::PROTOCOL_ID protocol_id = getGroupProtoclID(m_groupId, ProtocolID::BlockSync);
     dev::h256 genesisHash = m_blockChain->getBlockByNumber(int64_t(0))->headerHash();
-    m_sync = std::make_shared<SyncMaster>(m_service, m_txPool, m_blockChain, m_blockVerifier,
-        protocol_id, m_keyPair.pub(), genesisHash, m_param->mutableSyncParam().idleWaitMs);
+    auto syncMaster = std::make_shared<SyncMaster>(m_service, m_txPool, m_blockChain,
+        m_blockVerifier, protocol_id, m_keyPair.pub(), genesisHash,
+        m_param->mutableSyncParam().idleWaitMs);
+    syncMaster->setStateDiffSync(m_param->mutableSyncParam().stateDiffSync);
+    m_sync = syncMaster;
     Ledger_LOG(DEBUG) << LOG_BADGE("initLedger") << LOG_DESC("initSync SUCC");
     return true;
 }
@@ -53,6 +53,12 @@ struct ConsensusParam
     bool enableDynamicBlockSize = true;
     /// block size increase ratio
     float blockSizeIncreaseRatio = 0.5;
+    /// broadcast the prepare request with transaction hashes instead of transactions
+    bool enableCompactPrepare = false;
+    /// fan-out of the prepare broadcast tree, 0 broadcasts the prepare to all the sealers
+    unsigned broadcastTreeWidth = 0;
+    /// durability of the pbft message backup: sync, async or none
+    std::string backupDurability = "async";
 };
 
 struct AMDBParam
@@ -67,6 +73,12 @@ struct SyncParam
 {
     /// TODO: syncParam related
     signed idleWaitMs = SYNC_IDLE_WAIT_DEFAULT;
+    /// keep the StateDiffs of the committed blocks for the syncing peers
+    bool recordStateDiff = false;
+    /// the StateDiffs of the latest blocks kept, the older ones are deleted
+    int64_t stateDiffKeepBlocks = 10000;
+    /// apply the StateDiffs of the downloaded blocks instead of executing them
+    bool stateDiffSync = false;
 };
 
 /// modification 2019.03.20: add timeStamp field to GenesisParam
@@ -99,6 +111,15 @@ struct StorageParam
     uint32_t initConnections;
     uint32_t maxConnections;
     int maxForwardBlock;
+    int maxPendingBlock = 1;
+    // MB, the budget of the block cache of the blockchain
+    int blockCacheSize = 64;
+    // the WriteOptions of rocksdb
+    bool syncWrite = false;
+    bool disableWAL = false;
+    bool pipelinedWrite = false;
+    // write the rows of rocksdb in the RowCodec version 1 format
+    bool compactRowFormat = false;
 };
 struct StateParam
 {
@@ -108,6 +129,7 @@ struct TxParam
 {
     int64_t txGasLimit;
     bool enableParallel = false;
+    bool enableOptimistic = false;
 };
 class LedgerParam : public LedgerParamInterface
 {
@@ -26,6 +26,7 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <vector>
 
 namespace ba = boost::asio;
 namespace bi = ba::ip;
@@ -127,8 +128,10 @@ public:
         socket->ref().async_connect(peer_endpoint, handler);
     }
 
+    /// the buffers are written in order without being copied, they must stay alive until the
+    /// handler is called
     virtual void asyncWrite(std::shared_ptr<SocketFace> socket,
-        boost::asio::mutable_buffers_1 buffers, ReadWriteHandler handler)
+        std::vector<boost::asio::const_buffer> const& buffers, ReadWriteHandler handler)
     {
         auto type = m_type;
         m_ioService->post([type, socket, buffers, handler]() {
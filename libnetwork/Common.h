@@ -134,6 +134,22 @@ public:
 
     virtual void encode(bytes& buffer) = 0;
     virtual ssize_t decode(const byte* buffer, size_t size) = 0;
+
+    /// the encoded message in a buffer that is never modified once returned, so that all the
+    /// sessions a message is sent to can queue the same buffer
+    virtual std::shared_ptr<bytes> encodedBuffer()
+    {
+        auto buffer = std::make_shared<bytes>();
+        encode(*buffer);
+        return buffer;
+    }
+
+    /// decode from a ref-counted receive chunk, the message may keep a view into _chunk instead
+    /// of copying its payload out
+    virtual ssize_t decodeView(std::shared_ptr<bytes> _chunk, size_t _offset, size_t _size)
+    {
+        return decode(_chunk->data() + _offset, _size);
+    }
 };
 
 class MessageFactory : public std::enable_shared_from_this<MessageFactory>
@@ -32,14 +32,18 @@
 #include <libdevcore/CommonJS.h>
 #include <libdevcore/Exceptions.h>
 #include <libdevcore/easylog.h>
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 
 using namespace dev;
 using namespace dev::network;
 
+/// the receive chunk is shared by all the messages decoded from it
+static const size_t c_readChunkSize = 64 * 1024;
+
 Session::Session(size_t _bufferSize) : bufferSize(_bufferSize)
 {
-    m_recvBuffer.resize(bufferSize);
     m_seq2Callback = std::make_shared<std::unordered_map<uint32_t, ResponseCallback::Ptr>>();
 }
 
@@ -110,9 +114,8 @@ void Session::asyncSendMessage(Message::Ptr message, Options options, CallbackFu
     SESSION_LOG(TRACE) << LOG_DESC("Session asyncSendMessage")
                        << LOG_KV("seq2Callback.size", m_seq2Callback->size())
                        << LOG_KV("endpoint", nodeIPEndpoint().name());
-    std::shared_ptr<bytes> p_buffer = std::make_shared<bytes>();
-    message->encode(*p_buffer);
-    send(p_buffer);
+    /// shared with the other sessions the message is multicast to
+    send(message->encodedBuffer());
 }
 
 void Session::send(std::shared_ptr<bytes> _msg)
@@ -135,7 +138,8 @@ void Session::send(std::shared_ptr<bytes> _msg)
     write();
 }
 
-void Session::onWrite(boost::system::error_code ec, std::size_t, std::shared_ptr<bytes>)
+void Session::onWrite(
+    boost::system::error_code ec, std::size_t, std::shared_ptr<std::vector<std::shared_ptr<bytes>>>)
 {
     if (!actived())
     {
@@ -189,21 +193,35 @@ void Session::write()
 
         m_writing = true;
 
-        std::pair<std::shared_ptr<bytes>, u256> task;
-        u256 enter_time = u256(0);
-
         if (m_writeQueue.empty())
         {
             m_writing = false;
             return;
         }
 
-        task = m_writeQueue.top();
-        m_writeQueue.pop();
+        /// drain the queue up to m_maxWriteBytes, so that a burst of small messages costs one
+        /// write round instead of one per message, the encoded buffers of the messages are
+        /// written as a buffer sequence without being copied
+        auto buffers = std::make_shared<std::vector<std::shared_ptr<bytes>>>();
+        std::vector<boost::asio::const_buffer> constBuffers;
+        size_t totalBytes = 0;
+        do
+        {
+            auto const& task = m_writeQueue.top();
+            if (!buffers->empty() && totalBytes + task.first->size() > m_maxWriteBytes)
+            {
+                break;
+            }
+            totalBytes += task.first->size();
+            buffers->push_back(task.first);
+            constBuffers.push_back(boost::asio::buffer(*task.first));
+            m_writeQueue.pop();
+        } while (!m_writeQueue.empty());
 
-        enter_time = task.second;
         auto session = shared_from_this();
-        auto buffer = task.first;
+        m_writeRounds++;
+        m_writtenMessages += buffers->size();
+        m_writtenBytes += totalBytes;
 
         auto server = m_server.lock();
         if (server && server->haveNetwork())
@@ -211,9 +229,9 @@ void Session::write()
             if (m_socket->isConnected())
             {
                 // asio::buffer referecne buffer, so buffer need alive before asio::buffer be used
-                server->asioInterface()->asyncWrite(m_socket, boost::asio::buffer(*buffer),
+                server->asioInterface()->asyncWrite(m_socket, constBuffers,
                     boost::bind(&Session::onWrite, session, boost::asio::placeholders::error,
-                        boost::asio::placeholders::bytes_transferred, buffer));
+                        boost::asio::placeholders::bytes_transferred, buffers));
             }
             else
             {
@@ -239,6 +257,28 @@ void Session::write()
     }
 }
 
+SessionWriteStatus Session::writeStatus()
+{
+    SessionWriteStatus status;
+    {
+        Guard l(x_writeQueue);
+        status.queueSize = m_writeQueue.size();
+    }
+    status.writeRounds = m_writeRounds;
+    status.writtenMessages = m_writtenMessages;
+    status.writtenBytes = m_writtenBytes;
+    return status;
+}
+
+SessionReadStatus Session::readStatus()
+{
+    SessionReadStatus status;
+    status.readBytes = m_readBytes;
+    status.readChunks = m_readChunks;
+    status.readMessages = m_readMessages;
+    return status;
+}
+
 void Session::drop(DisconnectReason _reason)
 {
     auto server = m_server.lock();
@@ -386,6 +426,33 @@ void Session::start()
     }
 }
 
+void Session::prepareReadChunk()
+{
+    if (m_readChunk && m_readChunk->size() - m_readEnd >= bufferSize)
+    {
+        return;
+    }
+    size_t pending = m_readEnd - m_readBegin;
+    /// no message refers to the chunk any more, move the pending bytes to its front
+    if (m_readChunk && m_readChunk.unique() && m_readChunk->size() - pending >= bufferSize)
+    {
+        std::memmove(m_readChunk->data(), m_readChunk->data() + m_readBegin, pending);
+    }
+    else
+    {
+        /// at least doubles with the pending bytes so that a large packet is copied O(1) times
+        auto chunk = std::make_shared<bytes>(std::max(c_readChunkSize, pending * 2 + bufferSize));
+        if (pending > 0)
+        {
+            std::memcpy(chunk->data(), m_readChunk->data() + m_readBegin, pending);
+        }
+        m_readChunk = chunk;
+        ++m_readChunks;
+    }
+    m_readBegin = 0;
+    m_readEnd = pending;
+}
+
 void Session::doRead()
 {
     auto server = m_server.lock();
@@ -404,19 +471,21 @@ void Session::doRead()
                     s->drop(TCPError);
                     return;
                 }
-                s->m_data.insert(s->m_data.end(), s->m_recvBuffer.begin(),
-                    s->m_recvBuffer.begin() + bytesTransferred);
+                s->m_readEnd += bytesTransferred;
+                s->m_readBytes += bytesTransferred;
 
                 while (true)
                 {
                     Message::Ptr message = s->m_messageFactory->buildMessage();
-                    ssize_t result = message->decode(s->m_data.data(), s->m_data.size());
+                    ssize_t result = message->decodeView(
+                        s->m_readChunk, s->m_readBegin, s->m_readEnd - s->m_readBegin);
                     if (result > 0)
                     {
                         /// SESSION_LOG(TRACE) << "Decode success: " << result;
                         NetworkException e(P2PExceptionType::Success, "Success");
+                        s->m_readBegin += result;
+                        ++s->m_readMessages;
                         s->onMessage(e, message);
-                        s->m_data.erase(s->m_data.begin(), s->m_data.begin() + result);
                     }
                     else if (result == 0)
                     {
@@ -438,8 +507,11 @@ void Session::doRead()
 
         if (m_socket->isConnected())
         {
-            server->asioInterface()->asyncReadSome(
-                m_socket, boost::asio::buffer(m_recvBuffer, m_recvBuffer.size()), asyncRead);
+            prepareReadChunk();
+            server->asioInterface()->asyncReadSome(m_socket,
+                boost::asio::buffer(
+                    m_readChunk->data() + m_readEnd, m_readChunk->size() - m_readEnd),
+                asyncRead);
         }
         else
         {
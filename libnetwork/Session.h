@@ -61,6 +61,11 @@ public:
 
     virtual bool actived() const override;
 
+    virtual SessionWriteStatus writeStatus() override;
+    virtual SessionReadStatus readStatus() override;
+    /// upper bound of the bytes coalesced into one write, a larger message is written alone
+    void setMaxWriteBytes(size_t _maxWriteBytes) { m_maxWriteBytes = _maxWriteBytes; }
+
     virtual std::weak_ptr<Host> host() { return m_server; }
     virtual void setHost(std::weak_ptr<Host> host) { m_server = host; }
 
@@ -118,10 +123,20 @@ private:
     void send(std::shared_ptr<bytes> _msg);
 
     void doRead();
-    std::vector<byte> m_data;  ///< Buffer for ingress packet data.
-    std::vector<byte> m_recvBuffer;
+    /// make sure there are at least bufferSize free bytes behind m_readEnd
+    void prepareReadChunk();
+
+    /// ref-counted receive chunk, decoded messages may keep views into it so a full chunk is
+    /// never reused while referenced, only its undecoded tail is moved into a new one
+    std::shared_ptr<bytes> m_readChunk;
+    size_t m_readBegin = 0;  ///< start of the undecoded data in m_readChunk
+    size_t m_readEnd = 0;    ///< end of the received data in m_readChunk
     const size_t bufferSize;
 
+    std::atomic<uint64_t> m_readBytes = {0};
+    std::atomic<uint64_t> m_readChunks = {0};
+    std::atomic<uint64_t> m_readMessages = {0};
+
     /// Drop the connection for the reason @a _r.
     void drop(DisconnectReason _r);
 
@@ -130,9 +145,10 @@ private:
 
     void onTimeout(const boost::system::error_code& error, uint32_t seq);
 
-    /// Perform a single round of the write operation. This could end up calling itself
-    /// asynchronously.
-    void onWrite(boost::system::error_code ec, std::size_t length, std::shared_ptr<bytes> buffer);
+    /// Perform a single round of the write operation, all queued messages up to m_maxWriteBytes
+    /// are coalesced into one buffer. This could end up calling itself asynchronously.
+    void onWrite(boost::system::error_code ec, std::size_t length,
+        std::shared_ptr<std::vector<std::shared_ptr<bytes>>> buffers);
     void write();
 
     /// call by doRead() to deal with mesage
@@ -153,11 +169,17 @@ private:
         }
     };
 
+    /// the queued buffers may be shared with other sessions, they are only read
     boost::heap::priority_queue<std::pair<std::shared_ptr<bytes>, u256>,
         boost::heap::compare<QueueCompare>, boost::heap::stable<true>>
         m_writeQueue;
     std::atomic_bool m_writing = {false};
     Mutex x_writeQueue;
+    size_t m_maxWriteBytes = 256 * 1024;
+
+    std::atomic<uint64_t> m_writeRounds = {0};
+    std::atomic<uint64_t> m_writtenMessages = {0};
+    std::atomic<uint64_t> m_writtenBytes = {0};
 
     mutable Mutex x_info;
 
@@ -46,6 +46,23 @@ struct ResponseCallback : public std::enable_shared_from_this<ResponseCallback>
     std::shared_ptr<boost::asio::deadline_timer> timeoutHandler;
 };
 
+/// write path counters of a session, writtenBytes / writeRounds is the average coalesced write
+struct SessionWriteStatus
+{
+    size_t queueSize = 0;
+    uint64_t writeRounds = 0;
+    uint64_t writtenMessages = 0;
+    uint64_t writtenBytes = 0;
+};
+
+/// read path counters of a session, readChunks * 1MB / readBytes is the allocations per MB
+struct SessionReadStatus
+{
+    uint64_t readBytes = 0;
+    uint64_t readChunks = 0;
+    uint64_t readMessages = 0;
+};
+
 class SessionFace
 {
 public:
@@ -68,6 +85,9 @@ public:
     virtual NodeIPEndpoint nodeIPEndpoint() const = 0;
 
     virtual bool actived() const = 0;
+
+    virtual SessionWriteStatus writeStatus() { return SessionWriteStatus(); }
+    virtual SessionReadStatus readStatus() { return SessionReadStatus(); }
 };
 }  // namespace network
 }  // namespace dev
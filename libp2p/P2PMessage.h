@@ -54,9 +54,23 @@ public:
     virtual uint32_t seq() override { return m_seq; }
     virtual void setSeq(uint32_t _seq) { setField(m_seq, _seq); }
 
-    virtual std::shared_ptr<bytes> buffer() { return m_buffer; }
+    /// a payload decoded as a view is copied out of the receive chunk on the first call
+    virtual std::shared_ptr<bytes> buffer()
+    {
+        if (m_chunk)
+        {
+            m_buffer = std::make_shared<bytes>(m_payload.begin(), m_payload.end());
+            m_chunk.reset();
+            m_payload.reset();
+        }
+        return m_buffer;
+    }
+    /// the payload without any copy, valid as long as the message is
+    virtual bytesConstRef payload() { return m_chunk ? m_payload : ref(*m_buffer); }
     virtual void setBuffer(std::shared_ptr<bytes> _buffer)
     {
+        m_chunk.reset();
+        m_payload.reset();
         m_buffer.reset();
         m_buffer = _buffer;
         /// update the length
@@ -99,6 +113,10 @@ protected:
     uint32_t m_seq = 0;               ///< the message identify
     std::shared_ptr<bytes> m_buffer;  ///< message data
     bool m_dirty = true;
+
+    /// the receive chunk m_payload points into, m_buffer is not used while it is set
+    std::shared_ptr<bytes> m_chunk;
+    bytesConstRef m_payload;
 };
 enum AMOPPacketType
 {
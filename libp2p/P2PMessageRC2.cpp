@@ -29,10 +29,17 @@ using namespace dev::p2p;
 using namespace dev::compress;
 
 void P2PMessageRC2::encode(bytes& buffer)
+{
+    buffer = *encodedBuffer();
+}
+
+std::shared_ptr<bytes> P2PMessageRC2::encodedBuffer()
 {
     /// re-encode when m_cache is dirty
     if (dirty())
     {
+        /// a received message being forwarded, compress() and encode() read m_buffer
+        buffer();
         std::shared_ptr<bytes> compressData = std::make_shared<bytes>();
         /// compress success
         if (compress(compressData))
@@ -44,7 +51,7 @@ void P2PMessageRC2::encode(bytes& buffer)
             encode(m_buffer);
         }
     }
-    buffer = *m_cache;
+    return m_cache;
 }
 
 /**
@@ -55,8 +62,10 @@ void P2PMessageRC2::encode(bytes& buffer)
  */
 void P2PMessageRC2::encode(std::shared_ptr<bytes> encodeBuffer)
 {
-    m_cache->clear();  ///< It is not allowed to be assembled outside.
+    /// the previous m_cache may still be queued by sessions, never modify it
+    m_cache = std::make_shared<bytes>();  ///< It is not allowed to be assembled outside.
     m_length = HEADER_LENGTH + encodeBuffer->size();
+    m_cache->reserve(m_length);
 
     uint32_t length = htonl(m_length);
     VERSION_TYPE versionType = htons(m_version);
@@ -94,7 +103,7 @@ bool P2PMessageRC2::compress(std::shared_ptr<bytes> compressData)
     return true;
 }
 
-ssize_t P2PMessageRC2::decode(const byte* buffer, size_t size)
+ssize_t P2PMessageRC2::decodeHeader(const byte* buffer, size_t size)
 {
     if (size < HEADER_LENGTH)
     {
@@ -120,10 +129,24 @@ ssize_t P2PMessageRC2::decode(const byte* buffer, size_t size)
     /// get sesq
     offset += sizeof(m_packetType);
     m_seq = ntohl(*((uint32_t*)&buffer[offset]));
+    return m_length;
+}
 
-    /// the data has been compressed
-    if (g_BCOSConfig.compressEnabled() &&
-        ((m_version & dev::eth::CompressFlag) == dev::eth::CompressFlag))
+/// the data has been compressed
+bool P2PMessageRC2::compressed() const
+{
+    return g_BCOSConfig.compressEnabled() &&
+           ((m_version & dev::eth::CompressFlag) == dev::eth::CompressFlag);
+}
+
+ssize_t P2PMessageRC2::decode(const byte* buffer, size_t size)
+{
+    ssize_t result = decodeHeader(buffer, size);
+    if (result <= 0)
+    {
+        return result;
+    }
+    if (compressed())
     {
         /// uncompress data
         SnappyCompress::uncompress(
@@ -132,8 +155,29 @@ ssize_t P2PMessageRC2::decode(const byte* buffer, size_t size)
     }
     else
     {
-        ///< TODO: assign to std::move
         m_buffer->assign(&buffer[HEADER_LENGTH], &buffer[HEADER_LENGTH] + m_length - HEADER_LENGTH);
     }
     return m_length;
+}
+
+ssize_t P2PMessageRC2::decodeView(std::shared_ptr<bytes> _chunk, size_t _offset, size_t _size)
+{
+    const byte* buffer = _chunk->data() + _offset;
+    ssize_t result = decodeHeader(buffer, _size);
+    if (result <= 0)
+    {
+        return result;
+    }
+    if (compressed())
+    {
+        /// uncompressed straight into m_buffer, the chunk is not referenced
+        SnappyCompress::uncompress(
+            bytesConstRef(&buffer[HEADER_LENGTH], m_length - HEADER_LENGTH), *m_buffer);
+    }
+    else
+    {
+        m_chunk = _chunk;
+        m_payload = bytesConstRef(&buffer[HEADER_LENGTH], m_length - HEADER_LENGTH);
+    }
+    return m_length;
 }
\ No newline at end of file
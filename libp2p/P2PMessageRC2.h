@@ -44,9 +44,13 @@ public:
 
     virtual ~P2PMessageRC2() {}
     void encode(bytes& buffer) override;
+    /// encoded (and compressed) once until the message is modified again
+    std::shared_ptr<bytes> encodedBuffer() override;
     /// < If the decoding is successful, the length of the decoded data is returned; otherwise, 0 is
     /// returned.
     ssize_t decode(const byte* buffer, size_t size) override;
+    /// an uncompressed payload is kept as a view into _chunk
+    ssize_t decodeView(std::shared_ptr<bytes> _chunk, size_t _offset, size_t _size) override;
 
     virtual void setVersion(VERSION_TYPE const& _version) { setField(m_version, _version); }
     virtual VERSION_TYPE version() const { return m_version; }
@@ -59,6 +63,9 @@ protected:
 private:
     /// compress the data to be sended
     bool compress(std::shared_ptr<bytes>);
+    /// decode the header, returns m_length once the whole packet is available
+    ssize_t decodeHeader(const byte* buffer, size_t size);
+    bool compressed() const;
     std::shared_ptr<dev::bytes> m_cache;
 };
 }  // namespace p2p
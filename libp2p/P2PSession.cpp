@@ -60,9 +60,24 @@ void P2PSession::heartBeat()
     {
         if (m_session && m_session->actived())
         {
+            auto writeStatus = m_session->writeStatus();
+            auto readStatus = m_session->readStatus();
             SESSION_LOG(TRACE) << LOG_DESC("P2PSession onHeartBeat")
                                << LOG_KV("nodeID", m_nodeInfo.nodeID.abridged())
-                               << LOG_KV("name", m_session->nodeIPEndpoint().name());
+                               << LOG_KV("name", m_session->nodeIPEndpoint().name())
+                               << LOG_KV("writeQueue", writeStatus.queueSize)
+                               << LOG_KV("writeRounds", writeStatus.writeRounds)
+                               << LOG_KV("writtenMessages", writeStatus.writtenMessages)
+                               << LOG_KV("bytesPerWrite",
+                                      writeStatus.writeRounds == 0 ?
+                                          0 :
+                                          writeStatus.writtenBytes / writeStatus.writeRounds)
+                               << LOG_KV("readMessages", readStatus.readMessages)
+                               << LOG_KV("readChunksPerMB",
+                                      readStatus.readBytes == 0 ?
+                                          0 :
+                                          (double)readStatus.readChunks * 1024 * 1024 /
+                                              readStatus.readBytes);
             auto message =
                 std::dynamic_pointer_cast<P2PMessage>(service->p2pMessageFactory()->buildMessage());
 
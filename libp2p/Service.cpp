@@ -573,11 +573,7 @@ void Service::asyncMulticastMessageByTopic(std::string topic, P2PMessage::Ptr me
                        << LOG_KV("nodes", nodeIDsToSend.size());
     try
     {
-        for (auto nodeID : nodeIDsToSend)
-        {
-            asyncSendMessageByNodeID(
-                nodeID, message, CallbackFuncWithSession(), dev::network::Options());
-        }
+        multicastMessage(sessionsByNodeIDs(nodeIDsToSend), message, dev::network::Options());
     }
     catch (std::exception& e)
     {
@@ -592,11 +588,7 @@ void Service::asyncMulticastMessageByNodeIDList(NodeIDs nodeIDs, P2PMessage::Ptr
                        << LOG_KV("nodes size", nodeIDs.size());
     try
     {
-        for (auto nodeID : nodeIDs)
-        {
-            asyncSendMessageByNodeID(
-                nodeID, message, CallbackFuncWithSession(), dev::network::Options());
-        }
+        multicastMessage(sessionsByNodeIDs(nodeIDs), message, dev::network::Options());
     }
     catch (std::exception& e)
     {
@@ -609,16 +601,17 @@ void Service::asyncBroadcastMessage(P2PMessage::Ptr message, dev::network::Optio
 {
     try
     {
-        std::unordered_map<NodeID, P2PSession::Ptr> sessions;
+        std::vector<P2PSession::Ptr> sessions;
         {
             RecursiveGuard l(x_sessions);
-            sessions = m_sessions;
+            sessions.reserve(m_sessions.size());
+            for (auto const& it : m_sessions)
+            {
+                sessions.push_back(it.second);
+            }
         }
 
-        for (auto s : sessions)
-        {
-            asyncSendMessageByNodeID(s.first, message, CallbackFuncWithSession(), options);
-        }
+        multicastMessage(sessions, message, options);
     }
     catch (std::exception& e)
     {
@@ -627,6 +620,56 @@ void Service::asyncBroadcastMessage(P2PMessage::Ptr message, dev::network::Optio
     }
 }
 
+/// snapshot the sessions of the given nodes under a single x_sessions acquisition
+std::vector<P2PSession::Ptr> Service::sessionsByNodeIDs(NodeIDs const& _nodeIDs)
+{
+    std::vector<P2PSession::Ptr> sessions;
+    RecursiveGuard l(x_sessions);
+    sessions.reserve(_nodeIDs.size());
+    for (auto const& nodeID : _nodeIDs)
+    {
+        auto it = m_sessions.find(nodeID);
+        if (it != m_sessions.end())
+        {
+            sessions.push_back(it->second);
+        }
+        else if (nodeID != id())
+        {
+            SERVICE_LOG(WARNING) << "Node inactived" << LOG_KV("nodeID", nodeID.abridged());
+        }
+    }
+    return sessions;
+}
+
+/// the message is framed (and compressed) once, all sessions queue the same encoded buffer
+void Service::multicastMessage(std::vector<P2PSession::Ptr> const& _sessions,
+    P2PMessage::Ptr _message, dev::network::Options _options)
+{
+    if (_message->seq() == 0)
+    {
+        _message->setSeq(m_p2pMessageFactory->newSeq());
+    }
+    for (auto const& session : _sessions)
+    {
+        try
+        {
+            if (!session->actived())
+            {
+                SERVICE_LOG(WARNING)
+                    << "Node inactived" << LOG_KV("nodeID", session->nodeID().abridged());
+                continue;
+            }
+            session->session()->asyncSendMessage(_message, _options, nullptr);
+        }
+        catch (std::exception& e)
+        {
+            SERVICE_LOG(ERROR) << "multicastMessage"
+                               << LOG_KV("nodeID", session->nodeID().abridged())
+                               << LOG_KV("what", boost::diagnostic_information(e));
+        }
+    }
+}
+
 void Service::registerHandlerByProtoclID(PROTOCOL_ID protocolID, CallbackFuncWithSession handler)
 {
     RecursiveGuard l(x_protocolID2Handler);
@@ -139,6 +139,9 @@ public:
 
 private:
     NodeIDs getPeersByTopic(std::string const& topic);
+    std::vector<P2PSession::Ptr> sessionsByNodeIDs(NodeIDs const& _nodeIDs);
+    void multicastMessage(std::vector<P2PSession::Ptr> const& _sessions, P2PMessage::Ptr _message,
+        dev::network::Options _options);
 
     std::map<dev::network::NodeIPEndpoint, NodeID> m_staticNodes;
     RecursiveMutex x_nodes;
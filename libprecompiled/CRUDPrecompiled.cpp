@@ -28,6 +28,7 @@
 #include <libdevcore/easylog.h>
 #include <libdevcrypto/Hash.h>
 #include <libethcore/ABI.h>
+#include <boost/lexical_cast.hpp>
 
 using namespace dev;
 using namespace dev::blockverifier;
@@ -216,6 +217,11 @@ bytes CRUDPrecompiled::call(
                     {
                         record[iter->first] = iter->second;
                     }
+                    // the system fields are kept as integers, output them the same way whether
+                    // the row is cached or loaded from the storage
+                    record[ID_FIELD] = boost::lexical_cast<std::string>(entry->getID());
+                    record[NUM_FIELD] = boost::lexical_cast<std::string>(entry->num());
+                    record[STATUS] = boost::lexical_cast<std::string>(entry->getStatus());
                     records.append(record);
                 }
             }
@@ -69,41 +69,29 @@ Status BasicRocksDB::BatchPut(WriteBatch& batch, std::string const& key, std::st
     return status;
 }
 
-// since rocksDBStorage use put with TBB
-// this function set m_encryptHandler into the parallel field to impove the performance
-Status BasicRocksDB::PutWithLock(
-    WriteBatch& batch, std::string const& key, std::string const& value, tbb::spin_mutex& mutex)
+Status BasicRocksDB::Put(WriteBatch& batch, std::string const& key, std::string& value)
 {
     // encrypt value
     if (m_encryptHandler)
     {
         std::string encryptValue;
         m_encryptHandler(value, encryptValue);
-        // put handled value into the batch
-        tbb::spin_mutex::scoped_lock lock(mutex);
         return BatchPut(batch, key, encryptValue);
     }
     else
     {
         // put handled value into the batch
-        tbb::spin_mutex::scoped_lock lock(mutex);
         return BatchPut(batch, key, value);
     }
 }
 
-Status BasicRocksDB::Put(WriteBatch& batch, std::string const& key, std::string& value)
+void BasicRocksDB::Encrypt(std::string& value)
 {
-    // encrypt value
     if (m_encryptHandler)
     {
         std::string encryptValue;
         m_encryptHandler(value, encryptValue);
-        return BatchPut(batch, key, encryptValue);
-    }
-    else
-    {
-        // put handled value into the batch
-        return BatchPut(batch, key, value);
+        value.swap(encryptValue);
     }
 }
 
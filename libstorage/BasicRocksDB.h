@@ -27,7 +27,6 @@
 #include <rocksdb/options.h>
 #include <rocksdb/slice.h>
 #include <rocksdb/write_batch.h>
-#include <tbb/spin_mutex.h>
 #include <memory>
 #include <string>
 
@@ -61,10 +60,15 @@ public:
     virtual rocksdb::Status Put(
         rocksdb::WriteBatch& batch, std::string const& key, std::string& value);
 
-    // callback hook function, and put (key, value) into batch later
-    // for performance consideration, hook is called without lock, batch put is called with lock
-    virtual rocksdb::Status PutWithLock(rocksdb::WriteBatch& batch, std::string const& key,
-        std::string const& value, tbb::spin_mutex& mutex);
+    // encrypt the value in place if the disk encryption is enabled, can be called in parallel
+    virtual void Encrypt(std::string& value);
+
+    // put the value already handled by Encrypt into the batch
+    virtual rocksdb::Status PutEncrypted(
+        rocksdb::WriteBatch& batch, std::string const& key, std::string const& value)
+    {
+        return BatchPut(batch, key, value);
+    }
 
     virtual rocksdb::Status Write(
         rocksdb::WriteOptions const& options, rocksdb::WriteBatch& updates);
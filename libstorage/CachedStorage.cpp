@@ -37,6 +37,8 @@ Cache::Cache()
 {
     m_entries = std::make_shared<Entries>();
     m_num.store(0);
+    m_accessed.store(false);
+    m_pinned.store(0);
 }
 
 std::string Cache::key()
@@ -99,23 +101,95 @@ void Cache::setTableInfo(TableInfo::Ptr tableInfo)
     m_tableInfo = tableInfo;
 }
 
+void ClockEvictionPolicy::onInsert(Cache::Ptr cache)
+{
+    m_pending.push(cache);
+}
+
+Cache::Ptr ClockEvictionPolicy::evictOne(std::function<bool(const Cache::Ptr&)> tryEvict)
+{
+    drainPending();
+
+    // two full turns: the first one may only clear access bits
+    size_t steps = m_ring.size() * 2;
+    for (size_t i = 0; i < steps && !m_ring.empty(); ++i)
+    {
+        if (m_hand >= m_ring.size())
+        {
+            m_hand = 0;
+        }
+
+        auto& cache = m_ring[m_hand];
+        if (cache->accessed())
+        {
+            cache->clearAccessed();
+            ++m_hand;
+            continue;
+        }
+
+        if (tryEvict(cache))
+        {
+            // O(1) removal, the moved-in cache is inspected by the next call
+            auto victim = cache;
+            cache = m_ring.back();
+            m_ring.pop_back();
+            return victim;
+        }
+
+        ++m_hand;
+    }
+
+    return Cache::Ptr();
+}
+
+size_t ClockEvictionPolicy::size()
+{
+    return m_ring.size() + m_pending.unsafe_size();
+}
+
+void ClockEvictionPolicy::clear()
+{
+    m_pending.clear();
+    m_ring.clear();
+    m_hand = 0;
+}
+
+void ClockEvictionPolicy::drainPending()
+{
+    Cache::Ptr cache;
+    while (m_pending.try_pop(cache))
+    {
+        m_ring.push_back(cache);
+    }
+}
+
 CachedStorage::CachedStorage()
 {
     CACHED_STORAGE_LOG(INFO) << "Init flushStorage thread";
     m_taskThreadPool = std::make_shared<dev::ThreadPool>("FlushStorage", 1);
+    m_mergeThreadPool = std::make_shared<dev::ThreadPool>("MergeCache", 1);
 
-    m_mruQueue =
-        std::make_shared<tbb::concurrent_queue<std::tuple<std::string, std::string, ssize_t>>>();
-    m_mru = std::make_shared<boost::multi_index_container<std::pair<std::string, std::string>,
-        boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
-            boost::multi_index::hashed_unique<
-                boost::multi_index::identity<std::pair<std::string, std::string>>>>>>();
+    m_evictionPolicy = std::make_shared<ClockEvictionPolicy>();
     m_syncNum.store(0);
     m_commitNum.store(0);
     m_capacity.store(0);
 
-    m_hitTimes.store(0);
-    m_queryTimes.store(0);
+    m_evictTimes.store(0);
+    m_lastEvictLatency.store(0);
+    m_maxEvictLatency.store(0);
+    m_mergeFailed.store(false);
+
+    // 4 shards per hardware thread, rounded up to a power of two
+    size_t shardNum = std::max<size_t>(std::thread::hardware_concurrency(), 4) * 4;
+    while ((size_t(1) << m_shardBits) < shardNum)
+    {
+        ++m_shardBits;
+    }
+    m_cacheShards.resize(size_t(1) << m_shardBits);
+    for (auto& cacheShard : m_cacheShards)
+    {
+        cacheShard = std::make_shared<CacheShard>();
+    }
 
     m_running = std::make_shared<tbb::atomic<bool>>();
     m_running->store(true);
@@ -134,23 +208,96 @@ Entries::Ptr CachedStorage::select(h256 hash, int64_t num, TableInfo::Ptr tableI
 {
     auto out = std::make_shared<Entries>();
 
+    // taken before the cache, so a block merged in between is applied twice rather than missed
+    std::vector<PendingBlock::Ptr> pendingBlocks;
+    {
+        RWMutexScoped lock(m_pendingBlocksMutex, false);
+        pendingBlocks.assign(m_pendingBlocks.begin(), m_pendingBlocks.end());
+    }
+
     auto result = selectNoCondition(hash, num, tableInfo, key, condition);
 
+    // cached entries are never modified once published, commit() replaces them instead, so they
+    // are handed out as shared read-only views, the caller must clone() before writing
     Cache::Ptr caches = std::get<1>(result);
-    for (auto entry : *(caches->entries()))
+    if (pendingBlocks.empty())
+    {
+        for (auto entry : *(caches->entries()))
+        {
+            if (condition && !condition->process(entry))
+            {
+                continue;
+            }
+            out->addEntry(entry);
+        }
+        return out;
+    }
+
+    std::vector<Entry::Ptr> entries(caches->entries()->begin(), caches->entries()->end());
+    CacheKey cacheKey(tableInfo->name, key);
+    for (auto& pendingBlock : pendingBlocks)
+    {
+        applyPendingBlock(pendingBlock, cacheKey, entries);
+    }
+
+    for (auto entry : entries)
     {
         if (condition && !condition->process(entry))
         {
             continue;
         }
-        auto outEntry = std::make_shared<Entry>();
-        outEntry->copyFrom(entry);
-        out->addEntry(outEntry);
+        out->addEntry(entry);
     }
 
     return out;
 }
 
+void CachedStorage::applyPendingBlock(
+    PendingBlock::Ptr pendingBlock, const CacheKey& cacheKey, std::vector<Entry::Ptr>& entries)
+{
+    auto rowsIt = pendingBlock->rows.find(cacheKey);
+    if (rowsIt == pendingBlock->rows.end())
+    {
+        return;
+    }
+
+    auto idLess = [](const Entry::Ptr& lhs, const Entry::Ptr& rhs) {
+        return lhs->getID() < rhs->getID();
+    };
+
+    // exactly what mergePendingBlock() does to the cache, so applying a merged block is a no-op
+    for (auto& dirtyEntry : rowsIt->second.dirtyEntries)
+    {
+        auto entryIt = std::lower_bound(entries.begin(), entries.end(), dirtyEntry, idLess);
+        if (entryIt != entries.end() && (*entryIt)->getID() == dirtyEntry->getID())
+        {
+            *entryIt = mergeDirtyEntry(*entryIt, dirtyEntry, pendingBlock->num);
+        }
+    }
+
+    for (auto& newEntry : rowsIt->second.newEntries)
+    {
+        auto entryIt = std::lower_bound(entries.begin(), entries.end(), newEntry, idLess);
+        if (entryIt == entries.end() || (*entryIt)->getID() != newEntry->getID())
+        {
+            entries.insert(entryIt, newEntry);
+        }
+    }
+}
+
+Entry::Ptr CachedStorage::mergeDirtyEntry(
+    const Entry::Ptr& cacheEntry, const Entry::Ptr& dirtyEntry, int64_t num)
+{
+    auto mergedEntry = cacheEntry->clone();
+    for (auto fieldIt : *dirtyEntry)
+    {
+        mergedEntry->setField(fieldIt.first, fieldIt.second);
+    }
+    mergedEntry->setStatus(dirtyEntry->getStatus());
+    mergedEntry->setNum(num);
+    return mergedEntry;
+}
+
 std::tuple<std::shared_ptr<Cache::RWScoped>, Cache::Ptr> CachedStorage::selectNoCondition(h256 hash,
     int64_t num, TableInfo::Ptr tableInfo, const std::string& key, Condition::Ptr condition)
 {
@@ -177,13 +324,9 @@ std::tuple<std::shared_ptr<Cache::RWScoped>, Cache::Ptr> CachedStorage::selectNo
             {
                 totalCapacity += it->capacity();
             }
-            touchMRU(tableInfo->name, key, totalCapacity);
+            updateCapacity(totalCapacity);
         }
     }
-    else
-    {
-        touchMRU(tableInfo->name, key, 0);
-    }
 
     return std::make_tuple(std::get<0>(result), caches);
 }
@@ -193,7 +336,120 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
     CACHED_STORAGE_LOG(INFO) << "CachedStorage commit: " << datas.size() << " hash: " << hash
                              << " num: " << num;
 
-    tbb::atomic<size_t> total = 0;
+    TIME_RECORD("Sort new entries");
+    auto pendingBlock = std::make_shared<PendingBlock>();
+    pendingBlock->hash = hash;
+    pendingBlock->num = num;
+    pendingBlock->datas.resize(datas.size());
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, datas.size()), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++idx)
+            {
+                auto requestData = datas[idx];
+                auto pendingData = std::make_shared<TableData>();
+                pendingData->info = requestData->info;
+                pendingData->dirtyEntries = requestData->dirtyEntries;
+                pendingData->newEntries->shallowFrom(requestData->newEntries);
+                tbb::parallel_sort(pendingData->newEntries->begin(),
+                    pendingData->newEntries->end(), EntryLessNoLock(requestData->info));
+
+                pendingBlock->datas[idx] = pendingData;
+            }
+        });
+
+    // new entries get their IDs in commit order, before the block may be merged in the background
+    TIME_RECORD("Set new entries ID");
+    size_t total = 0;
+    for (auto& pendingData : pendingBlock->datas)
+    {
+        total += pendingData->dirtyEntries->size();
+        for (auto commitEntry : *pendingData->newEntries)
+        {
+            commitEntry->setID(++m_ID);
+            commitEntry->setNum(num);
+            ++total;
+        }
+    }
+    pendingBlock->lastID = m_ID;
+
+    if (m_maxPendingBlock == 0 || disabled())
+    {
+        mergePendingBlock(pendingBlock);
+        return total;
+    }
+
+    TIME_RECORD("Index pending block");
+    for (auto& pendingData : pendingBlock->datas)
+    {
+        for (auto entry : *pendingData->dirtyEntries)
+        {
+            CacheKey cacheKey(pendingData->info->name, entry->getField(pendingData->info->key));
+            pendingBlock->rows[cacheKey].dirtyEntries.push_back(entry);
+        }
+        for (auto entry : *pendingData->newEntries)
+        {
+            CacheKey cacheKey(pendingData->info->name, entry->getField(pendingData->info->key));
+            pendingBlock->rows[cacheKey].newEntries.push_back(entry);
+        }
+    }
+
+    TIME_RECORD("Wait pending blocks");
+    while (true)
+    {
+        if (m_mergeFailed.load())
+        {
+            // the blocks after the failed one can't reach the cache nor the backend
+            BOOST_THROW_EXCEPTION(
+                StorageException(-1, std::string("merge of a pending block failed")));
+        }
+        {
+            RWMutexScoped lock(m_pendingBlocksMutex, true);
+            if (m_pendingBlocks.size() < m_maxPendingBlock || !m_running->load())
+            {
+                m_pendingBlocks.push_back(pendingBlock);
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // select() sees the block from now on, the cache catches up in the background
+    auto self = std::weak_ptr<CachedStorage>(
+        std::dynamic_pointer_cast<CachedStorage>(shared_from_this()));
+    m_mergeThreadPool->enqueue([pendingBlock, self]() {
+        auto storage = self.lock();
+        if (storage)
+        {
+            try
+            {
+                storage->mergePendingBlock(pendingBlock);
+            }
+            catch (std::exception& e)
+            {
+                STORAGE_LOG(ERROR) << LOG_BADGE("CachedStorage")
+                                   << LOG_DESC("Merge pending block failed")
+                                   << LOG_KV("num", pendingBlock->num)
+                                   << LOG_KV("EINFO", e.what());
+                // stop the node as a failed commit to the backend does
+                storage->m_mergeFailed.store(true);
+                storage->m_running->store(false);
+                raise(SIGTERM);
+            }
+
+            RWMutexScoped lock(storage->m_pendingBlocksMutex, true);
+            storage->m_pendingBlocks.pop_front();
+        }
+    });
+
+    return total;
+}
+
+void CachedStorage::mergePendingBlock(PendingBlock::Ptr pendingBlock)
+{
+    auto hash = pendingBlock->hash;
+    auto num = pendingBlock->num;
+    auto& datas = pendingBlock->datas;
 
     TIME_RECORD("Process dirty entries");
     std::shared_ptr<std::vector<TableData::Ptr>> commitDatas =
@@ -225,8 +481,6 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
                     [&](const tbb::blocked_range<size_t>& rangeEntries) {
                         for (size_t i = rangeEntries.begin(); i < rangeEntries.end(); ++i)
                         {
-                            ++total;
-
                             auto entry = requestData->dirtyEntries->get(i);
                             auto key = entry->getField(requestData->info->key);
                             auto id = entry->getID();
@@ -261,7 +515,7 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
                                             << "backend capacity: " << requestData->info->name
                                             << "-" << key << ", capacity: " << totalCapacity;
 #endif
-                                        touchMRU(requestData->info->name, key, totalCapacity);
+                                        updateCapacity(totalCapacity);
                                     }
 
                                     restoreCache(requestData->info, key, caches);
@@ -281,25 +535,21 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
                                 {
                                     auto oldSize = (*entryIt)->capacity();
 
-                                    for (auto fieldIt : *entry)
-                                    {
-                                        (*entryIt)->setField(fieldIt.first, fieldIt.second);
-                                    }
-                                    (*entryIt)->setStatus(entry->getStatus());
+                                    // readers may still hold the published entry, replace it
+                                    auto cacheEntry = mergeDirtyEntry(*entryIt, entry, num);
 #if 0
                                     CACHED_STORAGE_LOG(TRACE)
                                         << "update capacity: " << commitData->info->name << "-"
                                         << key << ", from capacity: " << oldSize
-                                        << " to capacity: " << (*entryIt)->capacity();
+                                        << " to capacity: " << cacheEntry->capacity();
 #endif
                                     change = (ssize_t)(
-                                        (ssize_t)(*entryIt)->capacity() - (ssize_t)oldSize);
+                                        (ssize_t)cacheEntry->capacity() - (ssize_t)oldSize);
 
-                                    (*entryIt)->setNum(num);
+                                    *entryIt = cacheEntry;
 
-                                    auto commitEntry = std::make_shared<Entry>();
-                                    commitEntry->copyFrom(*entryIt);
-                                    (*commitData->dirtyEntries)[i] = commitEntry;
+                                    // immutable from now on, shared with the backend task
+                                    (*commitData->dirtyEntries)[i] = cacheEntry;
 
                                     if (m_backend && !m_backend->onlyDirty())
                                     {
@@ -336,7 +586,7 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
                                     << "Dirty entry id equal to 0, id: " << id << " key: " << key;
                             }
 
-                            touchMRU(requestData->info->name, key, change);
+                            updateCapacity(change);
                         }
                     });
 
@@ -344,12 +594,9 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
                 tbb::parallel_sort(commitData->dirtyEntries->begin(),
                     commitData->dirtyEntries->end(), EntryLessNoLock(requestData->info));
 
+                // sorted and numbered by commit()
                 commitData->newEntries->shallowFrom(requestData->newEntries);
 
-                TIME_RECORD("Sort new entries");
-                tbb::parallel_sort(commitData->newEntries->begin(), commitData->newEntries->end(),
-                    EntryLessNoLock(requestData->info));
-
                 (*commitDatas)[idx] = commitData;
             }
         });
@@ -364,17 +611,10 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
         for (size_t j = 0; j < newEntriesSize; ++j)
         {
             auto commitEntry = commitData->newEntries->get(j);
-            commitEntry->setID(++m_ID);
-            commitEntry->setNum(num);
-#if 0
-            STORAGE_LOG(TRACE) << "Set new entry ID: " << m_ID;
-#endif
-            ++total;
-
             auto key = commitEntry->getField(commitData->info->key);
 
-            auto cacheEntry = std::make_shared<Entry>();
-            cacheEntry->copyFrom(commitEntry);
+            // the committed table is not written any more, share the entry with the cache
+            auto cacheEntry = commitEntry;
 
             if (cacheEntry->force())
             {
@@ -412,7 +652,7 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
                         CACHED_STORAGE_LOG(TRACE) << "backend capacity: " << commitData->info->name
                                                   << "-" << key << ", capacity: " << totalCapacity;
 #endif
-                        touchMRU(commitData->info->name, key, totalCapacity);
+                        updateCapacity(totalCapacity);
                     }
 
                     restoreCache(commitData->info, key, caches);
@@ -426,7 +666,7 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
             STORAGE_LOG(TRACE) << "new cached: " << commitData->info->name << "-" << key
                                << ", capacity: " << cacheEntry->capacity();
 #endif
-            touchMRU(commitData->info->name, key, cacheEntry->capacity());
+            updateCapacity(cacheEntry->capacity());
         }
     }
 
@@ -457,7 +697,7 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
         idEntry->setNum(num);
         idEntry->setStatus(0);
         idEntry->setField(SYS_KEY, SYS_KEY_CURRENT_ID);
-        idEntry->setField("value", boost::lexical_cast<std::string>(m_ID));
+        idEntry->setField("value", boost::lexical_cast<std::string>(pendingBlock->lastID));
 
         data->dirtyEntries->addEntry(idEntry);
 
@@ -518,7 +758,6 @@ size_t CachedStorage::commit(h256 hash, int64_t num, const std::vector<TableData
 
         setSyncNum(num);
     }
-    return total;
 }
 
 bool CachedStorage::onlyDirty()
@@ -559,6 +798,7 @@ void CachedStorage::init()
 void CachedStorage::stop()
 {
     STORAGE_LOG(INFO) << "Stoping flushStorage thread";
+    m_mergeThreadPool->stop();
     m_taskThreadPool->stop();
     m_running->store(false);
 
@@ -578,9 +818,46 @@ void CachedStorage::stop()
 
 void CachedStorage::clear()
 {
-    RWMutexScoped lockCache(m_cachesMutex, true);
+    for (auto& cacheShard : m_cacheShards)
+    {
+        CacheShard::RWMutexScoped lockCache(cacheShard->m_mutex, true);
+
+        cacheShard->m_caches.clear();
+    }
+
+    m_evictionPolicy->clear();
+}
+
+void CachedStorage::setEvictionPolicy(CacheEvictionPolicy::Ptr evictionPolicy)
+{
+    m_evictionPolicy = evictionPolicy;
+}
 
-    m_caches.clear();
+CacheStatus CachedStorage::status()
+{
+    CacheStatus cacheStatus;
+    for (auto& cacheShard : m_cacheShards)
+    {
+        cacheStatus.hitTimes += cacheShard->m_hitTimes;
+        cacheStatus.queryTimes += cacheShard->m_queryTimes;
+    }
+    cacheStatus.evictTimes = m_evictTimes;
+    cacheStatus.lastEvictLatency = m_lastEvictLatency;
+    cacheStatus.maxEvictLatency = m_maxEvictLatency;
+    cacheStatus.capacity = m_capacity;
+    cacheStatus.cacheSize = cacheSize();
+
+    return cacheStatus;
+}
+
+size_t CachedStorage::cacheSize()
+{
+    size_t total = 0;
+    for (auto& cacheShard : m_cacheShards)
+    {
+        total += cacheShard->m_caches.size();
+    }
+    return total;
 }
 
 int64_t CachedStorage::syncNum()
@@ -603,6 +880,11 @@ void CachedStorage::setMaxForwardBlock(size_t maxForwardBlock)
     m_maxForwardBlock = maxForwardBlock;
 }
 
+void CachedStorage::setMaxPendingBlock(size_t maxPendingBlock)
+{
+    m_maxPendingBlock = maxPendingBlock;
+}
+
 size_t CachedStorage::ID()
 {
     return m_ID;
@@ -629,62 +911,61 @@ void CachedStorage::startClearThread()
     });
 }
 
-void CachedStorage::touchMRU(const std::string& table, const std::string& key, ssize_t capacity)
+CacheShard& CachedStorage::shard(const CacheKey& cacheKey)
 {
-    if (disabled())
-    {
-        return;
-    }
-
-    m_mruQueue->push(std::make_tuple(table, key, capacity));
-}
-
-void CachedStorage::updateMRU(const std::string& table, const std::string& key, ssize_t capacity)
-{
-    if (capacity != 0)
-    {
-        updateCapacity(capacity);
-    }
-
-    auto r = m_mru->push_back(std::make_pair(table, key));
-    if (!r.second)
-    {
-        m_mru->relocate(m_mru->end(), r.first);
-    }
+    // fibonacci hashing, the in-shard map consumes the low bits of the same hash
+    return *m_cacheShards[(cacheKey.hash * 11400714819323198485ull) >> (64 - m_shardBits)];
 }
 
 std::tuple<std::shared_ptr<Cache::RWScoped>, Cache::Ptr, bool> CachedStorage::touchCache(
     TableInfo::Ptr tableInfo, const std::string& key, bool write)
 {
-    bool hit = true;
+    CacheKey cacheKey(tableInfo->name, key);
+    auto& cacheShard = shard(cacheKey);
 
-    ++m_queryTimes;
+    ++cacheShard.m_queryTimes;
 
-    auto cache = std::make_shared<Cache>();
-    auto cacheKey = tableInfo->name + "_" + key;
+    Cache::Ptr cache;
 
     bool inserted = false;
     {
-        RWMutexScoped lockCache(m_cachesMutex, false);
+        CacheShard::RWMutexScoped lockCache(cacheShard.m_mutex, false);
 
-        auto result = m_caches.insert(std::make_pair(cacheKey, cache));
+        auto it = cacheShard.m_caches.find(cacheKey);
+        if (it != cacheShard.m_caches.end())
+        {
+            cache = it->second;
+        }
+        else
+        {
+            auto result = cacheShard.m_caches.insert(
+                std::make_pair(std::move(cacheKey), std::make_shared<Cache>()));
 
-        cache = result.first->second;
-        inserted = result.second;
+            cache = result.first->second;
+            inserted = result.second;
+        }
+        // pinned under the shard lock, so it is not evicted before it is locked below
+        cache->pin();
     }
 
     auto cacheLock = std::make_shared<Cache::RWScoped>(*(cache->mutex()), write);
+    cache->unpin();
     if (inserted)
     {
-        hit = false;
-
         cache->setKey(key);
         cache->setTableInfo(tableInfo);
-    }
 
-    if (hit)
+        // only the cache object created here joins the CLOCK ring, a second entry of the same
+        // object would keep it referenced and never evicted
+        if (!disabled())
+        {
+            m_evictionPolicy->onInsert(cache);
+        }
+    }
+    else
     {
-        ++m_hitTimes;
+        ++cacheShard.m_hitTimes;
+        cache->touch();
     }
 
     return std::make_tuple(cacheLock, cache, true);
@@ -694,36 +975,75 @@ void CachedStorage::restoreCache(TableInfo::Ptr table, const std::string& key, C
 {
     /*
      If the checkAndClear() run ahead of commit() at same key, commit() may flush data to the cache
-     object which erased in m_caches, the data will lost, to avoid this, re-insert the data into the
-     m_caches
+     object which erased in the shard, the data will lost, to avoid this, re-insert the data into
+     the shard
      */
 
-    RWMutexScoped lockCache(m_cachesMutex, false);
+    CacheKey cacheKey(table->name, key);
+    auto& cacheShard = shard(cacheKey);
 
-    auto cacheKey = table->name + "_" + key;
-    auto result = m_caches.insert(std::make_pair(cacheKey, cache));
-    if (!result.second && result.first->second != cache)
+    CacheShard::RWMutexScoped lockCache(cacheShard.m_mutex, false);
+
+    auto result = cacheShard.m_caches.insert(std::make_pair(cacheKey, cache));
+    if (result.second && !disabled())
+    {
+        m_evictionPolicy->onInsert(cache);
+    }
+    else if (!result.second && result.first->second != cache)
     {
-        CACHED_STORAGE_LOG(FATAL) << "Restore cache fail! Cache not equal: " << cacheKey << " "
-                                  << result.first->second << " " << cache;
+        CACHED_STORAGE_LOG(FATAL) << "Restore cache fail! Cache not equal: " << table->name << "-"
+                                  << key << " " << result.first->second << " " << cache;
 
         exit(1);
     }
 }
 
-void CachedStorage::removeCache(const std::string& table, const std::string& key)
+bool CachedStorage::evictCache(const Cache::Ptr& cache)
 {
-    auto cacheKey = table + "_" + key;
-    RWMutexScoped lockCache(m_cachesMutex, true);
+    Cache::RWScoped lock;
+    if (!lock.try_acquire(*(cache->mutex()), true))
+    {
+        // in use, give it another chance
+        return false;
+    }
 
-    auto c = m_caches.unsafe_erase(cacheKey);
+    if (cache->num() > m_syncNum)
+    {
+        // not flushed to the backend yet
+        return false;
+    }
 
-    if (c != 1)
+    CacheKey cacheKey(cache->tableInfo()->name, cache->key());
+    auto& cacheShard = shard(cacheKey);
     {
-        CACHED_STORAGE_LOG(FATAL) << "Can not remove cache: " << table << "-" << key;
+        // only this shard is blocked while erasing
+        CacheShard::RWMutexScoped lockCache(cacheShard.m_mutex, true);
 
-        exit(1);
+        auto it = cacheShard.m_caches.find(cacheKey);
+        if (it == cacheShard.m_caches.end() || it->second != cache)
+        {
+            // no longer in the shard, its capacity is not counted any more
+            return true;
+        }
+        // no thread can pin it while the shard is exclusively locked
+        if (cache->pinned())
+        {
+            return false;
+        }
+        cacheShard.m_caches.unsafe_erase(it);
+    }
+
+    int64_t totalCapacity = 0;
+    for (auto entryIt : *(cache->entries()))
+    {
+        totalCapacity += entryIt->capacity();
     }
+    updateCapacity(0 - totalCapacity);
+
+    cache->setEmpty(true);
+    cache->setEntries(std::make_shared<Entries>());
+
+    return true;
 }
 
 bool CachedStorage::disabled()
@@ -771,112 +1091,49 @@ bool CachedStorage::commitBackend(Task::Ptr task)
 
 void CachedStorage::checkAndClear()
 {
-    uint64_t count = 0;
-    while (count < m_maxPopMRU)
+    if (m_syncNum == 0 || m_capacity <= m_maxCapacity)
     {
-        std::tuple<std::string, std::string, ssize_t> mru;
-        auto result = m_mruQueue->try_pop(mru);
-        if (!result)
-        {
-            break;
-        }
-        updateMRU(std::get<0>(mru), std::get<1>(mru), std::get<2>(mru));
-        ++count;
+        return;
     }
 
-    CACHED_STORAGE_LOG(DEBUG) << "CheckAndClear pop: " << count << " elements";
-
     TIME_RECORD("Check and clear");
 
-    bool needClear = false;
-    size_t clearTimes = 0;
-
+    auto start = std::chrono::steady_clock::now();
     auto currentCapacity = m_capacity.load();
 
     size_t clearCount = 0;
-    size_t clearThrough = 0;
-    do
+    while (m_capacity > m_maxCapacity && m_running->load())
     {
-        needClear = false;
-
-        if (m_syncNum > 0)
+        auto cache = m_evictionPolicy->evictOne(
+            [this](const Cache::Ptr& cache) { return evictCache(cache); });
+        if (!cache)
         {
-            if (m_capacity > m_maxCapacity && !m_mru->empty())
-            {
-                needClear = true;
-            }
-        }
-
-        if (needClear)
-        {
-            for (auto it = m_mru->begin(); it != m_mru->end();)
-            {
-                if (m_capacity <= (int64_t)m_maxCapacity || m_mru->empty())
-                {
-                    break;
-                }
-
-                ++clearThrough;
-
-                auto tableInfo = std::make_shared<TableInfo>();
-                tableInfo->name = it->first;
-
-                auto result = touchCache(tableInfo, it->second, true);
-                auto cache = std::get<1>(result);
-
-                if (std::get<2>(result))
-                {
-                    if (m_syncNum > 0 && (cache->num() <= m_syncNum))
-                    {
-                        int64_t totalCapacity = 0;
-                        for (auto entryIt : *(cache->entries()))
-                        {
-                            totalCapacity += entryIt->capacity();
-                        }
-
-                        ++clearCount;
-                        updateCapacity(0 - totalCapacity);
-
-                        cache->setEmpty(true);
-                        removeCache(it->first, it->second);
-                        it = m_mru->erase(it);
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-                else
-                {
-                    ++it;
-                }
-            }
-            ++clearTimes;
+            // the rest is not flushed yet or in use
+            break;
         }
-    } while (needClear);
+        ++clearCount;
+    }
 
-    if (clearThrough > 0)
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start)
+                           .count();
+    m_evictTimes.fetch_and_add(clearCount);
+    m_lastEvictLatency.store(elapsed);
+    if (elapsed > m_maxEvictLatency)
     {
-        CACHED_STORAGE_LOG(INFO) << "Clear finished, total: " << clearCount << " entries, "
-                                 << "through: " << clearThrough << " entries, "
-                                 << readableCapacity(currentCapacity - m_capacity)
-                                 << ", Current total entries: " << m_caches.size()
-                                 << ", Current total mru entries: " << m_mru->size()
-                                 << ", total capacaity: " << readableCapacity(m_capacity);
-
-        CACHED_STORAGE_LOG(DEBUG)
-            << "Cache Status: \n\n"
-            << "\n---------------------------------------------------------------------\n"
-            << "Total query: " << m_queryTimes << "\n"
-            << "Total cache hit: " << m_hitTimes << "\n"
-            << "Total cache miss: " << m_queryTimes - m_hitTimes << "\n"
-            << "Total hit ratio: " << std::setiosflags(std::ios::fixed) << std::setprecision(4)
-            << ((double)m_hitTimes / m_queryTimes) * 100 << "%"
-            << "\n\n"
-            << "Cache capacity: " << readableCapacity(m_capacity) << "\n"
-            << "Cache size: " << m_mru->size()
-            << "\n---------------------------------------------------------------------\n";
+        m_maxEvictLatency.store(elapsed);
     }
+
+    auto cacheStatus = status();
+    CACHED_STORAGE_LOG(INFO) << LOG_DESC("Clear finished") << LOG_KV("evicted", clearCount)
+                             << LOG_KV("released", readableCapacity(currentCapacity - m_capacity))
+                             << LOG_KV("elapsedUs", elapsed)
+                             << LOG_KV("caches", cacheStatus.cacheSize)
+                             << LOG_KV("capacity", readableCapacity(cacheStatus.capacity))
+                             << LOG_KV("query", cacheStatus.queryTimes)
+                             << LOG_KV("hit", cacheStatus.hitTimes) << LOG_KV("hitRatio",
+                                    std::to_string(cacheStatus.hitRatio() * 100) + "%")
+                             << LOG_KV("totalEvicted", cacheStatus.evictTimes);
 }
 
 void CachedStorage::updateCapacity(ssize_t capacity)
@@ -31,10 +31,10 @@
 #include <tbb/recursive_mutex.h>
 #include <tbb/spin_mutex.h>
 #include <tbb/spin_rw_mutex.h>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/identity.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index_container.hpp>
+#include <boost/functional/hash.hpp>
+#include <deque>
+#include <functional>
+#include <unordered_map>
 
 namespace dev
 {
@@ -64,8 +64,27 @@ public:
     virtual bool empty();
     virtual void setEmpty(bool empty);
 
+    // access bit of the eviction policy, set on every touch without any allocation
+    void touch()
+    {
+        if (!m_accessed)
+        {
+            m_accessed = true;
+        }
+    }
+    bool accessed() const { return m_accessed; }
+    void clearAccessed() { m_accessed = false; }
+
+    // held by a thread that took the cache object out of its shard and has not locked it yet,
+    // a pinned cache object is never evicted
+    void pin() { ++m_pinned; }
+    void unpin() { --m_pinned; }
+    bool pinned() const { return m_pinned > 0; }
+
 private:
     RWMutex m_mutex;
+    tbb::atomic<bool> m_accessed;
+    tbb::atomic<uint32_t> m_pinned;
 
     TableInfo::Ptr m_tableInfo;
 
@@ -76,6 +95,129 @@ private:
     tbb::atomic<uint64_t> m_num;
 };
 
+struct CacheKey
+{
+    CacheKey() = default;
+    CacheKey(const std::string& _table, const std::string& _key)
+      : table(_table), key(_key), hash(computeHash(_table, _key))
+    {}
+
+    static size_t computeHash(const std::string& _table, const std::string& _key)
+    {
+        size_t seed = std::hash<std::string>()(_table);
+        boost::hash_combine(seed, std::hash<std::string>()(_key));
+        return seed;
+    }
+
+    bool operator==(const CacheKey& rhs) const
+    {
+        return hash == rhs.hash && key == rhs.key && table == rhs.table;
+    }
+
+    std::string table;
+    std::string key;
+    // precomputed once, used both for shard selection and the in-shard hash map
+    size_t hash = 0;
+};
+
+struct CacheKeyHash
+{
+    size_t operator()(const CacheKey& cacheKey) const { return cacheKey.hash; }
+};
+
+// one independently locked partition of the cache map
+class CacheShard
+{
+public:
+    typedef std::shared_ptr<CacheShard> Ptr;
+    typedef tbb::spin_rw_mutex RWMutex;
+    typedef tbb::spin_rw_mutex::scoped_lock RWMutexScoped;
+
+    CacheShard()
+    {
+        m_hitTimes.store(0);
+        m_queryTimes.store(0);
+    }
+
+    tbb::concurrent_unordered_map<CacheKey, Cache::Ptr, CacheKeyHash> m_caches;
+    // insert and find take the shared lock, erase takes the exclusive lock
+    RWMutex m_mutex;
+
+    tbb::atomic<uint64_t> m_hitTimes;
+    tbb::atomic<uint64_t> m_queryTimes;
+};
+
+class CacheEvictionPolicy
+{
+public:
+    typedef std::shared_ptr<CacheEvictionPolicy> Ptr;
+
+    virtual ~CacheEvictionPolicy(){};
+
+    // called from any thread once a cache object is inserted into its shard
+    virtual void onInsert(Cache::Ptr cache) = 0;
+
+    // called from the clear thread only, offers candidates to tryEvict until one is evicted,
+    // returns nullptr if no cache can be evicted at present
+    virtual Cache::Ptr evictOne(std::function<bool(const Cache::Ptr&)> tryEvict) = 0;
+
+    virtual size_t size() = 0;
+    virtual void clear() = 0;
+};
+
+// CLOCK (second chance) eviction, the hand sweeps over the cache objects and evicts the first one
+// whose access bit is not set, clearing the bits it passes
+class ClockEvictionPolicy : public CacheEvictionPolicy
+{
+public:
+    void onInsert(Cache::Ptr cache) override;
+    Cache::Ptr evictOne(std::function<bool(const Cache::Ptr&)> tryEvict) override;
+    size_t size() override;
+    void clear() override;
+
+private:
+    void drainPending();
+
+    tbb::concurrent_queue<Cache::Ptr> m_pending;
+    std::vector<Cache::Ptr> m_ring;
+    size_t m_hand = 0;
+};
+
+struct CacheStatus
+{
+    uint64_t queryTimes = 0;
+    uint64_t hitTimes = 0;
+    uint64_t evictTimes = 0;
+    // eviction latency of the last clear round and the worst one, in microseconds
+    uint64_t lastEvictLatency = 0;
+    uint64_t maxEvictLatency = 0;
+    int64_t capacity = 0;
+    size_t cacheSize = 0;
+
+    double hitRatio() const { return queryTimes == 0 ? 0 : (double)hitTimes / queryTimes; }
+};
+
+// rows of one pending block that belong to the same cache key
+struct PendingRows
+{
+    std::vector<Entry::Ptr> dirtyEntries;
+    std::vector<Entry::Ptr> newEntries;
+};
+
+// a committed block whose data is not merged into the cache yet, select() reads through it
+class PendingBlock
+{
+public:
+    typedef std::shared_ptr<PendingBlock> Ptr;
+
+    h256 hash;
+    int64_t num = 0;
+    // value of the ID counter once the new entries of this block are numbered
+    uint64_t lastID = 0;
+    std::vector<TableData::Ptr> datas;
+    std::unordered_map<CacheKey, PendingRows, CacheKeyHash> rows;
+};
+
 class Task
 {
 public:
@@ -121,43 +263,55 @@ public:
 
     void setMaxCapacity(int64_t maxCapacity);
     void setMaxForwardBlock(size_t maxForwardBlock);
+    // committed blocks that may wait to be merged into the cache, 0 merges in commit()
+    void setMaxPendingBlock(size_t maxPendingBlock);
 
     size_t ID();
 
     void startClearThread();
 
+    size_t shardNum() const { return m_cacheShards.size(); }
+    size_t cacheSize();
+
+    void setEvictionPolicy(CacheEvictionPolicy::Ptr evictionPolicy);
+    CacheStatus status();
+
+    void checkAndClear();
+
 private:
-    void touchMRU(const std::string& table, const std::string& key, ssize_t capacity);
-    void updateMRU(const std::string& table, const std::string& key, ssize_t capacity);
     std::tuple<std::shared_ptr<Cache::RWScoped>, Cache::Ptr, bool> touchCache(
         TableInfo::Ptr table, const std::string& key, bool write = false);
     void restoreCache(TableInfo::Ptr table, const std::string& key, Cache::Ptr cache);
 
-    void removeCache(const std::string& table, const std::string& key);
+    bool evictCache(const Cache::Ptr& cache);
+
+    void mergePendingBlock(PendingBlock::Ptr pendingBlock);
+    void applyPendingBlock(PendingBlock::Ptr pendingBlock, const CacheKey& cacheKey,
+        std::vector<Entry::Ptr>& entries);
+    Entry::Ptr mergeDirtyEntry(
+        const Entry::Ptr& cacheEntry, const Entry::Ptr& dirtyEntry, int64_t num);
+
+    CacheShard& shard(const CacheKey& cacheKey);
 
     bool disabled();
 
     bool commitBackend(Task::Ptr task);
 
-    void checkAndClear();
-
     void updateCapacity(ssize_t capacity);
     std::string readableCapacity(size_t num);
 
-    tbb::concurrent_unordered_map<std::string, Cache::Ptr> m_caches;
-    RWMutex m_cachesMutex;
+    // power-of-two number of shards, selected by the high bits of CacheKey::hash
+    std::vector<CacheShard::Ptr> m_cacheShards;
+    size_t m_shardBits = 0;
 
     Mutex m_commitMutex;
 
-    std::shared_ptr<boost::multi_index_container<std::pair<std::string, std::string>,
-        boost::multi_index::indexed_by<boost::multi_index::sequenced<>,
-            boost::multi_index::hashed_unique<
-                boost::multi_index::identity<std::pair<std::string, std::string> > > > > >
-        m_mru;
-    std::shared_ptr<tbb::concurrent_queue<std::tuple<std::string, std::string, ssize_t> > >
-        m_mruQueue;
+    // in commit order, the front one is being merged by m_mergeThreadPool
+    std::deque<PendingBlock::Ptr> m_pendingBlocks;
+    RWMutex m_pendingBlocksMutex;
+
+    CacheEvictionPolicy::Ptr m_evictionPolicy;
 
-    // boost::multi_index
     Storage::Ptr m_backend;
     uint64_t m_ID = 1;
 
@@ -167,17 +321,21 @@ private:
 
     // config
     uint64_t m_maxForwardBlock = 10;
+    uint64_t m_maxPendingBlock = 0;
     int64_t m_maxCapacity = 256 * 1024 * 1024;  // default 256MB for cache
-    uint64_t m_maxPopMRU = 100000;
     uint64_t m_clearInterval = 1000;
 
     dev::ThreadPool::Ptr m_taskThreadPool;
+    dev::ThreadPool::Ptr m_mergeThreadPool;
     std::shared_ptr<std::thread> m_clearThread;
 
-    tbb::atomic<uint64_t> m_hitTimes;
-    tbb::atomic<uint64_t> m_queryTimes;
+    tbb::atomic<uint64_t> m_evictTimes;
+    tbb::atomic<uint64_t> m_lastEvictLatency;
+    tbb::atomic<uint64_t> m_maxEvictLatency;
 
     std::shared_ptr<tbb::atomic<bool> > m_running;
+    // set by m_mergeThreadPool when a pending block failed to merge, commit() throws from then on
+    tbb::atomic<bool> m_mergeFailed;
 };
 
 }  // namespace storage
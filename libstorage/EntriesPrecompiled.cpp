@@ -58,7 +58,8 @@ bytes dev::blockverifier::EntriesPrecompiled::call(
         u256 num;
         abi.abiOut(data, num);
 
-        Entry::Ptr entry = getEntries()->get(num.convert_to<size_t>());
+        // the contract may set fields on it, never write through to a shared entry
+        Entry::Ptr entry = getEntries()->get(num.convert_to<size_t>())->clone();
         EntryPrecompiled::Ptr entryPrecompiled = std::make_shared<EntryPrecompiled>();
         entryPrecompiled->setEntry(entry);
         Address address = context->registerPrecompiled(entryPrecompiled);
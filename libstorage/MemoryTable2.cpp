@@ -20,6 +20,7 @@
  */
 #include "MemoryTable2.h"
 #include "Common.h"
+#include "StorageException.h"
 #include "Table.h"
 #include <arpa/inet.h>
 #include <json/json.h>
@@ -32,6 +33,8 @@
 #include <boost/lexical_cast.hpp>
 #include <algorithm>
 #include <csignal>
+#include <map>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -50,6 +53,7 @@ void prepareExit()
 
 Entries::ConstPtr MemoryTable2::select(const std::string& key, Condition::Ptr condition)
 {
+    recordAccess(key, false);
     return selectNoLock(key, condition);
 }
 
@@ -145,6 +149,8 @@ int MemoryTable2::update(
             return storage::CODE_NO_AUTHORIZED;
         }
 
+        recordAccess(key, true);
+
         checkField(entry);
 
         auto entries = selectNoLock(key, condition);
@@ -157,7 +163,10 @@ int MemoryTable2::update(
             // if id not equals to zero and not in the m_dirty, must be new dirty entry
             if (updateEntry->getID() != 0 && m_dirty.find(updateEntry->getID()) == m_dirty.end())
             {
-                m_dirty.insert(std::make_pair(updateEntry->getID(), updateEntry));
+                // entries from the storage are shared read-only views, copy on write
+                auto dirtyEntry = updateEntry->clone();
+                updateEntry =
+                    m_dirty.insert(std::make_pair(dirtyEntry->getID(), dirtyEntry)).first->second;
             }
 
             for (auto& it : *(entry))
@@ -206,6 +215,8 @@ int MemoryTable2::insert(const std::string& key, Entry::Ptr entry, AccessOptions
             return storage::CODE_NO_AUTHORIZED;
         }
 
+        recordAccess(key, true);
+
         checkField(entry);
 
         entry->setField(m_tableInfo->key, key);
@@ -255,6 +266,8 @@ int MemoryTable2::remove(
             return storage::CODE_NO_AUTHORIZED;
         }
 
+        recordAccess(key, true);
+
         auto entries = selectNoLock(key, condition);
 
         std::vector<Change::Record> records;
@@ -262,14 +275,17 @@ int MemoryTable2::remove(
         {
             Entry::Ptr removeEntry = entries->get(i);
 
-            removeEntry->setStatus(1);
-
             // if id not equals to zero and not in the m_dirty, must be new dirty entry
             if (removeEntry->getID() != 0 && m_dirty.find(removeEntry->getID()) == m_dirty.end())
             {
-                m_dirty.insert(std::make_pair(removeEntry->getID(), removeEntry));
+                // entries from the storage are shared read-only views, copy on write
+                auto dirtyEntry = removeEntry->clone();
+                removeEntry =
+                    m_dirty.insert(std::make_pair(dirtyEntry->getID(), dirtyEntry)).first->second;
             }
 
+            removeEntry->setStatus(1);
+
             records.emplace_back(removeEntry->getTempIndex(), "", "", removeEntry->getID());
         }
 
@@ -376,6 +392,72 @@ dev::storage::TableData::Ptr MemoryTable2::dump()
     return m_tableData;
 }
 
+void MemoryTable2::importDiff(Entries::Ptr _dirtyEntries, Entries::Ptr _newEntries, bool _dirty)
+{
+    // the tables opened without being written have no entries
+    if (!_dirty && (_dirtyEntries->size() > 0 || _newEntries->size() > 0))
+    {
+        BOOST_THROW_EXCEPTION(StorageException(
+            -1, "invalid state diff: entries of the unwritten table " + m_tableInfo->name));
+    }
+    auto checkFields = [&](Entry::Ptr const& _entry) {
+        for (auto const& field : *_entry)
+        {
+            if (m_tableInfo->fields.end() ==
+                find(m_tableInfo->fields.begin(), m_tableInfo->fields.end(), field.first))
+            {
+                BOOST_THROW_EXCEPTION(StorageException(-1, "invalid state diff: field " +
+                                                               field.first + " of " +
+                                                               m_tableInfo->name));
+            }
+        }
+    };
+    // the commit updates the row of the id of a dirty entry, so the id must be the one of a local
+    // row under the same key
+    std::map<std::string, std::set<uint64_t>> rowIDs;
+    for (auto const& entry : *_dirtyEntries)
+    {
+        checkFields(entry);
+        auto key = entry->getField(m_tableInfo->key);
+        auto it = rowIDs.find(key);
+        if (it == rowIDs.end())
+        {
+            it = rowIDs.insert(std::make_pair(key, std::set<uint64_t>())).first;
+            auto condition = std::make_shared<Condition>();
+            condition->EQ(m_tableInfo->key, key);
+            if (m_remoteDB)
+            {
+                auto rows =
+                    m_remoteDB->select(m_blockHash, m_blockNum, m_tableInfo, key, condition);
+                for (size_t i = 0; rows && i < rows->size(); ++i)
+                {
+                    it->second.insert(rows->get(i)->getID());
+                }
+            }
+        }
+        auto id = entry->getID();
+        if (id == 0 || !it->second.count(id) || m_dirty.count(id))
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid state diff: dirty entry " +
+                                                           boost::lexical_cast<std::string>(id) +
+                                                           " of " + m_tableInfo->name));
+        }
+        m_dirty[id] = entry;
+    }
+    for (auto const& entry : *_newEntries)
+    {
+        checkFields(entry);
+        auto key = entry->getField(m_tableInfo->key);
+        auto it = m_newEntries.find(key);
+        if (it == m_newEntries.end())
+        {
+            it = m_newEntries.insert(std::make_pair(key, std::make_shared<Entries>())).first;
+        }
+        it->second->addEntry(entry);
+    }
+    m_isDirty = _dirty;
+}
+
 void MemoryTable2::rollback(const Change& _change)
 {
 #if 0
@@ -31,6 +31,7 @@
 #include <tbb/concurrent_unordered_map.h>
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 #include <type_traits>
 
 namespace dev
@@ -44,6 +45,20 @@ public:
 
     virtual ~MemoryTable2(){};
 
+    Entry::Ptr newEntry() override
+    {
+        auto entry = std::make_shared<Entry>();
+        if (m_tableInfo)
+        {
+            // _id_, _num_ and _status_ are kept as integers, not as fields
+            entry->reserve(std::count_if(m_tableInfo->fields.begin(), m_tableInfo->fields.end(),
+                [](const std::string& field) {
+                    return field != ID_FIELD && field != NUM_FIELD && field != STATUS;
+                }));
+        }
+        return entry;
+    }
+
     Entries::ConstPtr select(const std::string& key, Condition::Ptr condition) override;
 
     int update(const std::string& key, Entry::Ptr entry, Condition::Ptr condition,
@@ -87,11 +102,31 @@ public:
 
     dev::storage::TableData::Ptr dump() override;
 
+    /// fill the table with the entries dumped by another node instead of executing the block,
+    /// _dirty marks the table written so its hash is calculated from the entries
+    void importDiff(Entries::Ptr _dirtyEntries, Entries::Ptr _newEntries, bool _dirty);
+
     void rollback(const Change& _change) override;
 
 private:
     Entries::Ptr selectNoLock(const std::string& key, Condition::Ptr condition);
 
+    void recordAccess(const std::string& key, bool write)
+    {
+        auto accessSet = TableAccessSet::current();
+        if (accessSet)
+        {
+            if (write)
+            {
+                accessSet->addWrite(m_tableInfo->name, key);
+            }
+            else
+            {
+                accessSet->addRead(m_tableInfo->name, key);
+            }
+        }
+    }
+
     tbb::concurrent_unordered_map<std::string, Entries::Ptr> m_newEntries;
     tbb::concurrent_unordered_map<uint64_t, Entry::Ptr> m_dirty;
 
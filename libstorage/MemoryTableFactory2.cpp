@@ -33,6 +33,7 @@
 #include <tbb/parallel_sort.h>
 #include <boost/algorithm/string.hpp>
 #include <memory>
+#include <set>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -61,43 +62,27 @@ Table::Ptr MemoryTableFactory2::openTable(
 {
     (void)isPara;
 
+    // whether a user table exists depends on _sys_tables_, even if it has been opened already
+    auto accessSet = TableAccessSet::current();
+    if (accessSet && m_sysTables.end() == find(m_sysTables.begin(), m_sysTables.end(), tableName))
+    {
+        accessSet->addRead(SYS_TABLES, tableName);
+    }
+
     RecursiveGuard l(x_name2Table);
     auto it = m_name2Table.find(tableName);
     if (it != m_name2Table.end())
     {
         return it->second;
     }
-    auto tableInfo = std::make_shared<storage::TableInfo>();
-
-    if (m_sysTables.end() != find(m_sysTables.begin(), m_sysTables.end(), tableName))
+    bool isSysTable = m_sysTables.end() != find(m_sysTables.begin(), m_sysTables.end(), tableName);
+    auto tableInfo = loadTableInfo(tableName, isSysTable ? nullptr : openTable(SYS_TABLES));
+    if (!tableInfo)
     {
-        tableInfo = getSysTableInfo(tableName);
-    }
-    else
-    {
-        auto tempSysTable = openTable(SYS_TABLES);
-        auto tableEntries = tempSysTable->select(tableName, tempSysTable->newCondition());
-        if (tableEntries->size() == 0u)
-        {
-            return nullptr;
-        }
-        auto entry = tableEntries->get(0);
-        tableInfo->name = tableName;
-        tableInfo->key = entry->getField("key_field");
-        std::string valueFields = entry->getField("value_field");
-        boost::split(tableInfo->fields, valueFields, boost::is_any_of(","));
+        return nullptr;
     }
-    tableInfo->fields.emplace_back(STATUS);
-    tableInfo->fields.emplace_back(tableInfo->key);
-    tableInfo->fields.emplace_back(NUM_FIELD);
-    tableInfo->fields.emplace_back(ID_FIELD);
 
-    Table::Ptr memoryTable = std::make_shared<MemoryTable2>();
-
-    memoryTable->setStateStorage(m_stateStorage);
-    memoryTable->setBlockHash(m_blockHash);
-    memoryTable->setBlockNum(m_blockNum);
-    memoryTable->setTableInfo(tableInfo);
+    Table::Ptr memoryTable = newTable(tableInfo);
 
     // authority flag
     if (authorityFlag)
@@ -122,13 +107,53 @@ Table::Ptr MemoryTableFactory2::openTable(
     }
 
     memoryTable->setTableInfo(tableInfo);
+
+    m_name2Table.insert({tableName, memoryTable});
+    return memoryTable;
+}
+
+storage::TableInfo::Ptr MemoryTableFactory2::loadTableInfo(
+    const std::string& _tableName, Table::Ptr _sysTable)
+{
+    auto tableInfo = std::make_shared<storage::TableInfo>();
+
+    if (m_sysTables.end() != find(m_sysTables.begin(), m_sysTables.end(), _tableName))
+    {
+        tableInfo = getSysTableInfo(_tableName);
+    }
+    else
+    {
+        auto tableEntries = _sysTable->select(_tableName, _sysTable->newCondition());
+        if (tableEntries->size() == 0u)
+        {
+            return nullptr;
+        }
+        auto entry = tableEntries->get(0);
+        tableInfo->name = _tableName;
+        tableInfo->key = entry->getField("key_field");
+        std::string valueFields = entry->getField("value_field");
+        boost::split(tableInfo->fields, valueFields, boost::is_any_of(","));
+    }
+    tableInfo->fields.emplace_back(STATUS);
+    tableInfo->fields.emplace_back(tableInfo->key);
+    tableInfo->fields.emplace_back(NUM_FIELD);
+    tableInfo->fields.emplace_back(ID_FIELD);
+    return tableInfo;
+}
+
+std::shared_ptr<MemoryTable2> MemoryTableFactory2::newTable(storage::TableInfo::Ptr _tableInfo)
+{
+    auto memoryTable = std::make_shared<MemoryTable2>();
+
+    memoryTable->setStateStorage(m_stateStorage);
+    memoryTable->setBlockHash(m_blockHash);
+    memoryTable->setBlockNum(m_blockNum);
+    memoryTable->setTableInfo(_tableInfo);
     memoryTable->setRecorder([&](Table::Ptr _table, Change::Kind _kind, std::string const& _key,
                                  std::vector<Change::Record>& _records) {
         auto& changeLog = getChangeLog();
         changeLog.emplace_back(_table, _kind, _key, _records);
     });
-
-    m_name2Table.insert({tableName, memoryTable});
     return memoryTable;
 }
 
@@ -227,6 +252,71 @@ h256 MemoryTableFactory2::hash()
     return m_hash;
 }
 
+StateDiff::Ptr MemoryTableFactory2::exportStateDiff()
+{
+    auto diff = std::make_shared<StateDiff>();
+    RecursiveGuard l(x_name2Table);
+    for (auto const& it : m_name2Table)
+    {
+        StateDiff::TableDiff table;
+        table.info = it.second->tableInfo();
+        // the tables opened without being written hash to zero
+        table.dirty = it.second->hash() != h256();
+        auto tableData = table.dirty ? it.second->dump() : nullptr;
+        if (tableData)
+        {
+            table.dirtyEntries = tableData->dirtyEntries;
+            table.newEntries = tableData->newEntries;
+        }
+        diff->tables.push_back(table);
+    }
+    return diff;
+}
+
+void MemoryTableFactory2::importStateDiff(StateDiff const& _diff)
+{
+    RecursiveGuard l(x_name2Table);
+    // the schema of a table is never taken from the diff, _sys_tables_ is imported first so that
+    // the tables created by the block are resolved from its new rows
+    std::vector<StateDiff::TableDiff const*> tables;
+    for (auto const& table : _diff.tables)
+    {
+        if (table.info->name == SYS_TABLES)
+        {
+            tables.insert(tables.begin(), &table);
+        }
+        else
+        {
+            tables.push_back(&table);
+        }
+    }
+    std::set<std::string> imported;
+    for (auto table : tables)
+    {
+        auto const& tableName = table->info->name;
+        if (!imported.insert(tableName).second)
+        {
+            BOOST_THROW_EXCEPTION(
+                StorageException(-1, "invalid state diff: duplicated table " + tableName));
+        }
+        Table::Ptr sysTable;
+        if (m_sysTables.end() == find(m_sysTables.begin(), m_sysTables.end(), tableName))
+        {
+            auto it = m_name2Table.find(SYS_TABLES);
+            sysTable = it != m_name2Table.end() ? it->second : newTable(loadTableInfo(SYS_TABLES));
+        }
+        auto tableInfo = loadTableInfo(tableName, sysTable);
+        if (!tableInfo)
+        {
+            BOOST_THROW_EXCEPTION(
+                StorageException(-1, "invalid state diff: unknown table " + tableName));
+        }
+        auto memoryTable = newTable(tableInfo);
+        memoryTable->importDiff(table->dirtyEntries, table->newEntries, table->dirty);
+        m_name2Table[tableName] = memoryTable;
+    }
+}
+
 std::vector<Change>& MemoryTableFactory2::getChangeLog()
 {
     return s_changeLog.local();
@@ -22,6 +22,7 @@
 
 #include "Common.h"
 #include "MemoryTable.h"
+#include "StateDiff.h"
 #include "Storage.h"
 #include "Table.h"
 #include "TablePrecompiled.h"
@@ -40,6 +41,8 @@ class ExecutiveContext;
 }
 namespace storage
 {
+class MemoryTable2;
+
 class MemoryTableFactory2 : public TableFactory
 {
 public:
@@ -64,7 +67,19 @@ public:
     virtual void rollback(size_t _savepoint) override;
     virtual void commitDB(h256 const& _blockHash, int64_t _blockNumber) override;
 
+    /// the opened tables with the entries to commit, called after hash()
+    StateDiff::Ptr exportStateDiff();
+    /// open the tables of the diff instead of executing the block, hash() and commitDB() work
+    /// on them as if the block were executed. The schemas are the local ones, throw
+    /// StorageException if the diff does not fit them
+    void importStateDiff(StateDiff const& _diff);
+
 private:
+    std::shared_ptr<MemoryTable2> newTable(storage::TableInfo::Ptr _tableInfo);
+    /// the schema with the system fields, from the rows of _sysTable for the user tables,
+    /// nullptr if the table does not exist
+    storage::TableInfo::Ptr loadTableInfo(
+        const std::string& _tableName, Table::Ptr _sysTable = nullptr);
     storage::TableInfo::Ptr getSysTableInfo(const std::string& tableName);
     void setAuthorizedAddress(storage::TableInfo::Ptr _tableInfo);
     std::vector<Change>& getChangeLog();
@@ -0,0 +1,512 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : export all the keys of RocksDB at the head block into a snapshot file and bulk load
+ * the file into an empty RocksDB of another node
+ * @file: RocksDBSnapshot.cpp
+ */
+#include "RocksDBSnapshot.h"
+#include "Common.h"
+#include "RowCodec.h"
+#include "StorageException.h"
+#include <libdevcore/RLP.h>
+#include <libdevcore/SnappyCompress.h>
+#include <libdevcrypto/Hash.h>
+#include <libethcore/Block.h>
+#include <rocksdb/sst_file_writer.h>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <map>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::eth;
+using namespace dev::storage;
+
+namespace
+{
+const char c_magic[] = {'F', 'B', 'S', 'N', 'A', 'P', 0, 1};
+const unsigned c_manifestVersion = 1;
+/// bounds the memory taken by a corrupted chunk header
+const uint64_t c_maxChunkSize = 1024 * 1024 * 1024;
+
+inline bytesConstRef toRef(string const& _data)
+{
+    return bytesConstRef((byte const*)_data.data(), _data.size());
+}
+
+inline void putVarint(string& _out, uint64_t _value)
+{
+    while (_value >= 0x80)
+    {
+        _out.push_back((char)(_value | 0x80));
+        _value >>= 7;
+    }
+    _out.push_back((char)_value);
+}
+
+inline void putString(string& _out, rocksdb::Slice const& _value)
+{
+    putVarint(_out, _value.size());
+    _out.append(_value.data(), _value.size());
+}
+
+void readBytes(istream& _in, char* _out, size_t _size)
+{
+    if (!_in.read(_out, _size))
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: truncated"));
+    }
+}
+
+uint64_t readVarint(istream& _in)
+{
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        char c;
+        readBytes(_in, &c, 1);
+        value |= (uint64_t)((uint8_t)c & 0x7f) << shift;
+        if (!((uint8_t)c & 0x80))
+        {
+            return value;
+        }
+    }
+    BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: varint overflow"));
+}
+
+/// reads the keys and the values of a raw chunk
+class ChunkReader
+{
+public:
+    ChunkReader(bytes const& _data) : m_data(_data) {}
+
+    bool end() const { return m_offset == m_data.size(); }
+
+    void readString(string& _out)
+    {
+        uint64_t size = 0;
+        for (unsigned shift = 0;; shift += 7)
+        {
+            if (shift >= 64 || end())
+            {
+                BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: chunk"));
+            }
+            uint8_t b = m_data[m_offset++];
+            size |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                break;
+            }
+        }
+        if (m_data.size() - m_offset < size)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: chunk"));
+        }
+        _out.assign((char const*)m_data.data() + m_offset, size);
+        m_offset += size;
+    }
+
+private:
+    bytes const& m_data;
+    size_t m_offset = 0;
+};
+
+void checkStatus(rocksdb::Status const& _status, string const& _what)
+{
+    if (!_status.ok())
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, _what + ": " + _status.ToString()));
+    }
+}
+
+/// the value of an encoded row of a system table
+string sysValue(string const& _row)
+{
+    if (_row.empty())
+    {
+        return "";
+    }
+    auto entries = RowCodec::decode(_row);
+    if (entries.empty())
+    {
+        return "";
+    }
+    return entries.front()->getField(SYS_VALUE);
+}
+
+/// the SYS_VALUE of the row stored under _key of _table, empty if not found
+string getSysValue(shared_ptr<BasicRocksDB> _basicDB, rocksdb::ReadOptions const& _options,
+    string const& _table, string const& _key)
+{
+    string value;
+    auto status = _basicDB->Get(_options, _table + "_" + _key, value);
+    if (status.IsNotFound())
+    {
+        return "";
+    }
+    return sysValue(value);
+}
+
+/// the header of the hex encoded head block, which must be the block of _number and _hash
+BlockHeader headHeader(string const& _block, int64_t _number, h256 const& _hash)
+{
+    Block headBlock(fromHex(_block), CheckTransaction::None);
+    auto const& header = headBlock.blockHeader();
+    if (header.hash() != _hash || header.number() != _number)
+    {
+        BOOST_THROW_EXCEPTION(
+            StorageException(-1, "the head block " + to_string(_number) + " mismatches its hash"));
+    }
+    return header;
+}
+}  // namespace
+
+RocksDBSnapshot::Manifest RocksDBSnapshot::readHead(
+    shared_ptr<BasicRocksDB> _basicDB, rocksdb::ReadOptions const& _options)
+{
+    Manifest head;
+    auto number = getSysValue(_basicDB, _options, SYS_CURRENT_STATE, SYS_KEY_CURRENT_NUMBER);
+    if (number.empty())
+    {
+        return head;
+    }
+    head.number = boost::lexical_cast<int64_t>(number);
+    auto hash = getSysValue(_basicDB, _options, SYS_NUMBER_2_HASH, number);
+    auto block = hash.empty() ? "" : getSysValue(_basicDB, _options, SYS_HASH_2_BLOCK, hash);
+    if (block.empty())
+    {
+        BOOST_THROW_EXCEPTION(
+            StorageException(-1, "the head block " + number + " not found in RocksDB"));
+    }
+    head.blockHash = h256(hash);
+    auto header = headHeader(block, head.number, head.blockHash);
+    head.stateRoot = header.stateRoot();
+    head.dbHash = header.dbHash();
+    return head;
+}
+
+RocksDBSnapshot::Manifest RocksDBSnapshot::exportSnapshot(shared_ptr<BasicRocksDB> _basicDB,
+    shared_ptr<rocksdb::DB> _db, ostream& _out, size_t _chunkSize)
+{
+    /// the head and the keys are read from the same view of RocksDB
+    shared_ptr<rocksdb::Snapshot const> snapshot(
+        _db->GetSnapshot(), [_db](rocksdb::Snapshot const* _s) { _db->ReleaseSnapshot(_s); });
+    rocksdb::ReadOptions options;
+    options.snapshot = snapshot.get();
+    options.fill_cache = false;
+
+    auto manifest = readHead(_basicDB, options);
+    if (manifest.number < 0)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "no block in RocksDB"));
+    }
+    _out.write(c_magic, sizeof(c_magic));
+
+    string raw;
+    bytes compressed;
+    bytes hashes;
+    auto writeChunk = [&]() {
+        if (raw.empty())
+        {
+            return;
+        }
+        compress::SnappyCompress::compress(toRef(raw), compressed);
+        auto hash = sha256(ref(compressed));
+        string header;
+        putVarint(header, raw.size());
+        putVarint(header, compressed.size());
+        _out.write(header.data(), header.size());
+        _out.write((char const*)hash.data(), h256::size);
+        _out.write((char const*)compressed.data(), compressed.size());
+        hashes += hash.asBytes();
+        ++manifest.chunks;
+        raw.clear();
+    };
+
+    unique_ptr<rocksdb::Iterator> it(_db->NewIterator(options));
+    for (it->SeekToFirst(); it->Valid(); it->Next())
+    {
+        putString(raw, it->key());
+        putString(raw, it->value());
+        ++manifest.keys;
+        if (raw.size() >= _chunkSize)
+        {
+            writeChunk();
+        }
+    }
+    checkStatus(it->status(), "iterate RocksDB failed");
+    writeChunk();
+    /// the empty chunk ends the chunks
+    _out.write("\0\0", 2);
+
+    manifest.digest = sha256(ref(hashes));
+    writeManifest(_out, manifest);
+    if (!_out)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "write the snapshot failed"));
+    }
+    return manifest;
+}
+
+void RocksDBSnapshot::writeManifest(ostream& _out, Manifest const& _manifest)
+{
+    RLPStream s(8);
+    s << c_manifestVersion << u256(_manifest.number) << _manifest.blockHash << _manifest.stateRoot
+      << _manifest.dbHash << u256(_manifest.keys) << u256(_manifest.chunks) << _manifest.digest;
+    auto const& out = s.out();
+    _out.write((char const*)out.data(), out.size());
+    char size[8];
+    for (size_t i = 0; i < sizeof(size); ++i)
+    {
+        size[i] = (char)(out.size() >> (8 * i));
+    }
+    _out.write(size, sizeof(size));
+}
+
+RocksDBSnapshot::Manifest RocksDBSnapshot::readManifest(istream& _in)
+{
+    char magic[sizeof(c_magic)];
+    _in.seekg(0, ios::end);
+    auto fileSize = (uint64_t)_in.tellg();
+    _in.seekg(0, ios::beg);
+    readBytes(_in, magic, sizeof(magic));
+    if (memcmp(magic, c_magic, sizeof(magic)) != 0 || fileSize < sizeof(magic) + 10)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: not a snapshot file"));
+    }
+
+    unsigned char size[8];
+    _in.seekg(fileSize - sizeof(size));
+    readBytes(_in, (char*)size, sizeof(size));
+    uint64_t manifestSize = 0;
+    for (size_t i = 0; i < sizeof(size); ++i)
+    {
+        manifestSize |= (uint64_t)size[i] << (8 * i);
+    }
+    if (manifestSize > fileSize - sizeof(magic) - sizeof(size) - 2)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: manifest"));
+    }
+    bytes data(manifestSize);
+    _in.seekg(fileSize - sizeof(size) - manifestSize);
+    readBytes(_in, (char*)data.data(), data.size());
+    /// the chunks are read next
+    _in.seekg(sizeof(magic));
+
+    Manifest manifest;
+    try
+    {
+        RLP rlp(data);
+        if (rlp.itemCount() != 8 || rlp[0].toInt<unsigned>() != c_manifestVersion)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: manifest version"));
+        }
+        manifest.number = (int64_t)rlp[1].toInt<u256>();
+        manifest.blockHash = rlp[2].toHash<h256>(RLP::VeryStrict);
+        manifest.stateRoot = rlp[3].toHash<h256>(RLP::VeryStrict);
+        manifest.dbHash = rlp[4].toHash<h256>(RLP::VeryStrict);
+        manifest.keys = (uint64_t)rlp[5].toInt<u256>();
+        manifest.chunks = (uint64_t)rlp[6].toInt<u256>();
+        manifest.digest = rlp[7].toHash<h256>(RLP::VeryStrict);
+    }
+    catch (StorageException const&)
+    {
+        throw;
+    }
+    catch (std::exception const& e)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, string("invalid snapshot: ") + e.what()));
+    }
+    return manifest;
+}
+
+void RocksDBSnapshot::readChunks(istream& _in, Manifest const& _manifest,
+    function<void(string const&, string const&)> const& _onKey)
+{
+    uint64_t keys = 0;
+    uint64_t chunks = 0;
+    bytes hashes;
+    bytes compressed;
+    bytes raw;
+    string key;
+    string value;
+    while (true)
+    {
+        auto rawSize = readVarint(_in);
+        auto compressedSize = readVarint(_in);
+        if (rawSize == 0 && compressedSize == 0)
+        {
+            break;
+        }
+        if (rawSize > c_maxChunkSize || compressedSize > c_maxChunkSize)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: chunk size"));
+        }
+        h256 hash;
+        readBytes(_in, (char*)hash.data(), h256::size);
+        compressed.resize(compressedSize);
+        readBytes(_in, (char*)compressed.data(), compressed.size());
+        if (sha256(ref(compressed)) != hash)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(
+                -1, "invalid snapshot: hash of chunk " + to_string(chunks) + " mismatches"));
+        }
+        if (compress::SnappyCompress::uncompress(ref(compressed), raw) != rawSize)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: uncompress failed"));
+        }
+        hashes += hash.asBytes();
+        ++chunks;
+
+        ChunkReader reader(raw);
+        while (!reader.end())
+        {
+            reader.readString(key);
+            reader.readString(value);
+            _onKey(key, value);
+            ++keys;
+        }
+    }
+    if (chunks != _manifest.chunks || keys != _manifest.keys ||
+        sha256(ref(hashes)) != _manifest.digest)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "invalid snapshot: chunks mismatch manifest"));
+    }
+}
+
+void RocksDBSnapshot::checkTrusted(
+    Manifest const& _manifest, h256 const& _trustedHash, int64_t _trustedNumber)
+{
+    if ((_trustedHash != h256() && _manifest.blockHash != _trustedHash) ||
+        (_trustedNumber >= 0 && _manifest.number != _trustedNumber))
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "the head block " +
+                                                       to_string(_manifest.number) +
+                                                       " mismatches the trusted block"));
+    }
+}
+
+RocksDBSnapshot::Manifest RocksDBSnapshot::verifySnapshot(
+    istream& _in, h256 const& _trustedHash, int64_t _trustedNumber)
+{
+    auto manifest = readManifest(_in);
+    checkTrusted(manifest, _trustedHash, _trustedNumber);
+    readChunks(_in, manifest, [](string const&, string const&) {});
+    return manifest;
+}
+
+RocksDBSnapshot::Manifest RocksDBSnapshot::importSnapshot(istream& _in,
+    shared_ptr<rocksdb::DB> _db, string const& _sstDir, size_t _sstSize, h256 const& _trustedHash,
+    int64_t _trustedNumber)
+{
+    if (_trustedHash == h256())
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "the trusted hash of the head block is needed"));
+    }
+    auto manifest = readManifest(_in);
+    checkTrusted(manifest, _trustedHash, _trustedNumber);
+    {
+        unique_ptr<rocksdb::Iterator> it(_db->NewIterator(rocksdb::ReadOptions()));
+        it->SeekToFirst();
+        if (it->Valid())
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "the RocksDB to import is not empty"));
+        }
+    }
+
+    boost::filesystem::create_directories(_sstDir);
+    vector<string> files;
+    auto removeFiles = [&]() {
+        for (auto const& file : files)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove(file, ec);
+        }
+        boost::system::error_code ec;
+        /// only removed if empty
+        boost::filesystem::remove(_sstDir, ec);
+    };
+    try
+    {
+        /// the keys are sorted, every SST file takes the keys following the previous one
+        unique_ptr<rocksdb::SstFileWriter> writer;
+        auto finishFile = [&]() {
+            if (writer)
+            {
+                checkStatus(writer->Finish(), "finish SST file failed");
+                writer.reset();
+            }
+        };
+        /// the rows of the head block are checked against the manifest before any file is
+        /// ingested, the keys are compared only since the tables are not known to RocksDB
+        auto number = to_string(manifest.number);
+        auto numberKey = SYS_CURRENT_STATE + "_" + SYS_KEY_CURRENT_NUMBER;
+        auto hashKey = SYS_NUMBER_2_HASH + "_" + number;
+        auto blockKey = SYS_HASH_2_BLOCK + "_" + manifest.blockHash.hex();
+        map<string, string> headRows;
+        auto options = _db->GetOptions();
+        readChunks(_in, manifest, [&](string const& _key, string const& _value) {
+            if (_key == numberKey || _key == hashKey || _key == blockKey)
+            {
+                headRows[_key] = sysValue(_value);
+            }
+            if (!writer)
+            {
+                auto file = boost::filesystem::path(_sstDir) / (to_string(files.size()) + ".sst");
+                writer.reset(new rocksdb::SstFileWriter(rocksdb::EnvOptions(), options));
+                checkStatus(writer->Open(file.string()), "open SST file failed");
+                files.push_back(file.string());
+            }
+            checkStatus(writer->Put(_key, _value), "write SST file failed");
+            if (writer->FileSize() >= _sstSize)
+            {
+                finishFile();
+            }
+        });
+        finishFile();
+
+        if (headRows[numberKey] != number || headRows[hashKey].empty() ||
+            h256(headRows[hashKey]) != manifest.blockHash || headRows[blockKey].empty())
+        {
+            BOOST_THROW_EXCEPTION(
+                StorageException(-1, "the head block " + number + " mismatches the manifest"));
+        }
+        auto header = headHeader(headRows[blockKey], manifest.number, manifest.blockHash);
+        if (header.stateRoot() != manifest.stateRoot || header.dbHash() != manifest.dbHash)
+        {
+            BOOST_THROW_EXCEPTION(
+                StorageException(-1, "the head block " + number + " mismatches the manifest"));
+        }
+
+        rocksdb::IngestExternalFileOptions ingestOptions;
+        ingestOptions.move_files = true;
+        if (!files.empty())
+        {
+            checkStatus(_db->IngestExternalFile(files, ingestOptions), "ingest SST files failed");
+        }
+    }
+    catch (...)
+    {
+        removeFiles();
+        throw;
+    }
+    removeFiles();
+    return manifest;
+}
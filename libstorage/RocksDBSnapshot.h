@@ -0,0 +1,96 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : export all the keys of RocksDB at the head block into a snapshot file and bulk load
+ * the file into an empty RocksDB of another node
+ * @file: RocksDBSnapshot.h
+ */
+#pragma once
+
+#include "BasicRocksDB.h"
+#include <libdevcore/FixedHash.h>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace dev
+{
+namespace storage
+{
+/**
+ * @brief: the snapshot file is
+ *   magic, chunk..., empty chunk, manifest, size of the manifest in 8 bytes
+ * and every chunk is
+ *   varint raw size, varint compressed size, sha256 of the compressed data, compressed data
+ * where the raw data is the sorted keys with their raw values, both prefixed by a varint size.
+ * The values are copied without being decoded, the snapshot of a disk encrypted node can only
+ * be loaded by the nodes sharing its data key.
+ */
+class RocksDBSnapshot
+{
+public:
+    /// anchored to the header of the head block, the node loading the snapshot syncs from the
+    /// next block
+    struct Manifest
+    {
+        int64_t number = -1;
+        h256 blockHash;
+        h256 stateRoot;
+        h256 dbHash;
+        uint64_t keys = 0;
+        uint64_t chunks = 0;
+        /// sha256 of the hashes of all the chunks
+        h256 digest;
+    };
+
+    /// export every key of _db at its head block, a chunk holds _chunkSize bytes of raw data at
+    /// most except a single key larger than it, throw StorageException on failure
+    static Manifest exportSnapshot(std::shared_ptr<dev::db::BasicRocksDB> _basicDB,
+        std::shared_ptr<rocksdb::DB> _db, std::ostream& _out, size_t _chunkSize);
+
+    /// verify every chunk of the snapshot and its head block against the manifest, then ingest
+    /// it into the empty _db through SST files of _sstSize bytes written in _sstDir, throw
+    /// StorageException on failure. The snapshot only proves that it is consistent with itself,
+    /// so the head block must be _trustedHash (and _trustedNumber if not -1) taken from a node
+    /// of the group
+    static Manifest importSnapshot(std::istream& _in, std::shared_ptr<rocksdb::DB> _db,
+        std::string const& _sstDir, size_t _sstSize, h256 const& _trustedHash,
+        int64_t _trustedNumber = -1);
+
+    /// read and verify the whole snapshot without loading it, the head block is checked against
+    /// _trustedHash and _trustedNumber if set
+    static Manifest verifySnapshot(
+        std::istream& _in, h256 const& _trustedHash = h256(), int64_t _trustedNumber = -1);
+
+    static Manifest readManifest(std::istream& _in);
+
+    /// the head block of _db read with _options, number is -1 if there is no block
+    static Manifest readHead(
+        std::shared_ptr<dev::db::BasicRocksDB> _basicDB, rocksdb::ReadOptions const& _options);
+
+private:
+    static void writeManifest(std::ostream& _out, Manifest const& _manifest);
+    static void checkTrusted(
+        Manifest const& _manifest, h256 const& _trustedHash, int64_t _trustedNumber);
+    /// read the chunks following the magic and call _onKey with every key and its value
+    static void readChunks(std::istream& _in, Manifest const& _manifest,
+        std::function<void(std::string const&, std::string const&)> const& _onKey);
+};
+
+}  // namespace storage
+}  // namespace dev
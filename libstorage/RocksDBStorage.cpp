@@ -21,13 +21,9 @@
 
 #include "RocksDBStorage.h"
 #include "BasicRocksDB.h"
+#include "RowCodec.h"
 #include "StorageException.h"
 #include "Table.h"
-#include "boost/archive/binary_iarchive.hpp"
-#include "boost/archive/binary_oarchive.hpp"
-#include "boost/serialization/map.hpp"
-#include "boost/serialization/serialization.hpp"
-#include "boost/serialization/vector.hpp"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
@@ -67,23 +63,8 @@ Entries::Ptr RocksDBStorage::select(
         Entries::Ptr entries = make_shared<Entries>();
         if (!s.IsNotFound())
         {
-            vector<map<string, string>> res;
-            stringstream ss(value);
-            boost::archive::binary_iarchive ia(ss);
-            ia >> res;
-
-            for (auto it = res.begin(); it != res.end(); ++it)
+            for (auto const& entry : RowCodec::decode(value))
             {
-                Entry::Ptr entry = make_shared<Entry>();
-
-                for (auto valueIt = it->begin(); valueIt != it->end(); ++valueIt)
-                {
-                    entry->setField(valueIt->first, valueIt->second);
-                }
-                entry->setID(it->at(ID_FIELD));
-                entry->setNum(it->at(NUM_FIELD));
-                entry->setStatus(it->at(STATUS));
-
                 if (entry->getStatus() == Entry::Status::NORMAL && condition->process(entry))
                 {
                     entry->setDirty(false);
@@ -110,46 +91,76 @@ Entries::Ptr RocksDBStorage::select(
     return Entries::Ptr();
 }
 
-size_t RocksDBStorage::commit(h256 hash, int64_t num, const vector<TableData::Ptr>& datas)
+size_t RocksDBStorage::commit(h256, int64_t num, const vector<TableData::Ptr>& datas)
 {
     try
     {
         auto start_time = utcTime();
 
-        auto hex = hash.hex();
-        WriteBatch batch;
+        /// group the rows by key, one table per task since the rows of a key may be read back
+        vector<shared_ptr<map<string, RowCodec::Rows>>> tableRows(datas.size());
         tbb::parallel_for(tbb::blocked_range<size_t>(0, datas.size()),
             [&](const tbb::blocked_range<size_t>& range) {
                 for (size_t i = range.begin(); i < range.end(); ++i)
                 {
-                    shared_ptr<map<string, vector<map<string, string>>>> key2value =
-                        make_shared<map<string, vector<map<string, string>>>>();
+                    auto key2value = make_shared<map<string, RowCodec::Rows>>();
 
                     auto tableInfo = datas[i]->info;
 
                     processDirtyEntries(num, key2value, tableInfo, datas[i]->dirtyEntries);
                     processNewEntries(num, key2value, tableInfo, datas[i]->newEntries);
+                    tableRows[i] = key2value;
+                }
+            });
 
-                    for (auto it : *key2value)
-                    {
-                        string entryKey = tableInfo->name + "_" + it.first;
-                        stringstream ss;
-                        boost::archive::binary_oarchive oa(ss);
-                        oa << it.second;
-                        {
-                            m_db->PutWithLock(batch, entryKey, ss.str(), m_writeBatchMutex);
-                        }
-                    }
+        /// encode and encrypt the keys of all the tables in parallel, a large table such as
+        /// _sys_tx_hash_2_block_ is split over the threads instead of being handled by one
+        typedef map<string, RowCodec::Rows>::const_iterator RowsIterator;
+        vector<pair<size_t, RowsIterator>> rows;
+        for (size_t i = 0; i < tableRows.size(); ++i)
+        {
+            for (auto it = tableRows[i]->begin(); it != tableRows[i]->end(); ++it)
+            {
+                rows.emplace_back(i, it);
+            }
+        }
+        vector<pair<string, string>> values(rows.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, rows.size()),
+            [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++i)
+                {
+                    auto tableInfo = datas[rows[i].first]->info;
+                    auto const& it = rows[i].second;
+                    values[i].first = tableInfo->name + "_" + it->first;
+                    values[i].second = m_compactRowFormat ?
+                                           RowCodec::encode(tableInfo, it->second) :
+                                           RowCodec::encodeLegacy(it->second);
+                    m_db->Encrypt(values[i].second);
                 }
             });
         auto encode_time_cost = utcTime();
 
+        /// the batch is filled in order without any lock and written atomically
+        size_t batchSize = 0;
+        for (auto const& value : values)
+        {
+            batchSize += value.first.size() + value.second.size() + 16;
+        }
+        WriteBatch batch(batchSize);
+        for (auto& value : values)
+        {
+            m_db->PutEncrypted(batch, value.first, value.second);
+            string().swap(value.second);
+        }
+
         WriteOptions options;
-        options.sync = false;
+        options.sync = m_syncWrite;
+        options.disableWAL = m_disableWAL;
         m_db->Write(options, batch);
         auto writeDB_time_cost = utcTime();
         STORAGE_ROCKSDB_LOG(DEBUG)
             << LOG_BADGE("Commit") << LOG_DESC("Write to db")
+            << LOG_KV("keys", values.size())
             << LOG_KV("encodeTimeCost", encode_time_cost - start_time)
             << LOG_KV("writeDBTimeCost", writeDB_time_cost - encode_time_cost)
             << LOG_KV("totalTimeCost", utcTime() - start_time);
@@ -178,7 +189,7 @@ bool RocksDBStorage::onlyDirty()
 
 
 void RocksDBStorage::processNewEntries(int64_t num,
-    shared_ptr<map<string, vector<map<string, string>>>> key2value, TableInfo::Ptr tableInfo,
+    shared_ptr<map<string, RowCodec::Rows>> key2value, TableInfo::Ptr tableInfo,
     Entries::Ptr entries)
 {
     for (size_t j = 0; j < entries->size(); ++j)
@@ -186,10 +197,10 @@ void RocksDBStorage::processNewEntries(int64_t num,
         auto entry = entries->get(j);
         auto key = entry->getField(tableInfo->key);
 
-        auto it = map<string, vector<map<string, string>>>::iterator();
+        auto it = map<string, RowCodec::Rows>::iterator();
         if (entry->force())
         {
-            it = key2value->insert(make_pair(key, vector<map<string, string>>())).first;
+            it = key2value->insert(make_pair(key, RowCodec::Rows())).first;
         }
         else
         {
@@ -211,35 +222,22 @@ void RocksDBStorage::processNewEntries(int64_t num,
                     BOOST_THROW_EXCEPTION(
                         StorageException(-1, "Query rocksdb exception:" + s.ToString()));
                 }
-                if (s.IsNotFound())
-                {
-                    it = key2value->insert(make_pair(key, vector<map<string, string>>())).first;
-                }
-                else
+                it = key2value->insert(make_pair(key, RowCodec::Rows())).first;
+                if (!s.IsNotFound())
                 {
-                    vector<map<string, string>> res;
-                    stringstream ss(value);
-                    boost::archive::binary_iarchive ia(ss);
-                    ia >> res;
-                    it = key2value->emplace(key, res).first;
+                    for (auto const& existed : RowCodec::decode(value))
+                    {
+                        it->second.emplace_back(existed, existed->num());
+                    }
                 }
             }
         }
-
-        map<string, string> value;
-        for (auto& fieldIt : *(entry))
-        {
-            value[fieldIt.first] = fieldIt.second;
-        }
-        value[NUM_FIELD] = boost::lexical_cast<string>(num);
-        value[ID_FIELD] = boost::lexical_cast<string>(entry->getID());
-        value[STATUS] = boost::lexical_cast<string>(entry->getStatus());
-        it->second.push_back(value);
+        it->second.emplace_back(entry, num);
     }
 }
 
 void RocksDBStorage::processDirtyEntries(int64_t num,
-    shared_ptr<map<string, vector<map<string, string>>>> key2value, TableInfo::Ptr tableInfo,
+    shared_ptr<map<string, RowCodec::Rows>> key2value, TableInfo::Ptr tableInfo,
     Entries::Ptr entries)
 {
     for (size_t j = 0; j < entries->size(); ++j)
@@ -250,17 +248,8 @@ void RocksDBStorage::processDirtyEntries(int64_t num,
         auto it = key2value->find(key);
         if (it == key2value->end())
         {
-            it = key2value->insert(make_pair(key, vector<map<string, string>>())).first;
-        }
-
-        map<string, string> value;
-        for (auto& fieldIt : *(entry))
-        {
-            value[fieldIt.first] = fieldIt.second;
+            it = key2value->insert(make_pair(key, RowCodec::Rows())).first;
         }
-        value[NUM_FIELD] = boost::lexical_cast<string>(num);
-        value[ID_FIELD] = boost::lexical_cast<string>(entry->getID());
-        value[STATUS] = boost::lexical_cast<string>(entry->getStatus());
-        it->second.push_back(value);
+        it->second.emplace_back(entry, num);
     }
 }
@@ -20,11 +20,11 @@
  */
 #pragma once
 
+#include "RowCodec.h"
 #include "Storage.h"
 #include <json/json.h>
 #include <libdevcore/FixedHash.h>
 #include <libdevcore/Guards.h>
-#include <tbb/spin_mutex.h>
 #include <map>
 
 namespace rocksdb
@@ -53,20 +53,28 @@ public:
     bool onlyDirty() override;
 
     void setDB(std::shared_ptr<dev::db::BasicRocksDB> db) { m_db = db; }
+    /// the WriteOptions of the batch written per block
+    void setWritePolicy(bool _sync, bool _disableWAL)
+    {
+        m_syncWrite = _sync;
+        m_disableWAL = _disableWAL;
+    }
+    /// write the rows in the RowCodec version 1 format, the legacy format is written by default
+    void setCompactRowFormat(bool _compact) { m_compactRowFormat = _compact; }
 
 private:
     void processNewEntries(int64_t num,
-        std::shared_ptr<std::map<std::string, std::vector<std::map<std::string, std::string>>>>
-            key2value,
+        std::shared_ptr<std::map<std::string, RowCodec::Rows>> key2value,
         TableInfo::Ptr tableInfo, Entries::Ptr entries);
 
     void processDirtyEntries(int64_t num,
-        std::shared_ptr<std::map<std::string, std::vector<std::map<std::string, std::string>>>>
-            key2value,
+        std::shared_ptr<std::map<std::string, RowCodec::Rows>> key2value,
         TableInfo::Ptr tableInfo, Entries::Ptr entries);
 
     std::shared_ptr<dev::db::BasicRocksDB> m_db;
-    tbb::spin_mutex m_writeBatchMutex;
+    bool m_syncWrite = false;
+    bool m_disableWAL = false;
+    bool m_compactRowFormat = false;
 };
 
 }  // namespace storage
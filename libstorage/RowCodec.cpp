@@ -0,0 +1,296 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : binary encoding of the rows stored under one key of RocksDB
+ * @file: RowCodec.cpp
+ */
+#include "RowCodec.h"
+#include "Common.h"
+#include "StorageException.h"
+#include "boost/archive/binary_iarchive.hpp"
+#include "boost/archive/binary_oarchive.hpp"
+#include "boost/lexical_cast.hpp"
+#include "boost/serialization/map.hpp"
+#include "boost/serialization/serialization.hpp"
+#include "boost/serialization/vector.hpp"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+using namespace std;
+using namespace dev;
+using namespace dev::storage;
+
+namespace
+{
+inline bool isSystemField(string const& _name)
+{
+    return _name == ID_FIELD || _name == NUM_FIELD || _name == STATUS;
+}
+
+inline void putVarint(string& _out, uint64_t _value)
+{
+    while (_value >= 0x80)
+    {
+        _out.push_back((char)(_value | 0x80));
+        _value >>= 7;
+    }
+    _out.push_back((char)_value);
+}
+
+inline void putString(string& _out, string const& _value)
+{
+    putVarint(_out, _value.size());
+    _out.append(_value);
+}
+
+class Reader
+{
+public:
+    Reader(string const& _value, size_t _offset) : m_value(_value), m_offset(_offset) {}
+
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            check(1);
+            uint8_t b = (uint8_t)m_value[m_offset++];
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                return value;
+            }
+        }
+        BOOST_THROW_EXCEPTION(StorageException(-1, "invalid row value: varint overflow"));
+    }
+
+    /// the count of the items taking one byte at least
+    size_t readCount()
+    {
+        auto count = readVarint();
+        check(count);
+        return count;
+    }
+
+    void readString(std::string& _out, size_t _size)
+    {
+        check(_size);
+        _out.assign(m_value, m_offset, _size);
+        m_offset += _size;
+    }
+
+    bool end() const { return m_offset == m_value.size(); }
+
+private:
+    void check(size_t _size)
+    {
+        if (m_value.size() - m_offset < _size)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid row value: truncated"));
+        }
+    }
+
+    std::string const& m_value;
+    size_t m_offset;
+};
+}  // namespace
+
+const char RowCodec::c_version;
+
+string RowCodec::encode(TableInfo::Ptr _tableInfo, Rows const& _rows)
+{
+    vector<string> names;
+    unordered_map<string, size_t> positions;
+    for (auto const& row : _rows)
+    {
+        for (auto const& field : *row.first)
+        {
+            if (!isSystemField(field.first) && positions.emplace(field.first, 0).second)
+            {
+                names.push_back(field.first);
+            }
+        }
+    }
+    /// order by the table schema, the fields out of the schema follow by name
+    auto rank = [&](string const& _name) -> size_t {
+        if (!_tableInfo)
+        {
+            return 0;
+        }
+        auto const& schema = _tableInfo->fields;
+        if (_name == _tableInfo->key)
+        {
+            return 0;
+        }
+        return find(schema.begin(), schema.end(), _name) - schema.begin() + 1;
+    };
+    vector<pair<size_t, string>> ranked;
+    ranked.reserve(names.size());
+    for (auto& name : names)
+    {
+        ranked.emplace_back(rank(name), move(name));
+    }
+    sort(ranked.begin(), ranked.end());
+
+    string out;
+    out.push_back(c_version);
+    putVarint(out, ranked.size());
+    for (size_t i = 0; i < ranked.size(); ++i)
+    {
+        putString(out, ranked[i].second);
+        positions[ranked[i].second] = i;
+    }
+    putVarint(out, _rows.size());
+    vector<string const*> values(ranked.size());
+    for (auto const& row : _rows)
+    {
+        putVarint(out, row.first->getID());
+        putVarint(out, row.second);
+        putVarint(out, row.first->getStatus());
+        fill(values.begin(), values.end(), nullptr);
+        for (auto const& field : *row.first)
+        {
+            if (!isSystemField(field.first))
+            {
+                values[positions[field.first]] = &field.second;
+            }
+        }
+        for (auto value : values)
+        {
+            if (!value)
+            {
+                putVarint(out, 0);
+                continue;
+            }
+            putVarint(out, value->size() + 1);
+            out.append(*value);
+        }
+    }
+    return out;
+}
+
+string RowCodec::encodeLegacy(Rows const& _rows)
+{
+    vector<map<string, string>> res;
+    res.reserve(_rows.size());
+    for (auto const& row : _rows)
+    {
+        map<string, string> value;
+        for (auto const& field : *row.first)
+        {
+            value[field.first] = field.second;
+        }
+        value[NUM_FIELD] = boost::lexical_cast<string>(row.second);
+        value[ID_FIELD] = boost::lexical_cast<string>(row.first->getID());
+        value[STATUS] = boost::lexical_cast<string>(row.first->getStatus());
+        res.push_back(move(value));
+    }
+    stringstream ss;
+    {
+        boost::archive::binary_oarchive oa(ss);
+        oa << res;
+    }
+    return ss.str();
+}
+
+vector<Entry::Ptr> RowCodec::decode(string const& _value)
+{
+    if (isLegacy(_value))
+    {
+        return decodeLegacy(_value);
+    }
+    Reader reader(_value, 1);
+    vector<string> names(reader.readCount());
+    for (auto& name : names)
+    {
+        reader.readString(name, reader.readVarint());
+    }
+    vector<Entry::Ptr> entries(reader.readCount());
+    string value;
+    for (auto& entry : entries)
+    {
+        entry = make_shared<Entry>();
+        entry->reserve(names.size());
+        entry->setID(reader.readVarint());
+        entry->setNum((uint32_t)reader.readVarint());
+        entry->setStatus((int)reader.readVarint());
+        for (auto const& name : names)
+        {
+            auto size = reader.readVarint();
+            if (size > 0)
+            {
+                reader.readString(value, size - 1);
+                entry->setField(name, value);
+            }
+        }
+    }
+    if (!reader.end())
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, "invalid row value: trailing bytes"));
+    }
+    return entries;
+}
+
+vector<Entry::Ptr> RowCodec::decodeLegacy(string const& _value)
+{
+    vector<map<string, string>> res;
+    stringstream ss(_value);
+    boost::archive::binary_iarchive ia(ss);
+    ia >> res;
+
+    vector<Entry::Ptr> entries;
+    entries.reserve(res.size());
+    for (auto it = res.begin(); it != res.end(); ++it)
+    {
+        Entry::Ptr entry = make_shared<Entry>();
+        for (auto valueIt = it->begin(); valueIt != it->end(); ++valueIt)
+        {
+            // system fields are kept as integers only
+            if (!isSystemField(valueIt->first))
+            {
+                entry->setField(valueIt->first, valueIt->second);
+            }
+        }
+        entry->setID(it->at(ID_FIELD));
+        entry->setNum(it->at(NUM_FIELD));
+        entry->setStatus(it->at(STATUS));
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+string RowCodec::upgrade(string const& _value)
+{
+    Rows rows;
+    for (auto const& entry : decodeLegacy(_value))
+    {
+        rows.emplace_back(entry, entry->num());
+    }
+    return encode(nullptr, rows);
+}
+
+string RowCodec::downgrade(string const& _value)
+{
+    Rows rows;
+    for (auto const& entry : decode(_value))
+    {
+        rows.emplace_back(entry, entry->num());
+    }
+    return encodeLegacy(rows);
+}
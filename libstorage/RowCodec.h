@@ -0,0 +1,68 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : binary encoding of the rows stored under one key of RocksDB
+ * @file: RowCodec.h
+ */
+#pragma once
+
+#include "Table.h"
+#include <string>
+#include <vector>
+
+namespace dev
+{
+namespace storage
+{
+/**
+ * @brief: the version 1 value is
+ *   [version] [field count] [field names...] [row count] [rows...]
+ * the field names are ordered by the table schema and followed by the fields out of the schema,
+ * every row is [_id_] [_num_] [_status_] followed by every field in the order of the names, as
+ * the length plus one or zero if the row has no such field. All the integers are varints.
+ * The names are kept in the value since the callers of select do not always know the schema.
+ * The values written by boost::serialization before are still decoded, and are still written
+ * unless storage.compact_row_format is set, since the nodes before cannot read version 1. A
+ * directory written in version 1 goes back with rocksdb-upgrade --downgrade.
+ */
+class RowCodec
+{
+public:
+    /// the entries and the block numbers to be stored with them
+    typedef std::vector<std::pair<Entry::Ptr, int64_t>> Rows;
+
+    static std::string encode(TableInfo::Ptr _tableInfo, Rows const& _rows);
+    /// the vector<map<string, string>> of boost::serialization, system fields as strings
+    static std::string encodeLegacy(Rows const& _rows);
+    /// decode both the version 1 and the legacy values, the system fields are set as integers
+    static std::vector<Entry::Ptr> decode(std::string const& _value);
+
+    static bool isLegacy(std::string const& _value)
+    {
+        return _value.empty() || _value[0] != c_version;
+    }
+    static std::vector<Entry::Ptr> decodeLegacy(std::string const& _value);
+    /// encode the legacy value in the version 1 format
+    static std::string upgrade(std::string const& _value);
+    /// encode the version 1 value in the legacy format
+    static std::string downgrade(std::string const& _value);
+
+    static const char c_version = (char)0xf1;
+};
+
+}  // namespace storage
+}  // namespace dev
@@ -0,0 +1,122 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : the tables written by the execution of a block
+ * @file: StateDiff.cpp
+ */
+#include "StateDiff.h"
+#include "StorageException.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::storage;
+
+/// the diff is [tables...], every table is
+///   [name, key, [fields...], dirty, [dirty entries...], [new entries...]]
+/// and every entry is [id, num, status, force, [[field, value]...]]
+void StateDiff::encode(bytes& _out) const
+{
+    RLPStream s(tables.size());
+    for (auto const& table : tables)
+    {
+        s.appendList(6);
+        s << table.info->name << table.info->key << table.info->fields << (unsigned)table.dirty;
+        encodeEntries(s, table.dirtyEntries);
+        encodeEntries(s, table.newEntries);
+    }
+    s.swapOut(_out);
+}
+
+void StateDiff::encodeEntries(RLPStream& _s, Entries::Ptr _entries)
+{
+    if (!_entries)
+    {
+        _s.appendList(0);
+        return;
+    }
+    _s.appendList(_entries->size());
+    for (auto const& entry : *_entries)
+    {
+        _s.appendList(5);
+        _s << u256(entry->getID()) << entry->num() << (unsigned)entry->getStatus()
+           << (unsigned)entry->force();
+        _s.appendList(entry->size());
+        for (auto const& field : *entry)
+        {
+            _s.appendList(2) << field.first << field.second;
+        }
+    }
+}
+
+StateDiff::Ptr StateDiff::decode(bytesConstRef _data)
+{
+    auto diff = make_shared<StateDiff>();
+    try
+    {
+        RLP rlp(_data);
+        for (auto const& tableRLP : rlp)
+        {
+            if (tableRLP.itemCount() != 6)
+            {
+                BOOST_THROW_EXCEPTION(StorageException(-1, "invalid state diff: table"));
+            }
+            TableDiff table;
+            table.info = make_shared<TableInfo>();
+            table.info->name = tableRLP[0].toString();
+            table.info->key = tableRLP[1].toString();
+            table.info->fields = tableRLP[2].toVector<string>();
+            table.dirty = tableRLP[3].toInt<unsigned>() != 0;
+            table.dirtyEntries = decodeEntries(tableRLP[4]);
+            table.newEntries = decodeEntries(tableRLP[5]);
+            diff->tables.push_back(table);
+        }
+    }
+    catch (StorageException const&)
+    {
+        throw;
+    }
+    catch (std::exception const& e)
+    {
+        BOOST_THROW_EXCEPTION(StorageException(-1, string("invalid state diff: ") + e.what()));
+    }
+    return diff;
+}
+
+Entries::Ptr StateDiff::decodeEntries(RLP const& _rlp)
+{
+    auto entries = make_shared<Entries>();
+    for (auto const& entryRLP : _rlp)
+    {
+        if (entryRLP.itemCount() != 5)
+        {
+            BOOST_THROW_EXCEPTION(StorageException(-1, "invalid state diff: entry"));
+        }
+        auto entry = make_shared<Entry>();
+        auto fields = entryRLP[4];
+        entry->reserve(fields.itemCount());
+        for (auto const& field : fields)
+        {
+            entry->setField(field[0].toString(), field[1].toString());
+        }
+        entry->setID(entryRLP[0].toInt<uint64_t>());
+        entry->setNum(entryRLP[1].toInt<uint32_t>());
+        entry->setStatus((int)entryRLP[2].toInt<unsigned>());
+        entry->setForce(entryRLP[3].toInt<unsigned>() != 0);
+        entries->addEntry(entry);
+    }
+    return entries;
+}
@@ -0,0 +1,65 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief : the tables written by the execution of a block
+ * @file: StateDiff.h
+ */
+#pragma once
+
+#include "Table.h"
+#include <libdevcore/RLP.h>
+#include <memory>
+#include <vector>
+
+namespace dev
+{
+namespace storage
+{
+/**
+ * @brief: every table opened by the execution of a block with the entries it dumps, taken when
+ * the dbHash of the block is calculated. The tables opened without being written are kept
+ * without entries since they take part in the dbHash too, so importing the diff into a new
+ * MemoryTableFactory2 gives the dbHash of the block without executing it.
+ */
+class StateDiff
+{
+public:
+    typedef std::shared_ptr<StateDiff> Ptr;
+
+    struct TableDiff
+    {
+        TableInfo::Ptr info;
+        /// the table has been written, its hash is calculated from the entries
+        bool dirty = false;
+        Entries::Ptr dirtyEntries;
+        Entries::Ptr newEntries;
+    };
+
+    /// the fields are encoded in order since the table hash depends on it
+    void encode(bytes& _out) const;
+    /// throw StorageException if _data is not a valid diff
+    static Ptr decode(bytesConstRef _data);
+
+    std::vector<TableDiff> tables;
+
+private:
+    static void encodeEntries(RLPStream& _s, Entries::Ptr _entries);
+    static Entries::Ptr decodeEntries(RLP const& _rlp);
+};
+
+}  // namespace storage
+}  // namespace dev
@@ -33,6 +33,7 @@
 #include <tbb/pipeline.h>
 #include <tbb/tbb_thread.h>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 
 using namespace dev::storage;
 
@@ -42,6 +43,12 @@ Entry::Entry() : m_data(std::make_shared<EntryData>())
     // m_data->m_fields.insert(std::make_pair(STATUS, "0"));
 }
 
+Entry::Entry(EntryData::Ptr data) : m_data(data)
+{
+    // caller holds the write lock of data
+    m_data->m_refCount += 1;
+}
+
 Entry::~Entry()
 {
     RWMutexScoped lock(m_data->m_mutex, true);
@@ -76,17 +83,52 @@ void Entry::setID(const std::string& id)
     m_dirty = true;
 }
 
+namespace
+{
+struct FieldNameLess
+{
+    bool operator()(const std::pair<std::string, std::string>& field, const std::string& name) const
+    {
+        return field.first < name;
+    }
+};
+
+Entry::Fields::const_iterator findField(const Entry::Fields& fields, const std::string& key)
+{
+    auto it = std::lower_bound(fields.begin(), fields.end(), key, FieldNameLess());
+    if (it != fields.end() && it->first == key)
+    {
+        return it;
+    }
+    return fields.end();
+}
+}  // namespace
+
 std::string Entry::getField(const std::string& key) const
 {
     RWMutexScoped lock(m_data->m_mutex, false);
 
-    auto it = m_data->m_fields.find(key);
+    auto it = findField(m_data->m_fields, key);
 
     if (it != m_data->m_fields.end())
     {
         return it->second;
     }
 
+    // system fields are kept as integers only
+    if (key == ID_FIELD)
+    {
+        return boost::lexical_cast<std::string>(m_ID);
+    }
+    if (key == NUM_FIELD)
+    {
+        return boost::lexical_cast<std::string>(m_num);
+    }
+    if (key == STATUS)
+    {
+        return boost::lexical_cast<std::string>(m_status);
+    }
+
     STORAGE_LOG(ERROR) << LOG_BADGE("Entry") << LOG_DESC("can't find key") << LOG_KV("key", key);
     return "";
 }
@@ -108,9 +150,10 @@ void Entry::setField(const std::string& key, const std::string& value)
 
     auto lock = checkRef();
 
-    auto it = m_data->m_fields.find(key);
+    auto it = std::lower_bound(
+        m_data->m_fields.begin(), m_data->m_fields.end(), key, FieldNameLess());
 
-    if (it != m_data->m_fields.end())
+    if (it != m_data->m_fields.end() && it->first == key)
     {
         m_capacity -= (key.size() + it->second.size());
         it->second = value;
@@ -118,7 +161,7 @@ void Entry::setField(const std::string& key, const std::string& value)
     }
     else
     {
-        m_data->m_fields.insert(std::make_pair(key, value));
+        m_data->m_fields.emplace(it, key, value);
         m_capacity += (key.size() + value.size());
     }
 
@@ -140,17 +183,17 @@ void Entry::setTempIndex(size_t index)
     m_tempIndex = index;
 }
 
-std::map<std::string, std::string>::const_iterator Entry::find(const std::string& key) const
+Entry::Fields::const_iterator Entry::find(const std::string& key) const
 {
-    return m_data->m_fields.find(key);
+    return findField(m_data->m_fields, key);
 }
 
-std::map<std::string, std::string>::const_iterator Entry::begin() const
+Entry::Fields::const_iterator Entry::begin() const
 {
     return m_data->m_fields.begin();
 }
 
-std::map<std::string, std::string>::const_iterator Entry::end() const
+Entry::Fields::const_iterator Entry::end() const
 {
     return m_data->m_fields.end();
 }
@@ -160,6 +203,13 @@ size_t Entry::size() const
     return m_data->m_fields.size();
 }
 
+void Entry::reserve(size_t size)
+{
+    auto lock = checkRef();
+
+    m_data->m_fields.reserve(size);
+}
+
 int Entry::getStatus() const
 {
     RWMutexScoped lock(m_data->m_mutex, false);
@@ -317,6 +367,23 @@ void Entry::copyFrom(Entry::Ptr entry)
     m_data->m_refCount += 1;
 }
 
+Entry::Ptr Entry::clone()
+{
+    RWMutexScoped lock(m_data->m_mutex, true);
+
+    auto entry = std::shared_ptr<Entry>(new Entry(m_data));
+    entry->m_ID = m_ID;
+    entry->m_status = m_status;
+    entry->m_tempIndex = m_tempIndex;
+    entry->m_num = m_num;
+    entry->m_dirty = m_dirty;
+    entry->m_force = m_force;
+    entry->m_deleted = m_deleted;
+    entry->m_capacity = m_capacity;
+
+    return entry;
+}
+
 ssize_t Entry::refCount()
 {
     RWMutexScoped lock(m_data->m_mutex, false);
@@ -776,3 +843,35 @@ bool Condition::related(Condition::Ptr condition)
 
     return false;
 }
+
+thread_local TableAccessSet* TableAccessSet::s_current = nullptr;
+
+void TableAccessSet::addRead(const std::string& _table, const std::string& _key)
+{
+    m_reads.emplace(_table, _key);
+}
+
+void TableAccessSet::addWrite(const std::string& _table, const std::string& _key)
+{
+    m_writes.emplace(_table, _key);
+}
+
+bool TableAccessSet::coveredBy(const TableAccessSet& _predicted) const
+{
+    for (auto& key : m_writes)
+    {
+        if (_predicted.m_writes.count(key) == 0)
+        {
+            return false;
+        }
+    }
+
+    for (auto& key : m_reads)
+    {
+        if (_predicted.m_reads.count(key) == 0 && _predicted.m_writes.count(key) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -28,6 +28,7 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <set>
 #include <type_traits>
 #include <vector>
 
@@ -70,6 +71,10 @@ public:
     typedef tbb::spin_rw_mutex RWMutex;
     typedef tbb::spin_rw_mutex::scoped_lock RWMutexScoped;
 
+    // fields sorted by name in one contiguous block, iterates in the same order as a std::map,
+    // short values stay inline thanks to the small string optimization
+    typedef std::vector<std::pair<std::string, std::string>> Fields;
+
     Entry();
     virtual ~Entry();
 
@@ -83,12 +88,14 @@ public:
     virtual size_t getTempIndex() const;
     virtual void setTempIndex(size_t index);
 
-    virtual std::map<std::string, std::string>::const_iterator find(const std::string& key) const;
+    virtual Fields::const_iterator find(const std::string& key) const;
 
-    virtual std::map<std::string, std::string>::const_iterator begin() const;
-    virtual std::map<std::string, std::string>::const_iterator end() const;
+    virtual Fields::const_iterator begin() const;
+    virtual Fields::const_iterator end() const;
 
     virtual size_t size() const;
+    // reserve room for the fields of a table schema, avoids regrowth on setField
+    virtual void reserve(size_t size);
 
     virtual int getStatus() const;
     virtual void setStatus(int status);
@@ -112,6 +119,9 @@ public:
 
     virtual void copyFrom(Entry::Ptr entry);
 
+    // copy-on-write clone: shares the fields with this entry until either side writes them
+    virtual Entry::Ptr clone();
+
     virtual ssize_t refCount();
 
     std::shared_ptr<RWMutexScoped> lock(bool write = false);
@@ -124,10 +134,12 @@ private:
         EntryData(){};
 
         ssize_t m_refCount = 0;
-        std::map<std::string, std::string> m_fields;
+        Fields m_fields;
         RWMutex m_mutex;
     };
 
+    Entry(EntryData::Ptr data);
+
     std::shared_ptr<RWMutexScoped> checkRef();
 
     uint64_t m_ID = 0;
@@ -283,6 +295,45 @@ struct Change
     {}
 };
 
+// rows read and written by one transaction, recorded by MemoryTable2 while the set is attached to
+// the executing thread
+class TableAccessSet
+{
+public:
+    typedef std::shared_ptr<TableAccessSet> Ptr;
+    // table name and row key
+    typedef std::pair<std::string, std::string> Key;
+
+    void addRead(const std::string& _table, const std::string& _key);
+    void addWrite(const std::string& _table, const std::string& _key);
+
+    const std::set<Key>& reads() const { return m_reads; }
+    const std::set<Key>& writes() const { return m_writes; }
+
+    // every write is a predicted write and every read is a predicted read or write
+    bool coveredBy(const TableAccessSet& _predicted) const;
+
+    // the set of the calling thread, nullptr if nothing is recorded
+    static TableAccessSet* current() { return s_current; }
+
+    // attaches a set to the calling thread until it goes out of scope
+    class Scope
+    {
+    public:
+        Scope(TableAccessSet* _accessSet) : m_previous(s_current) { s_current = _accessSet; }
+        ~Scope() { s_current = m_previous; }
+
+    private:
+        TableAccessSet* m_previous;
+    };
+
+private:
+    static thread_local TableAccessSet* s_current;
+
+    std::set<Key> m_reads;
+    std::set<Key> m_writes;
+};
+
 class TableData
 {
 public:
@@ -341,6 +392,7 @@ public:
     virtual void setBlockHash(h256 blockHash) = 0;
     virtual void setBlockNum(int blockNum) = 0;
     virtual void setTableInfo(TableInfo::Ptr tableInfo) { m_tableInfo = tableInfo; };
+    virtual TableInfo::Ptr tableInfo() const { return m_tableInfo; }
     virtual size_t cacheSize() { return 0; }
 
 protected:
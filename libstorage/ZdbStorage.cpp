@@ -55,7 +55,11 @@ Entries::Ptr ZdbStorage::select(h256 _hash, int64_t _num, TableInfo::Ptr _tableI
         Entry::Ptr entry = std::make_shared<Entry>();
         for (auto it2 : it)
         {
-            entry->setField(it2.first, it2.second);
+            // system fields are kept as integers only
+            if (it2.first != ID_FIELD && it2.first != NUM_FIELD && it2.first != STATUS)
+            {
+                entry->setField(it2.first, it2.second);
+            }
         }
         entry->setID(it.at(ID_FIELD));
         entry->setNum(it.at(NUM_FIELD));
@@ -48,6 +48,10 @@ static int64_t const c_maxRequestBlocks = 32;
 static size_t const c_maxRequestShards = 4;
 static uint64_t const c_eachBlockDownloadingRequestTimeout =
     200;  // ms: assume that we have 200ms timeout for each block
+// the blocks requested from a peer at a time, adapted to its latency and bandwidth
+static int64_t const c_minPeerRequestBlocks = 4;
+static int64_t const c_maxPeerRequestBlocks = c_maxRequestBlocks * 2;
+static uint64_t const c_peerRequestTargetTime = 1000;  // ms: expected time to answer a request
 
 static size_t const c_maxDownloadingBlockQueueSize =
     c_maxRequestShards * c_maxRequestBlocks * 2;  // maybe less than 128 is ok
@@ -55,11 +59,14 @@ static size_t const c_maxDownloadingBlockQueueBufferSize = c_maxDownloadingBlock
 
 static size_t const c_maxReceivedDownloadRequestPerPeer = 8;
 static uint64_t const c_respondDownloadRequestTimeout = 200;  // ms
+static size_t const c_maxRespondThreads = 4;  // peers answered concurrently
 
 static unsigned const c_syncPacketIDBase = 1;
 
 static uint64_t const c_maintainBlocksTimeout = 5000;  // ms
 
+static uint64_t const c_syncSpeedReportInterval = 10000;  // ms
+
 using NodeList = std::set<dev::p2p::NodeID>;
 using NodeID = dev::p2p::NodeID;
 using NodeIDs = std::vector<dev::p2p::NodeID>;
@@ -77,6 +84,8 @@ enum SyncPacketType : byte
     TransactionsPacket = 0x01,
     BlocksPacket = 0x02,
     ReqBlocskPacket = 0x03,
+    ReqStateDiffBlocksPacket = 0x04,
+    StateDiffBlocksPacket = 0x05,
     PacketCount
 };
 
@@ -23,6 +23,7 @@
 #include "DownloadingBlockQueue.h"
 #include "Common.h"
 #include <libdevcore/easylog.h>
+#include <tbb/parallel_for.h>
 
 using namespace std;
 using namespace dev;
@@ -30,7 +31,7 @@ using namespace dev::eth;
 using namespace dev::sync;
 
 /// Push a block
-void DownloadingBlockQueue::push(RLP const& _rlps)
+void DownloadingBlockQueue::push(RLP const& _rlps, bool _withStateDiff)
 {
     WriteGuard l(x_buffer);
     if (m_buffer->size() >= c_maxDownloadingBlockQueueBufferSize)
@@ -40,7 +41,8 @@ void DownloadingBlockQueue::push(RLP const& _rlps)
                           << LOG_KV("queueSize", m_buffer->size());
         return;
     }
-    ShardPtr blocksShard = make_shared<DownloadBlocksShard>(0, 0, _rlps.data().toBytes());
+    ShardPtr blocksShard =
+        make_shared<DownloadBlocksShard>(0, 0, _rlps.data().toBytes(), _withStateDiff);
     m_buffer->emplace_back(blocksShard);
 }
 
@@ -89,7 +91,11 @@ void DownloadingBlockQueue::pop()
 {
     WriteGuard l(x_blocks);
     if (!m_blocks.empty())
+    {
+        if (!m_stateDiffs.empty())
+            m_stateDiffs.erase(m_blocks.top()->headerHash());
         m_blocks.pop();
+    }
 }
 
 BlockPtr DownloadingBlockQueue::top(bool isFlushBuffer)
@@ -119,6 +125,14 @@ void DownloadingBlockQueue::clearQueue()
     WriteGuard l(x_blocks);
     std::priority_queue<BlockPtr, BlockPtrVec, BlockQueueCmp> emptyQueue;
     swap(m_blocks, emptyQueue);  // Does memory leak here ?
+    m_stateDiffs.clear();
+}
+
+shared_ptr<bytes> DownloadingBlockQueue::stateDiff(h256 const& _blockHash)
+{
+    ReadGuard l(x_blocks);
+    auto it = m_stateDiffs.find(_blockHash);
+    return it == m_stateDiffs.end() ? nullptr : it->second;
 }
 
 void DownloadingBlockQueue::flushBufferToQueue()
@@ -130,17 +144,21 @@ void DownloadingBlockQueue::flushBufferToQueue()
         m_buffer = make_shared<ShardPtrVec>();  // m_buffer point to a new vector
     }
 
-    // pop buffer into queue
-    WriteGuard l(x_blocks);
-
+    size_t queueSize = 0;
+    {
+        ReadGuard l(x_blocks);
+        queueSize = m_blocks.size();
+    }
+    // collect the blocks of the shards that the queue can hold
+    vector<bytesConstRef> items;
+    vector<bytesConstRef> stateDiffs;
     for (ShardPtr blocksShard : *localBuffer)
     {
-        if (m_blocks.size() >= c_maxDownloadingBlockQueueSize)  // TODO not to use size to control
-                                                                // insert
+        if (queueSize + items.size() >= c_maxDownloadingBlockQueueSize)
         {
             SYNC_LOG(TRACE) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
                             << LOG_DESC("DownloadingBlockQueueBuffer is full")
-                            << LOG_KV("queueSize", m_blocks.size());
+                            << LOG_KV("queueSize", queueSize + items.size());
 
             break;
         }
@@ -148,51 +166,111 @@ void DownloadingBlockQueue::flushBufferToQueue()
         SYNC_LOG(TRACE) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
                         << LOG_DESC("Decoding block buffer")
                         << LOG_KV("blocksShardSize", blocksShard->blocksBytes.size());
-
-
-        RLP const& rlps = RLP(ref(blocksShard->blocksBytes));
-        unsigned itemCount = rlps.itemCount();
-        size_t successCnt = 0;
-        for (unsigned i = 0; i < itemCount; ++i)
+        try
+        {
+            RLP const& rlps = RLP(ref(blocksShard->blocksBytes));
+            for (auto const& item : rlps)
+            {
+                if (blocksShard->withStateDiff)
+                {
+                    auto blockRef = item[0].toBytesConstRef();
+                    auto stateDiffRef = item[1].toBytesConstRef();
+                    items.push_back(blockRef);
+                    stateDiffs.push_back(stateDiffRef);
+                    continue;
+                }
+                items.push_back(item.toBytesConstRef());
+                stateDiffs.push_back(bytesConstRef());
+            }
+        }
+        catch (std::exception& e)
         {
-            try
+            SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                              << LOG_DESC("Invalid blocks RLP") << LOG_KV("reason", e.what())
+                              << LOG_KV("RLPDataSize", blocksShard->blocksBytes.size());
+        }
+    }
+
+    // decode the blocks, recover the transaction senders and check the signatures in parallel
+    BlockPtrVec blocks(items.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, items.size()), [&](tbb::blocked_range<size_t> const& _r) {
+            for (size_t i = _r.begin(); i < _r.end(); ++i)
             {
-                shared_ptr<Block> block =
-                    make_shared<Block>(rlps[i].toBytes(), CheckTransaction::Everything, false);
-                if (isNewerBlock(block))
+                try
+                {
+                    // the receipts are checked against the header when the StateDiff is applied
+                    auto block = make_shared<Block>(
+                        items[i], CheckTransaction::Everything, !stateDiffs[i].empty());
+                    if (!isNewerBlock(block))
+                    {
+                        continue;
+                    }
+                    if (fp_preVerify && !fp_preVerify(*block))
+                    {
+                        SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                                          << LOG_DESC("Ignore block failed to pre-verify")
+                                          << LOG_KV("number", block->header().number())
+                                          << LOG_KV("hash", block->headerHash().abridged());
+                        continue;
+                    }
+                    blocks[i] = block;
+                }
+                catch (std::exception& e)
                 {
-                    successCnt++;
-                    m_blocks.push(block);
+                    SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                                      << LOG_DESC("Invalid block RLP") << LOG_KV("reason", e.what())
+                                      << LOG_KV("RLPDataSize", items[i].size());
                 }
             }
-            catch (std::exception& e)
+        });
+
+    size_t successCnt = 0;
+    WriteGuard l(x_blocks);
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (blocks[i])
+        {
+            successCnt++;
+            m_blocks.push(blocks[i]);
+            if (!stateDiffs[i].empty())
             {
-                SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
-                                  << LOG_DESC("Invalid block RLP") << LOG_KV("reason", e.what())
-                                  << LOG_KV("RLPDataSize", rlps.data().size());
-                continue;
+                m_stateDiffs[blocks[i]->headerHash()] =
+                    make_shared<bytes>(stateDiffs[i].toBytes());
             }
         }
-
-        SYNC_LOG(TRACE) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
-                        << LOG_DESC("Flush buffer to block queue") << LOG_KV("import", successCnt)
-                        << LOG_KV("rcv", itemCount)
-                        << LOG_KV("downloadBlockQueue", m_blocks.size());
     }
+    SYNC_LOG(TRACE) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                    << LOG_DESC("Flush buffer to block queue") << LOG_KV("import", successCnt)
+                    << LOG_KV("rcv", items.size()) << LOG_KV("downloadBlockQueue", m_blocks.size());
 }
 
 void DownloadingBlockQueue::clearFullQueueIfNotHas(int64_t _blockNumber)
 {
-    bool needClear = false;
-    {
-        ReadGuard l(x_blocks);
+    WriteGuard l(x_blocks);
+    if (m_blocks.size() < c_maxDownloadingBlockQueueSize ||
+        m_blocks.top()->header().number() <= _blockNumber)
+        return;
 
-        if (m_blocks.size() == c_maxDownloadingBlockQueueSize &&
-            m_blocks.top()->header().number() > _blockNumber)
-            needClear = true;
+    // keep the lower half, they are executed as soon as the missing blocks arrive
+    BlockPtrVec kept;
+    size_t keepSize = m_blocks.size() / 2;
+    while (kept.size() < keepSize)
+    {
+        kept.emplace_back(m_blocks.top());
+        m_blocks.pop();
+    }
+    SYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                    << LOG_DESC("Drop the higher blocks of the full queue")
+                    << LOG_KV("missingNumber", _blockNumber)
+                    << LOG_KV("dropFrom", m_blocks.top()->header().number())
+                    << LOG_KV("dropSize", m_blocks.size());
+    for (; !m_blocks.empty(); m_blocks.pop())
+    {
+        m_stateDiffs.erase(m_blocks.top()->headerHash());
     }
-    if (needClear)
-        clearQueue();
+    m_blocks = std::priority_queue<BlockPtr, BlockPtrVec, BlockQueueCmp>(
+        BlockQueueCmp(), std::move(kept));
 }
 
 bool DownloadingBlockQueue::isNewerBlock(shared_ptr<Block> _block)
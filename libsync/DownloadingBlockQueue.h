@@ -26,6 +26,8 @@
 #include <libdevcore/Guards.h>
 #include <libethcore/Block.h>
 #include <climits>
+#include <functional>
+#include <map>
 #include <queue>
 #include <set>
 #include <vector>
@@ -37,12 +39,18 @@ namespace sync
 class DownloadBlocksShard
 {
 public:
-    DownloadBlocksShard(int64_t _fromNumber, int64_t _size, bytes const& _blocksBytes)
-      : fromNumber(_fromNumber), size(_size), blocksBytes(_blocksBytes)
+    DownloadBlocksShard(int64_t _fromNumber, int64_t _size, bytes const& _blocksBytes,
+        bool _withStateDiff = false)
+      : fromNumber(_fromNumber),
+        size(_size),
+        blocksBytes(_blocksBytes),
+        withStateDiff(_withStateDiff)
     {}
     int64_t fromNumber;
     int64_t size;
     bytes blocksBytes;
+    /// the items are [block, StateDiff]
+    bool withStateDiff;
 };
 
 struct BlockQueueCmp
@@ -74,7 +82,7 @@ public:
     {}
 
     /// PUsh a block packet
-    void push(RLP const& _rlps);
+    void push(RLP const& _rlps, bool _withStateDiff = false);
     void push(BlockPtrVec _blocks);
 
     /// Is the queue empty?
@@ -95,20 +103,41 @@ public:
     /// clear queue
     void clearQueue();
 
-    /// flush m_buffer into queue
+    /// the StateDiff received with the block in the queue, nullptr if not received
+    std::shared_ptr<bytes> stateDiff(h256 const& _blockHash);
+
+    /// decode the blocks of m_buffer in parallel and push them into queue
     void flushBufferToQueue();
 
+    /// is there any block packet waiting to be flushed?
+    bool bufferEmpty()
+    {
+        ReadGuard l(x_buffer);
+        return m_buffer->empty();
+    }
+
+    /// the checks independent of the chain state, run when the blocks are decoded
+    void registerPreVerifyHandler(std::function<bool(dev::eth::Block const&)> _handler)
+    {
+        fp_preVerify = _handler;
+    }
+
+    /// the blocks arrived out of order are kept until the queue is full without _blockNumber,
+    /// then the higher half is dropped to make room for the missing ones
     void clearFullQueueIfNotHas(int64_t _blockNumber);
 
 private:
     std::shared_ptr<dev::blockchain::BlockChainInterface> m_blockChain;
     NodeID m_nodeId;
     std::priority_queue<BlockPtr, BlockPtrVec, BlockQueueCmp> m_blocks;  //
+    std::map<h256, std::shared_ptr<bytes>> m_stateDiffs;                   // guarded by x_blocks
     std::shared_ptr<ShardPtrVec> m_buffer;  // use buffer for faster push return
 
     mutable SharedMutex x_blocks;
     mutable SharedMutex x_buffer;
 
+    std::function<bool(dev::eth::Block const&)> fp_preVerify = nullptr;
+
 private:
     bool isNewerBlock(std::shared_ptr<dev::eth::Block> _block);
 };
@@ -21,7 +21,6 @@
  */
 
 #include "DownloadingTxsQueue.h"
-#include <tbb/parallel_for.h>
 
 using namespace dev;
 using namespace dev::sync;
@@ -87,27 +86,16 @@ void DownloadingTxsQueue::pop2TxPool(
         auto decode_time_cost = utcTime() - record_time;
         record_time = utcTime();
 
-        // parallel verify transaction before import
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, txs.size()), [&](const tbb::blocked_range<size_t>& _r) {
-                for (size_t j = _r.begin(); j != _r.end(); ++j)
-                {
-                    if (!_txPool->txExists(txs[j].sha3()))
-                        txs[j].sender();
-                }
-            });
-
-        auto verifySig_time_cost = utcTime() - record_time;
-        record_time = utcTime();
-
-        // import into tx pool
+        // verify the signatures in parallel and import the whole shard under one txpool lock
+        auto importResults = _txPool->batchImport(txs);
         size_t successCnt = 0;
         std::vector<dev::h256> knownTxHash;
-        for (Transaction& tx : txs)
+        for (size_t j = 0; j < txs.size(); j++)
         {
+            Transaction& tx = txs[j];
             try
             {
-                auto importResult = _txPool->import(tx);
+                auto importResult = importResults[j];
                 if (dev::eth::ImportResult::Success == importResult)
                     successCnt++;
                 else if (dev::eth::ImportResult::AlreadyKnown == importResult)
@@ -159,7 +147,6 @@ void DownloadingTxsQueue::pop2TxPool(
                         << LOG_KV("isBufferFullTimeCost", isBufferFull_time_cost)
                         << LOG_KV("constructRLPTimeCost", constructRLP_time_cost)
                         << LOG_KV("decodTimeCost", decode_time_cost)
-                        << LOG_KV("verifySigTimeCost", verifySig_time_cost)
                         << LOG_KV("importTimeCost", import_time_cost)
                         << LOG_KV("setTxKnownByTimeCost", setTxKnownBy_time_cost)
                         << LOG_KV("getPendingSizeTimeCost", getPendingSize_time_cost)
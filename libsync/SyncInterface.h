@@ -60,6 +60,9 @@ public:
     // verify handler to check downloading block
     virtual void registerConsensusVerifyHandler(
         std::function<bool(dev::eth::Block const&)> _handler) = 0;
+
+    // handler to check the downloading block ahead of execution without the chain state
+    virtual void registerBlockPreVerifyHandler(std::function<bool(dev::eth::Block const&)>) {}
 };
 
 }  // namespace sync
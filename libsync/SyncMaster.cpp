@@ -118,6 +118,8 @@ void SyncMaster::stop()
     stopWorking();
     // will not restart worker, so terminate it
     terminate();
+    m_downloadWorker->stop();
+    m_respondWorker->stop();
 }
 
 void SyncMaster::doWork()
@@ -410,59 +412,71 @@ void SyncMaster::maintainPeersStatus()
         return;  // no need to send request block packet
     }
 
-    // Sharding by c_maxRequestBlocks to request blocks
-    size_t shardNumber =
-        (maxRequestNumber - currentNumber + c_maxRequestBlocks - 1) / c_maxRequestBlocks;
-    size_t shard = 0;
+    // Stripe the range over all the peers ahead, each gets the window adapted to its speed
+    vector<shared_ptr<SyncPeerStatus>> peers;
+    int64_t windows = 0;
+    m_syncStatus->foreachPeerRandom([&](std::shared_ptr<SyncPeerStatus> _p) {
+        if (_p->noteRequestTimeout())
+        {
+            // the peers without StateDiff support drop the request
+            if (!_p->stateDiffSupported)
+                _p->noStateDiff = true;
+            SYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                            << LOG_DESC("Peer timeout, shrink the request window")
+                            << LOG_KV("peer", _p->nodeId.abridged())
+                            << LOG_KV("window", _p->requestWindow());
+        }
+        if (_p->number > currentNumber)
+        {
+            peers.push_back(_p);
+            windows += _p->requestWindow();
+        }
+        return true;
+    });
+
+    // request what the peers answer in time and the queue can hold
+    int64_t queueRoom =
+        (int64_t)c_maxDownloadingBlockQueueSize - (int64_t)m_syncStatus->bq().size();
+    int64_t requestSize =
+        min(max(windows, c_maxRequestBlocks * (int64_t)c_maxRequestShards), queueRoom);
+    int64_t requestEnd = min(maxRequestNumber, currentNumber + requestSize);
 
     m_maxRequestNumber = 0;  // each request turn has new m_maxRequestNumber
-    while (shard < shardNumber && shard < c_maxRequestShards)
+    int64_t from = currentNumber + 1;
+    size_t skipped = 0;  // peers in a row behind from
+    for (size_t i = 0; from <= requestEnd && skipped < peers.size(); i = (i + 1) % peers.size())
     {
-        bool thisTurnFound = false;
-        m_syncStatus->foreachPeerRandom([&](std::shared_ptr<SyncPeerStatus> _p) {
-            if (m_syncStatus->knownHighestNumber <= 0 ||
-                _p->number != m_syncStatus->knownHighestNumber)
-            {
-                // Only send request to nodes which are not syncing(has max number)
-                return true;
-            }
-
-            // shard: [from, to]
-            int64_t from = currentNumber + 1 + shard * c_maxRequestBlocks;
-            int64_t to = min(from + c_maxRequestBlocks - 1, maxRequestNumber);
-            if (_p->number < to)
-                return true;  // exit, to next peer
-
-            // found a peer
-            thisTurnFound = true;
-            SyncReqBlockPacket packet;
-            unsigned size = to - from + 1;
-            packet.encode(from, size);
-            m_service->asyncSendMessageByNodeID(
-                _p->nodeId, packet.toMessage(m_protocolId), CallbackFuncWithSession(), Options());
-
-            // update max request number
-            m_maxRequestNumber = max(m_maxRequestNumber, to);
+        auto const& peer = peers[i];
+        if (peer->number < from)
+        {
+            ++skipped;
+            continue;
+        }
+        skipped = 0;
 
-            SYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("Request")
-                           << LOG_DESC("Request blocks") << LOG_KV("frm", from) << LOG_KV("to", to)
-                           << LOG_KV("peer", _p->nodeId.abridged());
+        // stripe: [from, to]
+        int64_t to = min(min(from + peer->requestWindow() - 1, requestEnd), peer->number);
+        SyncReqBlockPacket packet(m_stateDiffSync && !peer->noStateDiff);
+        unsigned size = to - from + 1;
+        packet.encode(from, size);
+        m_service->asyncSendMessageByNodeID(
+            peer->nodeId, packet.toMessage(m_protocolId), CallbackFuncWithSession(), Options());
+        peer->noteRequest(size);
 
-            ++shard;  // shard move
+        // update max request number
+        m_maxRequestNumber = max(m_maxRequestNumber, to);
 
-            return shard < shardNumber && shard < c_maxRequestShards;
-        });
-
-        if (!thisTurnFound)
-        {
-            int64_t from = currentNumber + shard * c_maxRequestBlocks;
-            int64_t to = min(from + c_maxRequestBlocks - 1, maxRequestNumber);
+        SYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                       << LOG_DESC("Request blocks") << LOG_KV("frm", from) << LOG_KV("to", to)
+                       << LOG_KV("peer", peer->nodeId.abridged());
+        from = to + 1;
+    }
 
-            SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("Request")
-                              << LOG_DESC("Couldn't find any peers to request blocks")
-                              << LOG_KV("from", from) << LOG_KV("to", to);
-            break;
-        }
+    if (from <= requestEnd)
+    {
+        SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                          << LOG_DESC("Couldn't find any peers to request blocks")
+                          << LOG_KV("from", from) << LOG_KV("to", requestEnd);
     }
 }
 
@@ -478,17 +492,34 @@ bool SyncMaster::maintainDownloadingQueue()
 
     // pop block in sequence and ignore block which number is lower than currentNumber +1
     BlockPtr topBlock = bq.top();
-    while (topBlock != nullptr && topBlock->header().number() <= (m_blockChain->number() + 1))
+    // the block committed last, parent of the next one
+    BlockInfo parentBlockInfo{h256(), -1, h256()};
+    while (true)
     {
+        if (topBlock == nullptr || topBlock->header().number() > (m_blockChain->number() + 1))
+        {
+            // the next block may be being decoded
+            if (!waitDownloadingBuffer())
+            {
+                break;
+            }
+            topBlock = bq.top();
+            continue;
+        }
+        // decode the blocks received meanwhile ahead of the execution
+        asyncFlushDownloadingBuffer();
         try
         {
             if (isNextBlock(topBlock))
             {
                 auto record_time = utcTime();
-                auto parentBlock =
-                    m_blockChain->getBlockByNumber(topBlock->blockHeader().number() - 1);
-                BlockInfo parentBlockInfo{parentBlock->header().hash(),
-                    parentBlock->header().number(), parentBlock->header().stateRoot()};
+                if (parentBlockInfo.number != topBlock->blockHeader().number() - 1)
+                {
+                    auto parentBlock =
+                        m_blockChain->getBlockByNumber(topBlock->blockHeader().number() - 1);
+                    parentBlockInfo = BlockInfo{parentBlock->header().hash(),
+                        parentBlock->header().number(), parentBlock->header().stateRoot()};
+                }
                 auto getBlockByNumber_time_cost = utcTime() - record_time;
                 record_time = utcTime();
                 SYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
@@ -496,8 +527,11 @@ bool SyncMaster::maintainDownloadingQueue()
                                << LOG_KV("number", topBlock->header().number())
                                << LOG_KV("txs", topBlock->transactions().size())
                                << LOG_KV("hash", topBlock->headerHash().abridged());
-                ExecutiveContext::Ptr exeCtx =
-                    m_blockVerifier->executeBlock(*topBlock, parentBlockInfo);
+                ExecutiveContext::Ptr exeCtx = applyStateDiff(topBlock, parentBlockInfo);
+                if (exeCtx == nullptr)
+                {
+                    exeCtx = m_blockVerifier->executeBlock(*topBlock, parentBlockInfo);
+                }
 
                 if (exeCtx == nullptr)
                 {
@@ -514,6 +548,10 @@ bool SyncMaster::maintainDownloadingQueue()
                 record_time = utcTime();
                 if (ret == CommitResult::OK)
                 {
+                    parentBlockInfo = BlockInfo{topBlock->header().hash(),
+                        topBlock->header().number(), topBlock->header().stateRoot()};
+                    m_syncedBlocks++;
+                    m_syncedTxs += topBlock->transactions().size();
                     m_txPool->dropBlockTrans(*topBlock);
                     auto dropBlockTrans_time_cost = utcTime() - record_time;
                     SYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
@@ -556,7 +594,7 @@ bool SyncMaster::maintainDownloadingQueue()
         bq.pop();
         topBlock = bq.top();
     }
-
+    reportSyncSpeed(false);
 
     currentNumber = m_blockChain->number();
     // has this request turn finished ?
@@ -572,6 +610,7 @@ bool SyncMaster::maintainDownloadingQueue()
                        << LOG_DESC("Download finish") << LOG_KV("latestHash", latestHash.abridged())
                        << LOG_KV("expectedHash", m_syncStatus->knownLatestHash.abridged());
 
+        reportSyncSpeed(true);
         if (m_syncStatus->knownLatestHash != latestHash)
             SYNC_LOG(ERROR)
                 << LOG_BADGE("Download")
@@ -674,37 +713,163 @@ void SyncMaster::maintainPeersConnection()
     m_needSendStatus = hasMyself;
 }
 
+ExecutiveContext::Ptr SyncMaster::applyStateDiff(
+    BlockPtr _block, BlockInfo const& _parentBlockInfo)
+{
+    auto stateDiff = m_syncStatus->bq().stateDiff(_block->headerHash());
+    if (!stateDiff)
+    {
+        return nullptr;
+    }
+    try
+    {
+        return m_blockVerifier->applyStateDiff(*_block, _parentBlockInfo, ref(*stateDiff));
+    }
+    catch (exception& e)
+    {
+        // the block is executed instead
+        SYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                          << LOG_DESC("Apply StateDiff failed")
+                          << LOG_KV("number", _block->header().number())
+                          << LOG_KV("hash", _block->headerHash().abridged())
+                          << LOG_KV("reason", e.what());
+    }
+    return nullptr;
+}
+
 void SyncMaster::maintainDownloadingQueueBuffer()
 {
     if (m_syncStatus->state == SyncState::Downloading)
     {
         m_syncStatus->bq().clearFullQueueIfNotHas(m_blockChain->number() + 1);
-        m_syncStatus->bq().flushBufferToQueue();
+        asyncFlushDownloadingBuffer();
     }
     else
         m_syncStatus->bq().clear();
 }
 
+void SyncMaster::asyncFlushDownloadingBuffer()
+{
+    // one flush at a time, the packets received meanwhile are flushed by the next one
+    if (m_flushResult.valid() &&
+        m_flushResult.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+    {
+        return;
+    }
+    if (m_syncStatus->bq().bufferEmpty())
+    {
+        return;
+    }
+    auto flushed = make_shared<promise<void>>();
+    m_flushResult = flushed->get_future().share();
+    auto syncStatus = m_syncStatus;
+    m_downloadWorker->enqueue([this, syncStatus, flushed]() {
+        try
+        {
+            syncStatus->bq().flushBufferToQueue();
+        }
+        catch (std::exception const& e)
+        {
+            SYNC_LOG(ERROR) << LOG_BADGE("Download") << LOG_DESC("Flush downloading buffer failed")
+                            << LOG_KV("EINFO", boost::diagnostic_information(e));
+        }
+        flushed->set_value();
+        // wake up the sync thread to execute the blocks
+        m_signalled.notify_all();
+    });
+}
+
+bool SyncMaster::waitDownloadingBuffer()
+{
+    if (!m_flushResult.valid())
+    {
+        return false;
+    }
+    m_flushResult.wait();
+    m_flushResult = shared_future<void>();
+    return true;
+}
+
+void SyncMaster::reportSyncSpeed(bool _force)
+{
+    auto now = utcTime();
+    auto timeCost = now - m_syncSpeedTime;
+    if (m_syncedBlocks == 0 || (!_force && timeCost < c_syncSpeedReportInterval))
+    {
+        return;
+    }
+    auto seconds = max<uint64_t>(timeCost, 1) / 1000.0;
+    SYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("BlockSync") << LOG_DESC("Sync speed")
+                   << LOG_KV("blocks", m_syncedBlocks) << LOG_KV("txs", m_syncedTxs)
+                   << LOG_KV("timeCost", timeCost)
+                   << LOG_KV("blocksPerSecond", m_syncedBlocks / seconds)
+                   << LOG_KV("txsPerSecond", m_syncedTxs / seconds)
+                   << LOG_KV("currentNumber", m_blockChain->number())
+                   << LOG_KV("knownHighestNumber", m_syncStatus->knownHighestNumber);
+    m_syncedBlocks = 0;
+    m_syncedTxs = 0;
+    m_syncSpeedTime = now;
+}
+
 void SyncMaster::maintainBlockRequest()
 {
     uint64_t timeout = utcTime() + c_respondDownloadRequestTimeout;
+    vector<shared_ptr<SyncPeerStatus>> peers;
     m_syncStatus->foreachPeerRandom([&](std::shared_ptr<SyncPeerStatus> _p) {
-        DownloadRequestQueue& reqQueue = _p->reqQueue;
-        if (reqQueue.empty())
-            return true;  // no need to respeond
+        if (!_p->reqQueue.empty())
+            peers.push_back(_p);
+        return true;
+    });
+    if (peers.size() <= 1)
+    {
+        for (auto const& peer : peers)
+            respondBlockRequest(peer, timeout);
+        return;
+    }
 
-        // Just select one peer per maintain
-        reqQueue.disablePush();  // drop push at this time
-        DownloadBlocksContainer blockContainer(m_service, m_protocolId, _p->nodeId);
+    // answer the peers concurrently, all within the timeout of this maintain
+    vector<future<void>> responds;
+    for (auto const& peer : peers)
+    {
+        auto responded = make_shared<promise<void>>();
+        responds.push_back(responded->get_future());
+        m_respondWorker->enqueue([this, peer, timeout, responded]() {
+            try
+            {
+                respondBlockRequest(peer, timeout);
+            }
+            catch (std::exception const& e)
+            {
+                SYNC_LOG(ERROR) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                                << LOG_DESC("Respond block request failed")
+                                << LOG_KV("peer", peer->nodeId.abridged())
+                                << LOG_KV("EINFO", boost::diagnostic_information(e));
+            }
+            responded->set_value();
+        });
+    }
+    for (auto& responded : responds)
+        responded.wait();
+}
 
-        while (!reqQueue.empty() && utcTime() <= timeout)
+void SyncMaster::respondBlockRequest(shared_ptr<SyncPeerStatus> _p, uint64_t _timeout)
+{
+    DownloadRequestQueue& reqQueue = _p->reqQueue;
+    reqQueue.disablePush();  // drop push at this time
+    bool withStateDiff = _p->wantStateDiff;
+    DownloadBlocksContainer blockContainer(m_service, m_protocolId, _p->nodeId, withStateDiff);
+
+    DownloadRequest unsent(0, 0);
+    try
+    {
+        while (!reqQueue.empty() && utcTime() <= _timeout)
         {
             DownloadRequest req = reqQueue.topAndPop();
             int64_t number = req.fromNumber;
             int64_t numberLimit = req.fromNumber + req.size;
 
             // Send block at sequence
-            for (; number < numberLimit && utcTime() <= timeout; number++)
+            for (; number < numberLimit && utcTime() <= _timeout; number++)
             {
                 auto start_get_block_time = utcTime();
                 shared_ptr<bytes> blockRLP = m_blockChain->getBlockRLPByNumber(number);
@@ -722,25 +887,41 @@ void SyncMaster::maintainBlockRequest()
                                 << LOG_BADGE("BlockSync") << LOG_DESC("Batch blocks for sending")
                                 << LOG_KV("number", number) << LOG_KV("peer", _p->nodeId.abridged())
                                 << LOG_KV("timeCost", utcTime() - start_get_block_time);
-                blockContainer.batchAndSend(blockRLP);
+                if (withStateDiff)
+                {
+                    blockContainer.batchAndSend(
+                        blockRLP, m_blockChain->getStateDiffByNumber(number));
+                }
+                else
+                {
+                    blockContainer.batchAndSend(blockRLP);
+                }
             }
 
             if (number < numberLimit)  // This respond not reach the end due to timeout
             {
-                // write back the rest request range
-                reqQueue.enablePush();
-                SYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("Request")
-                                << LOG_DESC("Push unsent requests back to reqQueue")
-                                << LOG_KV("from", number) << LOG_KV("to", numberLimit - 1)
-                                << LOG_KV("peer", _p->nodeId.abridged());
-                reqQueue.push(number, numberLimit - number);
-                return false;
+                unsent = DownloadRequest(number, numberLimit - number);
+                break;
             }
         }
-
+    }
+    catch (...)
+    {
         reqQueue.enablePush();
-        return false;
-    });
+        throw;
+    }
+    reqQueue.enablePush();
+
+    if (unsent.size > 0)
+    {
+        // write back the rest request range
+        SYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                        << LOG_DESC("Push unsent requests back to reqQueue")
+                        << LOG_KV("from", unsent.fromNumber)
+                        << LOG_KV("to", unsent.fromNumber + unsent.size - 1)
+                        << LOG_KV("peer", _p->nodeId.abridged());
+        reqQueue.push(unsent.fromNumber, unsent.size);
+    }
 }
 
 bool SyncMaster::isNextBlock(BlockPtr _block)
@@ -30,6 +30,7 @@
 #include <libblockchain/BlockChainInterface.h>
 #include <libblockverifier/BlockVerifierInterface.h>
 #include <libdevcore/FixedHash.h>
+#include <libdevcore/ThreadPool.h>
 #include <libdevcore/Worker.h>
 #include <libethcore/Common.h>
 #include <libethcore/Exceptions.h>
@@ -37,6 +38,7 @@
 #include <libnetwork/Session.h>
 #include <libp2p/P2PInterface.h>
 #include <libtxpool/TxPoolInterface.h>
+#include <future>
 #include <vector>
 
 
@@ -67,6 +69,10 @@ public:
     {
         m_syncStatus =
             std::make_shared<SyncMasterStatus>(_blockChain, _protocolId, _genesisHash, _nodeId);
+        m_downloadWorker =
+            std::make_shared<dev::ThreadPool>("SyncDecode-" + std::to_string(m_groupId), 1);
+        m_respondWorker = std::make_shared<dev::ThreadPool>(
+            "SyncRespond-" + std::to_string(m_groupId), c_maxRespondThreads);
         m_msgEngine = std::make_shared<SyncMsgEngine>(_service, _txPool, _blockChain, m_syncStatus,
             m_txQueue, _protocolId, _nodeId, _genesisHash);
 
@@ -110,6 +116,15 @@ public:
         fp_isConsensusOk = _handler;
     };
 
+    void registerBlockPreVerifyHandler(
+        std::function<bool(dev::eth::Block const&)> _handler) override
+    {
+        m_syncStatus->bq().registerPreVerifyHandler(_handler);
+    }
+
+    /// ask the peers for the StateDiffs of the blocks and apply them instead of executing
+    void setStateDiffSync(bool _stateDiffSync) { m_stateDiffSync = _stateDiffSync; }
+
     void noteNewTransactions()
     {
         m_newTransactions = true;
@@ -125,7 +140,12 @@ public:
     void noteDownloadingBegin()
     {
         if (m_syncStatus->state == SyncState::Idle)
+        {
             m_syncStatus->state = SyncState::Downloading;
+            m_syncedBlocks = 0;
+            m_syncedTxs = 0;
+            m_syncSpeedTime = utcTime();
+        }
     }
 
     void noteDownloadingFinish()
@@ -185,6 +205,7 @@ private:
     uint64_t m_maintainBlocksTimeout = 0;
     bool m_needMaintainTransactions = false;
     bool m_needSendStatus = true;
+    bool m_stateDiffSync = false;
 
     // settings
     dev::eth::Handler<> m_tqReady;
@@ -193,6 +214,17 @@ private:
     // verify handler to check downloading block
     std::function<bool(dev::eth::Block const&)> fp_isConsensusOk = nullptr;
 
+    /// decode the downloaded blocks while the sync thread executes the decoded ones
+    std::shared_ptr<dev::ThreadPool> m_downloadWorker;
+    std::shared_future<void> m_flushResult;
+    /// answer the block requests of the peers concurrently
+    std::shared_ptr<dev::ThreadPool> m_respondWorker;
+
+    /// the blocks and transactions synced since m_syncSpeedTime
+    int64_t m_syncedBlocks = 0;
+    size_t m_syncedTxs = 0;
+    uint64_t m_syncSpeedTime = 0;
+
 public:
     void maintainTransactions();
     void maintainDownloadingTransactions();
@@ -206,6 +238,14 @@ public:
 private:
     bool isNextBlock(BlockPtr _block);
     void printSyncInfo();
+    void asyncFlushDownloadingBuffer();
+    /// wait for the blocks being decoded, return false if no block is being decoded
+    bool waitDownloadingBuffer();
+    void reportSyncSpeed(bool _force);
+    void respondBlockRequest(std::shared_ptr<SyncPeerStatus> _p, uint64_t _timeout);
+    /// return nullptr if the block has no valid StateDiff, then it is executed
+    dev::blockverifier::ExecutiveContext::Ptr applyStateDiff(
+        BlockPtr _block, dev::blockverifier::BlockInfo const& _parentBlockInfo);
 };
 
 }  // namespace sync
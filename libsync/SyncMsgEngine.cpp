@@ -57,8 +57,8 @@ void SyncMsgEngine::messageHandler(
         SYNC_ENGINE_LOG(WARNING) << LOG_BADGE("Rcv") << LOG_BADGE("Packet")
                                  << LOG_DESC("Reject packet") << LOG_KV("reason", "decode failed")
                                  << LOG_KV("nodeId", _session->nodeID().abridged())
-                                 << LOG_KV("size", _msg->buffer()->size())
-                                 << LOG_KV("message", toHex(*_msg->buffer()));
+                                 << LOG_KV("size", _msg->payload().size())
+                                 << LOG_KV("message", toHex(_msg->payload()));
         return;
     }
 
@@ -81,7 +81,7 @@ bool SyncMsgEngine::checkSession(std::shared_ptr<dev::p2p::P2PSession> _session)
 
 bool SyncMsgEngine::checkMessage(P2PMessage::Ptr _msg)
 {
-    bytesConstRef msgBytes = ref(*_msg->buffer());
+    bytesConstRef msgBytes = _msg->payload();
     if (msgBytes.size() < 2 || msgBytes[0] > 0x7f)
         return false;
     if (RLP(msgBytes.cropped(1)).actualSize() + 1 != msgBytes.size())
@@ -110,9 +110,11 @@ bool SyncMsgEngine::interpret(SyncMsgPacket const& _packet)
             onPeerTransactions(_packet);
             break;
         case BlocksPacket:
+        case StateDiffBlocksPacket:
             onPeerBlocks(_packet);
             break;
         case ReqBlocskPacket:
+        case ReqStateDiffBlocksPacket:
             onPeerRequestBlocks(_packet);
             break;
         default:
@@ -213,7 +215,14 @@ void SyncMsgEngine::onPeerBlocks(SyncMsgPacket const& _packet)
                            << LOG_DESC("Receive peer block packet")
                            << LOG_KV("packetSize(B)", rlps.data().size());
 
-    m_syncStatus->bq().push(rlps);
+    // adapt the request window of the peer
+    shared_ptr<SyncPeerStatus> status = m_syncStatus->peerStatus(_packet.nodeId);
+    if (status && rlps.isList())
+        status->noteResponse(rlps.itemCount(), rlps.data().size());
+    if (status && _packet.packetType == StateDiffBlocksPacket)
+        status->stateDiffSupported = true;
+
+    m_syncStatus->bq().push(rlps, _packet.packetType == StateDiffBlocksPacket);
 }
 
 void SyncMsgEngine::onPeerRequestBlocks(SyncMsgPacket const& _packet)
@@ -247,7 +256,10 @@ void SyncMsgEngine::onPeerRequestBlocks(SyncMsgPacket const& _packet)
 
     auto peerStatus = m_syncStatus->peerStatus(_packet.nodeId);
     if (peerStatus != nullptr && peerStatus)
+    {
+        peerStatus->wantStateDiff = _packet.packetType == ReqStateDiffBlocksPacket;
         peerStatus->reqQueue.push(from, (int64_t)size);
+    }
 }
 
 void DownloadBlocksContainer::batchAndSend(BlockPtr _block)
@@ -260,22 +272,41 @@ void DownloadBlocksContainer::batchAndSend(BlockPtr _block)
 
 void DownloadBlocksContainer::batchAndSend(std::shared_ptr<dev::bytes> _blockRLP)
 {
+    if (m_withStateDiff)
+    {
+        batchAndSend(_blockRLP, nullptr);
+        return;
+    }
+
     // TODO: thread safe
-    bytes& blockRLP = *_blockRLP;
+    size_t blockSize = _blockRLP->size();
 
-    if (blockRLP.size() > c_maxPayload)
+    if (blockSize > c_maxPayload)
     {
-        sendBigBlock(blockRLP);
+        sendBigBlock(*_blockRLP);
         return;
     }
 
     // Clear and send batch if full
-    if (m_currentBatchSize + blockRLP.size() > c_maxPayload)
+    if (m_currentBatchSize + blockSize > c_maxPayload)
         clearBatchAndSend();
 
     // emplace back block in batch
-    m_blockRLPsBatch.emplace_back(blockRLP);
-    m_currentBatchSize += blockRLP.size();
+    m_blockRLPsBatch.emplace_back(_blockRLP);
+    m_currentBatchSize += blockSize;
+}
+
+void DownloadBlocksContainer::batchAndSend(
+    std::shared_ptr<dev::bytes> _blockRLP, std::shared_ptr<dev::bytes> _stateDiff)
+{
+    // the block is sent with its StateDiff even if they exceed the payload together
+    size_t blockSize = _blockRLP->size() + (_stateDiff ? _stateDiff->size() : 0);
+    if (m_currentBatchSize > 0 && m_currentBatchSize + blockSize > c_maxPayload)
+        clearBatchAndSend();
+
+    m_blockRLPsBatch.emplace_back(_blockRLP);
+    m_stateDiffsBatch.emplace_back(_stateDiff);
+    m_currentBatchSize += blockSize;
 }
 
 void DownloadBlocksContainer::clearBatchAndSend()
@@ -285,7 +316,10 @@ void DownloadBlocksContainer::clearBatchAndSend()
         return;
 
     SyncBlocksPacket retPacket;
-    retPacket.encode(m_blockRLPsBatch);
+    if (m_withStateDiff)
+        retPacket.encode(m_blockRLPsBatch, m_stateDiffsBatch);
+    else
+        retPacket.encode(m_blockRLPsBatch);
 
     auto msg = retPacket.toMessage(m_protocolId);
     m_service->asyncSendMessageByNodeID(m_nodeId, msg, CallbackFuncWithSession(), Options());
@@ -295,6 +329,7 @@ void DownloadBlocksContainer::clearBatchAndSend()
                           << LOG_KV("bytes(V)", msg->buffer()->size());
 
     m_blockRLPsBatch.clear();
+    m_stateDiffsBatch.clear();
     m_currentBatchSize = 0;
 }
 
@@ -96,9 +96,13 @@ private:
 class DownloadBlocksContainer
 {
 public:
-    DownloadBlocksContainer(
-        std::shared_ptr<dev::p2p::P2PInterface> _service, PROTOCOL_ID _protocolId, NodeID _nodeId)
-      : m_service(_service), m_protocolId(_protocolId), m_nodeId(_nodeId), m_blockRLPsBatch()
+    DownloadBlocksContainer(std::shared_ptr<dev::p2p::P2PInterface> _service,
+        PROTOCOL_ID _protocolId, NodeID _nodeId, bool _withStateDiff = false)
+      : m_service(_service),
+        m_protocolId(_protocolId),
+        m_nodeId(_nodeId),
+        m_withStateDiff(_withStateDiff),
+        m_blockRLPsBatch()
     {
         m_groupId = dev::eth::getGroupAndProtocol(_protocolId).first;
     }
@@ -106,6 +110,8 @@ public:
 
     void batchAndSend(BlockPtr _block);
     void batchAndSend(std::shared_ptr<bytes> _blockRLP);
+    /// only for the container created _withStateDiff, _stateDiff can be nullptr
+    void batchAndSend(std::shared_ptr<bytes> _blockRLP, std::shared_ptr<bytes> _stateDiff);
 
 private:
     void clearBatchAndSend();
@@ -116,7 +122,10 @@ private:
     PROTOCOL_ID m_protocolId;
     GROUP_ID m_groupId;
     NodeID m_nodeId;
-    std::vector<dev::bytes> m_blockRLPsBatch;
+    bool m_withStateDiff;
+    /// the RLPs shared with the block cache, copied only when encoded
+    std::vector<std::shared_ptr<dev::bytes>> m_blockRLPsBatch;
+    std::vector<std::shared_ptr<dev::bytes>> m_stateDiffsBatch;
     size_t m_currentBatchSize = 0;
 };
 
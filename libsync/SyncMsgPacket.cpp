@@ -37,7 +37,7 @@ bool SyncMsgPacket::decode(
     if (_msg == nullptr)
         return false;
 
-    bytesConstRef frame = ref(*(_msg->buffer()));
+    bytesConstRef frame = _msg->payload();
     if (!checkPacket(frame))
         return false;
 
@@ -113,6 +113,32 @@ void SyncBlocksPacket::encode(std::vector<dev::bytes> const& _blockRLPs)
         m_rlpStream.append(bs);
 }
 
+void SyncBlocksPacket::encode(std::vector<std::shared_ptr<dev::bytes>> const& _blockRLPs)
+{
+    m_rlpStream.clear();
+    unsigned size = _blockRLPs.size();
+    prep(m_rlpStream, BlocksPacket, size);
+    for (auto const& bs : _blockRLPs)
+        m_rlpStream.append(*bs);
+}
+
+void SyncBlocksPacket::encode(std::vector<std::shared_ptr<dev::bytes>> const& _blockRLPs,
+    std::vector<std::shared_ptr<dev::bytes>> const& _stateDiffs)
+{
+    packetType = StateDiffBlocksPacket;
+    m_rlpStream.clear();
+    unsigned size = _blockRLPs.size();
+    prep(m_rlpStream, StateDiffBlocksPacket, size);
+    for (size_t i = 0; i < _blockRLPs.size(); i++)
+    {
+        m_rlpStream.appendList(2).append(*_blockRLPs[i]);
+        if (_stateDiffs[i])
+            m_rlpStream.append(*_stateDiffs[i]);
+        else
+            m_rlpStream.append(bytesConstRef());
+    }
+}
+
 void SyncBlocksPacket::singleEncode(dev::bytes const& _blockRLP)
 {
     m_rlpStream.clear();
@@ -123,5 +149,5 @@ void SyncBlocksPacket::singleEncode(dev::bytes const& _blockRLP)
 void SyncReqBlockPacket::encode(int64_t _from, unsigned _size)
 {
     m_rlpStream.clear();
-    prep(m_rlpStream, ReqBlocskPacket, 2) << _from << _size;
+    prep(m_rlpStream, packetType, 2) << _from << _size;
 }
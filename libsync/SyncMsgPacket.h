@@ -98,13 +98,20 @@ class SyncBlocksPacket : public SyncMsgPacket
 public:
     SyncBlocksPacket() { packetType = BlocksPacket; }
     void encode(std::vector<dev::bytes> const& _blockRLPs);
+    void encode(std::vector<std::shared_ptr<dev::bytes>> const& _blockRLPs);
+    /// a StateDiffBlocksPacket of [block, StateDiff] items, the StateDiff is empty if not recorded
+    void encode(std::vector<std::shared_ptr<dev::bytes>> const& _blockRLPs,
+        std::vector<std::shared_ptr<dev::bytes>> const& _stateDiffs);
     void singleEncode(dev::bytes const& _blockRLP);
 };
 
 class SyncReqBlockPacket : public SyncMsgPacket
 {
 public:
-    SyncReqBlockPacket() { packetType = ReqBlocskPacket; }
+    SyncReqBlockPacket(bool _withStateDiff = false)
+    {
+        packetType = _withStateDiff ? ReqStateDiffBlocksPacket : ReqBlocskPacket;
+    }
     void encode(int64_t _from, unsigned _size);
 };
 
@@ -31,6 +31,56 @@ using namespace dev::p2p;
 using namespace dev::blockchain;
 using namespace dev::txpool;
 
+void SyncPeerStatus::noteRequest(int64_t _blocks)
+{
+    Guard l(x_request);
+    if (m_requestedBlocks == 0)
+    {
+        m_requestTime = utcTime();
+        m_receivedBlocks = 0;
+        m_receivedBytes = 0;
+    }
+    m_requestedBlocks += _blocks;
+}
+
+void SyncPeerStatus::noteResponse(size_t _blocks, size_t _bytes)
+{
+    Guard l(x_request);
+    if (m_requestedBlocks == 0)
+    {
+        return;  // not requested by the downloading
+    }
+    m_receivedBlocks += _blocks;
+    m_receivedBytes += _bytes;
+    if (m_receivedBlocks < m_requestedBlocks)
+    {
+        return;
+    }
+    // the blocks the peer can answer in c_peerRequestTargetTime at the observed speed
+    uint64_t timeCost = max<uint64_t>(utcTime() - m_requestTime, 1);
+    int64_t expected = m_receivedBlocks * (int64_t)c_peerRequestTargetTime / (int64_t)timeCost;
+    m_requestWindow = min(
+        max((m_requestWindow + expected) / 2, c_minPeerRequestBlocks), c_maxPeerRequestBlocks);
+    LOG(DEBUG) << LOG_BADGE("SYNC") << LOG_BADGE("Download")
+               << LOG_DESC("Peer answered the requested blocks")
+               << LOG_KV("peer", nodeId.abridged()) << LOG_KV("blocks", m_receivedBlocks)
+               << LOG_KV("bytesPerSecond", m_receivedBytes * 1000 / timeCost)
+               << LOG_KV("timeCost", timeCost) << LOG_KV("window", m_requestWindow);
+    m_requestedBlocks = 0;
+}
+
+bool SyncPeerStatus::noteRequestTimeout()
+{
+    Guard l(x_request);
+    if (m_requestedBlocks == 0)
+    {
+        return false;
+    }
+    m_requestWindow = max(m_requestWindow / 2, c_minPeerRequestBlocks);
+    m_requestedBlocks = 0;
+    return true;
+}
+
 bool SyncMasterStatus::hasPeer(NodeID const& _id)
 {
     ReadGuard l(x_peerStatus);
@@ -31,6 +31,7 @@
 #include <libnetwork/Session.h>
 #include <libp2p/P2PInterface.h>
 #include <libtxpool/TxPoolInterface.h>
+#include <atomic>
 #include <map>
 #include <queue>
 #include <set>
@@ -77,6 +78,23 @@ public:
         latestHash = _info.latestHash;
     }
 
+    /// the blocks to request from the peer at a time
+    int64_t requestWindow() const
+    {
+        Guard l(x_request);
+        return m_requestWindow;
+    }
+
+    /// note the blocks requested from the peer
+    void noteRequest(int64_t _blocks);
+
+    /// note the blocks received from the peer, the window is adapted to the time the peer takes
+    /// to answer all the requested blocks
+    void noteResponse(size_t _blocks, size_t _bytes);
+
+    /// shrink the window if the peer has not answered the blocks requested last turn
+    bool noteRequestTimeout();
+
 public:
     NodeID nodeId;
     int64_t number;
@@ -84,6 +102,20 @@ public:
     h256 latestHash;
     DownloadRequestQueue reqQueue;
     bool isSealer = false;
+    /// the peer asks for the blocks with their StateDiffs
+    std::atomic_bool wantStateDiff = {false};
+    /// the peer has answered a StateDiff request
+    std::atomic_bool stateDiffSupported = {false};
+    /// the peer has not answered any StateDiff request in time, ask it for the blocks only
+    std::atomic_bool noStateDiff = {false};
+
+private:
+    mutable Mutex x_request;
+    int64_t m_requestWindow = c_maxRequestBlocks;
+    int64_t m_requestedBlocks = 0;
+    int64_t m_receivedBlocks = 0;
+    size_t m_receivedBytes = 0;
+    uint64_t m_requestTime = 0;
 };
 
 class SyncMasterStatus
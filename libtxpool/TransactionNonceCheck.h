@@ -51,6 +51,8 @@ public:
     bool ok(dev::eth::Transaction const& _transaction, bool _needinsert = false);
     void updateCache(bool _rebuild = false);
     unsigned const& maxBlockLimit() const { return m_maxBlockLimit; }
+    /// block number of the last updateCache
+    int64_t blockNumber() const { return m_blockNumber; }
     void setBlockLimit(unsigned const& limit) { m_maxBlockLimit = limit; }
 
     bool isBlockLimitOk(dev::eth::Transaction const& _trans);
@@ -121,37 +121,62 @@ ImportResult TxPool::import(bytesConstRef _txBytes, IfDropped _ik)
  * @param _ik : Set to Retry to force re-addinga transaction that was previously dropped.
  * @return ImportResult : Import result code.
  */
-ImportResult TxPool::import(Transaction& _tx, IfDropped)
+ImportResult TxPool::import(Transaction& _tx, IfDropped _ik)
 {
     _tx.setImportTime(u256(utcTime()));
-    UpgradableGuard l(m_lock);
-    /// check the txpool size
-    if (m_txsQueue.size() >= m_limit)
+    /// recover the sender before taking the lock, concurrent imports verify in parallel
+    ImportResult verify_ret = preVerify(_tx, _ik);
+    if (verify_ret != ImportResult::Success)
+        return verify_ret;
     {
-        auto callback = _tx.rpcCallback();
-        if (callback)
-        {
-            dev::eth::LocalisedTransactionReceipt::Ptr receipt =
-                std::make_shared<dev::eth::LocalisedTransactionReceipt>(
-                    executive::TransactionException::TxPoolIsFull);
-
-            m_callbackPool.enqueue([callback, receipt] { callback(receipt, bytes()); });
-        }
-
-        return ImportResult::TransactionPoolIsFull;
+        WriteGuard l(m_lock);
+        verify_ret = insertVerified(_tx, _ik);
     }
-    /// check the verify result(nonce && signature check)
-    ImportResult verify_ret = verify(_tx);
     if (verify_ret == ImportResult::Success)
+        m_onReady();
+    return verify_ret;
+}
+
+/**
+ * @brief : Verify a batch of transactions and add the valid ones to the queue.
+ *          Stage one recovers the senders in parallel without holding m_lock,
+ *          stage two inserts all pre-verified transactions under one lock acquisition.
+ *
+ * @param _txs : Transactions to import, the sender of each one is recovered in place.
+ * @param _ik : Set to Retry to force re-addinga transaction that was previously dropped.
+ * @return std::vector<ImportResult> : Import result code of each transaction.
+ */
+std::vector<ImportResult> TxPool::batchImport(Transactions& _txs, IfDropped _ik)
+{
+    std::vector<ImportResult> results(_txs.size());
+    /// keep the batch order in the queue
+    auto importTime = u256(utcTime());
+    for (auto& tx : _txs)
+        tx.setImportTime(importTime);
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, _txs.size()), [&](const tbb::blocked_range<size_t>& _r) {
+            for (size_t i = _r.begin(); i != _r.end(); i++)
+            {
+                results[i] = preVerify(_txs[i], _ik);
+            }
+        });
+
+    size_t importedTxs = 0;
     {
-        UpgradeGuard ul(l);
-        if (insert(_tx))
+        WriteGuard l(m_lock);
+        for (size_t i = 0; i < _txs.size(); i++)
         {
-            m_commonNonceCheck->insertCache(_tx);
-            m_onReady();
+            if (results[i] != ImportResult::Success)
+                continue;
+            results[i] = insertVerified(_txs[i], _ik);
+            if (results[i] == ImportResult::Success)
+                importedTxs++;
         }
     }
-    return verify_ret;
+    if (importedTxs > 0)
+        m_onReady();
+    return results;
 }
 
 void TxPool::verifyAndSetSenderForBlock(dev::eth::Block& block)
@@ -164,13 +189,17 @@ void TxPool::verifyAndSetSenderForBlock(dev::eth::Block& block)
                 h256 txHash = block.transactions()[i].sha3();
 
                 /// force sender for the transaction
-                ReadGuard l(m_lock);
-                auto p_tx = m_txsHash.find(txHash);
-                l.unlock();
+                ConstTransactionPtr pooledTx;
+                {
+                    ReadGuard l(m_lock);
+                    auto p_tx = m_txsHash.find(txHash);
+                    if (p_tx != m_txsHash.end())
+                        pooledTx = p_tx->second.queueIt->second;
+                }
 
-                if (p_tx != m_txsHash.end())
+                if (pooledTx)
                 {
-                    block.setSenderForTransaction(i, p_tx->second->sender());
+                    block.setSenderForTransaction(i, pooledTx->sender());
                 }
                 /// verify the transaction
                 else
@@ -181,6 +210,21 @@ void TxPool::verifyAndSetSenderForBlock(dev::eth::Block& block)
         });
 }
 
+dev::eth::ConstTransactions TxPool::transactionViews(dev::h256s const& _txHashes)
+{
+    ConstTransactions ret(_txHashes.size());
+    ReadGuard l(m_lock);
+    for (size_t i = 0; i < _txHashes.size(); i++)
+    {
+        auto p_tx = m_txsHash.find(_txHashes[i]);
+        if (p_tx != m_txsHash.end())
+        {
+            ret[i] = p_tx->second.queueIt->second;
+        }
+    }
+    return ret;
+}
+
 bool TxPool::txExists(dev::h256 const& txHash)
 {
     ReadGuard l(m_lock);
@@ -195,36 +239,81 @@ bool TxPool::txExists(dev::h256 const& txHash)
 }
 
 /**
- * @brief : verify specified transaction, including:
- *  1. whether the transaction is known (refuse repeated transaction)
- *  2. check nonce
- *  3. check block limit
- *  4. check chainId and groupId
- *  TODO: check transaction filter
- *
- * @param trans : the transaction to be verified
- * @param _drop_policy : Import transaction policy
- * @return ImportResult : import result
+ * @brief : check whether the transaction is already in the queue or has been dropped,
+ *          m_lock must be held
  */
-ImportResult TxPool::verify(Transaction& trans, IfDropped _drop_policy, bool _needinsert)
+ImportResult TxPool::checkKnown(h256 const& _txHash, IfDropped _ik) const
 {
     /// check whether this transaction has been existed
-    h256 tx_hash = trans.sha3();
-    if (m_txsHash.find(tx_hash) != m_txsHash.end())
+    if (m_txsHash.find(_txHash) != m_txsHash.end())
     {
         TXPOOL_LOG(TRACE) << LOG_DESC("Verify: already known tx")
-                          << LOG_KV("hash", tx_hash.abridged());
+                          << LOG_KV("hash", _txHash.abridged());
         return ImportResult::AlreadyKnown;
     }
     /// the transaction has been dropped before
-    if (m_dropped.count(tx_hash) && _drop_policy == IfDropped::Ignore)
+    if (m_dropped.count(_txHash) && _ik == IfDropped::Ignore)
     {
         TXPOOL_LOG(TRACE) << LOG_DESC("Verify: already dropped tx: ")
-                          << LOG_KV("hash", tx_hash.abridged());
+                          << LOG_KV("hash", _txHash.abridged());
         return ImportResult::AlreadyInChain;
     }
+    return ImportResult::Success;
+}
+
+/**
+ * @brief : refuse the transaction when the txpool is full and notify its rpc callback,
+ *          m_lock must be held
+ */
+ImportResult TxPool::checkCapacity(Transaction const& _tx)
+{
+    if (m_txsQueue.size() >= m_limit)
+    {
+        auto callback = _tx.rpcCallback();
+        if (callback)
+        {
+            dev::eth::LocalisedTransactionReceipt::Ptr receipt =
+                std::make_shared<dev::eth::LocalisedTransactionReceipt>(
+                    executive::TransactionException::TxPoolIsFull);
+
+            m_callbackPool.enqueue([callback, receipt] { callback(receipt, bytes()); });
+        }
+
+        return ImportResult::TransactionPoolIsFull;
+    }
+    return ImportResult::Success;
+}
+
+/**
+ * @brief : verify specified transaction without holding m_lock, including:
+ *  1. check the txpool size (refuse transactions before the signature check if full)
+ *  2. whether the transaction is known (refuse repeated transaction)
+ *  3. check nonce
+ *  4. check block limit
+ *  5. check signature
+ *  6. check chainId and groupId
+ *  TODO: check transaction filter
+ *
+ * @param trans : the transaction to be verified
+ * @param _drop_policy : Import transaction policy
+ * @return ImportResult : import result
+ */
+ImportResult TxPool::preVerify(Transaction& trans, IfDropped _drop_policy)
+{
+    h256 tx_hash = trans.sha3();
+    {
+        /// skip the signature check when the pool is full or the transaction is known, both are
+        /// checked again by insertVerified
+        ReadGuard l(m_lock);
+        ImportResult ret = checkCapacity(trans);
+        if (ret != ImportResult::Success)
+            return ret;
+        ret = checkKnown(tx_hash, _drop_policy);
+        if (ret != ImportResult::Success)
+            return ret;
+    }
     /// check nonce
-    if (false == isBlockLimitOrNonceOk(trans, _needinsert))
+    if (false == isBlockLimitOrNonceOk(trans, false))
         return ImportResult::TransactionNonceCheckFail;
     try
     {
@@ -236,10 +325,6 @@ ImportResult TxPool::verify(Transaction& trans, IfDropped _drop_policy, bool _ne
         TXPOOL_LOG(ERROR) << "[Verify] invalid signature, tx = " << tx_hash.abridged();
         return ImportResult::Malformed;
     }
-    /// nonce related to txpool must be checked at the last, since this will insert nonce of the
-    /// valid transaction into the txpool nonce cache
-    if (false == txPoolNonceCheck(trans))
-        return ImportResult::TxPoolNonceCheckFail;
     /// check chainId and groupId
     if (false == trans.checkChainIdAndGroupId(u256(g_BCOSConfig.chainId()), u256(m_groupId)))
     {
@@ -249,6 +334,34 @@ ImportResult TxPool::verify(Transaction& trans, IfDropped _drop_policy, bool _ne
     return ImportResult::Success;
 }
 
+/**
+ * @brief : insert a transaction that passed preVerify into the queue, including:
+ *  1. check the txpool size
+ *  2. whether the transaction is known (imported concurrently after preVerify)
+ *  3. check the txpool nonce
+ *
+ * @param trans : the pre-verified transaction
+ * @param _drop_policy : Import transaction policy
+ * @return ImportResult : import result
+ */
+ImportResult TxPool::insertVerified(Transaction& trans, IfDropped _drop_policy)
+{
+    /// check the txpool size, the pool may be filled up after preVerify
+    ImportResult ret = checkCapacity(trans);
+    if (ret != ImportResult::Success)
+        return ret;
+    ret = checkKnown(trans.sha3(), _drop_policy);
+    if (ret != ImportResult::Success)
+        return ret;
+    /// nonce related to txpool must be checked at the last, since this will insert nonce of the
+    /// valid transaction into the txpool nonce cache
+    if (false == txPoolNonceCheck(trans))
+        return ImportResult::TxPoolNonceCheckFail;
+    if (insert(trans))
+        m_commonNonceCheck->insertCache(trans);
+    return ImportResult::Success;
+}
+
 /**
  * @brief: check the nonce
  * @param _tx : the transaction to be checked
@@ -283,15 +396,17 @@ bool TxPool::removeTrans(h256 const& _txHash, bool needTriggerCallback,
         return false;
     }
 
-    if (needTriggerCallback && pReceipt && p_tx->second->rpcCallback())
+    auto const& pooledTx = p_tx->second.queueIt->second;
+    if (needTriggerCallback && pReceipt && pooledTx->rpcCallback())
     {
         // Not to use bind here, pReceipt wiil be free. So use TxCallback instead.
-        // m_callbackPool.enqueue(bind(p_tx->second->rpcCallback(), pReceipt));
+        // m_callbackPool.enqueue(bind(pooledTx->rpcCallback(), pReceipt));
         auto tx = m_blockChain->getLocalisedTxByHash(_txHash);
-        TxCallback callback{p_tx->second->rpcCallback(), pReceipt};
+        TxCallback callback{pooledTx->rpcCallback(), pReceipt};
         m_callbackPool.enqueue([callback, tx] { callback.call(callback.pReceipt, tx.data()); });
     }
-    m_txsQueue.erase(p_tx->second);
+    m_txsBlockLimit.erase(p_tx->second.blockLimitIt);
+    m_txsQueue.erase(p_tx->second.queueIt);
     m_txsHash.erase(p_tx);
     return true;
 }
@@ -307,8 +422,12 @@ bool TxPool::insert(Transaction const& _tx)
     {
         return false;
     }
-    TransactionQueue::iterator p_tx = m_txsQueue.emplace(_tx).first;
-    m_txsHash[tx_hash] = p_tx;
+    /// immutable from now on, shared with the readers of the pool
+    auto pooledTx = std::make_shared<Transaction const>(_tx);
+    TransactionIndex index;
+    index.queueIt = m_txsQueue.emplace_hint(m_txsQueue.end(), ++m_importSeq, pooledTx);
+    index.blockLimitIt = m_txsBlockLimit.emplace(_tx.blockLimit(), tx_hash);
+    m_txsHash[tx_hash] = index;
     return true;
 }
 
@@ -399,9 +518,41 @@ bool TxPool::dropBlockTrans(Block const& block)
     removeBlockKnowTrans(block);
     /// remove the nonce check related to txpool
     m_commonNonceCheck->delCache(block.transactions());
+    /// the transactions that can't be sealed at the new block number any more
+    dropExpiredTransactions(m_txNonceCheck->blockNumber());
     return ret;
 }
 
+void TxPool::dropExpiredTransactions(int64_t _blockNumber)
+{
+    std::vector<dev::h256> expiredTxs;
+    {
+        WriteGuard l(m_lock);
+        /// the same as TransactionNonceCheck::isBlockLimitOk: expired once blockLimit <= number
+        auto expiredEnd = m_txsBlockLimit.upper_bound(u256(_blockNumber));
+        while (m_txsBlockLimit.begin() != expiredEnd)
+        {
+            h256 txHash = m_txsBlockLimit.begin()->second;
+            auto const& pooledTx = m_txsHash[txHash].queueIt->second;
+            m_commonNonceCheck->delCache(m_commonNonceCheck->generateKey(*pooledTx));
+            removeTrans(txHash);
+            m_dropped.insert(txHash);
+            expiredTxs.push_back(txHash);
+        }
+    }
+
+    if (expiredTxs.size() > 0)
+    {
+        WriteGuard l(x_transactionKnownBy);
+        for (auto const& txHash : expiredTxs)
+        {
+            removeTransactionKnowBy(txHash);
+            TXPOOL_LOG(DEBUG) << LOG_DESC("remove imported tx: the block limit expired")
+                              << LOG_KV("hash", txHash.abridged());
+        }
+    }
+}
+
 /**
  * @brief Get top transactions from the queue
  *
@@ -418,58 +569,41 @@ dev::eth::Transactions TxPool::topTransactions(uint64_t const& _limit)
 
 Transactions TxPool::topTransactions(uint64_t const& _limit, h256Hash& _avoid, bool _updateAvoid)
 {
-    uint64_t limit = min(m_limit, _limit);
-    uint64_t txCnt = 0;
+    /// copy the transactions after the pool lock is released
     Transactions ret;
-    std::vector<dev::h256> invalidBlockLimitTxs;
-    std::vector<dev::eth::NonceKeyType> nonceKeyCache;
+    for (auto const& tx : topTransactionViews(_limit, _avoid, _updateAvoid))
     {
-        UpgradableGuard l(m_lock);
-        for (auto it = m_txsQueue.begin(); txCnt < limit && it != m_txsQueue.end(); it++)
-        {
-            /// check block limit and nonce again when obtain transactions
-            if (false == m_txNonceCheck->isBlockLimitOk(*it))
-            {
-                invalidBlockLimitTxs.push_back(it->sha3());
-                nonceKeyCache.push_back(m_commonNonceCheck->generateKey(*it));
-                continue;
-            }
-            if (!_avoid.count(it->sha3()))
-            {
-                ret.push_back(*it);
-                txCnt++;
-                if (_updateAvoid)
-                    _avoid.insert(it->sha3());
-            }
-        }
-        if (invalidBlockLimitTxs.size() > 0)
-        {
-            UpgradeGuard ul(l);
-            for (auto txHash : invalidBlockLimitTxs)
-            {
-                removeTrans(txHash);
-                m_dropped.insert(txHash);
-            }
-        }
-        /// delete cached invalid nonce
-        if (nonceKeyCache.size() > 0)
-        {
-            for (auto key : nonceKeyCache)
-                m_commonNonceCheck->delCache(key);
-        }
+        ret.push_back(*tx);
     }
+    return ret;
+}
 
-    if (invalidBlockLimitTxs.size() > 0)
+/**
+ * @brief Get top transactions from the queue without copying them
+ *        (expired transactions are dropped by dropBlockTrans, so no block limit check here)
+ *
+ * @param _limit : _limit Max number of transactions to return.
+ * @param _avoid : Transactions to avoid returning.
+ * @param _updateAvoid : Insert the returned transactions into _avoid.
+ * @return ConstTransactions : up to _limit transactions shared with the queue
+ */
+ConstTransactions TxPool::topTransactionViews(
+    uint64_t const& _limit, h256Hash& _avoid, bool _updateAvoid)
+{
+    uint64_t limit = min(m_limit, _limit);
+    ConstTransactions ret;
+    ReadGuard l(m_lock);
+    ret.reserve(min(limit, (uint64_t)m_txsQueue.size()));
+    for (auto it = m_txsQueue.begin(); ret.size() < limit && it != m_txsQueue.end(); it++)
     {
-        WriteGuard l(x_transactionKnownBy);
-        for (auto txHash : invalidBlockLimitTxs)
+        auto const& txHash = it->second->sha3();
+        if (!_avoid.count(txHash))
         {
-            removeTransactionKnowBy(txHash);
-            TXPOOL_LOG(DEBUG) << LOG_DESC("remove imported tx: the block limit expired")
-                              << LOG_KV("hash", txHash.abridged());
+            ret.push_back(it->second);
+            if (_updateAvoid)
+                _avoid.insert(txHash);
         }
     }
-
     return ret;
 }
 
@@ -483,9 +617,9 @@ Transactions TxPool::topTransactionsCondition(uint64_t const& _limit, dev::h512
         ReadGuard l_kownTrans(x_transactionKnownBy);
         for (auto it = m_txsQueue.begin(); txCnt < limit && it != m_txsQueue.end(); it++)
         {
-            if (!isTransactionKnownBy(it->sha3(), _nodeId))
+            if (!isTransactionKnownBy(it->second->sha3(), _nodeId))
             {
-                ret.push_back(*it);
+                ret.push_back(*it->second);
                 txCnt++;
             }
         }
@@ -501,7 +635,7 @@ Transactions TxPool::pendingList() const
     Transactions ret;
     for (auto t = m_txsQueue.begin(); t != m_txsQueue.end(); ++t)
     {
-        ret.push_back(*t);
+        ret.push_back(*t->second);
     }
     return ret;
 }
@@ -528,6 +662,7 @@ void TxPool::clear()
 {
     WriteGuard l(m_lock);
     m_txsQueue.clear();
+    m_txsBlockLimit.clear();
     m_txsHash.clear();
     m_dropped.clear();
     WriteGuard l_trans(x_transactionKnownBy);
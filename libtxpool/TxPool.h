@@ -32,6 +32,7 @@
 #include <libethcore/Protocol.h>
 #include <libethcore/Transaction.h>
 #include <libp2p/P2PInterface.h>
+#include <map>
 
 using namespace dev::eth;
 using namespace dev::p2p;
@@ -54,13 +55,6 @@ class TxPoolNonceManager
 {
 public:
 };
-struct transactionCompare
-{
-    bool operator()(dev::eth::Transaction const& _first, dev::eth::Transaction const& _second) const
-    {
-        return _first.importTime() <= _second.importTime();
-    }
-};
 class TxPool : public TxPoolInterface, public std::enable_shared_from_this<TxPool>
 {
 public:
@@ -92,6 +86,18 @@ public:
      */
     std::pair<h256, Address> submit(dev::eth::Transaction& _tx) override;
 
+    /**
+     * @brief : Verify a batch of transactions and add the valid ones to the queue. The senders
+     * are recovered in parallel without holding the pool lock, then all valid transactions are
+     * inserted under a single lock acquisition.
+     *
+     * @param _txs : Transactions to import, the sender of each one is recovered in place.
+     * @param _ik : Set to Retry to force re-addinga transaction that was previously dropped.
+     * @return std::vector<ImportResult> : Import result code of each transaction.
+     */
+    std::vector<ImportResult> batchImport(
+        dev::eth::Transactions& _txs, IfDropped _ik = IfDropped::Ignore) override;
+
     /**
      * @brief Remove transaction from the queue
      * @param _txHash: Remove bad transaction from the queue
@@ -112,6 +118,10 @@ public:
         uint64_t const& _limit, h256Hash& _avoid, bool _updateAvoid = false) override;
     dev::eth::Transactions topTransactionsCondition(
         uint64_t const& _limit, dev::h512 const& _nodeId) override;
+    /// views of the pooled transactions in import order, only the pointers are copied under the
+    /// pool lock
+    dev::eth::ConstTransactions topTransactionViews(
+        uint64_t const& _limit, h256Hash& _avoid, bool _updateAvoid = false) override;
 
     /// get all transactions(maybe blocksync module need this interface)
     dev::eth::Transactions pendingList() const override;
@@ -145,6 +155,7 @@ public:
     /// verify and set the sender of known transactions of sepcified block
     void verifyAndSetSenderForBlock(dev::eth::Block& block) override;
     bool txExists(dev::h256 const& txHash) override;
+    dev::eth::ConstTransactions transactionViews(dev::h256s const& _txHashes) override;
 
     bool isFull() override
     {
@@ -163,15 +174,19 @@ protected:
      */
     ImportResult import(dev::eth::Transaction& _tx, IfDropped _ik = IfDropped::Ignore) override;
     ImportResult import(bytesConstRef _txBytes, IfDropped _ik = IfDropped::Ignore) override;
-    /// verify transcation
-    virtual ImportResult verify(
-        Transaction& trans, IfDropped _ik = IfDropped::Ignore, bool _needinsert = false);
+    /// verify transcation without holding m_lock, including the signature check
+    virtual ImportResult preVerify(Transaction& trans, IfDropped _ik = IfDropped::Ignore);
+    /// check a pre-verified transaction against the queue and insert it, m_lock must be held
+    /// exclusively
+    virtual ImportResult insertVerified(Transaction& trans, IfDropped _ik = IfDropped::Ignore);
     /// check nonce
     virtual bool isBlockLimitOrNonceOk(dev::eth::Transaction const& _ts, bool _needinsert) const;
     /// interface for filter check
     virtual u256 filterCheck(const Transaction&) const { return u256(0); };
     void clear();
     bool dropTransactions(dev::eth::Block const& block, bool needNotify = false);
+    /// drop the transactions whose block limit is not above _blockNumber
+    void dropExpiredTransactions(int64_t _blockNumber);
     bool removeBlockKnowTrans(dev::eth::Block const& block);
 
 private:
@@ -182,6 +197,8 @@ private:
     bool removeTrans(h256 const& _txHash, bool needTriggerCallback = false,
         dev::eth::LocalisedTransactionReceipt::Ptr pReceipt = nullptr);
     bool insert(dev::eth::Transaction const& _tx);
+    ImportResult checkKnown(h256 const& _txHash, IfDropped _ik) const;
+    ImportResult checkCapacity(dev::eth::Transaction const& _tx);
     void removeTransactionKnowBy(h256 const& _txHash);
     bool inline txPoolNonceCheck(dev::eth::Transaction const& tx)
     {
@@ -206,10 +223,19 @@ private:
     /// protocolId
     PROTOCOL_ID m_protocolId;
     GROUP_ID m_groupId;
-    /// transaction queue
-    using TransactionQueue = std::set<dev::eth::Transaction, transactionCompare>;
+    /// transaction queue in import order, keyed by an increasing import sequence
+    using TransactionQueue = std::map<uint64_t, dev::eth::ConstTransactionPtr>;
     TransactionQueue m_txsQueue;
-    std::unordered_map<h256, TransactionQueue::iterator> m_txsHash;
+    uint64_t m_importSeq = 0;
+    /// transactions by block limit, expired ones are dropped in bulk once a block is committed
+    using BlockLimitIndex = std::multimap<u256, h256>;
+    BlockLimitIndex m_txsBlockLimit;
+    struct TransactionIndex
+    {
+        TransactionQueue::iterator queueIt;
+        BlockLimitIndex::iterator blockLimitIt;
+    };
+    std::unordered_map<h256, TransactionIndex> m_txsHash;
     /// hash of dropped transactions
     h256Hash m_dropped;
     /// Transaction is known by some peers
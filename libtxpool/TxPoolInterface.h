@@ -56,6 +56,18 @@ public:
     virtual dev::eth::Transactions topTransactions(
         uint64_t const& _limit, h256Hash& _avoid, bool _updateAvoid = false) = 0;
 
+    /// same as topTransactions, but returns the pooled transactions without copying them
+    virtual dev::eth::ConstTransactions topTransactionViews(
+        uint64_t const& _limit, h256Hash& _avoid, bool _updateAvoid = false)
+    {
+        dev::eth::ConstTransactions ret;
+        for (auto& tx : topTransactions(_limit, _avoid, _updateAvoid))
+        {
+            ret.push_back(std::make_shared<dev::eth::Transaction const>(std::move(tx)));
+        }
+        return ret;
+    }
+
     /// param 1: the transaction limit
     /// param 2: the node id
     virtual dev::eth::Transactions topTransactionsCondition(uint64_t const&, dev::h512 const&)
@@ -86,6 +98,23 @@ public:
         dev::eth::Transaction& _tx, dev::eth::IfDropped _ik = dev::eth::IfDropped::Ignore) = 0;
     virtual dev::eth::ImportResult import(
         bytesConstRef _txBytes, dev::eth::IfDropped _ik = dev::eth::IfDropped::Ignore) = 0;
+
+    /**
+     * @brief : Verify a batch of transactions and add the valid ones to the queue.
+     * @param _txs : Transactions to import, the sender of each one is recovered in place.
+     * @param _ik : Set to Retry to force re-addinga transaction that was previously dropped.
+     * @return std::vector<ImportResult> : Import result code of each transaction.
+     */
+    virtual std::vector<dev::eth::ImportResult> batchImport(
+        dev::eth::Transactions& _txs, dev::eth::IfDropped _ik = dev::eth::IfDropped::Ignore)
+    {
+        std::vector<dev::eth::ImportResult> results;
+        for (auto& tx : _txs)
+        {
+            results.push_back(import(tx, _ik));
+        }
+        return results;
+    }
     /// @returns the status of the transaction queue.
     virtual TxPoolStatus status() const = 0;
 
@@ -119,6 +148,13 @@ public:
     /// determine the given transaction hash exists in the transaction pool or not
     virtual bool txExists(dev::h256 const&) { return false; }
 
+    /// param: transaction hashes
+    /// the pooled transactions of the given hashes in order, nullptr for those not in the pool
+    virtual dev::eth::ConstTransactions transactionViews(dev::h256s const& _txHashes)
+    {
+        return dev::eth::ConstTransactions(_txHashes.size());
+    }
+
     /// param: the block that should be verified and set sender according to transactions of local
     /// transaction pool
     virtual void verifyAndSetSenderForBlock(dev::eth::Block&) {}
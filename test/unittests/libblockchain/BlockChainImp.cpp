@@ -334,6 +334,106 @@ BOOST_AUTO_TEST_CASE(commitBlock)
     BOOST_CHECK_EQUAL(m_blockChainImp->number(), 2);
     BOOST_CHECK_EQUAL(m_blockChainImp->totalTransactionCount().first, 30);
     BOOST_CHECK_EQUAL(m_blockChainImp->totalTransactionCount().second, 2);
+
+    /// the committed transactions are served by the committed tx cache, the fake transactions
+    /// of a block are the same so the last one is indexed
+    auto const& tx = fakeBlock3->getBlock().transactions()[0];
+    auto localisedTx = m_blockChainImp->getLocalisedTxByHash(tx.sha3());
+    BOOST_CHECK_EQUAL(localisedTx.sha3(), tx.sha3());
+    BOOST_CHECK_EQUAL(localisedTx.blockNumber(), 2);
+    BOOST_CHECK_EQUAL(localisedTx.transactionIndex(), 14u);
+    auto localisedReceipt = m_blockChainImp->getLocalisedTxReceiptByHash(tx.sha3());
+    BOOST_CHECK_EQUAL(localisedReceipt.blockHash(), fakeBlock3->getBlock().headerHash());
+    BOOST_CHECK_EQUAL(localisedReceipt.transactionIndex(), 14u);
+}
+
+BOOST_AUTO_TEST_CASE(blockCache)
+{
+    BlockCache cache;
+    FakeBlock fakeBlock(5, KeyPair::create().secret(), 1);
+    auto& block = fakeBlock.getBlock();
+    auto blockRLP = std::make_shared<bytes>(fakeBlock.getBlockData());
+    cache.add(block, blockRLP);
+    BOOST_CHECK(cache.get(block.headerHash()).first->equalAll(block));
+    BOOST_CHECK(cache.get(1)->equalAll(block));
+    BOOST_CHECK(cache.getRLP(1) == blockRLP);
+    BOOST_CHECK(!cache.get(2));
+    auto cacheStatus = cache.status();
+    BOOST_CHECK_EQUAL(cacheStatus.blocks, 1u);
+    /// the decoded block is charged its decoded size
+    BOOST_CHECK(BlockCache::decodedSize(block) > 0);
+    BOOST_CHECK_EQUAL(cacheStatus.size, blockRLP->size() + BlockCache::decodedSize(block));
+    BOOST_CHECK_EQUAL(cacheStatus.queryTimes, 3u);
+    BOOST_CHECK_EQUAL(cacheStatus.hitTimes, 2u);
+    BOOST_CHECK_EQUAL(cacheStatus.rlpHitTimes, 1u);
+
+    /// only the encoding is cached
+    FakeBlock fakeBlock2(5, KeyPair::create().secret(), 2);
+    auto blockRLP2 = std::make_shared<bytes>(fakeBlock2.getBlockData());
+    cache.addRLP(fakeBlock2.getBlock().headerHash(), 2, blockRLP2);
+    BOOST_CHECK(!cache.get(2));
+    BOOST_CHECK(cache.getRLP(2) == blockRLP2);
+
+    /// the block cached without its encoding is encoded once
+    FakeBlock fakeBlock3(5, KeyPair::create().secret(), 3);
+    cache.add(fakeBlock3.getBlock());
+    auto blockRLP3 = cache.getRLP(3);
+    BOOST_CHECK(*blockRLP3 == fakeBlock3.getBlockData());
+    BOOST_CHECK(cache.getRLP(3) == blockRLP3);
+
+    /// only the most recently used block is kept without budget
+    cache.setCapacity(0);
+    BOOST_CHECK_EQUAL(cache.status().blocks, 1u);
+    for (int64_t i = 4; i < 40; i++)
+    {
+        FakeBlock fakeBlock(1, KeyPair::create().secret(), i);
+        cache.add(fakeBlock.getBlock(), std::make_shared<bytes>(fakeBlock.getBlockData()));
+        BOOST_CHECK(cache.get(i));
+    }
+    cacheStatus = cache.status();
+    BOOST_CHECK_EQUAL(cacheStatus.blocks, 1u);
+    BOOST_CHECK_EQUAL(cacheStatus.evictTimes, 39u - cacheStatus.blocks);
+}
+
+BOOST_AUTO_TEST_CASE(blockCacheLRU)
+{
+    std::vector<std::shared_ptr<bytes>> blockRLPs;
+    std::vector<h256> hashes;
+    for (int64_t i = 1; i <= 40; i++)
+    {
+        FakeBlock fakeBlock(1, KeyPair::create().secret(), i);
+        blockRLPs.push_back(std::make_shared<bytes>(fakeBlock.getBlockData()));
+        hashes.push_back(fakeBlock.getBlock().headerHash());
+    }
+    /// the budget is shared by the shards, so 4 blocks are kept wherever their shards are
+    uint64_t capacity = 0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        capacity = std::max<uint64_t>(capacity, blockRLPs[i]->size());
+    }
+    BlockCache cache(4 * capacity);
+    for (size_t i = 0; i < 4; i++)
+    {
+        cache.addRLP(hashes[i], i + 1, blockRLPs[i]);
+    }
+    BOOST_CHECK_EQUAL(cache.status().blocks, 4u);
+    /// the least recently used block is evicted first
+    BOOST_CHECK(cache.getRLP(1) == blockRLPs[0]);
+    for (size_t i = 4; i < 40; i++)
+    {
+        cache.addRLP(hashes[i], i + 1, blockRLPs[i]);
+        BOOST_CHECK(cache.getRLP(1) == blockRLPs[0]);
+        BOOST_CHECK(cache.getRLP(i + 1) == blockRLPs[i]);
+        BOOST_CHECK(cache.status().size <= 4 * capacity);
+    }
+    BOOST_CHECK(!cache.getRLP(2));
+    BOOST_CHECK(cache.status().blocks >= 3u);
+
+    /// a block larger than the capacity is kept alone
+    auto largeRLP = std::make_shared<bytes>(8 * capacity, 0x01);
+    cache.addRLP(h256(1), 100, largeRLP);
+    BOOST_CHECK(cache.getRLP(100) == largeRLP);
+    BOOST_CHECK_EQUAL(cache.status().blocks, 1u);
 }
 
 BOOST_AUTO_TEST_CASE(query)
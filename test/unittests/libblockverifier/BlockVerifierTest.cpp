@@ -33,6 +33,7 @@
 #include <libledger/LedgerManager.h>
 #include <libmptstate/MPTStateFactory.h>
 #include <libstorage/LevelDBStorage.h>
+#include <libstorage/StateDiff.h>
 #include <test/tools/libutils/TestOutputHelper.h>
 #include <test/unittests/libethcore/FakeBlock.h>
 #include <unistd.h>
@@ -218,6 +219,80 @@ public:
         canCallUserBalance(blockVerifier, block, _totalUser);
         return block.header().stateRoot();
     }
+
+    /// a block executed with its StateDiff recorded, the StateDiff is applied in place of the
+    /// execution only if it matches the header
+    void applyStateDiff(int _totalUser, int _totalTxs)
+    {
+        std::shared_ptr<LedgerParamInterface> params = std::make_shared<LedgerParam>();
+        params->mutableStorageParam().type = "RocksDB";
+        params->mutableStorageParam().path =
+            "fakeBlockVerifier/RocksDB_statediff_" + to_string(utcTime());
+        params->mutableStateParam().type = "storage";
+
+        auto dbInitializer = std::make_shared<dev::ledger::DBInitializer>(params);
+        dbInitializer->initStorageDB();
+        std::shared_ptr<BlockChainImp> blockChain = std::make_shared<BlockChainImp>();
+        blockChain->setStateStorage(dbInitializer->storage());
+        blockChain->setTableFactoryFactory(dbInitializer->tableFactoryFactory());
+
+        GenesisBlockParam initParam = {"", dev::h512s(), dev::h512s(), "consensusType",
+            "storageType", "stateType", 5000, 300000000, 0};
+        BOOST_CHECK(blockChain->checkAndBuildGenesisBlock(initParam));
+        dbInitializer->initState(blockChain->getBlockByNumber(0)->headerHash());
+
+        std::shared_ptr<BlockVerifier> blockVerifier = std::make_shared<BlockVerifier>(false);
+        blockVerifier->setExecutiveContextFactory(dbInitializer->executiveContextFactory());
+        blockVerifier->setNumberHash(boost::bind(&BlockChainImp::numberHash, blockChain, _1));
+        blockVerifier->setRecordStateDiff(true);
+
+        auto parentBlock = blockChain->getBlockByNumber(0);
+        BlockInfo parentBlockInfo = {parentBlock->header().hash(), parentBlock->header().number(),
+            parentBlock->header().stateRoot()};
+        initUser(_totalUser, parentBlockInfo, blockVerifier, blockChain);
+        parentBlock = blockChain->getBlockByNumber(1);
+        parentBlockInfo = {parentBlock->header().hash(), parentBlock->header().number(),
+            parentBlock->header().stateRoot()};
+
+        Block block;
+        block.header().setNumber(parentBlockInfo.number + 1);
+        block.header().setParentHash(parentBlockInfo.hash);
+        genTxUserTransfer(block, _totalUser, _totalTxs);
+        block.calTransactionRoot();
+        auto context = blockVerifier->executeBlock(block, parentBlockInfo);
+        BOOST_REQUIRE(context && context->stateDiff());
+        bytes stateDiff = *context->stateDiff();
+
+        Block applied = block;
+        BOOST_CHECK(blockVerifier->applyStateDiff(applied, parentBlockInfo, ref(stateDiff)));
+        BOOST_CHECK(applied.blockHeader() == block.blockHeader());
+
+        // the transfers update the committed rows of the users
+        auto tamper = [&](std::function<void(Entry::Ptr)> _change) {
+            auto diff = StateDiff::decode(ref(stateDiff));
+            for (auto& tableDiff : diff->tables)
+            {
+                if (tableDiff.dirtyEntries->size() > 0)
+                {
+                    _change(tableDiff.dirtyEntries->get(0));
+                    break;
+                }
+            }
+            bytes encoded;
+            diff->encode(encoded);
+            return encoded;
+        };
+        auto badStatus = tamper([](Entry::Ptr _entry) { _entry->setStatus(1); });
+        BOOST_CHECK_THROW(blockVerifier->applyStateDiff(applied, parentBlockInfo, ref(badStatus)),
+            InvalidBlockWithBadStateOrReceipt);
+        BOOST_CHECK(applied.blockHeader() == block.blockHeader());
+        auto badID = tamper([](Entry::Ptr _entry) { _entry->setID(0); });
+        BOOST_CHECK_THROW(blockVerifier->applyStateDiff(applied, parentBlockInfo, ref(badID)),
+            InvalidBlockWithBadStateOrReceipt);
+        BOOST_CHECK_THROW(blockVerifier->applyStateDiff(applied, parentBlockInfo,
+                              ref(stateDiff).cropped(0, stateDiff.size() - 1)),
+            InvalidBlockWithBadStateOrReceipt);
+    }
 };
 
 class BlockVerifierFixture : public TestOutputHelperFixture
@@ -245,6 +320,12 @@ BOOST_AUTO_TEST_CASE(executeBlockTest)
 
 BOOST_AUTO_TEST_CASE(executeTransactionTest) {}
 
+BOOST_AUTO_TEST_CASE(applyStateDiffTest)
+{
+    FakeVerifierWithDagTransfer verifier;
+    verifier.applyStateDiff(4, 20);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace test
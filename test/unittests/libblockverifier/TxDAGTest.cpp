@@ -28,6 +28,7 @@
 #include <libprecompiled/extension/DagTransferPrecompiled.h>
 #include <test/tools/libutils/TestOutputHelper.h>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <iostream>
 #include <set>
 
@@ -168,6 +169,76 @@ BOOST_AUTO_TEST_CASE(NormalAndParallelTxDAGTest)
     BOOST_CHECK_EQUAL(exeTrans[5].sha3(), trans[5].sha3());
 }
 
+BOOST_AUTO_TEST_CASE(WorkStealingTxDAGTest)
+{
+    shared_ptr<TxDAG> txDag = make_shared<TxDAG>();
+    ExecutiveContext::Ptr executiveContext = createCtx();
+
+    Transactions trans;
+    trans.emplace_back(createParallelTransferTx("A", "B", 100));
+    trans.emplace_back(createParallelTransferTx("C", "D", 100));
+    trans.emplace_back(createParallelTransferTx("E", "F", 100));
+    trans.emplace_back(createParallelTransferTx("A", "D", 100));
+    trans.emplace_back(createParallelTransferTx("D", "F", 100));
+
+    txDag->init(executiveContext, trans, 0);
+    BOOST_CHECK_EQUAL(txDag->criticalPathLength(), 3);
+
+    std::mutex x_exeIds;
+    vector<ID> exeIds;
+    txDag->setTxExecuteFunc([&](Transaction const&, ID _txId) {
+        Guard l(x_exeIds);
+        exeIds.emplace_back(_txId);
+        return true;
+    });
+    txDag->run(2);
+
+    BOOST_CHECK(txDag->hasFinished());
+    BOOST_CHECK_EQUAL(exeIds.size(), 5);
+    auto position = [&](ID _id) {
+        return find(exeIds.begin(), exeIds.end(), _id) - exeIds.begin();
+    };
+    BOOST_CHECK(position(0) < position(3));
+    BOOST_CHECK(position(1) < position(3));
+    BOOST_CHECK(position(3) < position(4));
+    BOOST_CHECK(position(2) < position(4));
+}
+
+BOOST_AUTO_TEST_CASE(AccessSetTxDAGTest)
+{
+    shared_ptr<TxDAG> txDag = make_shared<TxDAG>();
+
+    Transactions trans;
+    vector<storage::TableAccessSet::Ptr> accessSets;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        trans.emplace_back(i == 1 ? createNormalTx() : createParallelTransferTx("A", "B", i));
+        accessSets.emplace_back(make_shared<storage::TableAccessSet>());
+    }
+    accessSets[0]->addWrite("t_test", "A");
+    // the normal transaction is independent of the others, it must not be a barrier
+    accessSets[1]->addWrite("t_test", "X");
+    accessSets[2]->addRead("t_test", "A");
+    accessSets[2]->addWrite("t_test", "B");
+    accessSets[3]->addWrite("t_test", "X");
+    accessSets[4]->addRead("t_test", "B");
+
+    txDag->init(trans, accessSets, 0);
+
+    vector<ID> exeIds;
+    txDag->setTxExecuteFunc([&](Transaction const&, ID _txId) {
+        exeIds.emplace_back(_txId);
+        return true;
+    });
+
+    while (!txDag->hasFinished())
+    {
+        txDag->executeUnit();
+    }
+
+    BOOST_CHECK(exeIds == vector<ID>({0, 2, 4, 1, 3}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace test
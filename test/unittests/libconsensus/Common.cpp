@@ -155,6 +155,34 @@ BOOST_AUTO_TEST_CASE(testPrepareReq)
     BOOST_CHECK(new_req.timestamp >= tmp_req.timestamp);
 }
 
+/// test the PrepareReq of CompactPrepareReqPacket
+BOOST_AUTO_TEST_CASE(testCompactPrepareReq)
+{
+    KeyPair key_pair = KeyPair::create();
+    FakeBlock fake_block(5);
+    PrepareReq prepare_req(fake_block.m_block, key_pair, 2, 135);
+    bytes compact_data;
+    BOOST_REQUIRE_NO_THROW(prepare_req.encodeCompact(compact_data));
+    bytes full_data;
+    prepare_req.encode(full_data);
+    BOOST_CHECK(compact_data.size() < full_data.size());
+
+    /// decoded as a normal PrepareReq, the block field holds the header and the tx hashes
+    PrepareReq decoded_req;
+    BOOST_REQUIRE_NO_THROW(decoded_req.decode(ref(compact_data)));
+    checkPBFTMsg(decoded_req, key_pair, fake_block.m_block.blockHeader().number(), 2, 135,
+        prepare_req.timestamp, fake_block.m_block.header().hash());
+    BlockHeader header;
+    h256s tx_hashes;
+    BOOST_REQUIRE_NO_THROW(decoded_req.decodeCompactBlock(header, tx_hashes));
+    BOOST_CHECK(header.hash() == decoded_req.block_hash);
+    BOOST_CHECK(tx_hashes.size() == fake_block.m_block.transactions().size());
+    for (size_t i = 0; i < tx_hashes.size(); i++)
+    {
+        BOOST_CHECK(tx_hashes[i] == fake_block.m_block.transactions()[i].sha3());
+    }
+}
+
 /// test SignReq and CommitReq
 BOOST_AUTO_TEST_CASE(testSignReqAndCommitReq)
 {
@@ -210,6 +238,51 @@ BOOST_AUTO_TEST_CASE(testPBFTMsgPacket)
     BOOST_CHECK(tmp_packet != packet);
     BOOST_CHECK(tmp_packet.timestamp >= packet.timestamp);
 }
+
+/// test every sealer is reached exactly once from any root
+BOOST_AUTO_TEST_CASE(testBroadcastTree)
+{
+    for (IDXTYPE nodeNum = 1; nodeNum <= 20; nodeNum++)
+    {
+        for (unsigned width = 1; width <= 4; width++)
+        {
+            for (IDXTYPE root = 0; root < nodeNum; root++)
+            {
+                BroadcastTree tree(nodeNum, width, root);
+                std::vector<unsigned> received(nodeNum, 0);
+                received[root] = 1;
+                std::vector<IDXTYPE> level = {root};
+                unsigned depth = 0;
+                while (!level.empty())
+                {
+                    std::vector<IDXTYPE> next;
+                    for (auto idx : level)
+                    {
+                        for (auto child : tree.children(idx))
+                        {
+                            BOOST_CHECK(child < nodeNum);
+                            BOOST_CHECK(child != root);
+                            received[child]++;
+                            next.push_back(child);
+                        }
+                    }
+                    if (!next.empty())
+                    {
+                        depth++;
+                    }
+                    level = next;
+                }
+                for (auto count : received)
+                {
+                    BOOST_CHECK_EQUAL(count, 1u);
+                }
+                BOOST_CHECK_EQUAL(depth, tree.depth());
+            }
+        }
+    }
+    /// the node out of range has no child
+    BOOST_CHECK(BroadcastTree(4, 2, 0).children(4).empty());
+}
 BOOST_AUTO_TEST_SUITE_END()
 }  // namespace test
 }  // namespace dev
@@ -69,7 +69,7 @@ public:
     const std::shared_ptr<PBFTReqCache> reqCache() const { return m_reqCache; }
     TimeManager const& timeManager() const { return m_timeManager; }
     TimeManager& mutableTimeManager() { return m_timeManager; }
-    const std::shared_ptr<dev::db::LevelDB> backupDB() const { return m_backupDB; }
+    const PBFTBackupLog::Ptr backupLog() const { return m_backupLog; }
     int64_t consensusBlockNumber() const { return m_consensusBlockNumber; }
     void setConsensusBlockNumber(int64_t const& number) { m_consensusBlockNumber = number; }
 
@@ -245,6 +245,20 @@ public:
     /// NodeAccountType accountType() override { return m_accountType; }
     void setAccountType(NodeAccountType const& accountType) { m_accountType = accountType; }
 
+    void handleGetMissedTxsMsg(PBFTMsgPacket const& pbftMsg)
+    {
+        return PBFTEngine::handleGetMissedTxsMsg(pbftMsg);
+    }
+    void updateMissedTxsSource(PrepareReq const& req)
+    {
+        return PBFTEngine::updateMissedTxsSource(req);
+    }
+    void checkCompactPrepareTimeout() { return PBFTEngine::checkCompactPrepareTimeout(); }
+    std::shared_ptr<PendingCompactPrepare> pendingCompactPrepare()
+    {
+        return m_pendingCompactPrepare;
+    }
+
     bool notifyNextLeaderSeal() { return m_notifyNextLeaderSeal; }
     IDXTYPE getNextLeader() const { return PBFTEngine::getNextLeader(); }
 };
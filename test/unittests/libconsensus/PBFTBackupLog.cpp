@@ -0,0 +1,159 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+
+/**
+ * @brief: unit test for libconsensus/pbft/PBFTBackupLog.h
+ * @file: PBFTBackupLog.cpp
+ */
+#include <libconsensus/pbft/PBFTBackupLog.h>
+#include <test/tools/libutils/TestOutputHelper.h>
+#include <boost/filesystem.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/test/unit_test.hpp>
+#include <csignal>
+#include <fstream>
+using namespace dev::consensus;
+namespace dev
+{
+namespace test
+{
+class BackupLogFixture : public TestOutputHelperFixture
+{
+public:
+    BackupLogFixture() : m_path("./pbftBackupLogTest/backup.log")
+    {
+        boost::filesystem::remove_all("./pbftBackupLogTest");
+    }
+    ~BackupLogFixture() { boost::filesystem::remove_all("./pbftBackupLogTest"); }
+
+    std::string m_path;
+};
+
+BOOST_FIXTURE_TEST_SUITE(PBFTBackupLogTest, BackupLogFixture)
+
+BOOST_AUTO_TEST_CASE(testAppendAndReload)
+{
+    for (auto durability :
+        {BackupDurability::Sync, BackupDurability::Async, BackupDurability::NoSync})
+    {
+        boost::filesystem::remove_all("./pbftBackupLogTest");
+        bytes committed(1024, 0x01);
+        {
+            PBFTBackupLog log(m_path, durability);
+            log.open();
+            BOOST_CHECK(log.lookup("committed").empty());
+            log.append("committed", bytes(10, 0x02));
+            log.append("committed", committed);
+            log.append("other", bytes(5, 0x03));
+            BOOST_CHECK(log.lookup("committed") == committed);
+            log.flush();
+            BOOST_CHECK(log.fileSize() > committed.size());
+        }
+        PBFTBackupLog log(m_path, durability);
+        log.open();
+        BOOST_CHECK(log.lookup("committed") == committed);
+        BOOST_CHECK(log.lookup("other") == bytes(5, 0x03));
+    }
+    BOOST_CHECK(PBFTBackupLog::durabilityFromString("sync") == BackupDurability::Sync);
+    BOOST_CHECK(PBFTBackupLog::durabilityFromString("none") == BackupDurability::NoSync);
+    BOOST_CHECK(PBFTBackupLog::durabilityFromString("") == BackupDurability::Async);
+}
+
+/// the record appended without sync survives the process killed right after append
+BOOST_AUTO_TEST_CASE(testKilledAfterAppend)
+{
+    for (auto durability : {BackupDurability::Async, BackupDurability::NoSync})
+    {
+        boost::filesystem::remove_all("./pbftBackupLogTest");
+        pid_t pid = fork();
+        BOOST_REQUIRE(pid >= 0);
+        if (pid == 0)
+        {
+            try
+            {
+                PBFTBackupLog log(m_path, durability);
+                log.open();
+                log.append("committed", bytes(100, 0x01));
+            }
+            catch (...)
+            {
+            }
+            ::kill(::getpid(), SIGKILL);
+        }
+        int status = 0;
+        BOOST_REQUIRE(::waitpid(pid, &status, 0) == pid);
+        BOOST_CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+        PBFTBackupLog log(m_path, durability);
+        log.open();
+        BOOST_CHECK(log.lookup("committed") == bytes(100, 0x01));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testTornTail)
+{
+    uint64_t validSize = 0;
+    {
+        PBFTBackupLog log(m_path);
+        log.open();
+        log.append("committed", bytes(100, 0x01));
+        log.flush();
+        validSize = log.fileSize();
+    }
+    /// a record interrupted by the crash
+    {
+        std::ofstream file(m_path, std::ios::binary | std::ios::app);
+        file.write("\x00\x00\x01\x00\x12\x34", 6);
+    }
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(m_path), validSize + 6);
+    PBFTBackupLog log(m_path);
+    log.open();
+    BOOST_CHECK(log.lookup("committed") == bytes(100, 0x01));
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(m_path), validSize);
+    log.append("committed", bytes(100, 0x02));
+    log.stop();
+
+    PBFTBackupLog reloaded(m_path);
+    reloaded.open();
+    BOOST_CHECK(reloaded.lookup("committed") == bytes(100, 0x02));
+}
+
+BOOST_AUTO_TEST_CASE(testCompact)
+{
+    PBFTBackupLog log(m_path);
+    log.setCompactSize(4096);
+    log.open();
+    for (size_t i = 0; i < 100; i++)
+    {
+        log.append("committed", bytes(512, (byte)i));
+        log.flush();
+    }
+    /// only the latest record is kept
+    BOOST_CHECK(log.fileSize() < 4096 + 1024);
+    BOOST_CHECK_EQUAL(log.fileSize(), boost::filesystem::file_size(m_path));
+    log.stop();
+
+    PBFTBackupLog reloaded(m_path);
+    reloaded.open();
+    BOOST_CHECK(reloaded.lookup("committed") == bytes(512, (byte)99));
+    /// append after stop
+    BOOST_CHECK_THROW(log.append("committed", bytes()), BackupLogError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace dev
@@ -43,8 +43,8 @@ BOOST_AUTO_TEST_CASE(testInitPBFTEnvNormalCase)
     /// init pbft env
     fake_pbft.consensus()->initPBFTEnv(
         fake_pbft.consensus()->timeManager().m_emptyBlockGenTime * 3);
-    /// check level db has already been openend
-    BOOST_CHECK(fake_pbft.consensus()->backupDB());
+    /// check the backup log has already been openend
+    BOOST_CHECK(fake_pbft.consensus()->backupLog());
     BOOST_CHECK(fake_pbft.consensus()->consensusBlockNumber() == 0);
     BOOST_CHECK(fake_pbft.consensus()->toView() == 0);
     BOOST_CHECK(fake_pbft.consensus()->view() == 0);
@@ -798,6 +798,138 @@ BOOST_AUTO_TEST_CASE(testHandleMsg)
         }
     }
 }
+
+/// test answering the transactions missed by a compact prepare
+BOOST_AUTO_TEST_CASE(testHandleGetMissedTxs)
+{
+    FakeConsensus<FakePBFTEngine> fake_pbft(4, ProtocolID::PBFT);
+    FakeBlock fake_block(5);
+    PrepareReq req;
+    req.pBlock = std::make_shared<Block>(fake_block.m_block);
+    req.block_hash = req.pBlock->header().hash();
+    fake_pbft.consensus()->updateMissedTxsSource(req);
+    h512 requester = fake_pbft.m_sealerList[1];
+
+    /// answer the requested transactions in order
+    fake_pbft.consensus()->handleGetMissedTxsMsg(
+        fakeGetMissedTxsPacket(req.block_hash, {0, 3}, 1, requester));
+    compareAsyncSendTime(fake_pbft, requester, 1);
+    PBFTMsgPacket packet = lastSentPacket(fake_pbft, requester);
+    BOOST_CHECK(packet.packet_id == MissedTxsPacket);
+    RLP response(ref(packet.data));
+    BOOST_CHECK(response[0].toHash<h256>() == req.block_hash);
+    BOOST_REQUIRE(response[1].itemCount() == 2);
+    Transaction tx;
+    tx.decode(response[1][0], CheckTransaction::None);
+    BOOST_CHECK(tx.sha3() == req.pBlock->transactions()[0].sha3());
+    tx.decode(response[1][1], CheckTransaction::None);
+    BOOST_CHECK(tx.sha3() == req.pBlock->transactions()[3].sha3());
+
+    /// an unknown block and an out-of-range index are answered with an empty list
+    fake_pbft.consensus()->handleGetMissedTxsMsg(
+        fakeGetMissedTxsPacket(dev::sha3("fake"), {0}, 1, requester));
+    compareAsyncSendTime(fake_pbft, requester, 2);
+    packet = lastSentPacket(fake_pbft, requester);
+    BOOST_CHECK(RLP(ref(packet.data))[1].itemCount() == 0);
+    fake_pbft.consensus()->handleGetMissedTxsMsg(
+        fakeGetMissedTxsPacket(req.block_hash, {1, 5}, 1, requester));
+    compareAsyncSendTime(fake_pbft, requester, 3);
+    packet = lastSentPacket(fake_pbft, requester);
+    BOOST_CHECK(RLP(ref(packet.data))[1].itemCount() == 0);
+}
+
+/// test fetching the missed transactions of a compact prepare and relaying the rebuilt prepare
+BOOST_AUTO_TEST_CASE(testCompactPrepareMissedTxs)
+{
+    FakeConsensus<FakePBFTEngine> fake_pbft(4, ProtocolID::PBFT);
+    fake_pbft.consensus()->initPBFTEnv(
+        3 * (fake_pbft.consensus()->timeManager().m_emptyBlockGenTime));
+    fake_pbft.consensus()->setEnableCompactPrepare(true);
+    fake_pbft.consensus()->setBroadcastTreeWidth(1);
+    PrepareReq req;
+    PBFTMsgPacket packet;
+    fakeCompactPrepare(fake_pbft, req, packet, 0);
+    auto children = BroadcastTree(fake_pbft.consensus()->nodeNum(), 1, req.idx)
+                        .children(fake_pbft.consensus()->nodeIdx());
+    BOOST_REQUIRE(children.size() == 1);
+    /// the prepare is relayed by a sealer other than the leader and the child
+    IDXTYPE relayerIdx = 0;
+    while (relayerIdx == req.idx || relayerIdx == children[0])
+    {
+        relayerIdx++;
+    }
+    packet.setOtherField(relayerIdx, fake_pbft.m_sealerList[relayerIdx], "");
+    h512 relayer = fake_pbft.m_sealerList[relayerIdx];
+    h512 leader = fake_pbft.m_sealerList[req.idx];
+    h512 child = fake_pbft.m_sealerList[children[0]];
+
+    /// fetch the missed transactions from the relayer
+    fake_pbft.consensus()->handleMsg(packet);
+    BOOST_REQUIRE(fake_pbft.consensus()->pendingCompactPrepare());
+    compareAsyncSendTime(fake_pbft, relayer, 1);
+    PBFTMsgPacket request = lastSentPacket(fake_pbft, relayer);
+    BOOST_CHECK(request.packet_id == GetMissedTxsPacket);
+    BOOST_CHECK(RLP(ref(request.data))[1].toVector<unsigned>() == std::vector<unsigned>({0, 1, 2}));
+    BOOST_CHECK(!fake_pbft.consensus()->broadcastFilter(
+        child, CompactPrepareReqPacket, req.uniqueKey()));
+
+    /// a transaction that doesn't match its hash is rejected and fetched from the leader
+    Transactions tampered = req.pBlock->transactions();
+    tampered[1] = FakeBlock(1).m_block.transactions()[0];
+    fake_pbft.consensus()->handleMsg(
+        fakeMissedTxsPacket(req.block_hash, tampered, relayerIdx, relayer));
+    BOOST_REQUIRE(fake_pbft.consensus()->pendingCompactPrepare());
+    BOOST_CHECK(fake_pbft.consensus()->pendingCompactPrepare()->fetchFrom == leader);
+    compareAsyncSendTime(fake_pbft, leader, 1);
+    BOOST_CHECK(lastSentPacket(fake_pbft, leader).packet_id == GetMissedTxsPacket);
+    BOOST_CHECK(!fake_pbft.consensus()->broadcastFilter(
+        child, CompactPrepareReqPacket, req.uniqueKey()));
+
+    /// the answer of a node the transactions are not requested from is ignored
+    fake_pbft.consensus()->handleMsg(
+        fakeMissedTxsPacket(req.block_hash, req.pBlock->transactions(), relayerIdx, relayer));
+    BOOST_REQUIRE(fake_pbft.consensus()->pendingCompactPrepare());
+
+    /// the rebuilt prepare is relayed to the child in the tree
+    fake_pbft.consensus()->handleMsg(
+        fakeMissedTxsPacket(req.block_hash, req.pBlock->transactions(), req.idx, leader));
+    BOOST_CHECK(!fake_pbft.consensus()->pendingCompactPrepare());
+    BOOST_CHECK(fake_pbft.consensus()->broadcastFilter(
+        child, CompactPrepareReqPacket, req.uniqueKey()));
+}
+
+/// test retrying and dropping a compact prepare whose transactions are never received
+BOOST_AUTO_TEST_CASE(testCompactPrepareTimeout)
+{
+    FakeConsensus<FakePBFTEngine> fake_pbft(4, ProtocolID::PBFT);
+    fake_pbft.consensus()->initPBFTEnv(
+        3 * (fake_pbft.consensus()->timeManager().m_emptyBlockGenTime));
+    fake_pbft.consensus()->setEnableCompactPrepare(true);
+    PrepareReq req;
+    PBFTMsgPacket packet;
+    fakeCompactPrepare(fake_pbft, req, packet, 0);
+    IDXTYPE relayerIdx = (req.idx + 1) % 4;
+    packet.setOtherField(relayerIdx, fake_pbft.m_sealerList[relayerIdx], "");
+    h512 leader = fake_pbft.m_sealerList[req.idx];
+
+    fake_pbft.consensus()->handleMsg(packet);
+    BOOST_REQUIRE(fake_pbft.consensus()->pendingCompactPrepare());
+    /// not timed out yet
+    fake_pbft.consensus()->checkCompactPrepareTimeout();
+    compareAsyncSendTime(fake_pbft, leader, 0);
+    /// time out immediately
+    fake_pbft.consensus()->mutableTimeManager().m_viewTimeout = 0;
+    for (size_t i = 1; i <= 3; i++)
+    {
+        fake_pbft.consensus()->checkCompactPrepareTimeout();
+        BOOST_REQUIRE(fake_pbft.consensus()->pendingCompactPrepare());
+        BOOST_CHECK(fake_pbft.consensus()->pendingCompactPrepare()->retries == i);
+        compareAsyncSendTime(fake_pbft, leader, i);
+    }
+    fake_pbft.consensus()->checkCompactPrepareTimeout();
+    BOOST_CHECK(!fake_pbft.consensus()->pendingCompactPrepare());
+    compareAsyncSendTime(fake_pbft, leader, 3);
+}
 BOOST_AUTO_TEST_SUITE_END()
 }  // namespace test
 }  // namespace dev
@@ -244,18 +244,17 @@ static inline void checkDelCommitCache(
 static void checkBackupMsg(FakeConsensus<FakePBFTEngine>& fake_pbft, std::string const& key,
     bytes const& msgData, bool shouldClean = true)
 {
-    BOOST_CHECK(fake_pbft.consensus()->backupDB());
+    BOOST_CHECK(fake_pbft.consensus()->backupLog());
     /// insert succ
-    std::string data = fake_pbft.consensus()->backupDB()->lookup(key);
+    bytes data = fake_pbft.consensus()->backupLog()->lookup(key);
     if (msgData.size() == 0)
         BOOST_CHECK(data.empty() == true);
     else
     {
-        BOOST_CHECK(data == toHex(msgData));
+        BOOST_CHECK(data == msgData);
         /// remove the key
-        std::string empty = "";
         if (shouldClean)
-            fake_pbft.consensus()->backupDB()->insert(key, empty);
+            fake_pbft.consensus()->backupLog()->append(key, bytes());
     }
 }
 
@@ -638,5 +637,66 @@ static void TestIsValidViewChange(FakeConsensus<FakePBFTEngine>& fake_pbft, View
     req.view -= 1;
     BOOST_CHECK(fake_pbft.consensus()->isValidViewChangeReq(req, nodeIdxSource) == true);
 }
+
+/// fake a compact prepare of a block whose transactions are not in the txpool
+static void fakeCompactPrepare(FakeConsensus<FakePBFTEngine>& fake_pbft, PrepareReq& req,
+    PBFTMsgPacket& packet, IDXTYPE const& fromIdx)
+{
+    KeyPair key_pair;
+    req = FakePrepareReq(key_pair);
+    fakeValidPrepare(fake_pbft, req);
+    FakeBlock fake_block(3);
+    req.pBlock->appendTransactions(fake_block.m_block.transactions());
+    req.encodeCompact(packet.data);
+    packet.packet_id = CompactPrepareReqPacket;
+    packet.ttl = 5;
+    packet.setOtherField(fromIdx, fake_pbft.m_sealerList[fromIdx], "");
+}
+
+static PBFTMsgPacket fakeGetMissedTxsPacket(h256 const& blockHash,
+    std::vector<unsigned> const& indexes, IDXTYPE const& idx, h512 const& nodeId)
+{
+    RLPStream request;
+    request.appendList(2) << blockHash;
+    request.appendVector(indexes);
+    PBFTMsgPacket packet;
+    request.swapOut(packet.data);
+    packet.packet_id = GetMissedTxsPacket;
+    packet.setOtherField(idx, nodeId, "");
+    return packet;
+}
+
+static PBFTMsgPacket fakeMissedTxsPacket(h256 const& blockHash, Transactions const& txs,
+    IDXTYPE const& idx, h512 const& nodeId)
+{
+    RLPStream txList;
+    txList.appendList(txs.size());
+    for (auto const& tx : txs)
+    {
+        bytes txData;
+        tx.encode(txData);
+        txList.appendRaw(txData);
+    }
+    RLPStream response;
+    response.appendList(2) << blockHash;
+    response.appendRaw(txList.out());
+    PBFTMsgPacket packet;
+    response.swapOut(packet.data);
+    packet.packet_id = MissedTxsPacket;
+    packet.setOtherField(idx, nodeId, "");
+    return packet;
+}
+
+/// decode the PBFT packet last sent to the given node
+static PBFTMsgPacket lastSentPacket(FakeConsensus<FakePBFTEngine>& fake_pbft, h512 const& nodeId)
+{
+    FakeService* service =
+        dynamic_cast<FakeService*>(fake_pbft.consensus()->mutableService().get());
+    P2PMessage::Ptr message = service->getAsyncSendMessageByNodeID(nodeId);
+    BOOST_REQUIRE(message);
+    PBFTMsgPacket packet;
+    packet.decode(message->payload());
+    return packet;
+}
 }  // namespace test
 }  // namespace dev
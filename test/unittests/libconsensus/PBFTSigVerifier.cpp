@@ -0,0 +1,156 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+
+/**
+ * @brief: unit test and benchmark for libconsensus/pbft/PBFTSigVerifier.h
+ * @file: PBFTSigVerifier.cpp
+ */
+#include <libconsensus/pbft/PBFTSigVerifier.h>
+#include <test/tools/libbcos/Options.h>
+#include <test/tools/libutils/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <functional>
+#include <thread>
+using namespace dev::consensus;
+namespace ut = boost::unit_test;
+namespace dev
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(PBFTSigVerifierTest, TestOutputHelperFixture)
+
+/// the requests of _num sealers on the same block
+static std::vector<std::pair<KeyPair, PBFTMsg>> fakeRequests(size_t _num)
+{
+    std::vector<std::pair<KeyPair, PBFTMsg>> reqs;
+    h256 blockHash = sha3("block");
+    for (size_t i = 0; i < _num; i++)
+    {
+        KeyPair keyPair = KeyPair::create();
+        reqs.push_back(std::make_pair(keyPair, PBFTMsg(keyPair, 10, 1, i, blockHash)));
+    }
+    return reqs;
+}
+
+BOOST_AUTO_TEST_CASE(testVerify)
+{
+    auto reqs = fakeRequests(8);
+    PBFTSigVerifier verifier("verify", 2, 4);
+    for (auto const& req : reqs)
+    {
+        verifier.asyncVerify(req.first.pub(), req.second);
+    }
+    /// the results of the first four requests have been evicted
+    for (auto req = reqs.rbegin(); req != reqs.rend(); req++)
+    {
+        BOOST_CHECK(verifier.verify(req->first.pub(), req->second));
+    }
+    BOOST_CHECK_EQUAL(verifier.size(), 4u);
+    BOOST_CHECK_EQUAL(verifier.queryTimes(), 8u);
+    BOOST_CHECK_EQUAL(verifier.hitTimes(), 4u);
+
+    /// the cached result is not reused by the request with a forged field
+    PBFTMsg forged = reqs[0].second;
+    forged.timestamp += 1;
+    verifier.asyncVerify(reqs[0].first.pub(), forged);
+    BOOST_CHECK(!verifier.verify(reqs[0].first.pub(), forged));
+    BOOST_CHECK(!verifier.verify(reqs[1].first.pub(), reqs[0].second));
+
+    /// verify on the calling thread without workers
+    PBFTSigVerifier syncVerifier("verify", 0);
+    syncVerifier.asyncVerify(reqs[0].first.pub(), reqs[0].second);
+    BOOST_CHECK_EQUAL(syncVerifier.size(), 0u);
+    BOOST_CHECK(syncVerifier.verify(reqs[0].first.pub(), reqs[0].second));
+    BOOST_CHECK(syncVerifier.verify(reqs[0].first.pub(), reqs[0].second));
+    BOOST_CHECK_EQUAL(syncVerifier.hitTimes(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(testVerifyBatch)
+{
+    auto reqs = fakeRequests(10);
+    std::vector<SigItem> items;
+    for (auto const& req : reqs)
+    {
+        items.push_back(SigItem{req.first.pub(), req.second.sig, req.second.block_hash});
+    }
+    BOOST_CHECK(PBFTSigVerifier::verifyBatch(items));
+    BOOST_CHECK(PBFTSigVerifier::verifyBatch(std::vector<SigItem>()));
+    items[5].pub = items[6].pub;
+    BOOST_CHECK(!PBFTSigVerifier::verifyBatch(items));
+}
+
+/// compare the time to collect a quorum of sign requests serially, on the verifier workers and
+/// with the batch verification
+BOOST_AUTO_TEST_CASE(bench_verify, *ut::label("bench"))
+{
+    if (!Options::get().all)
+    {
+        std::cout << "Skipping benchmark test because --all option is not specified.\n";
+        return;
+    }
+    size_t const round = 20;
+    size_t threadNum = std::max(1u, std::thread::hardware_concurrency() / 2);
+    for (size_t sealerNum : {4, 10, 50, 100})
+    {
+        auto reqs = fakeRequests(sealerNum);
+        std::vector<SigItem> items;
+        for (auto const& req : reqs)
+        {
+            items.push_back(SigItem{req.first.pub(), req.second.sig, req.second.block_hash});
+            items.push_back(
+                SigItem{req.first.pub(), req.second.sig2, req.second.fieldsWithoutBlock()});
+        }
+
+        auto measure = [&](std::function<void()> _verify) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < round; i++)
+            {
+                _verify();
+            }
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count() /
+                   round;
+        };
+        auto serial = measure([&]() {
+            for (auto const& req : reqs)
+            {
+                BOOST_REQUIRE(PBFTSigVerifier::verifyReq(req.first.pub(), req.second));
+            }
+        });
+        auto parallel = measure([&]() {
+            PBFTSigVerifier verifier("bench", threadNum);
+            for (auto const& req : reqs)
+            {
+                verifier.asyncVerify(req.first.pub(), req.second);
+            }
+            for (auto const& req : reqs)
+            {
+                BOOST_REQUIRE(verifier.verify(req.first.pub(), req.second));
+            }
+        });
+        auto batch = measure([&]() { BOOST_REQUIRE(PBFTSigVerifier::verifyBatch(items)); });
+        std::cout << "sealers: " << sealerNum << ", serial: " << serial
+                  << " us, parallel(" << threadNum << " threads): " << parallel
+                  << " us, batch: " << batch << " us" << std::endl;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace dev
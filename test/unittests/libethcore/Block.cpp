@@ -89,6 +89,30 @@ BOOST_AUTO_TEST_CASE(testExceptionCases)
     fake_block.CheckInvalidBlockData(1);
 }
 
+/// test decoding a single transaction and receipt of the encoded block
+BOOST_AUTO_TEST_CASE(testDecodeAt)
+{
+    FakeBlock fake_block(5);
+    for (size_t i = 0; i < 5; i++)
+    {
+        BlockHeader header;
+        Transaction tx;
+        TransactionReceipt receipt;
+        BOOST_CHECK(Block::decodeAt(ref(fake_block.getBlockData()), i, header, &tx, &receipt));
+        BOOST_CHECK(header == fake_block.m_blockHeader);
+        BOOST_CHECK(tx == fake_block.m_transaction[i]);
+        BOOST_CHECK(receipt.rlp() == fake_block.m_transactionReceipt[i].rlp());
+    }
+    BlockHeader header;
+    Transaction tx;
+    BOOST_CHECK(Block::decodeAt(ref(fake_block.getBlockData()), 2, header, &tx, nullptr));
+    BOOST_CHECK(tx == fake_block.m_transaction[2]);
+    BOOST_CHECK(!Block::decodeAt(ref(fake_block.getBlockData()), 5, header, &tx, nullptr));
+
+    FakeBlock fake_block_empty;
+    BOOST_CHECK(!Block::decodeAt(ref(fake_block_empty.getBlockData()), 0, header, &tx, nullptr));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace test
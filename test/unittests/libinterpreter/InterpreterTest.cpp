@@ -26,7 +26,9 @@
 #include <libdevcore/FixedHash.h>
 #include <libdevcrypto/Common.h>
 #include <libethcore/EVMSchedule.h>
+#include <libinterpreter/AnalyzedCode.h>
 #include <libinterpreter/interpreter.h>
+#include <test/tools/libbcos/Options.h>
 #include <test/tools/libutils/FakeEvmc.h>
 #include <test/tools/libutils/TestOutputHelper.h>
 #include <boost/test/unit_test.hpp>
@@ -44,6 +46,69 @@ namespace dev
 {
 namespace test
 {
+// the contracts of the tests below, run again by optimizedCodeTest
+string const c_arithmeticCode1 =
+    "60606040523415600b57fe5b60405160208060d3833981016040528080519060200190919050505b60018101"
+    "6000819055506001810360018190555060648102600281905550600381811515605057fe5b04600381905550"
+    "600a81811515606257fe5b066004819055506002810a6005819055506003819060020a026006819055506001"
+    "819060020a90046007819055505b505b60338060a06000396000f30060606040525bfe00a165627a7a723058"
+    "2089c2307e810ceda56160585b80561a69fc72cb46a335d905cd748801c9ba2d830029";
+
+string const c_arithmeticCode2 =
+    "608060405234801561001057600080fd5b506040516020806102368339810180604052810190808051906020"
+    "019092919050505060018101600081905550606481036001819055507fffffffffffffffffffffffffffffff"
+    "ffffffffffffffffffffffffffffffff9c810260028190555060038181151561007c57fe5b05600381905550"
+    "600a8181151561008f57fe5b076004819055506100ad6100ef640100000000026401000000009004565b6005"
+    "600060066000600760006008600060096000600a60008c919050558b919050558a9190505589919050558891"
+    "90505587919050555050505050505061012e565b600080600080600080600460021b9550600860021c945060"
+    "0460011d935060066007600a08925060076004600309915060ff601f1a9050909192939495565b60fa806101"
+    "3c6000396000f300608060405260043610603f576000357c0100000000000000000000000000000000000000"
+    "000000000000000000900463ffffffff168063035ce6fa146044575b600080fd5b348015604f57600080fd5b"
+    "506056608f565b60405180878152602001868152602001858152602001848152602001838152602001828152"
+    "602001965050505050505060405180910390f35b600080600080600080600460021b9550600860021c945060"
+    "0460011d935060066007600a08925060076004600309915060ff601f1a90509091929394955600a165627a7a"
+    "72305820cc4f9b8d08e25bde5e4071499ce01359a27bd898c321c7c0150eac91b3a38aa50029";
+
+string const c_comparisonsCode1 =
+    "60606040523415600b57fe5b60405160208061010c833981016040528080519060200190919050505b600060"
+    "00829150600183019050808210600060006101000a81548160ff021916908315150217905550808211156000"
+    "60016101000a81548160ff02191690831515021790555080821415600060026101000a81548160ff02191690"
+    "831515021790555080821115600060036101000a81548160ff02191690831515021790555080821015156000"
+    "60046101000a81548160ff0219169083151502179055505b5050505b6033806100d96000396000f300606060"
+    "40525bfe00a165627a7a7230582074f82852a7899b3b0a67289c346f50f08b2eca7ab65580af33dedb3e72b6"
+    "8bde0029";
+
+string const c_comparisonsCode2 =
+    "60606040523415600b57fe5b60405160208060c283398101604052515b6000805460ff191660018301808412"
+    "91821761ff001916610100828613159081029190911762ff000019168286141562010000021763ff00000019"
+    "166301000000919091021764ff000000001916640100000000929092029190911790915581905b5050505b60"
+    "3380608f6000396000f30060606040525bfe00a165627a7a723058207ffb02d83832bb77d2f385eac28618b0"
+    "d66b382244251d54fec46642f8252eeb0029";
+
+string const c_bitOperationCode =
+    "60606040523415600b57fe5b604051602080607883398101604052515b610101808216600055808217600155"
+    "811860025580196003555b505b60338060456000396000f30060606040525bfe00a165627a7a72305820defb"
+    "2016449ae0c78dc39227ce845b9b0ca1f975a4dd3bcf448f0296b9ac2e920029";
+
+string const c_logCode =
+    "6060604052341561000c57fe5b5b7ff4560403888256621a13abd81f4930ecb469c609f6317e1dd2ee34fe69"
+    "293e1b60405180905060405180910390a17f0b24d1aaf91c6017a8257e85108e3ce49d5461be0dd82383c5eb"
+    "5f3eb47a1b4e60016040518082815260200191505060405180910390a160017fce34f015a0e20f2b0daf980b"
+    "28ed50729e87b993e4d30cca4c3f4da05acbd0ac60026040518082815260200191505060405180910390a260"
+    "0260017fd3d2405dd719b971a7f9b4e0a312db1f22d361f171f71c9870c715833392b52b6003604051808281"
+    "5260200191505060405180910390a36003600260017fc976bb9064fc5bb5ef2b52e9809965f4a1bb771fac31"
+    "a4937d151ca668c8c63c60046040518082815260200191505060405180910390a45b5b603380610138600039"
+    "6000f30060606040525bfe00a165627a7a723058207517a39f110484c49f94079c16e3775ecbe1a3c4cd46af"
+    "ac460426f8426fc4270029";
+
+string const c_helloWorldCode =
+    "608060405234801561001057600080fd5b50607b60008190555060df806100276000396000f3006080604052"
+    "600436106049576000357c0100000000000000000000000000000000000000000000000000000000900463ff"
+    "ffffff16806360fe47b114604e5780636d4ce63c146078575b600080fd5b348015605957600080fd5b506076"
+    "6004803603810190808035906020019092919050505060a0565b005b348015608357600080fd5b50608a60aa"
+    "565b6040518082815260200191505060405180910390f35b8060008190555050565b600080549050905600a1"
+    "65627a7a723058206ed282a30254e86080aeca513abfda612e925676970bdf4f17a8e5d36bcd8d230029";
+
 class InterpreterFixture : TestOutputHelperFixture
 {
 public:
@@ -243,12 +308,7 @@ BOOST_AUTO_TEST_CASE(arithmeticCaculateTest1)
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
     bytes code = fromHex(
-        string(
-            "60606040523415600b57fe5b60405160208060d3833981016040528080519060200190919050505b600181"
-            "016000819055506001810360018190555060648102600281905550600381811515605057fe5b0460038190"
-            "5550600a81811515606257fe5b066004819055506002810a6005819055506003819060020a026006819055"
-            "506001819060020a90046007819055505b505b60338060a06000396000f30060606040525bfe00a165627a"
-            "7a7230582089c2307e810ceda56160585b80561a69fc72cb46a335d905cd748801c9ba2d830029") +
+        c_arithmeticCode1 +
         string("0000000000000000000000000000000000000000000000000000000000000042"));
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
@@ -334,20 +394,7 @@ BOOST_AUTO_TEST_CASE(arithmeticCaculateTest2)
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
     bytes code = fromHex(
-        string("608060405234801561001057600080fd5b5060405160208061023683398101806040528101908080519"
-               "06020019092919050505060018101600081905550606481036001819055507fffffffffffffffffffff"
-               "ffffffffffffffffffffffffffffffffffffffffff9c810260028190555060038181151561007c57fe5"
-               "b05600381905550600a8181151561008f57fe5b076004819055506100ad6100ef640100000000026401"
-               "000000009004565b6005600060066000600760006008600060096000600a60008c919050558b9190505"
-               "58a919050558991905055889190505587919050555050505050505061012e565b600080600080600080"
-               "600460021b9550600860021c9450600460011d935060066007600a08925060076004600309915060ff6"
-               "01f1a9050909192939495565b60fa8061013c6000396000f300608060405260043610603f576000357c"
-               "0100000000000000000000000000000000000000000000000000000000900463ffffffff168063035ce"
-               "6fa146044575b600080fd5b348015604f57600080fd5b506056608f565b604051808781526020018681"
-               "52602001858152602001848152602001838152602001828152602001965050505050505060405180910"
-               "390f35b600080600080600080600460021b9550600860021c9450600460011d935060066007600a0892"
-               "5060076004600309915060ff601f1a90509091929394955600a165627a7a72305820cc4f9b8d08e25bd"
-               "e5e4071499ce01359a27bd898c321c7c0150eac91b3a38aa50029") +
+        c_arithmeticCode2 +
         string("0000000000000000000000000000000000000000000000000000000000000042"));
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
@@ -426,13 +473,7 @@ BOOST_AUTO_TEST_CASE(comparisonsTest1)
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
     bytes code = fromHex(
-        string("60606040523415600b57fe5b60405160208061010c833981016040528080519060200190919050505b6"
-               "0006000829150600183019050808210600060006101000a81548160ff02191690831515021790555080"
-               "821115600060016101000a81548160ff02191690831515021790555080821415600060026101000a815"
-               "48160ff02191690831515021790555080821115600060036101000a81548160ff021916908315150217"
-               "9055508082101515600060046101000a81548160ff0219169083151502179055505b5050505b6033806"
-               "100d96000396000f30060606040525bfe00a165627a7a7230582074f82852a7899b3b0a67289c346f50"
-               "f08b2eca7ab65580af33dedb3e72b68bde0029") +
+        c_comparisonsCode1 +
         string("0000000000000000000000000000000000000000000000000000000000000042"));
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
@@ -482,11 +523,7 @@ BOOST_AUTO_TEST_CASE(comparisonsTest2)
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
     bytes code = fromHex(
-        string("60606040523415600b57fe5b60405160208060c283398101604052515b6000805460ff1916600183018"
-               "0841291821761ff001916610100828613159081029190911762ff000019168286141562010000021763"
-               "ff00000019166301000000919091021764ff00000000191664010000000092909202919091179091558"
-               "1905b5050505b603380608f6000396000f30060606040525bfe00a165627a7a723058207ffb02d83832"
-               "bb77d2f385eac28618b0d66b382244251d54fec46642f8252eeb0029") +
+        c_comparisonsCode2 +
         string("0000000000000000000000000000000000000000000000000000000000000042"));
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
@@ -532,9 +569,7 @@ BOOST_AUTO_TEST_CASE(bitOperationTest)
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
     bytes code = fromHex(
-        string("60606040523415600b57fe5b604051602080607883398101604052515b6101018082166000558082176"
-               "00155811860025580196003555b505b60338060456000396000f30060606040525bfe00a165627a7a72"
-               "305820defb2016449ae0c78dc39227ce845b9b0ca1f975a4dd3bcf448f0296b9ac2e920029") +
+        c_bitOperationCode +
         string("0000000000000000000000000000000000000000000000000000000000000042"));
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
@@ -755,17 +790,7 @@ BOOST_AUTO_TEST_CASE(LogTest)
     }
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
-    bytes code = fromHex(
-        string("6060604052341561000c57fe5b5b7ff4560403888256621a13abd81f4930ecb469c609f6317e1dd2ee3"
-               "4fe69293e1b60405180905060405180910390a17f0b24d1aaf91c6017a8257e85108e3ce49d5461be0d"
-               "d82383c5eb5f3eb47a1b4e60016040518082815260200191505060405180910390a160017fce34f015a"
-               "0e20f2b0daf980b28ed50729e87b993e4d30cca4c3f4da05acbd0ac6002604051808281526020019150"
-               "5060405180910390a2600260017fd3d2405dd719b971a7f9b4e0a312db1f22d361f171f71c9870c7158"
-               "33392b52b60036040518082815260200191505060405180910390a36003600260017fc976bb9064fc5b"
-               "b5ef2b52e9809965f4a1bb771fac31a4937d151ca668c8c63c600460405180828152602001915050604"
-               "05180910390a45b5b6033806101386000396000f30060606040525bfe00a165627a7a723058207517a3"
-               "9f110484c49f94079c16e3775ecbe1a3c4cd46afac460426f8426fc4270029") +
-        string(""));
+    bytes code = fromHex(c_logCode);
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
     Address caller = Address("1000000000000000000000000000000000000000");
@@ -812,15 +837,7 @@ BOOST_AUTO_TEST_CASE(accessFunctionTest)
     }
     */
     dev::eth::EVMSchedule const& schedule = DefaultSchedule;
-    bytes code = fromHex(
-        string("608060405234801561001057600080fd5b50607b60008190555060df806100276000396000f30060806"
-               "04052600436106049576000357c01000000000000000000000000000000000000000000000000000000"
-               "00900463ffffffff16806360fe47b114604e5780636d4ce63c146078575b600080fd5b3480156059576"
-               "00080fd5b5060766004803603810190808035906020019092919050505060a0565b005b348015608357"
-               "600080fd5b50608a60aa565b6040518082815260200191505060405180910390f35b806000819055505"
-               "0565b600080549050905600a165627a7a723058206ed282a30254e86080aeca513abfda612e92567697"
-               "0bdf4f17a8e5d36bcd8d230029") +
-        string(""));
+    bytes code = fromHex(c_helloWorldCode);
     bytes data = fromHex("");
     Address destination{KeyPair::create().address()};
     Address caller = Address("1000000000000000000000000000000000000000");
@@ -1230,6 +1247,178 @@ BOOST_AUTO_TEST_CASE(errorCodeTest)
 }
 
 
+BOOST_AUTO_TEST_CASE(analyzedCodeCacheTest)
+{
+    // the HelloWorld of accessFunctionTest, the runtime code has pushes of the constant pool
+    // and constant jumps
+    dev::eth::EVMSchedule const& schedule = DefaultSchedule;
+    bytes code = fromHex(c_helloWorldCode);
+    Address destination{KeyPair::create().address()};
+    Address caller = Address("1000000000000000000000000000000000000000");
+    evmc_result result =
+        evmc.execute(schedule, code, bytes(), destination, caller, 0, 1000000, 0, true, false);
+    BOOST_REQUIRE(0 == result.status_code);
+
+    auto& cache = AnalyzedCodeCache::instance();
+    cache.clear();
+    code = getContractCode(destination);
+    // call function get()
+    bytes data = fromHex("0x6d4ce63c");
+    auto callGet = [&]() {
+        result =
+            evmc.execute(schedule, code, data, destination, caller, 0, 1000000, 0, false, true);
+        BOOST_REQUIRE(0 == result.status_code);
+        u256 r = fromBigEndian<u256>(bytesConstRef(result.output_data, result.output_size));
+        int64_t gasLeft = result.gas_left;
+        if (result.release)
+        {
+            result.release(&result);
+        }
+        BOOST_CHECK_EQUAL(u256(123), r);
+        return gasLeft;
+    };
+
+    auto queryTimes = cache.queryTimes();
+    auto hitTimes = cache.hitTimes();
+    auto gasLeft = callGet();
+    BOOST_CHECK(cache.get(sha3(code)) != nullptr);
+    /// the cached code costs the same gas
+    BOOST_CHECK_EQUAL(callGet(), gasLeft);
+    BOOST_CHECK_EQUAL(cache.queryTimes() - queryTimes, 3u);
+    BOOST_CHECK_EQUAL(cache.hitTimes() - hitTimes, 2u);
+
+    /// the most recently used code is kept beyond the capacity
+    cache.setCapacity(0);
+    BOOST_CHECK(cache.get(sha3(code)) != nullptr);
+    cache.setCapacity(AnalyzedCodeCache::c_defaultCapacity);
+
+    // benchmark of the calls analyzing the code every time and the calls of the cached code
+    if (!Options::get().all)
+    {
+        std::cout << "Skipping benchmark test because --all option is not specified.\n";
+        return;
+    }
+    size_t const rounds = 10000;
+    auto start = utcTimeUs();
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        cache.clear();
+        callGet();
+    }
+    auto analyzedTime = utcTimeUs() - start;
+    start = utcTimeUs();
+    for (size_t i = 0; i < rounds; ++i)
+    {
+        callGet();
+    }
+    auto cachedTime = utcTimeUs() - start;
+    cout << "calls: " << rounds << ", analyzed every call: " << analyzedTime
+         << "us, cached: " << cachedTime << "us" << endl;
+}
+
+BOOST_AUTO_TEST_CASE(optimizedCodeTest)
+{
+    // every vector is run as a call with the rewritten code and with the raw code put in the
+    // cache, both must end the same
+    dev::eth::EVMSchedule const& schedule = DefaultSchedule;
+    Address caller = Address("1000000000000000000000000000000000000000");
+    struct Outcome
+    {
+        evmc_status_code status;
+        int64_t gasLeft;
+        bytes output;
+        map<string, u256> storage;
+    };
+    auto& cache = AnalyzedCodeCache::instance();
+    auto run = [&](bytes const& _code, bytes const& _data, bool _optimize) {
+        cache.clear();
+        cache.add(sha3(_code), AnalyzedCode::analyze(_code.data(), _code.size(), _optimize));
+        auto hitTimes = cache.hitTimes();
+        Address destination{KeyPair::create().address()};
+        evmc_result result =
+            evmc.execute(schedule, _code, _data, destination, caller, 0, 1000000, 0, false, false);
+        BOOST_CHECK_EQUAL(cache.hitTimes() - hitTimes, 1u);
+        Outcome outcome{result.status_code, result.gas_left,
+            bytesConstRef(result.output_data, result.output_size).toBytes(), {}};
+        if (result.release)
+        {
+            result.release(&result);
+        }
+        for (auto const& value : state[destination.hex()])
+        {
+            outcome.storage[value.first] = fromEvmC(value.second);
+        }
+        return outcome;
+    };
+    auto check = [&](bytes const& _code, bytes const& _data) {
+        auto optimized = run(_code, _data, true);
+        auto raw = run(_code, _data, false);
+        BOOST_CHECK_EQUAL(optimized.status, raw.status);
+        BOOST_CHECK_EQUAL(optimized.gasLeft, raw.gasLeft);
+        BOOST_CHECK(optimized.output == raw.output);
+        BOOST_CHECK(optimized.storage == raw.storage);
+        return optimized;
+    };
+
+    bytes param = fromHex("0000000000000000000000000000000000000000000000000000000000000042");
+    for (auto const& code : {c_arithmeticCode1, c_arithmeticCode2, c_comparisonsCode1,
+             c_comparisonsCode2, c_bitOperationCode})
+    {
+        BOOST_CHECK_EQUAL(check(fromHex(code) + param, bytes()).status, EVMC_SUCCESS);
+    }
+    BOOST_CHECK_EQUAL(check(fromHex(c_logCode), bytes()).status, EVMC_SUCCESS);
+    // the constructor returns the runtime code of HelloWorld
+    auto helloWorld = check(fromHex(c_helloWorldCode), bytes()).output;
+    BOOST_CHECK_EQUAL(check(helloWorld, fromHex("0x6d4ce63c")).status, EVMC_SUCCESS);
+    BOOST_CHECK_EQUAL(
+        check(helloWorld,
+            fromHex("0x60fe47b100000000000000000000000000000000000000000000000000000000000001c8"))
+            .status,
+        EVMC_SUCCESS);
+    // the vectors of addTest and errorCodeTest
+    BOOST_CHECK_EQUAL(check(fromHex("602060006001600201600052f3"), bytes()).status, EVMC_SUCCESS);
+    BOOST_CHECK_EQUAL(check(fromHex("60006000fd"), bytes()).status, EVMC_REVERT);
+    BOOST_CHECK_EQUAL(check(fromHex("4f"), bytes()).status, EVMC_UNDEFINED_INSTRUCTION);
+    BOOST_CHECK_EQUAL(check(fromHex("56"), bytes()).status, EVMC_STACK_UNDERFLOW);
+    BOOST_CHECK_EQUAL(
+        check(fromHex("67FFFFFFFFFFFFFFFF56"), bytes()).status, EVMC_BAD_JUMP_DESTINATION);
+
+    // the pool is addressed by 2 bytes, the push of 0x10000 is the first one kept as PUSH6
+    bytes code;
+    size_t lastPush = 0;
+    for (size_t i = 0; i <= 0x10000; ++i)
+    {
+        lastPush = code.size();
+        code.push_back((byte)Instruction::PUSH6);
+        for (size_t j = 6; j--;)
+        {
+            code.push_back((byte)(i >> (8 * j)));
+        }
+        if (i < 0xffff)
+        {
+            code.push_back((byte)Instruction::POP);
+        }
+    }
+    // MSTORE 0x10000 at 0 and 0xffff at 0x20, RETURN both
+    code += fromHex("60005260205260406000f3");
+    auto analyzed = AnalyzedCode::analyze(code.data(), code.size());
+    BOOST_CHECK(analyzed->code[lastPush] == (byte)Instruction::PUSH6);
+    // the pool stays empty when EVM_OPTIMIZE is off
+    if (!analyzed->pool.empty())
+    {
+        BOOST_CHECK_EQUAL(analyzed->pool.size(), 0x10000u);
+        BOOST_CHECK(analyzed->code[lastPush - 7] == (byte)Instruction::PUSHC);
+    }
+    auto outcome = check(code, bytes());
+    BOOST_REQUIRE_EQUAL(outcome.status, EVMC_SUCCESS);
+    BOOST_REQUIRE_EQUAL(outcome.output.size(), 64u);
+    BOOST_CHECK_EQUAL(fromBigEndian<u256>(bytesConstRef(&outcome.output[0], 32)), u256(0x10000));
+    BOOST_CHECK_EQUAL(fromBigEndian<u256>(bytesConstRef(&outcome.output[32], 32)), u256(0xffff));
+}
+
+
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace test
@@ -76,10 +76,11 @@ public:
         }
     }
     void open() { m_alive = true; }
-    void write(boost::asio::mutable_buffers_1 buffers)
+    void write(std::vector<boost::asio::const_buffer> const& buffers)
     {
         auto b = std::make_shared<boost::asio::streambuf>();
-        boost::asio::streambuf::mutable_buffers_type bufs = b->prepare(buffers.size());
+        boost::asio::streambuf::mutable_buffers_type bufs =
+            b->prepare(boost::asio::buffer_size(buffers));
         auto copydSize = boost::asio::buffer_copy(bufs, buffers);
         b->commit(copydSize);
         m_queue.push(b);
@@ -0,0 +1,162 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/**
+ * @brief: unit test for the write path of Session
+ *
+ * @file SessionTest.cpp
+ */
+
+#include "libnetwork/Host.h"
+#include "FakeASIOInterface.h"
+#include "libnetwork/Session.h"
+#include "libp2p/P2PMessage.h"
+#include <test/tools/libutils/TestOutputHelper.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace dev;
+using namespace std;
+using namespace dev::network;
+using namespace dev::p2p;
+using namespace dev::test;
+
+namespace test_Session
+{
+/// the host is running without the io_service thread, the test polls the io_service itself
+class FakeHost : public dev::network::Host
+{
+public:
+    bool haveNetwork() const override { return true; }
+};
+
+/// the session never reads, the fake socket reads back what the session wrote
+class WriteOnlyASIOInterface : public FakeASIOInterface
+{
+public:
+    void strandPost(Base_Handler) override {}
+};
+
+struct SessionFixture : public TestOutputHelperFixture
+{
+    SessionFixture()
+    {
+        m_sslContext =
+            std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tlsv12);
+        m_ioService = std::make_shared<ba::io_service>();
+        m_asioInterface = std::make_shared<WriteOnlyASIOInterface>();
+        m_asioInterface->setIOService(m_ioService);
+        m_asioInterface->setSSLContext(m_sslContext);
+        m_asioInterface->setType(dev::network::ASIOInterface::SSL);
+
+        m_host = std::make_shared<FakeHost>();
+        m_host->setASIOInterface(m_asioInterface);
+
+        auto endpoint =
+            NodeIPEndpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0, 8888);
+        m_socket = std::dynamic_pointer_cast<FakeSocket>(m_asioInterface->newSocket(endpoint));
+        m_session = std::make_shared<Session>();
+        m_session->setHost(m_host);
+        m_session->setSocket(m_socket);
+        m_session->start();
+    }
+
+    P2PMessage::Ptr newMessage(uint32_t _seq, size_t _size)
+    {
+        auto message = std::make_shared<P2PMessage>();
+        message->setSeq(_seq);
+        message->setProtocolID(1);
+        message->setBuffer(std::make_shared<bytes>(_size, static_cast<uint8_t>(_seq)));
+        return message;
+    }
+
+    /// one streambuf of the fake socket per asyncWrite
+    bytes readWrite()
+    {
+        bytes buffer(1024 * 1024);
+        auto size = m_socket->doRead(boost::asio::buffer(buffer));
+        buffer.resize(size);
+        return buffer;
+    }
+
+    std::shared_ptr<boost::asio::ssl::context> m_sslContext;
+    std::shared_ptr<ba::io_service> m_ioService;
+    std::shared_ptr<WriteOnlyASIOInterface> m_asioInterface;
+    std::shared_ptr<FakeHost> m_host;
+    std::shared_ptr<FakeSocket> m_socket;
+    Session::Ptr m_session;
+};
+
+BOOST_FIXTURE_TEST_SUITE(SessionTest, SessionFixture)
+
+BOOST_AUTO_TEST_CASE(coalescedWrite)
+{
+    BOOST_CHECK(m_session->actived());
+    std::vector<P2PMessage::Ptr> messages;
+    for (uint32_t seq = 1; seq <= 4; ++seq)
+    {
+        messages.push_back(newMessage(seq, 100 * seq));
+        m_session->asyncSendMessage(messages.back());
+    }
+    /// the first message is written at once, the others queue up behind it
+    BOOST_CHECK_EQUAL(m_session->writeStatus().queueSize, 3u);
+
+    m_ioService->poll();
+    auto status = m_session->writeStatus();
+    BOOST_CHECK_EQUAL(status.queueSize, 0u);
+    BOOST_CHECK_EQUAL(status.writeRounds, 2u);
+    BOOST_CHECK_EQUAL(status.writtenMessages, 4u);
+
+    BOOST_CHECK(readWrite() == *messages[0]->encodedBuffer());
+    /// the queued messages go out in one write, in the order they were sent
+    bytes coalesced;
+    for (size_t i = 1; i < messages.size(); ++i)
+    {
+        auto encoded = messages[i]->encodedBuffer();
+        coalesced.insert(coalesced.end(), encoded->begin(), encoded->end());
+    }
+    BOOST_CHECK(readWrite() == coalesced);
+    BOOST_CHECK(readWrite().empty());
+}
+
+BOOST_AUTO_TEST_CASE(maxWriteBytes)
+{
+    m_session->setMaxWriteBytes(250);
+    std::vector<P2PMessage::Ptr> messages;
+    for (uint32_t seq = 1; seq <= 4; ++seq)
+    {
+        messages.push_back(newMessage(seq, 100));
+        m_session->asyncSendMessage(messages.back());
+    }
+    m_ioService->poll();
+
+    /// two messages of 100 bytes and the header fit into one write of up to 250 bytes
+    BOOST_CHECK(readWrite() == *messages[0]->encodedBuffer());
+    for (size_t i = 1; i < messages.size(); i += 2)
+    {
+        auto expected = *messages[i]->encodedBuffer();
+        if (i + 1 < messages.size())
+        {
+            auto next = messages[i + 1]->encodedBuffer();
+            expected.insert(expected.end(), next->begin(), next->end());
+        }
+        BOOST_CHECK(readWrite() == expected);
+    }
+    BOOST_CHECK_EQUAL(m_session->writeStatus().writeRounds, 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test_Session
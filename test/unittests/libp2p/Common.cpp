@@ -28,6 +28,7 @@
 
 #include <libdevcore/Assertions.h>
 #include <libp2p/P2PMessage.h>
+#include <libp2p/P2PMessageRC2.h>
 #include <test/tools/libutils/TestOutputHelper.h>
 #include <boost/test/unit_test.hpp>
 
@@ -152,6 +153,78 @@ BOOST_AUTO_TEST_CASE(testMessage)
     BOOST_CHECK_EQUAL("topic", t);*/
 }
 
+BOOST_AUTO_TEST_CASE(testSharedEncodedBuffer)
+{
+    auto msg = std::make_shared<p2p::P2PMessageRC2>();
+    msg->setProtocolID(8);
+    msg->setPacketType(1);
+    std::string s = "hello world!";
+    msg->setBuffer(std::make_shared<bytes>(s.begin(), s.end()));
+
+    /// encoded once and shared until the message changes
+    auto encoded = msg->encodedBuffer();
+    BOOST_CHECK(msg->encodedBuffer() == encoded);
+    bytes copied;
+    msg->encode(copied);
+    BOOST_CHECK(copied == *encoded);
+
+    /// a modified message is encoded into a new buffer, the queued one is left untouched
+    msg->setSeq(10);
+    auto reEncoded = msg->encodedBuffer();
+    BOOST_CHECK(reEncoded != encoded);
+    BOOST_CHECK(*encoded == copied);
+
+    auto message = std::make_shared<p2p::P2PMessageRC2>();
+    BOOST_CHECK(message->decode(reEncoded->data(), reEncoded->size()) == (ssize_t)msg->length());
+    BOOST_CHECK(message->seq() == 10);
+    BOOST_CHECK(*message->buffer() == bytes(s.begin(), s.end()));
+}
+
+BOOST_AUTO_TEST_CASE(testDecodeView)
+{
+    auto msg = std::make_shared<p2p::P2PMessageRC2>();
+    msg->setProtocolID(8);
+    msg->setSeq(10);
+    std::string s = "hello world!";
+    msg->setBuffer(std::make_shared<bytes>(s.begin(), s.end()));
+    auto encoded = msg->encodedBuffer();
+
+    /// two packets and an incomplete one in the same receive chunk
+    auto chunk = std::make_shared<bytes>(*encoded);
+    chunk->insert(chunk->end(), encoded->begin(), encoded->end());
+    chunk->insert(chunk->end(), encoded->begin(), encoded->begin() + 3);
+
+    auto first = std::make_shared<p2p::P2PMessageRC2>();
+    ssize_t length = first->decodeView(chunk, 0, chunk->size());
+    BOOST_CHECK(length == (ssize_t)encoded->size());
+    auto second = std::make_shared<p2p::P2PMessageRC2>();
+    BOOST_CHECK(second->decodeView(chunk, length, chunk->size() - length) == length);
+    auto third = std::make_shared<p2p::P2PMessageRC2>();
+    BOOST_CHECK(third->decodeView(chunk, length * 2, chunk->size() - length * 2) ==
+                dev::network::PACKET_INCOMPLETE);
+
+    /// the payload points into the chunk, which lives as long as the messages
+    BOOST_CHECK(first->payload().data() == chunk->data() + p2p::P2PMessageRC2::HEADER_LENGTH);
+    std::weak_ptr<bytes> weakChunk = chunk;
+    chunk.reset();
+    BOOST_CHECK(!weakChunk.expired());
+    BOOST_CHECK(first->payload().toString() == s);
+    BOOST_CHECK(second->seq() == 10);
+
+    /// buffer() copies the payload out and releases the chunk
+    BOOST_CHECK(*first->buffer() == bytes(s.begin(), s.end()));
+    BOOST_CHECK(*second->buffer() == bytes(s.begin(), s.end()));
+    BOOST_CHECK(weakChunk.expired());
+
+    /// a decoded message can be forwarded as is
+    second->setSeq(11);
+    auto forwarded = std::make_shared<p2p::P2PMessageRC2>();
+    auto reEncoded = second->encodedBuffer();
+    BOOST_CHECK(forwarded->decode(reEncoded->data(), reEncoded->size()) == length);
+    BOOST_CHECK(forwarded->seq() == 11);
+    BOOST_CHECK(forwarded->payload().toString() == s);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }  // namespace test
 }  // namespace dev
@@ -131,6 +131,10 @@ BOOST_AUTO_TEST_CASE(CRUD)
     Json::Reader reader;
     reader.parse(selectResult, entryJson);
     BOOST_TEST(entryJson.size() == 1);
+    BOOST_TEST(entryJson[0]["item_name"].asString() == "apple");
+    BOOST_TEST(entryJson[0].isMember(ID_FIELD));
+    BOOST_TEST(entryJson[0].isMember(NUM_FIELD));
+    BOOST_TEST(entryJson[0][STATUS].asString() == "0");
 
     // select table not exist
     param.clear();
@@ -591,6 +591,235 @@ BOOST_AUTO_TEST_CASE(checkAndClear)
     select_condition_invoker();
 }
 
+BOOST_AUTO_TEST_CASE(shardedCache)
+{
+    BOOST_TEST(cachedStorage->shardNum() >= 16u);
+    BOOST_TEST((cachedStorage->shardNum() & (cachedStorage->shardNum() - 1)) == 0u);
+
+    // "a_" + "b" and "a" + "_b" were the same key when table and key were concatenated
+    BOOST_TEST(!(CacheKey("a_", "b") == CacheKey("a", "_b")));
+    BOOST_TEST(CacheKey("a", "b") == CacheKey("a", "b"));
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_shard";
+    tableInfo->key = "key";
+
+    tbb::atomic<size_t> mismatch = 0;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, 1000), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+            {
+                auto result = cachedStorage->selectNoCondition(
+                    h256(), 0, tableInfo, boost::lexical_cast<std::string>(i), nullptr);
+                if (std::get<1>(result)->key() != boost::lexical_cast<std::string>(i))
+                {
+                    ++mismatch;
+                }
+            }
+        });
+
+    BOOST_TEST(mismatch == 0u);
+    BOOST_TEST(cachedStorage->cacheSize() == 1000u);
+
+    cachedStorage->clear();
+    BOOST_TEST(cachedStorage->cacheSize() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(clockEviction)
+{
+    auto clock = std::make_shared<ClockEvictionPolicy>();
+
+    std::vector<Cache::Ptr> caches;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto cache = std::make_shared<Cache>();
+        cache->setKey(boost::lexical_cast<std::string>(i));
+        caches.push_back(cache);
+        clock->onInsert(cache);
+    }
+    BOOST_TEST(clock->size() == 3u);
+
+    // the accessed cache gets a second chance
+    caches[0]->touch();
+    auto victim = clock->evictOne([](const Cache::Ptr&) { return true; });
+    BOOST_TEST(victim == caches[1]);
+    BOOST_TEST(!caches[0]->accessed());
+    BOOST_TEST(clock->size() == 2u);
+
+    // nothing evictable
+    victim = clock->evictOne([](const Cache::Ptr&) { return false; });
+    BOOST_TEST(!victim);
+    BOOST_TEST(clock->size() == 2u);
+
+    clock->clear();
+    BOOST_TEST(clock->size() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(evictByCapacity)
+{
+    cachedStorage->setMaxCapacity(1);
+    cachedStorage->setSyncNum(100);
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_test";
+    tableInfo->key = "Name";
+
+    auto result = cachedStorage->selectNoCondition(h256(), 0, tableInfo, "LiSi", nullptr);
+    BOOST_TEST(std::get<1>(result)->entries()->size() == 1u);
+    result = decltype(result)();
+
+    BOOST_TEST(cachedStorage->status().capacity > 0);
+    BOOST_TEST(cachedStorage->cacheSize() == 1u);
+
+    cachedStorage->checkAndClear();
+
+    auto cacheStatus = cachedStorage->status();
+    BOOST_TEST(cacheStatus.capacity == 0);
+    BOOST_TEST(cacheStatus.evictTimes == 1u);
+    BOOST_TEST(cacheStatus.queryTimes == 1u);
+    BOOST_TEST(cacheStatus.hitRatio() == 0);
+    BOOST_TEST(cachedStorage->cacheSize() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(evictAfterHit)
+{
+    cachedStorage->setMaxCapacity(1);
+    cachedStorage->setSyncNum(100);
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_test";
+    tableInfo->key = "Name";
+
+    // the hits do not add the cache object to the CLOCK ring again
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto result = cachedStorage->selectNoCondition(h256(), 0, tableInfo, "LiSi", nullptr);
+        BOOST_TEST(std::get<1>(result)->entries()->size() == 1u);
+    }
+    BOOST_TEST(cachedStorage->status().hitTimes == 2u);
+
+    cachedStorage->checkAndClear();
+    BOOST_TEST(cachedStorage->status().evictTimes == 1u);
+    BOOST_TEST(cachedStorage->cacheSize() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(evictPinned)
+{
+    cachedStorage->setMaxCapacity(1);
+    cachedStorage->setSyncNum(100);
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_test";
+    tableInfo->key = "Name";
+
+    auto result = cachedStorage->selectNoCondition(h256(), 0, tableInfo, "LiSi", nullptr);
+    auto cache = std::get<1>(result);
+    result = decltype(result)();
+
+    // a pinned cache object is kept
+    cache->pin();
+    cachedStorage->checkAndClear();
+    BOOST_TEST(cachedStorage->status().evictTimes == 0u);
+    BOOST_TEST(cachedStorage->cacheSize() == 1u);
+
+    // other references do not keep it
+    cache->unpin();
+    cachedStorage->checkAndClear();
+    BOOST_TEST(cachedStorage->status().evictTimes == 1u);
+    BOOST_TEST(cachedStorage->status().capacity == 0);
+    BOOST_TEST(cachedStorage->cacheSize() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(sharedSelect)
+{
+    auto storage = std::make_shared<CachedStorage>();
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_shared";
+    tableInfo->key = "Name";
+    tableInfo->fields.push_back("id");
+
+    auto tableData = std::make_shared<TableData>();
+    tableData->info = tableInfo;
+    auto entry = std::make_shared<Entry>();
+    entry->setField("Name", "LiSi");
+    entry->setField("id", "1");
+    entry->setForce(true);
+    tableData->newEntries->addEntry(entry);
+    storage->commit(h256(), 1, std::vector<TableData::Ptr>{tableData});
+
+    // reads share the cached entry
+    auto entries1 = storage->select(h256(), 2, tableInfo, "LiSi", nullptr);
+    auto entries2 = storage->select(h256(), 2, tableInfo, "LiSi", nullptr);
+    BOOST_TEST(entries1->size() == 1u);
+    BOOST_TEST(entries1->get(0) == entries2->get(0));
+
+    // a commit replaces the cached entry instead of writing through
+    auto published = entries1->get(0);
+    auto dirtyEntry = published->clone();
+    dirtyEntry->setField("id", "2");
+    tableData = std::make_shared<TableData>();
+    tableData->info = tableInfo;
+    tableData->dirtyEntries->addEntry(dirtyEntry);
+    storage->commit(h256(), 2, std::vector<TableData::Ptr>{tableData});
+
+    BOOST_TEST(published->getField("id") == "1");
+    auto entries3 = storage->select(h256(), 3, tableInfo, "LiSi", nullptr);
+    BOOST_TEST(entries3->get(0) != published);
+    BOOST_TEST(entries3->get(0)->getField("id") == "2");
+    BOOST_TEST(entries3->get(0)->num() == 2u);
+
+    storage->stop();
+}
+
+BOOST_AUTO_TEST_CASE(pendingBlock)
+{
+    auto storage = std::make_shared<CachedStorage>();
+    storage->setMaxPendingBlock(2);
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_pending";
+    tableInfo->key = "Name";
+    tableInfo->fields.push_back("id");
+
+    auto tableData = std::make_shared<TableData>();
+    tableData->info = tableInfo;
+    auto entry = std::make_shared<Entry>();
+    entry->setField("Name", "LiSi");
+    entry->setField("id", "1");
+    tableData->newEntries->addEntry(entry);
+    storage->commit(h256(), 1, std::vector<TableData::Ptr>{tableData});
+
+    // visible right after commit, whether or not it has been merged into the cache
+    auto entries = storage->select(h256(), 2, tableInfo, "LiSi", nullptr);
+    BOOST_TEST(entries->size() == 1u);
+    BOOST_TEST(entries->get(0)->getID() == 2u);
+
+    auto dirtyEntry = entries->get(0)->clone();
+    dirtyEntry->setField("id", "2");
+    tableData = std::make_shared<TableData>();
+    tableData->info = tableInfo;
+    tableData->dirtyEntries->addEntry(dirtyEntry);
+    storage->commit(h256(), 2, std::vector<TableData::Ptr>{tableData});
+
+    entries = storage->select(h256(), 3, tableInfo, "LiSi", nullptr);
+    BOOST_TEST(entries->size() == 1u);
+    BOOST_TEST(entries->get(0)->getField("id") == "2");
+    BOOST_TEST(entries->get(0)->num() == 2u);
+
+    for (size_t i = 0; i < 100 && storage->syncNum() != 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    BOOST_TEST(storage->syncNum() == 2);
+
+    entries = storage->select(h256(), 3, tableInfo, "LiSi", nullptr);
+    BOOST_TEST(entries->size() == 1u);
+    BOOST_TEST(entries->get(0)->getField("id") == "2");
+
+    storage->stop();
+}
+
 BOOST_AUTO_TEST_CASE(dirtyAndNew)
 {
 #if 0
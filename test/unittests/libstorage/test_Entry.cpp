@@ -61,6 +61,63 @@ BOOST_AUTO_TEST_CASE(copyFrom)
     BOOST_TEST(entry2->refCount() == 1);
 }
 
+BOOST_AUTO_TEST_CASE(clone)
+{
+    auto entry1 = std::make_shared<Entry>();
+    entry1->setField("key", "value");
+    entry1->setID(10);
+    entry1->setNum(5);
+
+    auto entry2 = entry1->clone();
+    BOOST_TEST(entry1->refCount() == 2);
+    BOOST_TEST(entry2->getID() == 10u);
+    BOOST_TEST(entry2->num() == 5u);
+    BOOST_TEST(entry2->getField("key") == "value");
+
+    entry2->setField("key", "value2");
+    entry2->setStatus(1);
+    BOOST_TEST(entry2->getField("key") == "value2");
+    BOOST_TEST(entry1->getField("key") == "value");
+    BOOST_TEST(entry1->getStatus() == 0);
+    BOOST_TEST(entry1->refCount() == 1);
+    BOOST_TEST(entry2->refCount() == 1);
+
+    auto entry3 = entry1->clone();
+    entry3.reset();
+    BOOST_TEST(entry1->refCount() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(fields)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->reserve(3);
+    entry->setField("c", "3");
+    entry->setField("a", "1");
+    entry->setField("b", "2");
+    entry->setField("a", "11");
+
+    // iterates in name order like std::map
+    std::vector<std::string> names;
+    for (auto& it : *entry)
+    {
+        names.push_back(it.first);
+    }
+    BOOST_TEST(names == std::vector<std::string>({"a", "b", "c"}));
+    BOOST_TEST(entry->size() == 3u);
+    BOOST_TEST(entry->find("a")->second == "11");
+    BOOST_TEST((entry->find("d") == entry->end()));
+    BOOST_TEST(entry->capacity() == 7);
+
+    // system fields are integers, not stored as fields
+    entry->setID(7);
+    entry->setNum(8);
+    entry->setStatus(1);
+    BOOST_TEST(entry->getField(ID_FIELD) == "7");
+    BOOST_TEST(entry->getField(NUM_FIELD) == "8");
+    BOOST_TEST(entry->getField(STATUS) == "1");
+    BOOST_TEST(entry->size() == 3u);
+}
+
 BOOST_AUTO_TEST_CASE(parallel_copyFrom)
 {
 #if 0
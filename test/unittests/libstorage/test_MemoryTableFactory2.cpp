@@ -21,10 +21,13 @@
 #include <libstorage/Common.h>
 #include <libstorage/MemoryTable.h>
 #include <libstorage/MemoryTableFactory2.h>
+#include <libstorage/StateDiff.h>
 #include <libstorage/Storage.h>
+#include <libstorage/StorageException.h>
 #include <libstorage/Table.h>
 #include <tbb/parallel_for.h>
 #include <boost/test/unit_test.hpp>
+#include <functional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -51,6 +54,26 @@ public:
     bool onlyDirty() override { return false; }
 };
 
+/// the committed row of the key "id" of t_test, so that an update makes a dirty entry
+class MockRowDB : public MockAMOPDB
+{
+public:
+    Entries::Ptr select(h256, int64_t, TableInfo::Ptr _tableInfo, const std::string& _key,
+        Condition::Ptr) override
+    {
+        Entries::Ptr entries = std::make_shared<Entries>();
+        if (_tableInfo->name == "t_test" && _key == "id")
+        {
+            auto entry = std::make_shared<Entry>();
+            entry->setField("key", "id");
+            entry->setField("value", "12345");
+            entry->setID(1);
+            entries->addEntry(entry);
+        }
+        return entries;
+    }
+};
+
 struct MemoryTableFactoryFixture2
 {
     MemoryTableFactoryFixture2()
@@ -232,6 +255,197 @@ BOOST_AUTO_TEST_CASE(open_sysTables)
     table = memoryDBFactory->openTable(SYS_HASH_2_BLOCK);
 }
 
+BOOST_AUTO_TEST_CASE(accessSet)
+{
+    memoryDBFactory->createTable("t_test", "key", "value", true, Address(), false);
+
+    TableAccessSet accessSet;
+    {
+        TableAccessSet::Scope scope(&accessSet);
+        Table::Ptr table = memoryDBFactory->openTable("t_test", true, false);
+        table->select("name", table->newCondition());
+        auto entry = table->newEntry();
+        entry->setField("value", "Lili");
+        table->insert("id", entry);
+    }
+    BOOST_TEST(TableAccessSet::current() == nullptr);
+
+    BOOST_TEST(accessSet.reads().count(TableAccessSet::Key("t_test", "name")));
+    BOOST_TEST(accessSet.reads().count(TableAccessSet::Key(SYS_TABLES, "t_test")));
+    BOOST_TEST(accessSet.writes().size() == 1u);
+    BOOST_TEST(accessSet.writes().count(TableAccessSet::Key("t_test", "id")));
+
+    TableAccessSet predicted;
+    predicted.addRead("t_test", "name");
+    predicted.addRead(SYS_TABLES, "t_test");
+    BOOST_TEST(!accessSet.coveredBy(predicted));
+    predicted.addWrite("t_test", "id");
+    BOOST_TEST(accessSet.coveredBy(predicted));
+}
+
+BOOST_AUTO_TEST_CASE(stateDiff)
+{
+    memoryDBFactory->createTable("t_test", "key", "value", true, Address(), false);
+    auto table = memoryDBFactory->openTable("t_test", true, false);
+    auto entry = table->newEntry();
+    entry->setField("key", "name");
+    entry->setField("value", "Lili");
+    table->insert("name", entry);
+    entry = table->newEntry();
+    entry->setField("key", "id");
+    entry->setField("value", "12345");
+    table->insert("id", entry);
+    // opened without being written
+    memoryDBFactory->openTable(SYS_CONFIG);
+    auto dbHash = memoryDBFactory->hash();
+
+    bytes encoded;
+    memoryDBFactory->exportStateDiff()->encode(encoded);
+    auto diff = StateDiff::decode(ref(encoded));
+    for (auto const& tableDiff : diff->tables)
+    {
+        if (tableDiff.info->name == SYS_CONFIG)
+        {
+            BOOST_TEST(!tableDiff.dirty);
+        }
+        if (tableDiff.info->name == "t_test")
+        {
+            BOOST_TEST(tableDiff.dirty);
+            BOOST_TEST(tableDiff.newEntries->size() == 2u);
+        }
+    }
+
+    auto importFactory = std::make_shared<dev::storage::MemoryTableFactory2>();
+    importFactory->setStateStorage(memoryDBFactory->stateStorage());
+    importFactory->importStateDiff(*diff);
+    BOOST_TEST(importFactory->hash() == dbHash);
+    auto entries = importFactory->openTable("t_test")->select("id", table->newCondition());
+    BOOST_TEST(entries->size() == 1u);
+    BOOST_TEST(entries->get(0)->getField("value") == "12345");
+
+    // any changed entry changes the hash
+    for (auto& tableDiff : diff->tables)
+    {
+        if (tableDiff.info->name == "t_test")
+        {
+            tableDiff.newEntries->get(0)->setField("value", "0");
+        }
+    }
+    importFactory = std::make_shared<dev::storage::MemoryTableFactory2>();
+    importFactory->setStateStorage(memoryDBFactory->stateStorage());
+    importFactory->importStateDiff(*diff);
+    BOOST_TEST(importFactory->hash() != dbHash);
+
+    BOOST_CHECK_THROW(StateDiff::decode(ref(encoded).cropped(0, encoded.size() - 1)),
+        StorageException);
+}
+
+BOOST_AUTO_TEST_CASE(stateDiffDirtyEntries)
+{
+    auto rowDB = std::make_shared<MockRowDB>();
+    auto factory = std::make_shared<dev::storage::MemoryTableFactory2>();
+    factory->setStateStorage(rowDB);
+    factory->createTable("t_test", "key", "value", true, Address(), false);
+    auto table = factory->openTable("t_test", true, false);
+    auto entry = table->newEntry();
+    entry->setField("value", "54321");
+    BOOST_TEST(table->update("id", entry, table->newCondition()) == 1);
+    auto dbHash = factory->hash();
+
+    bytes encoded;
+    factory->exportStateDiff()->encode(encoded);
+    auto importDiff = [&](uint64_t _id) {
+        auto diff = StateDiff::decode(ref(encoded));
+        for (auto& tableDiff : diff->tables)
+        {
+            if (tableDiff.info->name == "t_test")
+            {
+                BOOST_TEST(tableDiff.dirtyEntries->size() == 1u);
+                BOOST_TEST(tableDiff.dirtyEntries->get(0)->getID() == 1u);
+                tableDiff.dirtyEntries->get(0)->setID(_id);
+            }
+        }
+        auto importFactory = std::make_shared<dev::storage::MemoryTableFactory2>();
+        importFactory->setStateStorage(rowDB);
+        importFactory->importStateDiff(*diff);
+        return importFactory;
+    };
+
+    auto importFactory = importDiff(1);
+    BOOST_TEST(importFactory->hash() == dbHash);
+    auto entries = importFactory->openTable("t_test")->select("id", table->newCondition());
+    BOOST_TEST(entries->size() == 1u);
+    BOOST_TEST(entries->get(0)->getField("value") == "54321");
+
+    // the id of a dirty entry must be the one of a committed row of its key
+    BOOST_CHECK_THROW(importDiff(0), StorageException);
+    BOOST_CHECK_THROW(importDiff(2), StorageException);
+}
+
+BOOST_AUTO_TEST_CASE(stateDiffSchema)
+{
+    memoryDBFactory->createTable("t_test", "key", "value", true, Address(), false);
+    auto table = memoryDBFactory->openTable("t_test", true, false);
+    auto entry = table->newEntry();
+    entry->setField("key", "name");
+    entry->setField("value", "Lili");
+    table->insert("name", entry);
+    memoryDBFactory->openTable(SYS_CONFIG);
+    auto dbHash = memoryDBFactory->hash();
+
+    bytes encoded;
+    memoryDBFactory->exportStateDiff()->encode(encoded);
+    auto importDiff = [&](std::function<void(StateDiff::TableDiff&)> _tamper) {
+        auto diff = StateDiff::decode(ref(encoded));
+        for (auto& tableDiff : diff->tables)
+        {
+            _tamper(tableDiff);
+        }
+        auto importFactory = std::make_shared<dev::storage::MemoryTableFactory2>();
+        importFactory->setStateStorage(memoryDBFactory->stateStorage());
+        importFactory->importStateDiff(*diff);
+        return importFactory;
+    };
+
+    // the schema of t_test comes from the _sys_tables_ row of the diff, not from the diff
+    auto importFactory = importDiff([](StateDiff::TableDiff& _table) {
+        if (_table.info->name == "t_test")
+        {
+            _table.info->fields.push_back("extra");
+        }
+    });
+    BOOST_TEST(importFactory->hash() == dbHash);
+
+    // a field out of the schema
+    BOOST_CHECK_THROW(importDiff([](StateDiff::TableDiff& _table) {
+        if (_table.info->name == "t_test")
+        {
+            _table.info->fields.push_back("extra");
+            _table.newEntries->get(0)->setField("extra", "x");
+        }
+    }),
+        StorageException);
+    // a table missing in _sys_tables_
+    BOOST_CHECK_THROW(importDiff([](StateDiff::TableDiff& _table) {
+        if (_table.info->name == "t_test")
+        {
+            _table.info->name = "t_unknown";
+        }
+    }),
+        StorageException);
+    // the entries of a table opened without being written
+    BOOST_CHECK_THROW(importDiff([](StateDiff::TableDiff& _table) {
+        if (_table.info->name == SYS_CONFIG)
+        {
+            auto entry = std::make_shared<Entry>();
+            entry->setField("key", "tx_count_limit");
+            entry->setField("value", "1");
+            _table.newEntries->addEntry(entry);
+        }
+    }),
+        StorageException);
+}
+
 BOOST_AUTO_TEST_CASE(setBlockHash)
 {
     memoryDBFactory->setBlockHash(h256(0x12345));
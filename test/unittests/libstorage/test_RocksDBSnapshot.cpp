@@ -0,0 +1,173 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/** @file test_RocksDBSnapshot.cpp
+ */
+
+#include <libstorage/BasicRocksDB.h>
+#include <libstorage/Common.h>
+#include <libstorage/RocksDBSnapshot.h>
+#include <libstorage/RowCodec.h>
+#include <libstorage/StorageException.h>
+#include <test/tools/libutils/TestOutputHelper.h>
+#include <test/unittests/libethcore/FakeBlock.h>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+using namespace dev::storage;
+using namespace dev::test;
+
+namespace test_RocksDBSnapshot
+{
+struct RocksDBSnapshotFixture : public TestOutputHelperFixture
+{
+    RocksDBSnapshotFixture() { clear(); }
+    ~RocksDBSnapshotFixture() { clear(); }
+
+    void clear()
+    {
+        boost::filesystem::remove_all(sourcePath);
+        boost::filesystem::remove_all(targetPath);
+        boost::filesystem::remove_all(sstDir);
+    }
+
+    shared_ptr<rocksdb::DB> open(shared_ptr<BasicRocksDB> _basicDB, string const& _path)
+    {
+        rocksdb::Options options;
+        options.create_if_missing = true;
+        options.max_open_files = 200;
+        options.compression = rocksdb::kSnappyCompression;
+        return _basicDB->Open(options, _path);
+    }
+
+    void putRow(shared_ptr<BasicRocksDB> _basicDB, rocksdb::WriteBatch& _batch,
+        string const& _table, string const& _key, string const& _value)
+    {
+        auto entry = make_shared<Entry>();
+        entry->setField(SYS_KEY, _key);
+        entry->setField(SYS_VALUE, _value);
+        auto value = RowCodec::encode(nullptr, RowCodec::Rows{make_pair(entry, 0)});
+        _basicDB->Put(_batch, _table + "_" + _key, value);
+    }
+
+    string sourcePath = "snapshot_source_db";
+    string targetPath = "snapshot_target_db";
+    string sstDir = "snapshot_sst";
+};
+
+BOOST_FIXTURE_TEST_SUITE(RocksDBSnapshotTest, RocksDBSnapshotFixture)
+
+BOOST_AUTO_TEST_CASE(exportAndImport)
+{
+    FakeBlock fakeBlock(2, KeyPair::create().secret(), 3);
+    auto const& header = fakeBlock.getBlock().blockHeader();
+    auto source = make_shared<BasicRocksDB>();
+    auto sourceDB = open(source, sourcePath);
+    rocksdb::WriteBatch batch;
+    putRow(source, batch, SYS_CURRENT_STATE, SYS_KEY_CURRENT_NUMBER, "3");
+    putRow(source, batch, SYS_NUMBER_2_HASH, "3", header.hash().hex());
+    putRow(source, batch, SYS_HASH_2_BLOCK, header.hash().hex(), toHex(fakeBlock.getBlockData()));
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        putRow(source, batch, "t_test", to_string(i), string(100, 'v') + to_string(i));
+    }
+    source->Write(rocksdb::WriteOptions(), batch);
+
+    stringstream snapshot;
+    auto manifest = RocksDBSnapshot::exportSnapshot(source, sourceDB, snapshot, 4096);
+    BOOST_CHECK_EQUAL(manifest.number, 3);
+    BOOST_CHECK(manifest.blockHash == header.hash());
+    BOOST_CHECK(manifest.stateRoot == header.stateRoot());
+    BOOST_CHECK_EQUAL(manifest.keys, 2003u);
+    BOOST_CHECK(manifest.chunks > 1);
+
+    auto data = snapshot.str();
+    stringstream verified(data);
+    BOOST_CHECK(RocksDBSnapshot::verifySnapshot(verified).digest == manifest.digest);
+
+    auto target = make_shared<BasicRocksDB>();
+    auto targetDB = open(target, targetPath);
+    /// the head block in the manifest is not the one of the chunks, nothing is ingested
+    auto otherHead = data;
+    auto hash = header.hash();
+    auto pos = otherHead.rfind(string((char const*)hash.data(), h256::size));
+    BOOST_REQUIRE(pos != string::npos);
+    otherHead[pos] ^= 1;
+    stringstream otherHeadStream(otherHead);
+    BOOST_CHECK_THROW(
+        RocksDBSnapshot::importSnapshot(otherHeadStream, targetDB, sstDir, 16 * 1024, hash),
+        StorageException);
+    {
+        unique_ptr<rocksdb::Iterator> it(targetDB->NewIterator(rocksdb::ReadOptions()));
+        it->SeekToFirst();
+        BOOST_CHECK(!it->Valid());
+    }
+    BOOST_CHECK(!boost::filesystem::exists(sstDir));
+
+    /// the consistent snapshot of another head block than the trusted one
+    for (auto trusted : {make_pair(h256(), -1), make_pair(h256(1), -1), make_pair(hash, 2)})
+    {
+        stringstream untrusted(data);
+        BOOST_CHECK_THROW(RocksDBSnapshot::importSnapshot(untrusted, targetDB, sstDir, 16 * 1024,
+                              trusted.first, trusted.second),
+            StorageException);
+    }
+    stringstream untrusted(data);
+    BOOST_CHECK_THROW(RocksDBSnapshot::verifySnapshot(untrusted, h256(1)), StorageException);
+
+    /// the SST files are smaller than the data to ingest more than one of them
+    auto imported =
+        RocksDBSnapshot::importSnapshot(snapshot, targetDB, sstDir, 16 * 1024, hash, 3);
+    BOOST_CHECK(imported.digest == manifest.digest);
+    BOOST_CHECK(RocksDBSnapshot::readHead(target, rocksdb::ReadOptions()).blockHash ==
+                header.hash());
+    BOOST_CHECK(!boost::filesystem::exists(sstDir));
+
+    unique_ptr<rocksdb::Iterator> sourceIt(sourceDB->NewIterator(rocksdb::ReadOptions()));
+    unique_ptr<rocksdb::Iterator> targetIt(targetDB->NewIterator(rocksdb::ReadOptions()));
+    size_t keys = 0;
+    for (sourceIt->SeekToFirst(), targetIt->SeekToFirst(); sourceIt->Valid();
+         sourceIt->Next(), targetIt->Next())
+    {
+        BOOST_REQUIRE(targetIt->Valid());
+        BOOST_CHECK_EQUAL(sourceIt->key().ToString(), targetIt->key().ToString());
+        BOOST_CHECK_EQUAL(sourceIt->value().ToString(), targetIt->value().ToString());
+        ++keys;
+    }
+    BOOST_CHECK(!targetIt->Valid());
+    BOOST_CHECK_EQUAL(keys, 2003u);
+
+    /// only imported into an empty RocksDB
+    stringstream again(data);
+    BOOST_CHECK_THROW(RocksDBSnapshot::importSnapshot(again, targetDB, sstDir, 16 * 1024, hash),
+        StorageException);
+
+    /// a byte of a chunk changed
+    auto tampered = data;
+    tampered[tampered.size() / 2] ^= 1;
+    stringstream tamperedStream(tampered);
+    BOOST_CHECK_THROW(RocksDBSnapshot::verifySnapshot(tamperedStream), StorageException);
+    stringstream truncated(data.substr(0, data.size() - 1));
+    BOOST_CHECK_THROW(RocksDBSnapshot::verifySnapshot(truncated), StorageException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test_RocksDBSnapshot
@@ -57,8 +57,9 @@ class MockRocksDB : public BasicRocksDB
 public:
     MockRocksDB() {}
     virtual ~MockRocksDB() {}
-    Status Write(WriteOptions const&, WriteBatch& updates) override
+    Status Write(WriteOptions const& options, WriteBatch& updates) override
     {
+        writeOptions = options;
         auto batch = reinterpret_cast<MockWriteBatch*>(&updates);
         size_t count = batch->Count();
         auto input = batch->getOriginData();
@@ -76,7 +77,7 @@ public:
             if (key == "e_Exception")
                 return Status::InvalidArgument(Slice("InvalidArgument"));
             LOG(INFO) << "write key=" << key.ToString();
-            db.insert(std::make_pair(key.ToString(), value.ToString()));
+            db[key.ToString()] = value.ToString();
         }
         return Status::OK();
     }
@@ -213,6 +214,9 @@ private:
     MockRocksDB(const MockRocksDB&) = delete;
     void operator=(const MockRocksDB&) = delete;
     std::map<std::string, std::string> db;
+
+public:
+    WriteOptions writeOptions;
 };
 
 struct RocksDBFixture
@@ -220,7 +224,7 @@ struct RocksDBFixture
     RocksDBFixture()
     {
         rocksDB = std::make_shared<dev::storage::RocksDBStorage>();
-        std::shared_ptr<MockRocksDB> mockRocksDB = std::make_shared<MockRocksDB>();
+        mockRocksDB = std::make_shared<MockRocksDB>();
         rocksDB->setDB(mockRocksDB);
     }
     Entries::Ptr getEntries()
@@ -233,6 +237,7 @@ struct RocksDBFixture
         return entries;
     }
     dev::storage::RocksDBStorage::Ptr rocksDB;
+    std::shared_ptr<MockRocksDB> mockRocksDB;
 };
 
 BOOST_FIXTURE_TEST_SUITE(RocksDB, RocksDBFixture)
@@ -280,6 +285,52 @@ BOOST_AUTO_TEST_CASE(commit)
     BOOST_CHECK_EQUAL(entries->size(), 1u);
 }
 
+BOOST_AUTO_TEST_CASE(commitManyKeys)
+{
+    h256 h(0x01);
+    std::vector<dev::storage::TableData::Ptr> datas;
+    for (auto const& name : {"t_large", "t_small"})
+    {
+        dev::storage::TableData::Ptr tableData = std::make_shared<dev::storage::TableData>();
+        tableData->info->name = name;
+        tableData->info->key = "Name";
+        tableData->info->fields.push_back("id");
+        datas.push_back(tableData);
+    }
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        Entry::Ptr entry = std::make_shared<Entry>();
+        entry->setField("Name", "key" + std::to_string(i));
+        entry->setField("id", std::to_string(i));
+        datas[0]->newEntries->addEntry(entry);
+    }
+    datas[1]->newEntries = getEntries();
+    rocksDB->setWritePolicy(true, false);
+    BOOST_CHECK_EQUAL(rocksDB->commit(h, 1, datas), 2u);
+    BOOST_CHECK(mockRocksDB->writeOptions.sync);
+    BOOST_CHECK(!mockRocksDB->writeOptions.disableWAL);
+
+    auto tableInfo = std::make_shared<TableInfo>();
+    tableInfo->name = "t_large";
+    for (size_t i = 0; i < 1000; i += 99)
+    {
+        auto entries = rocksDB->select(
+            h, 1, tableInfo, "key" + std::to_string(i), std::make_shared<Condition>());
+        BOOST_REQUIRE_EQUAL(entries->size(), 1u);
+        BOOST_CHECK_EQUAL(entries->get(0)->getField("id"), std::to_string(i));
+    }
+
+    /// the new rows of a key are appended to the rows stored
+    datas[0]->newEntries = getEntries();
+    datas[1]->newEntries = getEntries();
+    rocksDB->setWritePolicy(false, true);
+    BOOST_CHECK_EQUAL(rocksDB->commit(h, 2, datas), 2u);
+    BOOST_CHECK(mockRocksDB->writeOptions.disableWAL);
+    tableInfo->name = "t_small";
+    auto entries = rocksDB->select(h, 2, tableInfo, "LiSi", std::make_shared<Condition>());
+    BOOST_CHECK_EQUAL(entries->size(), 2u);
+}
+
 BOOST_AUTO_TEST_CASE(exception)
 {
     h256 h(0x01);
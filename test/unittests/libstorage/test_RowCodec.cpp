@@ -0,0 +1,108 @@
+/*
+ * @CopyRight:
+ * FISCO-BCOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FISCO-BCOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FISCO-BCOS.  If not, see <http://www.gnu.org/licenses/>
+ * (c) 2016-2018 fisco-dev contributors.
+ */
+/** @file test_RowCodec.cpp
+ */
+
+#include <libstorage/RowCodec.h>
+#include <libstorage/StorageException.h>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+
+using namespace std;
+using namespace dev;
+using namespace dev::storage;
+
+namespace test_RowCodec
+{
+BOOST_AUTO_TEST_SUITE(RowCodecTest)
+
+BOOST_AUTO_TEST_CASE(encodeAndDecode)
+{
+    auto tableInfo = make_shared<TableInfo>();
+    tableInfo->name = "t_test";
+    tableInfo->key = "name";
+    tableInfo->fields = vector<string>{"value", "age"};
+
+    auto entry1 = make_shared<Entry>();
+    entry1->setField("name", "LiSi");
+    entry1->setField("value", "");
+    entry1->setField("age", "3");
+    entry1->setField("extra", "x");
+    entry1->setID(7);
+    entry1->setStatus(Entry::Status::DELETED);
+    auto entry2 = make_shared<Entry>();
+    entry2->setField("name", "LiSi");
+    entry2->setField("value", string(300, 'v'));
+    entry2->setID(300);
+
+    RowCodec::Rows rows{make_pair(entry1, 5), make_pair(entry2, 70000)};
+    auto value = RowCodec::encode(tableInfo, rows);
+    BOOST_CHECK(!RowCodec::isLegacy(value));
+
+    auto entries = RowCodec::decode(value);
+    BOOST_REQUIRE_EQUAL(entries.size(), 2u);
+    BOOST_CHECK(entries[0]->find("value") != entries[0]->end());
+    BOOST_CHECK_EQUAL(entries[0]->getField("value"), "");
+    BOOST_CHECK_EQUAL(entries[0]->getField("age"), "3");
+    BOOST_CHECK_EQUAL(entries[0]->getField("extra"), "x");
+    BOOST_CHECK_EQUAL(entries[0]->getID(), 7u);
+    BOOST_CHECK_EQUAL(entries[0]->num(), 5u);
+    BOOST_CHECK_EQUAL(entries[0]->getStatus(), Entry::Status::DELETED);
+    BOOST_CHECK(entries[1]->find("age") == entries[1]->end());
+    BOOST_CHECK_EQUAL(entries[1]->getField("value"), string(300, 'v'));
+    BOOST_CHECK_EQUAL(entries[1]->getID(), 300u);
+    BOOST_CHECK_EQUAL(entries[1]->num(), 70000u);
+
+    /// the truncated value
+    BOOST_CHECK_THROW(RowCodec::decode(value.substr(0, value.size() - 1)), StorageException);
+}
+
+BOOST_AUTO_TEST_CASE(upgradeLegacy)
+{
+    vector<map<string, string>> res{
+        {{"name", "LiSi"}, {"value", "1"}, {ID_FIELD, "9"}, {NUM_FIELD, "4"}, {STATUS, "0"}}};
+    stringstream ss;
+    {
+        boost::archive::binary_oarchive oa(ss);
+        oa << res;
+    }
+    auto legacy = ss.str();
+    BOOST_CHECK(RowCodec::isLegacy(legacy));
+    BOOST_CHECK_EQUAL(RowCodec::decode(legacy)[0]->getField("value"), "1");
+
+    auto value = RowCodec::upgrade(legacy);
+    BOOST_CHECK(!RowCodec::isLegacy(value));
+    auto entries = RowCodec::decode(value);
+    BOOST_REQUIRE_EQUAL(entries.size(), 1u);
+    BOOST_CHECK_EQUAL(entries[0]->getField("name"), "LiSi");
+    BOOST_CHECK_EQUAL(entries[0]->getField("value"), "1");
+    BOOST_CHECK(entries[0]->find(ID_FIELD) == entries[0]->end());
+    BOOST_CHECK_EQUAL(entries[0]->getID(), 9u);
+    BOOST_CHECK_EQUAL(entries[0]->num(), 4u);
+
+    /// the legacy value written is read back as it was before RowCodec
+    auto downgraded = RowCodec::downgrade(value);
+    BOOST_CHECK_EQUAL(downgraded, legacy);
+    BOOST_CHECK_EQUAL(RowCodec::encodeLegacy(RowCodec::Rows{make_pair(entries[0], 4)}), legacy);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test_RowCodec
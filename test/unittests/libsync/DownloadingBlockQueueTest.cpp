@@ -116,6 +116,58 @@ BOOST_AUTO_TEST_CASE(AllTest)
         fakeQueue.size() == c_maxDownloadingBlockQueueSize + c_maxDownloadingBlockQueueBufferSize);
 }
 
+BOOST_AUTO_TEST_CASE(DropHigherBlocksTest)
+{
+    DownloadingBlockQueue fakeQueue;
+    vector<shared_ptr<Block>> blocks;
+    for (size_t i = 0; i < c_maxDownloadingBlockQueueSize; ++i)
+    {
+        FakeBlock fakeBlock;
+        fakeBlock.getBlock().header().setNumber(static_cast<int64_t>(i + 2));
+        blocks.emplace_back(make_shared<Block>(fakeBlock.getBlock()));
+    }
+    fakeQueue.push(blocks);
+    fakeQueue.flushBufferToQueue();
+    BOOST_CHECK_EQUAL(fakeQueue.size(), c_maxDownloadingBlockQueueSize);
+
+    // the next block is in queue
+    fakeQueue.clearFullQueueIfNotHas(2);
+    BOOST_CHECK_EQUAL(fakeQueue.size(), c_maxDownloadingBlockQueueSize);
+
+    // block 1 is missing, keep the lower half
+    fakeQueue.clearFullQueueIfNotHas(1);
+    BOOST_CHECK_EQUAL(fakeQueue.size(), c_maxDownloadingBlockQueueSize / 2);
+    BOOST_CHECK_EQUAL(fakeQueue.top()->header().number(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(PreVerifyTest)
+{
+    DownloadingBlockQueue fakeQueue;
+    fakeQueue.registerPreVerifyHandler(
+        [](Block const& _block) { return _block.blockHeader().number() % 2 == 0; });
+    for (int64_t shard = 0; shard < 4; ++shard)
+    {
+        vector<shared_ptr<Block>> blocks;
+        for (int64_t i = shard * 10; i < (shard + 1) * 10; ++i)
+        {
+            FakeBlock fakeBlock;
+            fakeBlock.getBlock().header().setNumber(i);
+            blocks.emplace_back(make_shared<Block>(fakeBlock.getBlock()));
+        }
+        fakeQueue.push(blocks);
+    }
+    BOOST_CHECK(!fakeQueue.bufferEmpty());
+    fakeQueue.flushBufferToQueue();
+    BOOST_CHECK(fakeQueue.bufferEmpty());
+    // the blocks of odd numbers are dropped
+    BOOST_CHECK_EQUAL(fakeQueue.size(), 20u);
+    for (int64_t i = 0; i < 40; i += 2)
+    {
+        BOOST_CHECK_EQUAL(fakeQueue.top()->header().number(), i);
+        fakeQueue.pop();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }  // namespace test
 }  // namespace dev
@@ -369,6 +369,36 @@ BOOST_AUTO_TEST_CASE(MaintainDownloadingQueueTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(PipelinedDownloadingQueueTest)
+{
+    int64_t latestNumber = 6;
+    Secret sec = dev::KeyPair::create().secret();
+    FakeSyncToolsSet syncTools = fakeSyncToolsSet(1, 5, NodeID(100), sec);
+    std::shared_ptr<SyncMaster> sync = syncTools.sync;
+    std::shared_ptr<SyncMasterStatus> status = sync->syncStatus();
+    std::shared_ptr<BlockChainInterface> blockChain = syncTools.blockChain;
+
+    FakeBlockChain latestBlockChain(latestNumber + 1, 5, sec);
+    status->knownHighestNumber = latestNumber;
+    status->knownLatestHash = latestBlockChain.getBlockByNumber(latestNumber)->headerHash();
+    sync->noteDownloadingBegin();
+
+    // the blocks are decoded on the download worker, and executed once decoded
+    for (int64_t i = latestNumber; i > 0; --i)
+    {
+        status->bq().push(vector<shared_ptr<Block>>{latestBlockChain.getBlockByNumber(i)});
+    }
+    sync->maintainDownloadingQueueBuffer();
+    BOOST_CHECK_EQUAL(sync->maintainDownloadingQueue(), true);  // finish
+    BOOST_CHECK_EQUAL(blockChain->number(), latestNumber);
+    BOOST_CHECK(status->bq().empty());
+    for (int64_t i = 0; i <= latestNumber; ++i)
+    {
+        BOOST_CHECK_EQUAL(blockChain->getBlockByNumber(i)->headerHash(),
+            latestBlockChain.getBlockByNumber(i)->headerHash());
+    }
+}
+
 inline void maintainAllBlockRequest(std::shared_ptr<SyncMaster> _sync)
 {
     for (size_t i = 0; i < 20; i++)  // Repeat 20 times is enough to reach all peers.
@@ -419,6 +449,28 @@ BOOST_AUTO_TEST_CASE(maintainBlockRequestTest)
     BOOST_CHECK_EQUAL(service->getAsyncSendSizeByNodeID(NodeID(102)), 2);
 }
 
+BOOST_AUTO_TEST_CASE(ConcurrentBlockRequestTest)
+{
+    int64_t currentBlockNumber = 4;
+    FakeSyncToolsSet syncTools = fakeSyncToolsSet(currentBlockNumber + 1, 5, NodeID(100));
+    std::shared_ptr<SyncMaster> sync = syncTools.sync;
+    std::shared_ptr<FakeService> service = syncTools.service;
+
+    // all the peers are answered in one maintain
+    for (unsigned id = 101; id <= 106; id++)
+    {
+        sync->syncStatus()->newSyncPeerStatus(
+            SyncPeerInfo{NodeID(id), 0, m_genesisHash, m_genesisHash});
+        sync->syncStatus()->peerStatus(NodeID(id))->reqQueue.push(1, 4);
+    }
+    sync->maintainBlockRequest();
+    for (unsigned id = 101; id <= 106; id++)
+    {
+        BOOST_CHECK_EQUAL(service->getAsyncSendSizeByNodeID(NodeID(id)), 1);
+        BOOST_CHECK(sync->syncStatus()->peerStatus(NodeID(id))->reqQueue.empty());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(DoWorkTest)
 {
     int64_t currentBlockNumber = 0;
@@ -24,6 +24,7 @@
 #include "FakeSyncToolsSet.h"
 #include <libdevcrypto/Common.h>
 #include <libnetwork/Common.h>
+#include <libsync/DownloadingBlockQueue.h>
 #include <libsync/SyncMsgPacket.h>
 #include <test/tools/libutils/TestOutputHelper.h>
 #include <test/unittests/libethcore/FakeBlock.h>
@@ -172,6 +173,40 @@ BOOST_AUTO_TEST_CASE(SyncBlocksPacketTest)
     BOOST_CHECK(block.equalAll(fakeBlock.getBlock()));
 }
 
+BOOST_AUTO_TEST_CASE(SyncStateDiffBlocksPacketTest)
+{
+    FakeBlock fakeBlock1(2, KeyPair::create().secret(), 1);
+    FakeBlock fakeBlock2(2, KeyPair::create().secret(), 2);
+    vector<shared_ptr<bytes>> blockRLPs{make_shared<bytes>(fakeBlock1.getBlock().rlp()),
+        make_shared<bytes>(fakeBlock2.getBlock().rlp())};
+    // only the StateDiff of the first block is recorded
+    auto stateDiff = make_shared<bytes>(bytes{0x01, 0x02, 0x03});
+    vector<shared_ptr<bytes>> stateDiffs{stateDiff, nullptr};
+
+    SyncBlocksPacket blocksPacket;
+    blocksPacket.encode(blockRLPs, stateDiffs);
+    auto msgPtr = blocksPacket.toMessage(0x03);
+    blocksPacket.decode(fakeSessionPtr, msgPtr);
+    BOOST_CHECK(blocksPacket.packetType == StateDiffBlocksPacket);
+
+    DownloadingBlockQueue bq;
+    bq.push(blocksPacket.rlp(), true);
+    bq.flushBufferToQueue();
+    BOOST_CHECK_EQUAL(bq.size(), 2);
+    auto hash1 = fakeBlock1.getBlock().headerHash();
+    auto hash2 = fakeBlock2.getBlock().headerHash();
+    BOOST_REQUIRE(bq.stateDiff(hash1));
+    BOOST_CHECK(*bq.stateDiff(hash1) == *stateDiff);
+    BOOST_CHECK(!bq.stateDiff(hash2));
+
+    // the StateDiff leaves the queue with its block
+    BOOST_CHECK(bq.top()->headerHash() == hash1);
+    BOOST_CHECK(bq.top()->transactionReceipts().size() == 2);
+    bq.pop();
+    BOOST_CHECK(!bq.stateDiff(hash1));
+    BOOST_CHECK(bq.top()->headerHash() == hash2);
+}
+
 BOOST_AUTO_TEST_CASE(SyncReqBlockPacketTest)
 {
     SyncReqBlockPacket reqBlockPacket;
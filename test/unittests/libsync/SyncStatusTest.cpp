@@ -69,6 +69,36 @@ BOOST_AUTO_TEST_CASE(PeerNewHasDeleteTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(RequestWindowTest)
+{
+    SyncPeerInfo node{NodeID(1), 1, h256(1), h256(1)};
+    status.newSyncPeerStatus(node);
+    shared_ptr<SyncPeerStatus> peerStatus = status.peerStatus(node.nodeId);
+    BOOST_CHECK_EQUAL(peerStatus->requestWindow(), c_maxRequestBlocks);
+
+    // the blocks not requested
+    peerStatus->noteResponse(c_maxRequestBlocks, 1024);
+    BOOST_CHECK_EQUAL(peerStatus->requestWindow(), c_maxRequestBlocks);
+    BOOST_CHECK(!peerStatus->noteRequestTimeout());
+
+    // answered in time
+    peerStatus->noteRequest(c_maxRequestBlocks);
+    peerStatus->noteResponse(c_maxRequestBlocks / 2, 1024);
+    BOOST_CHECK_EQUAL(peerStatus->requestWindow(), c_maxRequestBlocks);
+    peerStatus->noteResponse(c_maxRequestBlocks / 2, 1024);
+    BOOST_CHECK_GT(peerStatus->requestWindow(), c_maxRequestBlocks);
+    BOOST_CHECK_LE(peerStatus->requestWindow(), c_maxPeerRequestBlocks);
+    BOOST_CHECK(!peerStatus->noteRequestTimeout());
+
+    // not answered
+    for (size_t i = 0; i < 10; i++)
+    {
+        peerStatus->noteRequest(c_maxRequestBlocks);
+        BOOST_CHECK(peerStatus->noteRequestTimeout());
+    }
+    BOOST_CHECK_EQUAL(peerStatus->requestWindow(), c_minPeerRequestBlocks);
+}
+
 BOOST_AUTO_TEST_CASE(PeerStatusTest)
 {
     unsigned id = 999;
@@ -54,6 +54,7 @@ public:
     void asyncSendMessageByNodeID(
         NodeID nodeID, P2PMessage::Ptr message, CallbackFuncWithSession, dev::p2p::Options) override
     {
+        Guard l(x_asyncSend);
         if (m_asyncSend.count(nodeID))
             m_asyncSend[nodeID]++;
         else
@@ -62,6 +63,7 @@ public:
     }
     size_t getAsyncSendSizeByNodeID(NodeID const& nodeID)
     {
+        Guard l(x_asyncSend);
         if (!m_asyncSend.count(nodeID))
             return 0;
         return m_asyncSend[nodeID];
@@ -69,6 +71,7 @@ public:
 
     P2PMessage::Ptr getAsyncSendMessageByNodeID(NodeID const& nodeID)
     {
+        Guard l(x_asyncSend);
         auto msg = m_asyncSendMsgs.find(nodeID);
         if (msg == m_asyncSendMsgs.end())
             return nullptr;
@@ -86,6 +89,8 @@ private:
     P2PSessionInfos m_sessionInfos;
     std::map<NodeID, size_t> m_asyncSend;
     std::map<NodeID, P2PMessage::Ptr> m_asyncSendMsgs;
+    /// the sync module sends to the peers concurrently
+    Mutex x_asyncSend;
     std::shared_ptr<dev::p2p::P2PMessageFactory> m_messageFactory;
     bool m_connected = false;
 };
@@ -136,6 +136,96 @@ BOOST_AUTO_TEST_CASE(testImportAndSubmit)
     pool_test.m_txPool->setMaxBlockLimit(100);
     BOOST_CHECK(pool_test.m_txPool->maxBlockLimit() == 100);
 }
+
+BOOST_AUTO_TEST_CASE(testBatchImport)
+{
+    TxPoolFixture pool_test(5, 5);
+    Transactions txs = pool_test.m_blockChain->getBlockByHash(pool_test.m_blockChain->numberHash(0))
+                           ->transactions();
+    for (size_t i = 0; i < txs.size(); i++)
+    {
+        txs[i].setNonce(txs[i].nonce() + u256(i) + u256(1));
+        txs[i].setBlockLimit(pool_test.m_blockChain->number() + u256(1));
+        Signature sig = sign(pool_test.m_blockChain->m_sec, txs[i].sha3(WithoutSignature));
+        txs[i].updateSignature(SignatureStruct(sig));
+    }
+    /// the same transaction twice in one batch and one with a broken signature
+    txs.push_back(txs[0]);
+    Transaction badTx = txs[1];
+    badTx.setNonce(badTx.nonce() + u256(100));
+    txs.push_back(badTx);
+
+    auto results = pool_test.m_txPool->batchImport(txs);
+    BOOST_CHECK(results.size() == txs.size());
+    for (size_t i = 0; i < 5; i++)
+    {
+        BOOST_CHECK(results[i] == ImportResult::Success);
+        BOOST_CHECK(txs[i].sender() == toAddress(KeyPair(pool_test.m_blockChain->m_sec).pub()));
+    }
+    BOOST_CHECK(results[5] == ImportResult::AlreadyKnown);
+    BOOST_CHECK(results[6] == ImportResult::Malformed);
+    BOOST_CHECK(pool_test.m_txPool->pendingSize() == 5);
+
+    /// importing the batch again only reports known transactions
+    Transactions knownTxs(txs.begin(), txs.begin() + 5);
+    results = pool_test.m_txPool->batchImport(knownTxs);
+    for (auto result : results)
+    {
+        BOOST_CHECK(result == ImportResult::AlreadyKnown);
+    }
+    BOOST_CHECK(pool_test.m_txPool->pendingSize() == 5);
+
+    /// a full pool refuses transactions before checking their signatures
+    pool_test.m_txPool->setTxPoolLimit(5);
+    Transactions fullTxs{badTx};
+    results = pool_test.m_txPool->batchImport(fullTxs);
+    BOOST_CHECK(results[0] == ImportResult::TransactionPoolIsFull);
+}
+
+BOOST_AUTO_TEST_CASE(testTopTransactionViews)
+{
+    TxPoolFixture pool_test(5, 5);
+    Transactions txs = pool_test.m_blockChain->getBlockByHash(pool_test.m_blockChain->numberHash(0))
+                           ->transactions();
+    for (size_t i = 0; i < txs.size(); i++)
+    {
+        txs[i].setNonce(txs[i].nonce() + u256(i) + u256(1));
+        txs[i].setBlockLimit(pool_test.m_blockChain->number() + u256(1));
+        Signature sig = sign(pool_test.m_blockChain->m_sec, txs[i].sha3(WithoutSignature));
+        txs[i].updateSignature(SignatureStruct(sig));
+    }
+    pool_test.m_txPool->batchImport(txs);
+
+    /// the views share the pooled transactions and keep the import order
+    h256Hash avoid;
+    auto views = pool_test.m_txPool->topTransactionViews(3, avoid, true);
+    BOOST_CHECK(views.size() == 3);
+    BOOST_CHECK(avoid.size() == 3);
+    for (size_t i = 0; i < views.size(); i++)
+    {
+        BOOST_CHECK(views[i]->sha3() == txs[i].sha3());
+    }
+    auto rest = pool_test.m_txPool->topTransactionViews(10, avoid, true);
+    BOOST_CHECK(rest.size() == 2);
+    BOOST_CHECK(rest[0]->sha3() == txs[3].sha3());
+    h256Hash emptyAvoid;
+    BOOST_CHECK(pool_test.m_txPool->topTransactionViews(1, emptyAvoid)[0] == views[0]);
+
+    /// lookup by hash, nullptr for the unknown ones
+    auto byHash = pool_test.m_txPool->transactionViews(h256s{txs[1].sha3(), h256(), txs[0].sha3()});
+    BOOST_CHECK(byHash.size() == 3);
+    BOOST_CHECK(byHash[0] == views[1]);
+    BOOST_CHECK(byHash[1] == nullptr);
+    BOOST_CHECK(byHash[2] == views[0]);
+
+    /// all transactions expire once the block number reaches their block limit
+    pool_test.m_blockChain->setBlockNumber(pool_test.m_blockChain->number() + 2);
+    pool_test.m_txPool->dropBlockTrans(Block());
+    BOOST_CHECK(pool_test.m_txPool->pendingSize() == 0);
+    BOOST_CHECK(pool_test.m_txPool->status().dropped == 5);
+    /// the views stay valid after the transactions left the pool
+    BOOST_CHECK(views[0]->sha3() == txs[0].sha3());
+}
 BOOST_AUTO_TEST_SUITE_END()
 }  // namespace test
 }  // namespace dev
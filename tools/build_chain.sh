@@ -513,12 +513,33 @@ function generate_group_ini()
     ; min block generation time(ms), the max block generation time is 1000 ms
     ;min_block_generation_time=500
     ;enable_dynamic_block_size=true
+    ; broadcast the prepare block as transaction hashes, all the sealers must support it
+    ;enable_compact_prepare=false
+    ; relay the prepare along a tree of the given fan-out instead of sending it to every sealer,
+    ; the leader sends it directly to the sealers that haven't signed it after 1/3 of the timeout
+    ;broadcast_tree_width=0
+    ; sync: fsync the pbft message backup before committing, async: write it before committing
+    ; and fsync it in the background, so only a power loss may lose it
+    ;backup_durability=async
 [storage]
     ; storage db type, rocksdb / mysql / external, rocksdb is recommended
     type=${storage_type}
     ; max cache memeory, MB
     max_capacity=256
     max_forward_block=10
+    ; blocks merged into the cache in the background while the next blocks commit, 0: merge in place
+    max_pending_block=1
+    ; max memory of the decoded and the encoded blocks cached, MB
+    ;block_cache_size=64
+    ; only for rocksdb, fsync the batch of every block / skip the WAL / pipeline the WAL writes
+    ;sync_write=false
+    ; disable_wal loses the blocks committed since the last memtable flush if the node crashes,
+    ; the node syncs them again from the others, but they are gone if all the nodes crash together
+    ;disable_wal=false
+    ;pipelined_write=false
+    ; only for rocksdb, write the rows in the compact format that the older nodes cannot read,
+    ; the rows are converted back with rocksdb-upgrade --downgrade after the node is stopped
+    ;compact_row_format=false
     ; only for external
     max_retry=100
     topic=DB
@@ -532,6 +553,13 @@ function generate_group_ini()
     limit=150000
 [tx_execute]
     enable_parallel=${enable_parallel}
+[sync]
+    ; only for the storage state, keep the table writes of every committed block for the peers
+    ;record_state_diff=false
+    ; the table writes of the latest blocks kept, the peers further behind execute the blocks
+    ;state_diff_keep_blocks=10000
+    ; apply the table writes recorded by the peers instead of executing the downloaded blocks
+    ;state_diff_sync=false
 EOF
 }
 